@@ -15,6 +15,9 @@
 /// \author Jens Wiechula, Jens.Wiechula@ikf.uni-frankfurt.de
 
 #include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
 
 #include "Rtypes.h"
 #include "TLinearFitter.h"
@@ -155,7 +158,147 @@ namespace mathBase {
         chi2=-1.;
     }
     return chi2;
-  
+
+  }
+
+  /// fast fit of an array with ranges (histogram) with gaussian function
+  ///
+  /// Same procedure and return values as fitGaus, but the weighted linear fit of the parabola is
+  /// solved directly via the normal equations instead of using static fitter objects.
+  /// Therefore the function can be called from several threads in parallel.
+  ///
+  /// \param[in]  nbins size of the array and number of histogram bins
+  /// \param[in]  arr   array with elements
+  /// \param[in]  xMin  minimum range of the array
+  /// \param[in]  xMax  maximum range of the array
+  /// \param[out] param return paramters of the fit (0-Constant, 1-Mean, 2-Sigma, 3-Sum)
+  ///
+  /// \return chi2 or exit code, see fitGaus
+  template <typename T>
+  Double_t  fitGausThreadSafe(const size_t nBins, const T *arr, const T xMin, const T xMax, std::vector<T>& param)
+  {
+    const Double_t kTol = std::numeric_limits<Double_t>::epsilon();
+    T rms = TMath::RMS(nBins,arr);
+    T max = TMath::MaxElement(nBins,arr);
+    T binWidth = (xMax-xMin)/T(nBins);
+
+    Float_t meanCOG = 0;
+    Float_t rms2COG = 0;
+    Float_t sumCOG  = 0;
+
+    Float_t entries = 0;
+
+    param.resize(4);
+    param[0] = 0.;
+    param[1] = 0.;
+    param[2] = 0.;
+    param[3] = 0.;
+
+    for (size_t i=0; i<nBins; i++){
+      entries+=arr[i];
+    }
+
+    if (max<4) return -4;
+    if (entries<12) return -4;
+
+    if (rms<kTol) return -4;
+
+    param[3] = entries;
+
+    // sums of the normal equations of the parabola, the weight is the inverse squared error of the logarithm, i.e. the entries
+    Double_t sumX[5] = {0., 0., 0., 0., 0.};
+    Double_t sumXY[3] = {0., 0., 0.};
+
+    Int_t npoints=0;
+    for (size_t ibin=0; ibin<nBins; ibin++){
+      Float_t entriesI = arr[ibin];
+      if (entriesI>1){
+        Double_t xcenter = xMin+(ibin+0.5)*binWidth;
+        Double_t val = TMath::Log(Float_t(entriesI));
+        Double_t weightX = entriesI;
+        for (int k=0; k<5; ++k) {
+          sumX[k] += weightX;
+          if (k<3) sumXY[k] += weightX*val;
+          weightX *= xcenter;
+        }
+        if (npoints<3){
+          meanCOG+=xcenter*entriesI;
+          rms2COG +=xcenter*entriesI*xcenter;
+          sumCOG +=entriesI;
+        }
+        npoints++;
+      }
+    }
+
+    Double_t chi2 = 0;
+    if (npoints>=3){
+      // solve the normal equations by gaussian elimination with partial pivoting
+      Double_t mat[3][4];
+      for (int i=0; i<3; ++i) {
+        for (int j=0; j<3; ++j) mat[i][j] = sumX[i+j];
+        mat[i][3] = sumXY[i];
+      }
+      for (int col=0; col<3; ++col) {
+        int pivot = col;
+        for (int i=col+1; i<3; ++i) {
+          if (TMath::Abs(mat[i][col]) > TMath::Abs(mat[pivot][col])) pivot = i;
+        }
+        if (TMath::Abs(mat[pivot][col]) < kTol) return -4;
+        for (int j=0; j<4; ++j) std::swap(mat[col][j], mat[pivot][j]);
+        for (int i=col+1; i<3; ++i) {
+          const Double_t factor = mat[i][col]/mat[col][col];
+          for (int j=col; j<4; ++j) mat[i][j] -= factor*mat[col][j];
+        }
+      }
+      Double_t par[3];
+      for (int i=2; i>=0; --i) {
+        par[i] = mat[i][3];
+        for (int j=i+1; j<3; ++j) par[i] -= mat[i][j]*par[j];
+        par[i] /= mat[i][i];
+      }
+
+      if ( npoints == 3 ){
+        chi2 = -3.;
+      } else {
+        for (size_t ibin=0; ibin<nBins; ibin++){
+          Float_t entriesI = arr[ibin];
+          if (entriesI>1){
+            Double_t xcenter = xMin+(ibin+0.5)*binWidth;
+            Double_t residual = TMath::Log(Float_t(entriesI)) - (par[0] + par[1]*xcenter + par[2]*xcenter*xcenter);
+            chi2 += entriesI*residual*residual;
+          }
+        }
+        chi2 /= Double_t(npoints);
+      }
+      if (TMath::Abs(par[1])<kTol) return -4;
+      if (TMath::Abs(par[2])<kTol) return -4;
+
+      param[1] = T(par[1]/(-2.*par[2]));
+      param[2] = T(1./TMath::Sqrt(TMath::Abs(-2.*par[2])));
+      Double_t lnparam0 = par[0]+ par[1]* param[1] +  par[2]*param[1]*param[1];
+      if ( lnparam0>307 ) return -4;
+      param[0] = TMath::Exp(lnparam0);
+
+      return chi2;
+    }
+
+    if (npoints == 2){
+      //use center of gravity for 2 points
+      meanCOG/=sumCOG;
+      rms2COG /=sumCOG;
+      param[0] = max;
+      param[1] = meanCOG;
+      param[2] = TMath::Sqrt(TMath::Abs(meanCOG*meanCOG-rms2COG));
+      chi2=-2.;
+    }
+    if ( npoints == 1 ){
+      meanCOG/=sumCOG;
+      param[0] = max;
+      param[1] = meanCOG;
+      param[2] = binWidth/TMath::Sqrt(12);
+      chi2=-1.;
+    }
+    return chi2;
   }
 
   /// struct for returning statistical parameters
@@ -21,6 +21,8 @@
 
 #pragma link C++ function o2::mathUtils::mathBase::fitGaus < float > ;
 #pragma link C++ function o2::mathUtils::mathBase::fitGaus < double > ;
+#pragma link C++ function o2::mathUtils::mathBase::fitGausThreadSafe < float > ;
+#pragma link C++ function o2::mathUtils::mathBase::fitGausThreadSafe < double > ;
 
 #pragma link C++ function o2::mathUtils::mathBase::getStatisticsData < float > ;
 #pragma link C++ function o2::mathUtils::mathBase::getStatisticsData < double > ;
@@ -0,0 +1,50 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test MathBase
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "MathUtils/MathBase.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace o2::mathUtils::mathBase;
+
+BOOST_AUTO_TEST_CASE(fitGausThreadSafe_test)
+{
+  const size_t nBins = 121;
+  const float xMin = 0.f;
+  const float xMax = 121.f;
+
+  // histograms with different widths, down to three filled bins
+  for (const float sigma : {0.6f, 1.5f, 4.f}) {
+    std::vector<float> hist(nBins);
+    for (size_t i = 0; i < nBins; ++i) {
+      const float x = xMin + i + 0.5f - 60.3f;
+      hist[i] = std::round(1000.f * std::exp(-0.5f * x * x / (sigma * sigma)) + (i % 3));
+    }
+
+    std::vector<float> param, paramThreadSafe;
+    const double chi2 = fitGaus(nBins, hist.data(), xMin, xMax, param);
+    const double chi2ThreadSafe = fitGausThreadSafe(nBins, hist.data(), xMin, xMax, paramThreadSafe);
+
+    BOOST_CHECK_CLOSE(chi2ThreadSafe, chi2, 1e-2);
+    for (size_t i = 0; i < param.size(); ++i) {
+      BOOST_CHECK_CLOSE(paramThreadSafe[i], param[i], 1e-2);
+    }
+  }
+
+  // not enough entries
+  std::vector<float> empty(nBins);
+  std::vector<float> param;
+  BOOST_CHECK_EQUAL(fitGausThreadSafe(nBins, empty.data(), xMin, xMax, param), -4);
+}
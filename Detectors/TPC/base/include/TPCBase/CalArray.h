@@ -12,6 +12,9 @@
 #define ALICEO2_TPC_CALARRAY_H_
 
 #include <Vc/Vc>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <vector>
 #include <string>
@@ -27,6 +30,15 @@ using boost::format;
 namespace o2 {
 namespace TPC {
 
+/// Statistics of the values of a set of pads
+struct CalStatistics {
+  size_t entries = 0; ///< number of pads used
+  double mean = 0.;   ///< mean value
+  double stdDev = 0.; ///< standard deviation (normalised to the number of entries)
+  double min = 0.;    ///< minimum value
+  double max = 0.;    ///< maximum value
+};
+
 /// Class to hold calibration data on a pad level
 /// 
 /// Calibration data per pad for a certain subset of pads:
@@ -124,6 +136,21 @@ public:
 
   /// Divide value on all channels
   const CalArray& operator/= (const T& val);
+
+  /// Set all channels which are set in the mask (non zero) to a value
+  /// \param mask mask of the same pad subset
+  /// \param val value to set for the masked channels
+  template <class M>
+  const CalArray& applyMask(const CalArray<M>& mask, const T& val = T{});
+
+  /// Statistics of all channels
+  CalStatistics getStatistics() const;
+
+  /// Statistics of all channels which are not set in the mask
+  /// \param mask mask of the same pad subset
+  template <class M>
+  CalStatistics getStatistics(const CalArray<M>& mask) const;
+
 private:
   std::string mName;
   // better to use std::array?
@@ -135,6 +162,36 @@ private:
 
   /// initialize the data array depending on what is set as PadSubset
   void initData();
+
+  /// check if other has the same pad subset, print an error otherwise
+  template <class U>
+  bool isCompatible(const CalArray<U>& other) const;
+
+  /// Apply an operation on all channels: operation(value)
+  /// For float and double the channels are processed in SIMD vectors
+  template <class Operation>
+  void transform(Operation operation);
+
+  /// Apply an operation on all channels together with the same channel of other: operation(value, otherValue)
+  /// For float and double the channels are processed in SIMD vectors
+  template <class Operation>
+  void transform(const CalArray& other, Operation operation);
+
+  /// Statistics of all channels for which isUsed(channel) is true
+  template <class Selector>
+  CalStatistics computeStatistics(Selector isUsed) const;
+
+  /// SIMD vectors are only used for the floating point types
+  using UseSIMD = std::integral_constant<bool, std::is_same<T, float>::value || std::is_same<T, double>::value>;
+
+  template <class Operation>
+  void transform(Operation operation, std::true_type);
+  template <class Operation>
+  void transform(Operation operation, std::false_type);
+  template <class Operation>
+  void transform(const CalArray& other, Operation operation, std::true_type);
+  template <class Operation>
+  void transform(const CalArray& other, Operation operation, std::false_type);
 };
 
 // ===| pad region etc. initialisation |========================================
@@ -183,16 +240,100 @@ inline const T CalArray<T>::getValue(const size_t row, const size_t pad) const
 
 //______________________________________________________________________________
 template <class T>
-inline const CalArray<T>& CalArray<T>::operator+= (const CalArray<T>& other)
+template <class U>
+inline bool CalArray<T>::isCompatible(const CalArray<U>& other) const
 {
-  if ( !((mPadSubset == other.mPadSubset) && (mPadSubsetNumber == other.mPadSubsetNumber) ) ){
+  if ( !((mPadSubset == other.getPadSubset()) && (mPadSubsetNumber == other.getPadSubsetNumber()) && (mData.size() == other.getData().size())) ){
     LOG(ERROR) << "You are trying to operate on incompatible objects: Pad subset type and number must be the same on both objects"
                << FairLogger::endl;
-    return *this;
+    return false;
+  }
+  return true;
+}
+
+//______________________________________________________________________________
+template <class T>
+template <class Operation>
+inline void CalArray<T>::transform(Operation operation)
+{
+  transform(operation, UseSIMD());
+}
+
+//______________________________________________________________________________
+template <class T>
+template <class Operation>
+inline void CalArray<T>::transform(const CalArray& other, Operation operation)
+{
+  transform(other, operation, UseSIMD());
+}
+
+//______________________________________________________________________________
+template <class T>
+template <class Operation>
+inline void CalArray<T>::transform(Operation operation, std::true_type)
+{
+  using Vector = Vc::Vector<T>;
+  T* data = mData.data();
+  const size_t size = mData.size();
+  size_t i = 0;
+  for (; i + Vector::Size <= size; i += Vector::Size) {
+    Vector value(data + i, Vc::Unaligned);
+    operation(value);
+    value.store(data + i, Vc::Unaligned);
+  }
+  for (; i < size; ++i) {
+    operation(data[i]);
   }
+}
+
+//______________________________________________________________________________
+template <class T>
+template <class Operation>
+inline void CalArray<T>::transform(Operation operation, std::false_type)
+{
+  for (auto& data : mData) {
+    operation(data);
+  }
+}
+
+//______________________________________________________________________________
+template <class T>
+template <class Operation>
+inline void CalArray<T>::transform(const CalArray& other, Operation operation, std::true_type)
+{
+  using Vector = Vc::Vector<T>;
+  T* data = mData.data();
+  const T* otherData = other.mData.data();
+  const size_t size = mData.size();
+  size_t i = 0;
+  for (; i + Vector::Size <= size; i += Vector::Size) {
+    Vector value(data + i, Vc::Unaligned);
+    operation(value, Vector(otherData + i, Vc::Unaligned));
+    value.store(data + i, Vc::Unaligned);
+  }
+  for (; i < size; ++i) {
+    operation(data[i], otherData[i]);
+  }
+}
+
+//______________________________________________________________________________
+template <class T>
+template <class Operation>
+inline void CalArray<T>::transform(const CalArray& other, Operation operation, std::false_type)
+{
   for (size_t i=0; i<mData.size(); ++i) {
-    mData[i] += other.getValue(i);
+    operation(mData[i], other.mData[i]);
+  }
+}
+
+//______________________________________________________________________________
+template <class T>
+inline const CalArray<T>& CalArray<T>::operator+= (const CalArray<T>& other)
+{
+  if (!isCompatible(other)) {
+    return *this;
   }
+  transform(other, [](auto& value, const auto& otherValue) { value += otherValue; });
   return *this;
 }
 
@@ -200,14 +341,10 @@ inline const CalArray<T>& CalArray<T>::operator+= (const CalArray<T>& other)
 template <class T>
 inline const CalArray<T>& CalArray<T>::operator-= (const CalArray<T>& other)
 {
-  if ( !((mPadSubset == other.mPadSubset) && (mPadSubsetNumber == other.mPadSubsetNumber) ) ){
-    LOG(ERROR) << "You are trying to operate on incompatible objects: Pad subset type and number must be the same on both objects"
-               << FairLogger::endl;
+  if (!isCompatible(other)) {
     return *this;
   }
-  for (size_t i=0; i<mData.size(); ++i) {
-    mData[i] -= other.getValue(i);
-  }
+  transform(other, [](auto& value, const auto& otherValue) { value -= otherValue; });
   return *this;
 }
 
@@ -215,14 +352,10 @@ inline const CalArray<T>& CalArray<T>::operator-= (const CalArray<T>& other)
 template <class T>
 inline const CalArray<T>& CalArray<T>::operator*= (const CalArray<T>& other)
 {
-  if ( !((mPadSubset == other.mPadSubset) && (mPadSubsetNumber == other.mPadSubsetNumber) ) ){
-    LOG(ERROR) << "pad subste type of the objects it not compatible" 
-               << FairLogger::endl;
+  if (!isCompatible(other)) {
     return *this;
   }
-  for (size_t i=0; i<mData.size(); ++i) {
-    mData[i] *= other.getValue(i);
-  }
+  transform(other, [](auto& value, const auto& otherValue) { value *= otherValue; });
   return *this;
 }
 
@@ -230,14 +363,10 @@ inline const CalArray<T>& CalArray<T>::operator*= (const CalArray<T>& other)
 template <class T>
 inline const CalArray<T>& CalArray<T>::operator/= (const CalArray<T>& other)
 {
-  if ( !((mPadSubset == other.mPadSubset) && (mPadSubsetNumber == other.mPadSubsetNumber) ) ){
-    LOG(ERROR) << "pad subste type of the objects it not compatible" 
-               << FairLogger::endl;
+  if (!isCompatible(other)) {
     return *this;
   }
-  for (size_t i=0; i<mData.size(); ++i) {
-    mData[i] /= other.getValue(i);
-  }
+  transform(other, [](auto& value, const auto& otherValue) { value /= otherValue; });
   return *this;
 }
 
@@ -245,9 +374,7 @@ inline const CalArray<T>& CalArray<T>::operator/= (const CalArray<T>& other)
 template <class T>
 inline const CalArray<T>& CalArray<T>::operator+= (const T& val)
 {
-  for (auto& data : mData) {
-    data += val;
-  }
+  transform([val](auto& value) { value += val; });
   return *this;
 }
 
@@ -255,9 +382,7 @@ inline const CalArray<T>& CalArray<T>::operator+= (const T& val)
 template <class T>
 inline const CalArray<T>& CalArray<T>::operator-= (const T& val)
 {
-  for (auto& data : mData) {
-    data -= val;
-  }
+  transform([val](auto& value) { value -= val; });
   return *this;
 }
 
@@ -265,9 +390,7 @@ inline const CalArray<T>& CalArray<T>::operator-= (const T& val)
 template <class T>
 inline const CalArray<T>& CalArray<T>::operator*= (const T& val)
 {
-  for (auto& data : mData) {
-    data *= val;
-  }
+  transform([val](auto& value) { value *= val; });
   return *this;
 }
 
@@ -275,12 +398,80 @@ inline const CalArray<T>& CalArray<T>::operator*= (const T& val)
 template <class T>
 inline const CalArray<T>& CalArray<T>::operator/= (const T& val)
 {
-  for (auto& data : mData) {
-    data /= val;
+  transform([val](auto& value) { value /= val; });
+  return *this;
+}
+
+//______________________________________________________________________________
+template <class T>
+template <class M>
+inline const CalArray<T>& CalArray<T>::applyMask(const CalArray<M>& mask, const T& val)
+{
+  if (!isCompatible(mask)) {
+    return *this;
+  }
+  const auto& maskData = mask.getData();
+  for (size_t i=0; i<mData.size(); ++i) {
+    mData[i] = maskData[i] ? val : mData[i];
   }
   return *this;
 }
 
+//______________________________________________________________________________
+template <class T>
+inline CalStatistics CalArray<T>::getStatistics() const
+{
+  return computeStatistics([](size_t) { return true; });
+}
+
+//______________________________________________________________________________
+template <class T>
+template <class M>
+inline CalStatistics CalArray<T>::getStatistics(const CalArray<M>& mask) const
+{
+  if (!isCompatible(mask)) {
+    return CalStatistics();
+  }
+  const auto& maskData = mask.getData();
+  return computeStatistics([&maskData](size_t channel) { return !maskData[channel]; });
+}
+
+//______________________________________________________________________________
+template <class T>
+template <class Selector>
+inline CalStatistics CalArray<T>::computeStatistics(Selector isUsed) const
+{
+  CalStatistics statistics;
+  statistics.min = std::numeric_limits<double>::max();
+  statistics.max = std::numeric_limits<double>::lowest();
+
+  // two passes for the numerical stability of the standard deviation
+  double sum = 0.;
+  for (size_t i=0; i<mData.size(); ++i) {
+    if (!isUsed(i)) continue;
+    const double value = mData[i];
+    sum += value;
+    statistics.min = std::min(statistics.min, value);
+    statistics.max = std::max(statistics.max, value);
+    ++statistics.entries;
+  }
+
+  if (!statistics.entries) {
+    return CalStatistics();
+  }
+  statistics.mean = sum / statistics.entries;
+
+  double sumSquares = 0.;
+  for (size_t i=0; i<mData.size(); ++i) {
+    if (!isUsed(i)) continue;
+    const double deviation = mData[i] - statistics.mean;
+    sumSquares += deviation * deviation;
+  }
+  statistics.stdDev = std::sqrt(sumSquares / statistics.entries);
+
+  return statistics;
+}
+
 using CalROC = CalArray<float>;
 
 }
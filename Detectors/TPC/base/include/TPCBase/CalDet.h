@@ -11,6 +11,11 @@
 #ifndef ALICEO2_TPC_CALDET_H_
 #define ALICEO2_TPC_CALDET_H_
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <memory>
 #include <vector>
 #include <string>
@@ -23,12 +28,83 @@
 #include "TPCBase/Mapper.h"
 #include "TPCBase/ROC.h"
 #include "TPCBase/CalArray.h"
+#include "TPCBase/MappedFile.h"
+#include "TPCBase/ThreadPool.h"
 
 using boost::format;
 
 namespace o2 {
 namespace TPC {
 
+namespace calDetBinary {
+/// Header of the binary format written by CalDet::writeBinary
+///
+/// The header is followed by the name of the object, the number of values of
+/// each calibration array (uint32_t) and the values of all arrays. Name, sizes
+/// and each array start at a multiple of Alignment bytes, such that the values
+/// can be used directly from a memory mapping of the file.
+struct FileHeader {
+  static constexpr uint32_t Version = 1;
+  static constexpr size_t Alignment = 64;
+
+  char magic[8];           ///< file identifier
+  uint32_t version;        ///< version of the format
+  uint32_t valueType;      ///< size of the value type and flags for floating point and signed types
+  uint32_t padSubset;      ///< pad subset granularity
+  uint32_t numberOfArrays; ///< number of calibration arrays
+  uint32_t nameLength;     ///< length of the object name
+  uint32_t reserved;       ///< unused
+
+  FileHeader() = default;
+  FileHeader(uint32_t type, PadSubset subset, uint32_t arrays, uint32_t nameSize);
+
+  /// check file identifier and version
+  bool isValid() const;
+
+  /// value type identifier stored in the header
+  template <class T>
+  static constexpr uint32_t getValueType()
+  {
+    return sizeof(T) | (std::is_floating_point<T>::value << 8) | (std::is_signed<T>::value << 9);
+  }
+
+  /// round up to the next multiple of Alignment
+  static size_t align(size_t position) { return (position + Alignment - 1) / Alignment * Alignment; }
+
+  /// write zeros until the stream position is a multiple of Alignment
+  static void alignStream(std::ostream& stream);
+};
+
+/// write the values of a calibration array
+template <class T>
+void writeValues(std::ostream& stream, const std::vector<T>& values)
+{
+  stream.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+/// write the values of a calibration array, one byte per value
+inline void writeValues(std::ostream& stream, const std::vector<bool>& values)
+{
+  const std::vector<char> bytes(values.begin(), values.end());
+  stream.write(bytes.data(), bytes.size());
+}
+
+/// read the values of a calibration array of known size
+template <class T>
+void readValues(const char* buffer, std::vector<T>& values)
+{
+  std::memcpy(values.data(), buffer, values.size() * sizeof(T));
+}
+
+/// read the values of a calibration array of known size, one byte per value
+inline void readValues(const char* buffer, std::vector<bool>& values)
+{
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = buffer[i];
+  }
+}
+} // namespace calDetBinary
+
 /// Class to hold calibration data on a pad level
 ///
 template <class T>
@@ -38,6 +114,30 @@ public:
   CalDet() = default;
   ~CalDet() = default;
 
+  /// copies have their own thread pool with the same number of threads
+  CalDet(const CalDet& other)
+    : mName(other.mName),
+      mData(other.mData),
+      mPadSubset(other.mPadSubset)
+  {
+    setNumThreads(other.getNumThreads());
+  }
+
+  CalDet(CalDet&&) = default;
+
+  CalDet& operator=(const CalDet& other)
+  {
+    mName = other.mName;
+    mData = other.mData;
+    mPadSubset = other.mPadSubset;
+    if (getNumThreads() != other.getNumThreads()) {
+      setNumThreads(other.getNumThreads());
+    }
+    return *this;
+  }
+
+  CalDet& operator=(CalDet&&) = default;
+
   CalDet(PadSubset padSusbset)
     : mName{"PadCalibrationObject"},
       mData{},
@@ -93,13 +193,67 @@ public:
   const CalDet& operator-= (const T& val);
   const CalDet& operator*= (const T& val);
   const CalDet& operator/= (const T& val);
+
+  /// Set all channels which are set in the mask (non zero) to a value
+  /// \param mask mask with the same pad subset
+  /// \param val value to set for the masked channels
+  template <class M>
+  const CalDet& applyMask(const CalDet<M>& mask, const T& val = T{});
+
+  /// Statistics of each calibration array (e.g. per ROC)
+  std::vector<CalStatistics> getArrayStatistics() const;
+
+  /// Statistics of each calibration array (e.g. per ROC) excluding channels set in the mask
+  /// \param mask mask with the same pad subset
+  template <class M>
+  std::vector<CalStatistics> getArrayStatistics(const CalDet<M>& mask) const;
+
+  /// Statistics of all channels
+  CalStatistics getStatistics() const { return combineStatistics(getArrayStatistics()); }
+
+  /// Statistics of all channels which are not set in the mask
+  /// \param mask mask with the same pad subset
+  template <class M>
+  CalStatistics getStatistics(const CalDet<M>& mask) const { return combineStatistics(getArrayStatistics(mask)); }
+
+  /// Set the number of threads used to process the calibration arrays in parallel
+  /// By default the arrays are processed in the calling thread, the operations on a single
+  /// CalDet are too short to profit from threads unless it is processed repeatedly
+  /// \param nThreads number of threads, 0 uses the hardware concurrency
+  void setNumThreads(unsigned int nThreads) { mThreadPool.reset((nThreads == 1) ? nullptr : new ThreadPool(nThreads)); }
+
+  /// Number of threads used to process the calibration arrays
+  unsigned int getNumThreads() const { return mThreadPool ? mThreadPool->getNumThreads() : 1; }
+
+  /// Write the object in a compact binary format, see calDetBinary::FileHeader
+  /// \param fileName output file name
+  /// \return true on success
+  bool writeBinary(const std::string& fileName) const;
+
+  /// Read the object from the compact binary format written by writeBinary
+  /// \param fileName input file name
+  /// \return true on success, the object is unchanged otherwise
+  bool readBinary(const std::string& fileName);
+
 private:
   std::string mName;          ///< name of the object
   std::vector<CalType> mData; ///< internal CalArrays
   PadSubset mPadSubset;       ///< Pad subset granularity
+  std::unique_ptr<ThreadPool> mThreadPool; //!< threads for the processing of the calibration arrays, none for the calling thread only
 
   /// initialize the data array depending on what is set as PadSubset
   void initData();
+
+  /// check if other has the same pad subset, print an error otherwise
+  template <class U>
+  bool isCompatible(const CalDet<U>& other) const;
+
+  /// Call operation(index) for all calibration arrays, distributed over the threads of the pool
+  template <class Operation>
+  void forEachArray(Operation operation) const;
+
+  /// Combine the statistics of several sets of pads
+  static CalStatistics combineStatistics(const std::vector<CalStatistics>& statistics);
 };
 
 //______________________________________________________________________________
@@ -171,21 +325,44 @@ inline const T CalDet<T>::getValue(const CRU cru, const size_t row, const size_t
 
 //______________________________________________________________________________
 template <class T>
-inline const CalDet<T>& CalDet<T>::operator+= (const CalDet& other)
+template <class U>
+inline bool CalDet<T>::isCompatible(const CalDet<U>& other) const
 {
   // make sure the calibration objects have the same substructure
   // TODO: perhaps make it independed of this
-  if (mPadSubset != other.mPadSubset) {
+  if ((mPadSubset != other.getPadSubset()) || (mData.size() != other.getData().size())) {
     LOG(ERROR) << "Pad subste type of the objects it not compatible" 
                << FairLogger::endl;
+    return false;
+  }
+  return true;
+}
+
+//______________________________________________________________________________
+template <class T>
+template <class Operation>
+inline void CalDet<T>::forEachArray(Operation operation) const
+{
+  if (!mThreadPool) {
+    for (size_t i=0; i<mData.size(); ++i) {
+      operation(i);
+    }
+    return;
+  }
+  mThreadPool->run(mData.size(), [&operation](unsigned, size_t i) { operation(i); });
+}
+
+//______________________________________________________________________________
+template <class T>
+inline const CalDet<T>& CalDet<T>::operator+= (const CalDet& other)
+{
+  if (!isCompatible(other)) {
     return *this;
   }
   // somehow rootcint does not like boost::combine for some reason :(
   //for (auto& val : boost::combine(mData, other.mData)) {
     //val.get<0>() += val.get<1>();
-  for (size_t i=0; i<mData.size(); ++i) {
-    mData[i] += other.mData[i];
-  }
+  forEachArray([this, &other](size_t i) { mData[i] += other.mData[i]; });
   return *this;
 }
 
@@ -193,19 +370,13 @@ inline const CalDet<T>& CalDet<T>::operator+= (const CalDet& other)
 template <class T>
 inline const CalDet<T>& CalDet<T>::operator-= (const CalDet& other)
 {
-  // make sure the calibration objects have the same substructure
-  // TODO: perhaps make it independed of this
-  if (mPadSubset != other.mPadSubset) {
-    LOG(ERROR) << "Pad subste type of the objects it not compatible" 
-               << FairLogger::endl;
+  if (!isCompatible(other)) {
     return *this;
   }
   // somehow rootcint does not like boost::combine for some reason :(
   //for (auto& val : boost::combine(mData, other.mData)) {
     //val.get<0>() -= val.get<1>();
-  for (size_t i=0; i<mData.size(); ++i) {
-    mData[i] -= other.mData[i];
-  }
+  forEachArray([this, &other](size_t i) { mData[i] -= other.mData[i]; });
   return *this;
 }
 
@@ -213,19 +384,13 @@ inline const CalDet<T>& CalDet<T>::operator-= (const CalDet& other)
 template <class T>
 inline const CalDet<T>& CalDet<T>::operator*= (const CalDet& other)
 {
-  // make sure the calibration objects have the same substructure
-  // TODO: perhaps make it independed of this
-  if (mPadSubset != other.mPadSubset) {
-    LOG(ERROR) << "Pad subste type of the objects it not compatible" 
-               << FairLogger::endl;
+  if (!isCompatible(other)) {
     return *this;
   }
   // somehow rootcint does not like boost::combine for some reason :(
   //for (auto& val : boost::combine(mData, other.mData)) {
     //val.get<0>() *= val.get<1>();
-  for (size_t i=0; i<mData.size(); ++i) {
-    mData[i] *= other.mData[i];
-  }
+  forEachArray([this, &other](size_t i) { mData[i] *= other.mData[i]; });
   return *this;
 }
 
@@ -233,19 +398,13 @@ inline const CalDet<T>& CalDet<T>::operator*= (const CalDet& other)
 template <class T>
 inline const CalDet<T>& CalDet<T>::operator/= (const CalDet& other)
 {
-  // make sure the calibration objects have the same substructure
-  // TODO: perhaps make it independed of this
-  if (mPadSubset != other.mPadSubset) {
-    LOG(ERROR) << "Pad subste type of the objects it not compatible" 
-               << FairLogger::endl;
+  if (!isCompatible(other)) {
     return *this;
   }
   // somehow rootcint does not like boost::combine for some reason :(
   //for (auto& val : boost::combine(mData, other.mData)) {
     //val.get<0>() /= val.get<1>();
-  for (size_t i=0; i<mData.size(); ++i) {
-    mData[i] /= other.mData[i];
-  }
+  forEachArray([this, &other](size_t i) { mData[i] /= other.mData[i]; });
   return *this;
 }
 
@@ -253,9 +412,7 @@ inline const CalDet<T>& CalDet<T>::operator/= (const CalDet& other)
 template <class T>
 inline const CalDet<T>& CalDet<T>::operator+= (const T& val)
 {
-  for (auto& cal : mData) {
-    cal += val;
-  }
+  forEachArray([this, &val](size_t i) { mData[i] += val; });
   return *this;
 }
 
@@ -263,9 +420,7 @@ inline const CalDet<T>& CalDet<T>::operator+= (const T& val)
 template <class T>
 inline const CalDet<T>& CalDet<T>::operator-= (const T& val)
 {
-  for (auto& cal : mData) {
-    cal -= val;
-  }
+  forEachArray([this, &val](size_t i) { mData[i] -= val; });
   return *this;
 }
 
@@ -273,9 +428,7 @@ inline const CalDet<T>& CalDet<T>::operator-= (const T& val)
 template <class T>
 inline const CalDet<T>& CalDet<T>::operator*= (const T& val)
 {
-  for (auto& cal : mData) {
-    cal *= val;
-  }
+  forEachArray([this, &val](size_t i) { mData[i] *= val; });
   return *this;
 }
 
@@ -283,12 +436,166 @@ inline const CalDet<T>& CalDet<T>::operator*= (const T& val)
 template <class T>
 inline const CalDet<T>& CalDet<T>::operator/= (const T& val)
 {
-  for (auto& cal : mData) {
-    cal /= val;
+  forEachArray([this, &val](size_t i) { mData[i] /= val; });
+  return *this;
+}
+
+//______________________________________________________________________________
+template <class T>
+template <class M>
+inline const CalDet<T>& CalDet<T>::applyMask(const CalDet<M>& mask, const T& val)
+{
+  if (!isCompatible(mask)) {
+    return *this;
   }
+  forEachArray([this, &mask, &val](size_t i) { mData[i].applyMask(mask.getCalArray(i), val); });
   return *this;
 }
 
+//______________________________________________________________________________
+template <class T>
+inline std::vector<CalStatistics> CalDet<T>::getArrayStatistics() const
+{
+  std::vector<CalStatistics> statistics(mData.size());
+  forEachArray([this, &statistics](size_t i) { statistics[i] = mData[i].getStatistics(); });
+  return statistics;
+}
+
+//______________________________________________________________________________
+template <class T>
+template <class M>
+inline std::vector<CalStatistics> CalDet<T>::getArrayStatistics(const CalDet<M>& mask) const
+{
+  std::vector<CalStatistics> statistics(mData.size());
+  if (!isCompatible(mask)) {
+    return statistics;
+  }
+  forEachArray([this, &mask, &statistics](size_t i) { statistics[i] = mData[i].getStatistics(mask.getCalArray(i)); });
+  return statistics;
+}
+
+//______________________________________________________________________________
+template <class T>
+inline CalStatistics CalDet<T>::combineStatistics(const std::vector<CalStatistics>& statistics)
+{
+  CalStatistics combined;
+  double sum = 0.;
+  double sumSquares = 0.;
+  for (const auto& stat : statistics) {
+    if (!stat.entries) continue;
+    combined.min = combined.entries ? std::min(combined.min, stat.min) : stat.min;
+    combined.max = combined.entries ? std::max(combined.max, stat.max) : stat.max;
+    combined.entries += stat.entries;
+    sum += stat.mean * stat.entries;
+    sumSquares += (stat.stdDev * stat.stdDev + stat.mean * stat.mean) * stat.entries;
+  }
+  if (combined.entries) {
+    combined.mean = sum / combined.entries;
+    combined.stdDev = std::sqrt(std::max(sumSquares / combined.entries - combined.mean * combined.mean, 0.));
+  }
+  return combined;
+}
+
+//______________________________________________________________________________
+template <class T>
+bool CalDet<T>::writeBinary(const std::string& fileName) const
+{
+  using calDetBinary::FileHeader;
+
+  std::ofstream file(fileName, std::ios::binary);
+  if (!file.is_open()) {
+    LOG(ERROR) << "Can't open file " << fileName << " for writing" << FairLogger::endl;
+    return false;
+  }
+
+  const FileHeader header(FileHeader::getValueType<T>(), mPadSubset, mData.size(), mName.size());
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  FileHeader::alignStream(file);
+  file.write(mName.data(), mName.size());
+  FileHeader::alignStream(file);
+
+  std::vector<uint32_t> sizes;
+  for (const auto& calArray : mData) {
+    sizes.emplace_back(calArray.getData().size());
+  }
+  file.write(reinterpret_cast<const char*>(sizes.data()), sizes.size() * sizeof(uint32_t));
+
+  for (const auto& calArray : mData) {
+    FileHeader::alignStream(file);
+    calDetBinary::writeValues(file, calArray.getData());
+  }
+
+  if (!file.good()) {
+    LOG(ERROR) << "Error writing file " << fileName << FairLogger::endl;
+    return false;
+  }
+  return true;
+}
+
+//______________________________________________________________________________
+template <class T>
+bool CalDet<T>::readBinary(const std::string& fileName)
+{
+  using calDetBinary::FileHeader;
+
+  const MappedFile file(fileName);
+  if (!file.isOpen()) {
+    LOG(ERROR) << "Can't read file " << fileName << FairLogger::endl;
+    return false;
+  }
+
+  FileHeader header;
+  if (file.size() < sizeof(header)) {
+    LOG(ERROR) << "File " << fileName << " is too short for the header" << FairLogger::endl;
+    return false;
+  }
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (!header.isValid()) {
+    LOG(ERROR) << "File " << fileName << " is not a calibration object in binary format" << FairLogger::endl;
+    return false;
+  }
+  if (header.valueType != FileHeader::getValueType<T>()) {
+    LOG(ERROR) << "File " << fileName << " contains values of a different type" << FairLogger::endl;
+    return false;
+  }
+  if (header.padSubset > uint32_t(PadSubset::Region)) {
+    LOG(ERROR) << "File " << fileName << " has an unknown pad subset type " << header.padSubset << FairLogger::endl;
+    return false;
+  }
+
+  // the array sizes are given by the pad subset, only the layout is taken from the file
+  CalDet<T> calDet(PadSubset(header.padSubset));
+  const size_t valueSize = FileHeader::getValueType<T>() & 0xFF;
+  size_t position = FileHeader::align(sizeof(header));
+  const size_t namePosition = position;
+  position = FileHeader::align(position + header.nameLength);
+  const size_t sizesPosition = position;
+  position += header.numberOfArrays * sizeof(uint32_t);
+
+  if ((header.numberOfArrays != calDet.mData.size()) || (position > file.size())) {
+    LOG(ERROR) << "File " << fileName << " has an inconsistent number of calibration arrays" << FairLogger::endl;
+    return false;
+  }
+
+  for (size_t i=0; i<calDet.mData.size(); ++i) {
+    auto& values = calDet.mData[i].getData();
+    uint32_t size = 0;
+    std::memcpy(&size, file.data() + sizesPosition + i * sizeof(uint32_t), sizeof(size));
+    position = FileHeader::align(position);
+    if ((size != values.size()) || (position + size * valueSize > file.size())) {
+      LOG(ERROR) << "File " << fileName << " has an inconsistent size of calibration array " << i << FairLogger::endl;
+      return false;
+    }
+    calDetBinary::readValues(file.data() + position, values);
+    position += size * valueSize;
+  }
+
+  mName.assign(file.data() + namePosition, header.nameLength);
+  mData = std::move(calDet.mData);
+  mPadSubset = calDet.mPadSubset;
+  return true;
+}
+
 // ===| Full detector initialisation |==========================================
 template <class T>
 void CalDet<T>::initData()
@@ -0,0 +1,65 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// @file   MappedFile.h
+///
+
+/// @brief  Read only memory mapping of a file
+///
+/// The file is mapped for sequential reading, the data is valid as long
+/// as the object lives. A file only counts as open if it could be mapped,
+/// or if it is empty and there is nothing to map.
+///
+/// origin: TPC
+
+#ifndef ALICEO2_TPC_MAPPEDFILE_H_
+#define ALICEO2_TPC_MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace o2 {
+namespace TPC {
+
+class MappedFile
+{
+  public:
+    /// constructor, maps the file
+    /// @param [in] fileName name of the file
+    explicit MappedFile(const std::string& fileName);
+
+    /// destructor, unmaps the file
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// check if the file could be opened and mapped
+    /// @return true if the data can be accessed
+    bool isOpen() const { return mOpen; }
+
+    /// data of the file
+    /// @return pointer to the data, nullptr for an empty or unmapped file
+    const char* data() const { return static_cast<const char*>(mData); }
+
+    /// size of the file
+    /// @return size in bytes, 0 for an empty or unmapped file
+    size_t size() const { return mSize; }
+
+  private:
+    void* mData = nullptr;  ///< start of the mapping
+    size_t mSize = 0;       ///< size of the mapping
+    bool mOpen = false;     ///< the file is mapped or empty
+};
+
+} // namespace TPC
+} // namespace o2
+#endif
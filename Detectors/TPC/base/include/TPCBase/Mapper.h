@@ -265,6 +265,22 @@ public:
   const DigitPos findDigitPosFromLocalPosition(const LocalPosition3D& pos, const Sector& sec) const;
   const DigitPos findDigitPosFromGlobalPosition(const GlobalPosition3D& pos) const;
 
+  /// Find the pads of a set of global positions
+  /// The result is the same as the one of findDigitPosFromGlobalPosition, but the positions are passed as arrays
+  /// and processed with precomputed region tables, which is considerably faster for many positions
+  /// \param n number of positions
+  /// \param x global x positions
+  /// \param y global y positions
+  /// \param z global z positions
+  /// \param cru output CRU of each position, -1 if the position is not on a pad
+  /// \param row output pad row in the pad region
+  /// \param pad output pad in the row
+  /// \param padFraction if not nullptr, output position inside the pad along the row in units of the pad width, in [0, 1)
+  /// \param rowFraction if not nullptr, output position inside the pad across the row in units of the pad height, in [0, 1)
+  void findDigitPosFromGlobalPositions(const size_t n, const float* x, const float* y, const float* z,
+                                       int* cru, int* row, int* pad,
+                                       float* padFraction = nullptr, float* rowFraction = nullptr) const;
+
 
   static constexpr unsigned short getNumberOfIROCs() { return 36; }
   static constexpr unsigned short getNumberOfOROCs() { return 36; }
@@ -458,6 +474,13 @@ private:
   // ===| Pad number and row mappings |=========================================
   std::array<int, mNumberOfPadRowsIROC + mNumberOfPadRowsOROC> mMapNumberOfPadsPerRow; ///< number of pads per global pad row in sector
   std::array<int, mNumberOfPadRowsIROC + mNumberOfPadRowsOROC> mMapPadOffsetPerRow;    ///< global pad number offset in a row
+
+  // ===| Pad region tables for the fast pad finding |==========================
+  std::array<float, 10> mRegionRadiusFirstRow;  ///< lower edge of the first row of each pad region
+  std::array<float, 10> mRegionPadHeight;       ///< pad height of each pad region
+  std::array<float, 10> mRegionPadWidth;        ///< pad width of each pad region
+  std::array<int, 10>   mRegionNumberOfPadRows; ///< number of pad rows of each pad region
+  std::array<int, 10>   mRegionGlobalRowOffset; ///< global row offset of each pad region
 };
 
 // ===| inline functions |======================================================
@@ -20,6 +20,8 @@
 /// reused in order to save computing time.
 /// The numbers can then be used as a continuous stream in
 /// a ring buffer
+/// Copies of a ring contain the same numbers but have their own position,
+/// which allows e.g. several threads to draw reproducible sequences
 ///
 /// origin: TPC
 /// @author Jens Wiechula, Jens.Wiechula@cern.ch
@@ -30,6 +32,7 @@
 #include <boost/format.hpp>
 
 #include "Vc/Vc"
+#include <cstdint>
 #include <vector>
 
 #include "TF1.h"
@@ -110,16 +113,6 @@ class RandomRing
     std::vector<float, Vc::Allocator<float>> mRandomNumbers;  ///< Ring with random gaus numbers
     unsigned int mRingPosition;                               ///< presently accessed position in the ring
 
-    // =========================================================================
-    // ===| functions |=========================================================
-    //
-
-    /// disallow copy constructor
-    RandomRing(const RandomRing &);
-
-    /// disallow assignment operator
-    void operator=(const RandomRing &) {}
-
 }; // end class RandomRing
 
 //______________________________________________________________________________
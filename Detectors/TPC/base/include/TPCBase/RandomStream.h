@@ -0,0 +1,163 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// @file   RandomStream.h
+///
+
+/// @brief  Stream of random numbers from a counter based generator
+///
+/// The random numbers are obtained from the Philox4x32-10 generator,
+/// which computes the n-th random number of a stream directly from a
+/// key and the counter n. A stream is thus fully defined by its key,
+/// it does not depend on any global state and never repeats itself in
+/// practice. Deriving the key from e.g. the event, sector and hit
+/// number gives the same numbers whatever the order in which the
+/// hits are processed, also when running in several threads.
+///
+/// The numbers are produced in blocks, which are transformed into
+/// the requested distribution with Vc. Custom distributions given
+/// by a TF1 are sampled from a tabulated inverse cumulative
+/// distribution.
+///
+/// The interface follows the one of RandomRing.
+///
+/// origin: TPC
+
+#ifndef ALICEO2_TPC_RANDOMSTREAM_H_
+#define ALICEO2_TPC_RANDOMSTREAM_H_
+
+#include "Vc/Vc"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class TF1;
+
+using float_v=Vc::float_v;
+
+namespace o2 {
+namespace TPC {
+
+class RandomStream
+{
+  public:
+    enum class RandomType : char {
+      Gaus,                  ///< Gaussian distribution
+      Flat,                  ///< Flat distribution in [0, 1)
+      CustomTF1,             ///< Custom TF1 function to be used
+      None                   ///< Not selected, yet
+    };
+
+    /// number of random values produced at once
+    static constexpr size_t BlockSize = 64;
+
+    /// default constructor, all values are 0
+    RandomStream() = default;
+
+    /// constructor
+    /// @param [in] randomType type of the random distribution
+    RandomStream(const RandomType randomType) { initialize(randomType); }
+
+    /// constructor accepting TF1
+    /// @param [in] function TF1 function
+    /// @param [in] tableSize number of points of the tabulated inverse cumulative distribution
+    RandomStream(TF1 &function, const size_t tableSize = 16384) { initialize(function, tableSize); }
+
+    /// initialisation of the random stream
+    /// @param [in] randomType type of the random distribution
+    void initialize(const RandomType randomType = RandomType::Gaus);
+
+    /// initialisation of the random stream
+    /// @param [in] function TF1 function
+    /// @param [in] tableSize number of points of the tabulated inverse cumulative distribution
+    void initialize(TF1 &function, const size_t tableSize = 16384);
+
+    /// restart the stream with a new key
+    /// @param [in] key key of the stream
+    void setKey(uint64_t key)
+    {
+      mKey = key;
+      mCounter = 0;
+      mPosition = BlockSize;
+    }
+
+    /// key of the stream
+    /// @return key of the stream
+    uint64_t getKey() const { return mKey; }
+
+    /// next random value
+    /// @return next random value
+    float getNextValue()
+    {
+      if (mPosition >= BlockSize) {
+        fillBlock();
+      }
+      return mBlock[mPosition++];
+    }
+
+    /// next vector with random values
+    /// @return vector with random values
+    float_v getNextValueVc()
+    {
+      if (mPosition + float_v::Size > BlockSize) {
+        fillBlock();
+      }
+      const float_v value(&mBlock[mPosition], Vc::Unaligned);
+      mPosition += float_v::Size;
+      return value;
+    }
+
+    /// build a key from a set of numbers, e.g. event, sector and hit number
+    /// @param [in] event event number
+    /// @param [in] sector sector number
+    /// @param [in] hit hit number
+    /// @param [in] stream index of the stream using the key, to have independent streams for the same hit
+    /// @return key
+    static uint64_t makeKey(uint64_t event, uint64_t sector, uint64_t hit, uint64_t stream = 0)
+    {
+      return mix(mix(mix(mix(0, event), sector), hit), stream);
+    }
+
+    /// Philox4x32-10 generator
+    /// @param [in] counter counter
+    /// @param [in] key key
+    /// @return four random 32 bit values
+    static std::array<uint32_t, 4> philox(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key);
+
+  private:
+    /// combine a value into a hash (splitmix64 finalizer)
+    static uint64_t mix(uint64_t hash, uint64_t value)
+    {
+      uint64_t z = hash + (value + 1) * 0x9e3779b97f4a7c15ULL;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+    }
+
+    /// produce the next block of random values
+    void fillBlock();
+
+    // =========================================================================
+    // ===| members |===========================================================
+    //
+
+    RandomType mRandomType{ RandomType::None };           ///< Type of random numbers used
+    uint64_t mKey{ 0 };                                   ///< Key of the stream
+    uint64_t mCounter{ 0 };                               ///< Number of blocks produced with the present key
+    size_t mPosition{ BlockSize };                        ///< Position of the next value in the block
+    std::array<float, BlockSize> mBlock{ { 0.f } };      ///< Present block of random values
+    std::vector<float> mInverseCDF;                       ///< Tabulated inverse cumulative distribution of a custom TF1
+
+}; // end class RandomStream
+
+} // namespace TPC
+} // namespace o2
+#endif
@@ -0,0 +1,113 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// @file   ThreadPool.h
+///
+
+/// @brief  Pool of worker threads for data parallel loops
+///
+/// The pool threads live as long as the pool and wait for work between
+/// the calls, such that handing out a loop does not cost the creation
+/// of threads. The items of a loop are taken one by one from a shared
+/// counter, idle workers thus take over the remaining work. The calling
+/// thread takes part in the processing as worker 0.
+///
+/// Each worker has an ID below getNumThreads(), which can be used to
+/// index per-worker output buffers. Which worker processes which item is
+/// not deterministic, results have to be merged in item order if the
+/// output order matters.
+///
+/// origin: TPC
+
+#ifndef ALICEO2_TPC_THREADPOOL_H_
+#define ALICEO2_TPC_THREADPOOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace o2 {
+namespace TPC {
+
+class ThreadPool
+{
+  public:
+    /// function processing one item, called with the worker ID and the item index
+    using ItemFunction = std::function<void(unsigned workerID, size_t item)>;
+
+    /// constructor
+    /// @param [in] threads number of threads including the calling one, 0 for the hardware default
+    explicit ThreadPool(unsigned threads = 1) { setNumThreads(threads); }
+
+    /// destructor, stops and joins the pool threads
+    ~ThreadPool() { stopWorkers(); }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// set the number of threads, the pool is resized at the next call of run
+    /// @param [in] threads number of threads including the calling one, 0 for the hardware default
+    void setNumThreads(unsigned threads) { mNumThreads = std::max((threads == 0) ? std::thread::hardware_concurrency() : threads, 1u); }
+
+    /// number of threads including the calling one
+    /// @return number of threads, all worker IDs are below this number
+    unsigned getNumThreads() const { return mNumThreads; }
+
+    /// number of workers used for a given number of items
+    /// @param [in] nItems number of items
+    /// @return number of workers, at least 1
+    unsigned getNumWorkers(size_t nItems) const { return static_cast<unsigned>(std::max<size_t>(std::min<size_t>(mNumThreads, nItems), 1)); }
+
+    /// process the items 0 to nItems-1 in parallel and return when all are done
+    /// At most getNumWorkers(nItems) workers take part, a single worker runs in the calling thread only.
+    /// run must not be called concurrently on the same pool.
+    /// @param [in] nItems number of items
+    /// @param [in] function function called once for each item
+    void run(size_t nItems, const ItemFunction& function);
+
+  private:
+    /// process items until all items of the present call are taken
+    /// @param [in] workerID ID of the worker
+    void processItems(unsigned workerID);
+
+    /// main loop of the pool threads, waiting for work until the pool is stopped
+    /// @param [in] workerID ID of the worker
+    /// @param [in] generation counter of the calls at the start of the thread
+    void workerLoop(unsigned workerID, unsigned generation);
+
+    /// start the pool threads, if their number does not match the requested number of threads
+    void startWorkers();
+
+    /// stop and join the pool threads
+    void stopWorkers();
+
+    unsigned mNumThreads = 1;                   ///< Number of threads including the calling one
+    std::vector<std::thread> mWorkers;          ///< Pool threads, worker i+1 is mWorkers[i]
+    std::mutex mMutex;                          ///< Mutex protecting the pool state
+    std::condition_variable mStartCondition;    ///< Signals the pool threads new work or the stop request
+    std::condition_variable mDoneCondition;     ///< Signals the calling thread that all pool threads are done
+    unsigned mGeneration = 0;                   ///< Counter of the calls handed to the pool
+    unsigned mNumActive = 0;                    ///< Number of workers taking part in the present call
+    unsigned mActiveWorkers = 0;                ///< Number of pool threads still working on the present call
+    bool mStop = false;                         ///< Request to the pool threads to terminate
+    const ItemFunction* mFunction = nullptr;    ///< Function of the present call
+    size_t mNumItems = 0;                       ///< Number of items of the present call
+    std::atomic<size_t> mNextItem{ 0 };         ///< Next item to be taken by a worker
+};
+
+} // namespace TPC
+} // namespace o2
+#endif
@@ -11,3 +11,38 @@
 #include "TPCBase/CalDet.h"
 
 using namespace o2::TPC;
+using namespace o2::TPC::calDetBinary;
+
+namespace {
+constexpr char Magic[8] = {'O', '2', 'T', 'P', 'C', 'C', 'A', 'L'};
+}
+
+constexpr uint32_t FileHeader::Version;
+constexpr size_t FileHeader::Alignment;
+
+//______________________________________________________________________________
+FileHeader::FileHeader(uint32_t type, PadSubset subset, uint32_t arrays, uint32_t nameSize)
+  : magic(),
+    version(Version),
+    valueType(type),
+    padSubset(uint32_t(subset)),
+    numberOfArrays(arrays),
+    nameLength(nameSize),
+    reserved(0)
+{
+  std::memcpy(magic, Magic, sizeof(magic));
+}
+
+//______________________________________________________________________________
+bool FileHeader::isValid() const
+{
+  return (std::memcmp(magic, Magic, sizeof(magic)) == 0) && (version == Version);
+}
+
+//______________________________________________________________________________
+void FileHeader::alignStream(std::ostream& stream)
+{
+  static const char zeros[Alignment] = {};
+  const size_t position = stream.tellp();
+  stream.write(zeros, align(position) - position);
+}
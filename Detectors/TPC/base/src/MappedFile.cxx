@@ -0,0 +1,50 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "TPCBase/MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace o2::TPC;
+
+//______________________________________________________________________________
+MappedFile::MappedFile(const std::string& fileName)
+{
+  const int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) == 0) {
+    if (fileStat.st_size == 0) {
+      mOpen = true;
+    } else {
+      void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        mData = data;
+        mSize = fileStat.st_size;
+        mOpen = true;
+        madvise(mData, mSize, MADV_SEQUENTIAL);
+      }
+    }
+  }
+  close(fd);
+}
+
+//______________________________________________________________________________
+MappedFile::~MappedFile()
+{
+  if (mData) {
+    munmap(mData, mSize);
+  }
+}
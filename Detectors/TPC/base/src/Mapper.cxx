@@ -13,6 +13,7 @@
 #include <string>
 #include <sstream>
 #include <cstdlib>
+#include <algorithm>
 #include <cmath>
 
 // #include <boost/format.hpp>
@@ -21,6 +22,9 @@
 // using boost::format;
 
 #include "TPCBase/Mapper.h"
+
+#include <Vc/Vc>
+
 namespace o2 {
 namespace TPC {
   constexpr std::array<double, SECTORSPERSIDE> Mapper::SinsPerSector/*{{
@@ -230,6 +234,12 @@ void Mapper::initPadRegionsAndPartitions()
   int padsInRow=0;
   int padOffset=0;
   for (const auto& reg : mMapPadRegionInfo) {
+    const int region = reg.getPartition();
+    mRegionRadiusFirstRow[region] = reg.getRadiusFirstRow();
+    mRegionPadHeight[region]      = reg.getPadHeight();
+    mRegionPadWidth[region]       = reg.getPadWidth();
+    mRegionNumberOfPadRows[region] = reg.getNumberOfPadRows();
+    mRegionGlobalRowOffset[region] = reg.getGlobalRowOffset();
     for (int row=0; row<reg.getNumberOfPadRows(); ++row) {
       mMapPadOffsetPerRow[globalRow] = padOffset;
       padsInRow = reg.getPadsInRowRegion(row);
@@ -240,5 +250,69 @@ void Mapper::initPadRegionsAndPartitions()
   }
 }
 
+void Mapper::findDigitPosFromGlobalPositions(const size_t n, const float* x, const float* y, const float* z,
+                                             int* cru, int* row, int* pad,
+                                             float* padFraction, float* rowFraction) const
+{
+  using Vc::float_v;
+  const int nRegions = mMapPadRegionInfo.size();
+
+  for (size_t i = 0; i < n; i += float_v::Size) {
+    const size_t nLanes = std::min(float_v::size(), n - i);
+
+    // ===| find sectors |======================================================
+    float_v posX = float_v::Zero();
+    float_v posY = float_v::Zero();
+    if (nLanes == float_v::Size) {
+      posX.load(x + i, Vc::Unaligned);
+      posY.load(y + i, Vc::Unaligned);
+    } else {
+      for (size_t lane = 0; lane < nLanes; ++lane) {
+        posX[lane] = x[i + lane];
+        posY[lane] = y[i + lane];
+      }
+    }
+    float_v phi = Vc::atan2(posY, posX);
+    phi(phi < 0.f) += float(TWOPI);
+    const float_v secNum = Vc::min(Vc::floor(phi * float(1. / SECPHIWIDTH)), float_v(float(SECTORSPERSIDE - 1)));
+
+    // ===| rotate and find pad region, row and pad |===========================
+    // same arithmetic as GlobalToLocal and PadRegionInfo::findPad, but without branches
+    for (size_t lane = 0; lane < nLanes; ++lane) {
+      const size_t k = i + lane;
+      const int sec = int(secNum[lane]);
+      const double cs = CosinsPerSector[sec], sn = -SinsPerSector[sec];
+      const float localX = float(double(x[k]) * cs - double(y[k]) * sn);
+      const float localY = float(double(x[k]) * sn + double(y[k]) * cs);
+
+      int region = 0;
+      for (int r = 1; r < nRegions; ++r) {
+        region += (localX - mRegionRadiusFirstRow[r] > 0.f);
+      }
+      const float padWidth = mRegionPadWidth[region];
+      const float rowPosition = (localX - mRegionRadiusFirstRow[region]) / mRegionPadHeight[region];
+      const float rowInRegion = std::floor(rowPosition);
+      bool valid = (localX - mRegionRadiusFirstRow[0] > 0.f) && (rowInRegion < mRegionNumberOfPadRows[region]);
+      const int padRow = valid ? int(rowInRegion) : 0;
+
+      const unsigned int npads = mMapNumberOfPadsPerRow[mRegionGlobalRowOffset[region] + padRow];
+      const float localYfactor = (z[k] >= 0) ? -1.f : 1.f;
+      const float padPosition = (npads / 2 * padWidth - localYfactor * localY) / padWidth;
+      const int padInRow = int(padPosition);
+      valid = valid && (padInRow >= 0) && (padInRow < int(npads));
+
+      cru[k] = valid ? (sec + (z[k] < 0) * SECTORSPERSIDE) * CRU::CRUperSector + region : -1;
+      row[k] = padRow;
+      pad[k] = padInRow;
+      if (padFraction) {
+        padFraction[k] = valid ? std::min(padPosition - float(padInRow), 0.99999994f) : 0.f;
+      }
+      if (rowFraction) {
+        rowFraction[k] = valid ? std::min(rowPosition - rowInRegion, 0.99999994f) : 0.f;
+      }
+    }
+  }
+}
+
 }
 }
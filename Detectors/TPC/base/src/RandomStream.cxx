@@ -0,0 +1,111 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// @file   RandomStream.cxx
+///
+
+#include "TPCBase/RandomStream.h"
+
+#include "TF1.h"
+
+#include <cmath>
+
+using namespace o2::TPC;
+
+constexpr size_t RandomStream::BlockSize;
+
+//______________________________________________________________________________
+void RandomStream::initialize(const RandomType randomType)
+{
+  mRandomType = randomType;
+  mInverseCDF.clear();
+  setKey(mKey);
+}
+
+//______________________________________________________________________________
+void RandomStream::initialize(TF1 &function, const size_t tableSize)
+{
+  mRandomType = RandomType::CustomTF1;
+
+  // quantiles at equidistant probabilities from 0 to 1
+  std::vector<double> probabilities(tableSize);
+  std::vector<double> quantiles(tableSize);
+  for (size_t i = 0; i < tableSize; ++i) {
+    probabilities[i] = double(i) / double(tableSize - 1);
+  }
+  function.GetQuantiles(tableSize, quantiles.data(), probabilities.data());
+  mInverseCDF.assign(quantiles.begin(), quantiles.end());
+  setKey(mKey);
+}
+
+//______________________________________________________________________________
+std::array<uint32_t, 4> RandomStream::philox(std::array<uint32_t, 4> counter, std::array<uint32_t, 2> key)
+{
+  for (int round = 0; round < 10; ++round) {
+    const uint64_t product0 = uint64_t(0xD2511F53) * counter[0];
+    const uint64_t product1 = uint64_t(0xCD9E8D57) * counter[2];
+    counter = { { uint32_t(product1 >> 32) ^ counter[1] ^ key[0], uint32_t(product1),
+                  uint32_t(product0 >> 32) ^ counter[3] ^ key[1], uint32_t(product0) } };
+    key[0] += 0x9E3779B9;
+    key[1] += 0xBB67AE85;
+  }
+  return counter;
+}
+
+//______________________________________________________________________________
+void RandomStream::fillBlock()
+{
+  // ===| raw random bits, converted to flat values in [0, 1) |=================
+  const std::array<uint32_t, 2> key{ { uint32_t(mKey), uint32_t(mKey >> 32) } };
+  for (size_t i = 0; i < BlockSize; i += 4) {
+    const auto bits = philox({ { uint32_t(mCounter), uint32_t(mCounter >> 32), uint32_t(i / 4), 0u } }, key);
+    for (size_t j = 0; j < 4; ++j) {
+      mBlock[i + j] = (bits[j] >> 8) * (1.f / 16777216.f);
+    }
+  }
+  ++mCounter;
+  mPosition = 0;
+
+  // ===| transformation to the requested distribution |========================
+  switch (mRandomType) {
+    case RandomType::Flat: {
+      break;
+    }
+    case RandomType::Gaus: {
+      // Box-Muller transformation, two vectors of flat values give two vectors of gaussian values
+      for (size_t i = 0; i < BlockSize; i += 2 * float_v::Size) {
+        const float_v u1 = float_v::One() - float_v(&mBlock[i], Vc::Unaligned); // (0, 1], avoids log(0)
+        const float_v u2(&mBlock[i + float_v::Size], Vc::Unaligned);
+        const float_v radius = Vc::sqrt(-2.f * Vc::log(u1));
+        float_v sin, cos;
+        Vc::sincos(u2 * float(2. * M_PI), &sin, &cos);
+        (radius * cos).store(&mBlock[i], Vc::Unaligned);
+        (radius * sin).store(&mBlock[i + float_v::Size], Vc::Unaligned);
+      }
+      break;
+    }
+    case RandomType::CustomTF1: {
+      // linear interpolation in the tabulated inverse cumulative distribution
+      const float scale = mInverseCDF.size() - 1;
+      for (auto& value : mBlock) {
+        const float x = value * scale;
+        const size_t index = static_cast<size_t>(x);
+        const float fraction = x - index;
+        value = mInverseCDF[index] + fraction * (mInverseCDF[index + 1] - mInverseCDF[index]);
+      }
+      break;
+    }
+    default: {
+      mBlock.fill(0.f);
+      break;
+    }
+  }
+}
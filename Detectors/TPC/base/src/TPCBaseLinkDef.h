@@ -14,6 +14,7 @@
 #pragma link off all classes;
 #pragma link off all functions;
 
+#pragma link C++ class o2::TPC::CalStatistics+;
 #pragma link C++ class o2::TPC::CalArray<float>+;
 #pragma link C++ class o2::TPC::CalArray<double>+;
 #pragma link C++ class o2::TPC::CalArray<int>+;
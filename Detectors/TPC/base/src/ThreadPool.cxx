@@ -0,0 +1,110 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "TPCBase/ThreadPool.h"
+
+using namespace o2::TPC;
+
+//______________________________________________________________________________
+void ThreadPool::run(size_t nItems, const ItemFunction& function)
+{
+  const unsigned nWorkers = getNumWorkers(nItems);
+  if (nWorkers == 1) {
+    for (size_t item = 0; item < nItems; ++item) {
+      function(0, item);
+    }
+    return;
+  }
+
+  // hand the items to the pool, the calling thread takes part in the
+  // processing and waits for the pool threads afterwards
+  startWorkers();
+  mFunction = &function;
+  mNumItems = nItems;
+  mNextItem = 0;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mNumActive = nWorkers;
+    mActiveWorkers = nWorkers - 1;
+    ++mGeneration;
+  }
+  mStartCondition.notify_all();
+  processItems(0);
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDoneCondition.wait(lock, [this] { return mActiveWorkers == 0; });
+  }
+  mFunction = nullptr;
+}
+
+//______________________________________________________________________________
+void ThreadPool::processItems(unsigned workerID)
+{
+  for (size_t item = mNextItem++; item < mNumItems; item = mNextItem++) {
+    (*mFunction)(workerID, item);
+  }
+}
+
+//______________________________________________________________________________
+void ThreadPool::workerLoop(unsigned workerID, unsigned generation)
+{
+  while (true) {
+    {
+      // workers which are not needed for a call sleep through it
+      std::unique_lock<std::mutex> lock(mMutex);
+      mStartCondition.wait(lock, [this, workerID, generation] {
+        return mStop || (mGeneration != generation && workerID < mNumActive);
+      });
+      if (mStop) {
+        return;
+      }
+      generation = mGeneration;
+    }
+
+    processItems(workerID);
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (--mActiveWorkers == 0) {
+        mDoneCondition.notify_one();
+      }
+    }
+  }
+}
+
+//______________________________________________________________________________
+void ThreadPool::startWorkers()
+{
+  const unsigned nPoolThreads = mNumThreads - 1;
+  if (mWorkers.size() == nPoolThreads) {
+    return;
+  }
+
+  stopWorkers();
+  mStop = false;
+  const unsigned generation = mGeneration;
+  for (unsigned workerID = 1; workerID <= nPoolThreads; ++workerID) {
+    mWorkers.emplace_back([this, workerID, generation] { workerLoop(workerID, generation); });
+  }
+}
+
+//______________________________________________________________________________
+void ThreadPool::stopWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mStartCondition.notify_all();
+  for (auto& worker : mWorkers) {
+    worker.join();
+  }
+  mWorkers.clear();
+}
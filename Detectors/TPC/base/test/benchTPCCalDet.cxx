@@ -0,0 +1,112 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchTPCCalDet.cxx
+/// \brief Benchmark of the full TPC pad calibration object
+///
+/// Loading a CalPad from a ROOT file is compared to loading it from the compact binary
+/// format. The arithmetics and statistics are run with a varying number of threads, 1 is the
+/// default of a CalDet and 0 the hardware concurrency.
+/// The items per second give the number of pads per second.
+
+#include "benchmark/benchmark.h"
+
+#include "TPCBase/CalDet.h"
+#include "TFile.h"
+
+#include <cstdio>
+
+using namespace o2::TPC;
+
+namespace {
+/// CalPad with different values on all pads
+CalPad makeCalPad()
+{
+  CalPad pad(PadSubset::ROC);
+  int iter = 0;
+  for (auto& calArray : pad.getData()) {
+    for (auto& value : calArray.getData()) {
+      value = (iter++ % 1000) * 0.1f;
+    }
+  }
+  return pad;
+}
+
+size_t numberOfPads(const CalPad& pad)
+{
+  size_t nPads = 0;
+  for (const auto& calArray : pad.getData()) nPads += calArray.getData().size();
+  return nPads;
+}
+} // namespace
+
+static void BM_readROOT(benchmark::State& state)
+{
+  const auto pad = makeCalPad();
+  auto f = TFile::Open("benchCalDet.root", "recreate");
+  f->WriteObject(&pad, "CalPad");
+  delete f;
+
+  for (auto _ : state) {
+    CalPad* padRead = nullptr;
+    f = TFile::Open("benchCalDet.root");
+    f->GetObject("CalPad", padRead);
+    delete f;
+    benchmark::DoNotOptimize(padRead);
+    delete padRead;
+  }
+  state.SetItemsProcessed(state.iterations() * numberOfPads(pad));
+  std::remove("benchCalDet.root");
+}
+
+static void BM_readBinary(benchmark::State& state)
+{
+  const auto pad = makeCalPad();
+  pad.writeBinary("benchCalDet.bin");
+
+  for (auto _ : state) {
+    CalPad padRead;
+    padRead.readBinary("benchCalDet.bin");
+    benchmark::DoNotOptimize(padRead.getData().data());
+  }
+  state.SetItemsProcessed(state.iterations() * numberOfPads(pad));
+  std::remove("benchCalDet.bin");
+}
+
+static void BM_arithmetics(benchmark::State& state)
+{
+  auto pad = makeCalPad();
+  const auto pad2 = makeCalPad();
+  pad.setNumThreads(state.range(0));
+  for (auto _ : state) {
+    pad += pad2;
+    pad *= 0.5f;
+    benchmark::DoNotOptimize(pad.getData().data());
+  }
+  state.SetItemsProcessed(state.iterations() * numberOfPads(pad));
+}
+
+static void BM_statistics(benchmark::State& state)
+{
+  auto pad = makeCalPad();
+  pad.setNumThreads(state.range(0));
+  for (auto _ : state) {
+    const auto statistics = pad.getStatistics();
+    benchmark::DoNotOptimize(statistics);
+  }
+  state.SetItemsProcessed(state.iterations() * numberOfPads(pad));
+}
+
+BENCHMARK(BM_readROOT)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_readBinary)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_arithmetics)->Arg(1)->Arg(4)->Arg(8)->Arg(0);
+BENCHMARK(BM_statistics)->Arg(1)->Arg(4)->Arg(8)->Arg(0);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,81 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchTPCMapper.cxx
+/// \brief Benchmark of the pad finding in the TPC Mapper
+///
+/// The lookup of single positions with findDigitPosFromGlobalPosition is compared to the
+/// lookup of arrays of positions with findDigitPosFromGlobalPositions. The items per second
+/// give the number of lookups per second.
+
+#include "benchmark/benchmark.h"
+
+#include "TPCBase/Mapper.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace o2::TPC;
+
+namespace {
+/// Random positions in the full TPC volume
+struct Positions {
+  explicit Positions(size_t n) : x(n), y(n), z(n)
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> radius(80.f, 250.f);
+    std::uniform_real_distribution<float> phi(0.f, 2.f * PI);
+    std::uniform_real_distribution<float> posZ(-250.f, 250.f);
+    for (size_t i = 0; i < n; ++i) {
+      const float r = radius(generator);
+      const float p = phi(generator);
+      x[i] = r * std::cos(p);
+      y[i] = r * std::sin(p);
+      z[i] = posZ(generator);
+    }
+  }
+  std::vector<float> x, y, z;
+};
+} // namespace
+
+static void BM_findDigitPosScalar(benchmark::State& state)
+{
+  const Mapper& mapper = Mapper::instance();
+  const size_t n = state.range(0);
+  const Positions positions(n);
+  for (auto _ : state) {
+    int nValid = 0;
+    for (size_t i = 0; i < n; ++i) {
+      const DigitPos digi = mapper.findDigitPosFromGlobalPosition(GlobalPosition3D(positions.x[i], positions.y[i], positions.z[i]));
+      nValid += digi.isValid();
+    }
+    benchmark::DoNotOptimize(nValid);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_findDigitPosArray(benchmark::State& state)
+{
+  const Mapper& mapper = Mapper::instance();
+  const size_t n = state.range(0);
+  const Positions positions(n);
+  std::vector<int> cru(n), row(n), pad(n);
+  for (auto _ : state) {
+    mapper.findDigitPosFromGlobalPositions(n, positions.x.data(), positions.y.data(), positions.z.data(), cru.data(), row.data(), pad.data());
+    benchmark::DoNotOptimize(cru.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK(BM_findDigitPosScalar)->Arg(40)->Arg(10000);
+BENCHMARK(BM_findDigitPosArray)->Arg(40)->Arg(10000);
+
+BENCHMARK_MAIN();
@@ -15,6 +15,8 @@
 #include <boost/test/unit_test.hpp>
 #include <vector>
 #include <limits>
+#include <cmath>
+#include <cstdio>
 
 #include "TMath.h"
 #include "TPCBase/Mapper.h"
@@ -307,5 +309,152 @@ BOOST_AUTO_TEST_CASE(CalDet_Arithmetics)
   BOOST_CHECK_EQUAL(isEqual, true);
 }
 
+BOOST_AUTO_TEST_CASE(CalDet_Threads)
+{
+  // the same results for any number of threads
+  for (const auto padSubset : {PadSubset::ROC, PadSubset::Region}) {
+    CalPad pad(padSubset);
+    CalPad pad2(padSubset);
+
+    int iter = 0;
+    for (auto& calArray : pad.getData()) {
+      for (auto& value : calArray.getData()) {
+        value = iter % 1000 + 0.5f;
+        ++iter;
+      }
+    }
+    for (auto& calArray : pad2.getData()) {
+      for (auto& value : calArray.getData()) {
+        value = iter % 7 + 1.f;
+        ++iter;
+      }
+    }
+
+    CalPad padSingle = pad;
+    padSingle.setNumThreads(1);
+    padSingle *= pad2;
+    padSingle += 3.f;
+    padSingle /= pad2;
+
+    for (unsigned nThreads : {4u, 200u}) {
+      CalPad padThreads = pad;
+      padThreads.setNumThreads(nThreads);
+      padThreads *= pad2;
+      padThreads += 3.f;
+      padThreads /= pad2;
+
+      bool isEqual = true;
+      for (auto const& arrays : boost::combine(padThreads.getData(), padSingle.getData())) {
+        for (auto const& val : boost::combine(arrays.get<0>().getData(), arrays.get<1>().getData())) {
+          isEqual &= (val.get<0>() == val.get<1>());
+        }
+      }
+      BOOST_CHECK_EQUAL(isEqual, true);
+
+      // copies get their own threads
+      const CalPad padCopy = padThreads;
+      BOOST_CHECK_EQUAL(padCopy.getNumThreads(), nThreads);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CalDet_MaskAndStatistics)
+{
+  CalPad pad(PadSubset::ROC);
+  CalDet<bool> mask(PadSubset::ROC);
+
+  // every third pad is masked and has a large value
+  double sum = 0.;
+  double sumSquares = 0.;
+  size_t entries = 0;
+  for (size_t roc = 0; roc < pad.getData().size(); ++roc) {
+    auto& values = pad.getCalArray(roc).getData();
+    auto& masked = mask.getCalArray(roc).getData();
+    for (size_t i = 0; i < values.size(); ++i) {
+      masked[i] = (i % 3 == 0);
+      values[i] = masked[i] ? 1000.f : float(roc + i % 5);
+      if (masked[i]) continue;
+      sum += values[i];
+      sumSquares += values[i] * values[i];
+      ++entries;
+    }
+  }
+  const double mean = sum / entries;
+  const double stdDev = std::sqrt(sumSquares / entries - mean * mean);
+
+  // statistics per ROC
+  const auto arrayStatistics = pad.getArrayStatistics(mask);
+  BOOST_REQUIRE_EQUAL(arrayStatistics.size(), pad.getData().size());
+  BOOST_CHECK_EQUAL(arrayStatistics[5].min, 5.);
+  BOOST_CHECK_EQUAL(arrayStatistics[5].max, 9.);
+  BOOST_CHECK_CLOSE(arrayStatistics[5].mean, 7., 1.e-2);
+
+  // full detector statistics
+  const auto statistics = pad.getStatistics(mask);
+  BOOST_CHECK_EQUAL(statistics.entries, entries);
+  BOOST_CHECK_CLOSE(statistics.mean, mean, 1.e-6);
+  BOOST_CHECK_CLOSE(statistics.stdDev, stdDev, 1.e-6);
+  BOOST_CHECK_EQUAL(statistics.min, 0.);
+  BOOST_CHECK_EQUAL(statistics.max, 75.);
+  BOOST_CHECK_EQUAL(pad.getStatistics().max, 1000.);
+
+  // masked pads are set to a value
+  pad.applyMask(mask, -1.f);
+  const auto statisticsMasked = pad.getStatistics();
+  BOOST_CHECK_EQUAL(statisticsMasked.min, -1.);
+  BOOST_CHECK_EQUAL(statisticsMasked.max, 75.);
+  BOOST_CHECK_EQUAL(pad.getCalArray(3).getValue(3), -1.f);
+  BOOST_CHECK_EQUAL(pad.getCalArray(3).getValue(4), 7.f);
+}
+
+BOOST_AUTO_TEST_CASE(CalDet_BinaryIO)
+{
+  CalPad pad(PadSubset::Partition);
+  pad.setName("PartitionData");
+  CalDet<bool> mask(PadSubset::ROC);
+  mask.setName("Mask");
+
+  int iter = 0;
+  for (auto& calArray : pad.getData()) {
+    for (auto& value : calArray.getData()) {
+      value = iter++ * 0.25f;
+    }
+  }
+  for (auto& calArray : mask.getData()) {
+    for (size_t i = 0; i < calArray.getData().size(); ++i) {
+      calArray.getData()[i] = (iter++ % 11 == 0);
+    }
+  }
+
+  BOOST_REQUIRE(pad.writeBinary("CalDet_BinaryIO.bin"));
+  BOOST_REQUIRE(mask.writeBinary("CalDet_BinaryIO_mask.bin"));
+
+  CalPad padRead;
+  CalDet<bool> maskRead;
+  BOOST_REQUIRE(padRead.readBinary("CalDet_BinaryIO.bin"));
+  BOOST_REQUIRE(maskRead.readBinary("CalDet_BinaryIO_mask.bin"));
+
+  BOOST_CHECK_EQUAL(padRead.getName(), pad.getName());
+  BOOST_CHECK(padRead.getPadSubset() == PadSubset::Partition);
+  BOOST_REQUIRE_EQUAL(padRead.getData().size(), pad.getData().size());
+  for (size_t i = 0; i < pad.getData().size(); ++i) {
+    BOOST_CHECK(padRead.getCalArray(i).getData() == pad.getCalArray(i).getData());
+  }
+
+  BOOST_CHECK_EQUAL(maskRead.getName(), mask.getName());
+  BOOST_REQUIRE_EQUAL(maskRead.getData().size(), mask.getData().size());
+  for (size_t i = 0; i < mask.getData().size(); ++i) {
+    BOOST_CHECK(maskRead.getCalArray(i).getData() == mask.getCalArray(i).getData());
+  }
+
+  // files with a different value type or no calibration data are rejected
+  CalDet<double> padDouble;
+  BOOST_CHECK(!padDouble.readBinary("CalDet_BinaryIO.bin"));
+  BOOST_CHECK(!padRead.readBinary("CalDet_BinaryIO_missing.bin"));
+
+  std::remove("CalDet_BinaryIO.bin");
+  std::remove("CalDet_BinaryIO_mask.bin");
+}
+
 } // TPC
 } // AliceO2
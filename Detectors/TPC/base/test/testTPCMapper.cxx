@@ -17,10 +17,13 @@
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
 #include <cstdlib>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <random>
 #include <string>
+#include <vector>
 #include "TPCBase/Mapper.h"
 
 namespace o2 {
@@ -129,5 +132,46 @@ namespace TPC {
       }
     }
   }
+
+  /// \brief Test of the pad finding for arrays of positions
+  /// Random positions in the full TPC volume are processed with findDigitPosFromGlobalPositions
+  /// and compared to the result of findDigitPosFromGlobalPosition
+  BOOST_AUTO_TEST_CASE(Mapper_array_test)
+  {
+    const Mapper& mapper = Mapper::instance();
+    std::mt19937 generator(4711);
+    std::uniform_real_distribution<float> radius(80.f, 250.f);
+    std::uniform_real_distribution<float> phi(0.f, 2.f * PI);
+    std::uniform_real_distribution<float> z(-250.f, 250.f);
+
+    const size_t nPositions = 100003; // not a multiple of the vector size on purpose
+    std::vector<float> x(nPositions), y(nPositions), zPos(nPositions);
+    for (size_t i = 0; i < nPositions; ++i) {
+      const float r = radius(generator);
+      const float p = phi(generator);
+      x[i] = r * std::cos(p);
+      y[i] = r * std::sin(p);
+      zPos[i] = z(generator);
+    }
+
+    std::vector<int> cru(nPositions), row(nPositions), pad(nPositions);
+    std::vector<float> padFraction(nPositions), rowFraction(nPositions);
+    mapper.findDigitPosFromGlobalPositions(nPositions, x.data(), y.data(), zPos.data(), cru.data(), row.data(), pad.data(),
+                                           padFraction.data(), rowFraction.data());
+
+    int nValid = 0;
+    for (size_t i = 0; i < nPositions; ++i) {
+      const DigitPos digi = mapper.findDigitPosFromGlobalPosition(GlobalPosition3D(x[i], y[i], zPos[i]));
+      BOOST_CHECK_EQUAL(digi.isValid(), cru[i] >= 0);
+      if (!digi.isValid() || cru[i] < 0) continue;
+      ++nValid;
+      BOOST_CHECK_EQUAL(int(digi.getCRU().number()), cru[i]);
+      BOOST_CHECK_EQUAL(int(digi.getPadPos().getRow()), row[i]);
+      BOOST_CHECK_EQUAL(int(digi.getPadPos().getPad()), pad[i]);
+      BOOST_CHECK(padFraction[i] >= 0.f && padFraction[i] < 1.f);
+      BOOST_CHECK(rowFraction[i] >= 0.f && rowFraction[i] < 1.f);
+    }
+    BOOST_CHECK(nValid > 0);
+  }
 }
 }
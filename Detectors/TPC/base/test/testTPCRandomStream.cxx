@@ -0,0 +1,116 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTPCRandomStream.cxx
+/// \brief This task tests the counter based random streams
+
+#define BOOST_TEST_MODULE Test TPC RandomStream
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TPCBase/RandomStream.h"
+
+#include "TF1.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace o2 {
+namespace TPC {
+
+  /// \brief Test of the Philox generator against the known answers of the Random123 reference implementation
+  BOOST_AUTO_TEST_CASE(RandomStream_philox_test)
+  {
+    const auto zero = RandomStream::philox({ { 0, 0, 0, 0 } }, { { 0, 0 } });
+    BOOST_CHECK(zero == (std::array<uint32_t, 4>{ { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } }));
+    const auto ones = RandomStream::philox({ { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff } }, { { 0xffffffff, 0xffffffff } });
+    BOOST_CHECK(ones == (std::array<uint32_t, 4>{ { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd } }));
+    const auto pi = RandomStream::philox({ { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 } }, { { 0xa4093822, 0x299f31d0 } });
+    BOOST_CHECK(pi == (std::array<uint32_t, 4>{ { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } }));
+  }
+
+  /// \brief The values only depend on the key and the number of values drawn, not on the instance or on the way they are drawn
+  BOOST_AUTO_TEST_CASE(RandomStream_reproducibility_test)
+  {
+    RandomStream first(RandomStream::RandomType::Gaus);
+    RandomStream second(RandomStream::RandomType::Gaus);
+    first.setKey(RandomStream::makeKey(1, 2, 3));
+    second.setKey(RandomStream::makeKey(1, 2, 3));
+
+    // vectors are never taken across blocks, hence compare in units of blocks
+    for (size_t block = 0; block < 10; ++block) {
+      for (size_t i = 0; i < RandomStream::BlockSize; i += float_v::Size) {
+        const float_v values = first.getNextValueVc();
+        for (size_t lane = 0; lane < float_v::Size; ++lane) {
+          BOOST_CHECK_EQUAL(values[lane], second.getNextValue());
+        }
+      }
+    }
+
+    // a different hit gives different numbers
+    first.setKey(RandomStream::makeKey(1, 2, 3));
+    second.setKey(RandomStream::makeKey(1, 2, 4));
+    int nEqual = 0;
+    for (int i = 0; i < 1000; ++i) {
+      nEqual += (first.getNextValue() == second.getNextValue());
+    }
+    BOOST_CHECK(nEqual < 5);
+
+    // restarting the stream gives the same numbers again
+    first.setKey(RandomStream::makeKey(5, 6, 7));
+    const float value = first.getNextValue();
+    first.getNextValue();
+    first.setKey(RandomStream::makeKey(5, 6, 7));
+    BOOST_CHECK_EQUAL(value, first.getNextValue());
+  }
+
+  /// \brief Test of the moments of the distributions
+  BOOST_AUTO_TEST_CASE(RandomStream_distribution_test)
+  {
+    const int nValues = 1000000;
+
+    RandomStream gaus(RandomStream::RandomType::Gaus);
+    gaus.setKey(RandomStream::makeKey(0, 0, 0));
+    double sum = 0., sum2 = 0.;
+    for (int i = 0; i < nValues; ++i) {
+      const double value = gaus.getNextValue();
+      sum += value;
+      sum2 += value * value;
+    }
+    BOOST_CHECK_SMALL(sum / nValues, 0.01);
+    BOOST_CHECK_CLOSE(std::sqrt(sum2 / nValues - sum * sum / nValues / nValues), 1., 1.);
+
+    RandomStream flat(RandomStream::RandomType::Flat);
+    flat.setKey(RandomStream::makeKey(0, 0, 0));
+    sum = 0.;
+    float minimum = 1.f, maximum = 0.f;
+    for (int i = 0; i < nValues; ++i) {
+      const float value = flat.getNextValue();
+      minimum = std::min(minimum, value);
+      maximum = std::max(maximum, value);
+      sum += value;
+    }
+    BOOST_CHECK(minimum >= 0.f);
+    BOOST_CHECK(maximum < 1.f);
+    BOOST_CHECK_CLOSE(sum / nValues, 0.5, 1.);
+
+    // linear distribution in [0, 1], the mean is 2/3
+    TF1 function("linear", "x", 0., 1.);
+    RandomStream custom(function);
+    custom.setKey(RandomStream::makeKey(0, 0, 0));
+    sum = 0.;
+    for (int i = 0; i < nValues; ++i) {
+      sum += custom.getNextValue();
+    }
+    BOOST_CHECK_CLOSE(sum / nValues, 2. / 3., 1.);
+  }
+}
+}
@@ -0,0 +1,82 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTPCThreadPool.cxx
+/// \brief This task tests the pool of worker threads
+
+#define BOOST_TEST_MODULE Test TPC ThreadPool
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TPCBase/ThreadPool.h"
+
+#include <atomic>
+#include <vector>
+
+namespace o2 {
+namespace TPC {
+
+  /// \brief Every item is processed exactly once, by a worker with a valid ID, for any number of threads and items
+  BOOST_AUTO_TEST_CASE(ThreadPool_items_test)
+  {
+    ThreadPool pool;
+    for (unsigned nThreads : { 1u, 2u, 8u, 1u, 4u }) {
+      pool.setNumThreads(nThreads);
+      BOOST_CHECK_EQUAL(pool.getNumThreads(), nThreads);
+      // the same pool is used repeatedly, also with fewer items than threads
+      for (size_t nItems : { 0, 1, 3, 1000 }) {
+        std::vector<std::atomic<int>> count(nItems);
+        for (auto& c : count) {
+          c = 0;
+        }
+        std::atomic<bool> validWorker(true);
+        const unsigned nWorkers = pool.getNumWorkers(nItems);
+        pool.run(nItems, [&](unsigned workerID, size_t item) {
+          if (workerID >= nWorkers) {
+            validWorker = false;
+          }
+          ++count[item];
+        });
+        BOOST_CHECK(validWorker);
+        for (auto& c : count) {
+          BOOST_CHECK_EQUAL(c, 1);
+        }
+      }
+    }
+  }
+
+  /// \brief Per-worker buffers indexed by the worker ID are not shared between threads
+  BOOST_AUTO_TEST_CASE(ThreadPool_worker_buffer_test)
+  {
+    ThreadPool pool(4);
+    const size_t nItems = 10000;
+    std::vector<std::vector<size_t>> buffers(pool.getNumThreads());
+    pool.run(nItems, [&buffers](unsigned workerID, size_t item) { buffers[workerID].push_back(item); });
+
+    std::vector<int> seen(nItems, 0);
+    for (const auto& buffer : buffers) {
+      for (auto item : buffer) {
+        ++seen[item];
+      }
+    }
+    for (auto s : seen) {
+      BOOST_CHECK_EQUAL(s, 1);
+    }
+  }
+
+  /// \brief 0 threads selects the hardware default, which is at least 1
+  BOOST_AUTO_TEST_CASE(ThreadPool_hardware_test)
+  {
+    ThreadPool pool(0);
+    BOOST_CHECK(pool.getNumThreads() >= 1);
+    BOOST_CHECK_EQUAL(pool.getNumWorkers(0), 1u);
+  }
+}
+}
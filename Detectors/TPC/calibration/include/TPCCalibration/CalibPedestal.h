@@ -22,6 +22,7 @@
 #include "DataFormatsTPC/Defs.h"
 #include "TPCBase/CalDet.h"
 #include "TPCBase/CRU.h"
+#include "TPCBase/ThreadPool.h"
 #include "TPCCalibration/CalibRawBase.h"
 
 namespace o2
@@ -34,6 +35,10 @@ namespace TPC
 ///
 /// This class is used to produce pad wise pedestal and noise calibration data
 ///
+/// The ADC values of each pad are filled into a histogram, the histograms of one
+/// readout chamber are stored in one contiguous array. The histograms are analysed
+/// at the end, the readout chambers in parallel.
+///
 /// origin: TPC
 /// \author Jens Wiechula, Jens.Wiechula@ikf.uni-frankfurt.de
 
@@ -42,6 +47,12 @@ class CalibPedestal : public CalibRawBase
   public:
     using vectorType = std::vector<float>;
 
+    /// method to extract pedestal and noise from the ADC histograms
+    enum class StatisticsType : char {
+      GausFit,    ///< Gaussian fit to the histogram
+      MeanStdDev  ///< Mean and standard deviation of the histogram
+    };
+
     /// default constructor
     CalibPedestal(PadSubset padSubset = PadSubset::ROC);
 
@@ -58,10 +69,24 @@ class CalibPedestal : public CalibRawBase
     Int_t updateROC(const Int_t roc, const Int_t row, const Int_t pad,
                     const Int_t timeBin, const Float_t signal) final;
 
+    /// update function called once per pad with the signals of consecutive time bins
+    ///
+    /// \param roc readout chamber
+    /// \param row row in roc
+    /// \param pad pad in row
+    /// \param firstTimeBin time bin of the first signal
+    /// \param signals ADC signals
+    Int_t updateROC(const Int_t roc, const Int_t row, const Int_t pad,
+                    const Int_t firstTimeBin, gsl::span<const float> signals) final;
+
     /// not used
     Int_t updateCRU(const CRU& cru, const Int_t row, const Int_t pad,
                     const Int_t timeBin, const Float_t signal) final { return 0;}
 
+    /// not used
+    Int_t updateCRU(const CRU& cru, const Int_t row, const Int_t pad,
+                    const Int_t firstTimeBin, gsl::span<const float> signals) final { return 0;}
+
     /// Reset pedestal data
     void resetData();
 
@@ -70,6 +95,14 @@ class CalibPedestal : public CalibRawBase
 
     /// set the time bin range to analyse
     void setTimeBinRange(int first, int last) { mFirstTimeBin=first; mLastTimeBin=last; }
+
+    /// set the method to extract pedestal and noise
+    void setStatisticsType(StatisticsType statisticsType) { mStatisticsType = statisticsType; }
+
+    /// set the number of threads used in the analysis
+    /// \param threads number of threads, if 0 hardware default value is used
+    void setNumThreads(unsigned threads) { mThreadPool.setNumThreads(threads); }
+
     /// Analyse the buffered adc values and calculate noise and pedestal
     void analyse();
 
@@ -95,6 +128,8 @@ class CalibPedestal : public CalibRawBase
     int        mADCMin;       ///< minimum adc value
     int        mADCMax;       ///< maximum adc value
     int        mNumberOfADCs; ///< number of adc values (mADCMax-mADCMin+1)
+    StatisticsType mStatisticsType; ///< method to extract pedestal and noise
+    ThreadPool mThreadPool;   ///< threads used in the analysis
     CalPad     mPedestal;     ///< CalDet object with pedestal information
     CalPad     mNoise;        ///< CalDet object with noise
 
@@ -106,6 +141,12 @@ class CalibPedestal : public CalibRawBase
     /// \param create if to create the vector if it does not exist
     vectorType* getVector(ROC roc, bool create=kFALSE);
 
+    /// analyse the adc values of one readout chamber
+    ///
+    /// \param roc readout chamber
+    /// \param fitValues buffer for the fit results
+    void analyseROC(ROC roc, std::vector<float>& fitValues);
+
     /// dummy reset
     void resetEvent() final {}
 };
@@ -64,6 +64,20 @@ class CalibPulser : public CalibRawBase
     Int_t updateCRU(const CRU& cru, const Int_t row, const Int_t pad,
                     const Int_t timeBin, const Float_t signal) final { return 0;}
 
+    /// update function called once per pad with the signals of consecutive time bins
+    ///
+    /// \param roc readout chamber
+    /// \param row row in roc
+    /// \param pad pad in row
+    /// \param firstTimeBin time bin of the first signal
+    /// \param signals ADC signals
+    Int_t updateROC(const Int_t roc, const Int_t row, const Int_t pad,
+                    const Int_t firstTimeBin, gsl::span<const float> signals) final;
+
+    /// not used
+    Int_t updateCRU(const CRU& cru, const Int_t row, const Int_t pad,
+                    const Int_t firstTimeBin, gsl::span<const float> signals) final { return 0;}
+
     /// Reset temporary data and histogrms
     void resetData();
 
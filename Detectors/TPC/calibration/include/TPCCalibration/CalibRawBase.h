@@ -17,6 +17,9 @@
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <array>
+
+#include <gsl/span>
 
 #include "TString.h"
 #include "Rtypes.h"
@@ -39,7 +42,7 @@ namespace TPC
 ///
 /// This class is the base class for raw data calibrations
 /// It implements base raw reader functionality and calls
-/// an 'update' function for each digit
+/// an 'update' function for the signals of each pad
 ///
 /// origin: TPC
 /// \author Jens Wiechula, Jens.Wiechula@ikf.uni-frankfurt.de
@@ -79,6 +82,30 @@ class CalibRawBase
     virtual Int_t updateCRU(const CRU& cru, const Int_t row, const Int_t pad,
                             const Int_t timeBin, const Float_t signal) = 0;
 
+    /// update function called once per pad with the signals of consecutive time bins
+    ///
+    /// The default implementation calls updateROC for each time bin,
+    /// calibrations should override it to process all signals at once
+    /// \param roc readout chamber
+    /// \param row row in roc
+    /// \param pad pad in row
+    /// \param firstTimeBin time bin of the first signal
+    /// \param signals ADC signals
+    virtual Int_t updateROC(const Int_t roc, const Int_t row, const Int_t pad,
+                            const Int_t firstTimeBin, gsl::span<const float> signals);
+
+    /// update function called once per pad with the signals of consecutive time bins
+    ///
+    /// The default implementation calls updateCRU for each time bin,
+    /// calibrations should override it to process all signals at once
+    /// \param cru CRU
+    /// \param row row in CRU
+    /// \param pad pad in row
+    /// \param firstTimeBin time bin of the first signal
+    /// \param signals ADC signals
+    virtual Int_t updateCRU(const CRU& cru, const Int_t row, const Int_t pad,
+                            const Int_t firstTimeBin, gsl::span<const float> signals);
+
     /// add GBT frame container to process
     void addGBTFrameContainer(GBTFrameContainer *cont) { mGBTFrameContainers.push_back(std::unique_ptr<GBTFrameContainer>(cont)); }
 
@@ -135,6 +162,19 @@ class CalibRawBase
     PadSubset mPadSubset;              //!< pad subset type used
     std::vector<std::unique_ptr<GBTFrameContainer>> mGBTFrameContainers; //! raw reader pointer
     std::vector<std::unique_ptr<RawReader>> mRawReaders; //! raw reader pointer
+    std::vector<float> mSignals;       //!< signals of the pads passed to the update functions
+
+    /// row offset to convert the row in the CRU to the row in the pad subset
+    /// \param cru CRU
+    int getRowOffset(const CRU& cru) const;
+
+    /// pass the signals of consecutive time bins of one pad to the update functions
+    /// \param cru CRU
+    /// \param row row in CRU
+    /// \param pad pad in row
+    /// \param firstTimeBin time bin of the first signal
+    /// \param signals ADC signals
+    void updatePad(const CRU& cru, const int row, const int pad, const int firstTimeBin, gsl::span<const float> signals);
 
     virtual void resetEvent() = 0;
     virtual void endEvent() = 0;
@@ -164,66 +204,125 @@ inline CalibRawBase::ProcessStatus CalibRawBase::processEvent(int eventNumber)
   }
 }
 
+//______________________________________________________________________________
+inline Int_t CalibRawBase::updateROC(const Int_t roc, const Int_t row, const Int_t pad,
+                                     const Int_t firstTimeBin, gsl::span<const float> signals)
+{
+  Int_t ret = 0;
+  Int_t timeBin = firstTimeBin;
+  for (const float signal : signals) {
+    ret += updateROC(roc, row, pad, timeBin++, signal);
+  }
+  return ret;
+}
+
+//______________________________________________________________________________
+inline Int_t CalibRawBase::updateCRU(const CRU& cru, const Int_t row, const Int_t pad,
+                                     const Int_t firstTimeBin, gsl::span<const float> signals)
+{
+  Int_t ret = 0;
+  Int_t timeBin = firstTimeBin;
+  for (const float signal : signals) {
+    ret += updateCRU(cru, row, pad, timeBin++, signal);
+  }
+  return ret;
+}
+
+//______________________________________________________________________________
+inline int CalibRawBase::getRowOffset(const CRU& cru) const
+{
+  // TODO: OROC case needs subtraction of number of pad rows in IROC
+  const PadRegionInfo& regionInfo = mMapper.getPadRegionInfo(cru.region());
+  const PartitionInfo& partInfo = mMapper.getPartitionInfo(cru.partition());
+
+  int rowOffset = 0;
+  switch (mPadSubset) {
+    case PadSubset::ROC: {
+        rowOffset = regionInfo.getGlobalRowOffset();
+        rowOffset -= (cru.rocType()==RocType::OROC)*mMapper.getNumberOfRowsROC(0);
+        break;
+      }
+    case PadSubset::Region: {
+        break;
+      }
+    case PadSubset::Partition: {
+        rowOffset = regionInfo.getGlobalRowOffset();
+        rowOffset -= partInfo.getGlobalRowOffset();
+        break;
+      }
+  }
+  return rowOffset;
+}
+
+//______________________________________________________________________________
+inline void CalibRawBase::updatePad(const CRU& cru, const int row, const int pad, const int firstTimeBin, gsl::span<const float> signals)
+{
+  // modify row depending on the calibration type used
+  updateCRU(cru, row, pad, firstTimeBin, signals);
+  updateROC(cru.roc(), row+getRowOffset(cru), pad, firstTimeBin, signals);
+}
+
 //______________________________________________________________________________
 inline CalibRawBase::ProcessStatus CalibRawBase::processEventGBT()
 {
   if (!mGBTFrameContainers.size()) return ProcessStatus::NoReaders;
   resetEvent();
 
-  // loop over raw readers, fill digits for 500 time bins and process
-  // digits
-
-  const int nRowIROC = mMapper.getNumberOfRowsROC(0);
+  // loop over raw readers, collect the signals of each channel for 500 time bins and process
+  // them pad by pad
 
   ProcessStatus status = ProcessStatus::Ok;
 
-  std::vector<Digit> digits(80);
+  mProcessedTimeBins = 0;
+
+  // one digit per channel and time bin, always in the same order of the 80 channels
+  static constexpr int nChannels = 80;
+  std::vector<Digit> digits;
+  digits.reserve(nChannels);
+  std::array<Digit, nChannels> channelDigits;
+  mSignals.resize(nChannels * mTimeBinsPerCall);
+
   for (auto& reader_ptr : mGBTFrameContainers) {
     auto reader = reader_ptr.get();
     int readTimeBins = 0;
+
+    // signals of the time bins from firstTimeBin are collected, a time bin without data ends the range
+    int firstTimeBin = 0;
+    int nTimeBins = 0;
+    auto processChannels = [this, &channelDigits, &firstTimeBin, &nTimeBins]() {
+      if (nTimeBins == 0) return;
+      for (int channel = 0; channel < nChannels; ++channel) {
+        const Digit& digi = channelDigits[channel];
+        // row is local in region (CRU)
+        const int row    = digi.getRow();
+        const int pad    = digi.getPad();
+        if (row==255 || pad==255) continue;
+        updatePad(CRU(digi.getCRU()), row, pad, firstTimeBin,
+                  gsl::span<const float>(&mSignals[channel * mTimeBinsPerCall], nTimeBins));
+      }
+      nTimeBins = 0;
+    };
+
     for (int i=0; i<mTimeBinsPerCall; ++i) {
-      if (reader->getData(digits)) {
-        for (auto& digi : digits) {
-          CRU cru(digi.getCRU());
-          const int roc = cru.roc();
-          // TODO: OROC case needs subtraction of number of pad rows in IROC
-          const PadRegionInfo& regionInfo = mMapper.getPadRegionInfo(cru.region());
-          const PartitionInfo& partInfo = mMapper.getPartitionInfo(cru.partition());
-
-          // row is local in region (CRU)
-          const int row    = digi.getRow();
-          const int pad    = digi.getPad();
-          if (row==255 || pad==255) continue;
-
-          int rowOffset = 0;
-          switch (mPadSubset) {
-            case PadSubset::ROC: {
-                rowOffset = regionInfo.getGlobalRowOffset();
-                rowOffset -= (cru.rocType()==RocType::OROC)*nRowIROC;
-              break;
-            }
-            case PadSubset::Region: {
-              break;
-            }
-            case PadSubset::Partition: {
-              rowOffset = regionInfo.getGlobalRowOffset();
-              rowOffset -= partInfo.getGlobalRowOffset();
-              break;
-            }
-          }
-
-          // modify row depending on the calibration type used
-          const int timeBin= i; //digi.getTimeStamp();
-          const float signal = digi.getChargeFloat();
-
-          updateCRU(cru, row, pad, timeBin, signal );
-          updateROC(roc, row+rowOffset, pad, timeBin, signal );
+      if (reader->getData(digits) && digits.size() == nChannels) {
+        if (nTimeBins == 0) {
+          firstTimeBin = i;
+          std::copy(digits.begin(), digits.end(), channelDigits.begin());
+        }
+        for (int channel = 0; channel < nChannels; ++channel) {
+          mSignals[channel * mTimeBinsPerCall + nTimeBins] = digits[channel].getChargeFloat();
         }
+        ++nTimeBins;
         ++readTimeBins;
+      } else {
+        processChannels();
       }
 
       digits.clear();
     }
+    processChannels();
+
+    mProcessedTimeBins = std::max(mProcessedTimeBins, size_t(readTimeBins));
 
     // set status, don't overwrite decision
     if (status == ProcessStatus::Ok) {
@@ -250,10 +349,7 @@ inline CalibRawBase::ProcessStatus CalibRawBase::processEventRawReader(int event
   if (!mRawReaders.size()) return ProcessStatus::NoReaders;
   resetEvent();
 
-  // loop over raw readers, fill digits for 500 time bins and process
-  // digits
-
-  const int nRowIROC = mMapper.getNumberOfRowsROC(0);
+  // loop over raw readers, process the signals of all time bins pad by pad
 
   ProcessStatus status = ProcessStatus::Ok;
 
@@ -278,52 +374,23 @@ inline CalibRawBase::ProcessStatus CalibRawBase::processEventRawReader(int event
       mPresentEventNumber = reader->loadPreviousEvent();
     }
 
-    o2::TPC::PadPos padPos;
-    while (std::shared_ptr<std::vector<uint16_t>> data = reader->getNextData(padPos)) {
-      if (!data) continue;
+    const CRU cru(reader->getRegion());
 
-      mProcessedTimeBins = std::max(mProcessedTimeBins, data->size());
+    o2::TPC::PadPos padPos;
+    size_t nTimeBins = 0;
+    while (const uint16_t* data = reader->getNextPadData(padPos, nTimeBins)) {
 
-      CRU cru(reader->getRegion());
-      const int roc = cru.roc();
-      // TODO: OROC case needs subtraction of number of pad rows in IROC
-      const PadRegionInfo& regionInfo = mMapper.getPadRegionInfo(cru.region());
-      const PartitionInfo& partInfo = mMapper.getPartitionInfo(cru.partition());
+      mProcessedTimeBins = std::max(mProcessedTimeBins, nTimeBins);
 
       // row is local in region (CRU)
       const int row    = padPos.getRow();
       const int pad    = padPos.getPad();
       if (row==255 || pad==255) continue;
 
-      int timeBin=0;
-      for (const auto& signalI : *data) {
-
-        int rowOffset = 0;
-        switch (mPadSubset) {
-          case PadSubset::ROC: {
-              rowOffset = regionInfo.getGlobalRowOffset();
-              rowOffset -= (cru.rocType()==RocType::OROC)*nRowIROC;
-              break;
-            }
-          case PadSubset::Region: {
-              break;
-            }
-          case PadSubset::Partition: {
-              rowOffset = regionInfo.getGlobalRowOffset();
-              rowOffset -= partInfo.getGlobalRowOffset();
-              break;
-            }
-        }
-
-        // modify row depending on the calibration type used
-        const float signal = float(signalI);
-        //const FECInfo& fecInfo = mTPCmapper.getFECInfo(PadSecPos(roc, row, pad));
-        //printf("Call update: %d, %d, %d, %d (%d), %.3f -- reg: %02d -- FEC: %02d, Chip: %02d, Chn: %02d\n", roc, row, pad, timeBin, i, signal, cru.region(), fecInfo.getIndex(), fecInfo.getSampaChip(), fecInfo.getSampaChannel());
-        updateCRU(cru, row, pad, timeBin, signal );
-        updateROC(roc, row+rowOffset, pad, timeBin, signal );
-        ++timeBin;
-        hasData=true;
-      }
+      mSignals.resize(std::max(mSignals.size(), nTimeBins));
+      std::copy(data, data + nTimeBins, mSignals.begin());
+      updatePad(cru, row, pad, 0, gsl::span<const float>(mSignals.data(), nTimeBins));
+      hasData |= (nTimeBins > 0);
     }
 
     // notify that one raw reader processing finalized for this event
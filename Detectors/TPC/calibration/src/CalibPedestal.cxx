@@ -11,13 +11,17 @@
 /// \file   CalibPedestal.cxx
 /// \author Jens Wiechula, Jens.Wiechula@ikf.uni-frankfurt.de
 
+#include <algorithm>
+
 #include "TFile.h"
 #include "TPCBase/ROC.h"
 #include "MathUtils/MathBase.h"
 #include "TPCCalibration/CalibPedestal.h"
 
 using namespace o2::TPC;
-using o2::mathUtils::mathBase::fitGaus;
+using o2::mathUtils::mathBase::fitGausThreadSafe;
+using o2::mathUtils::mathBase::getStatisticsData;
+using o2::mathUtils::mathBase::StatisticsData;
 
 CalibPedestal::CalibPedestal(PadSubset padSubset)
   : CalibRawBase(padSubset),
@@ -26,6 +30,8 @@ CalibPedestal::CalibPedestal(PadSubset padSubset)
     mADCMin(0),
     mADCMax(120),
     mNumberOfADCs(mADCMax-mADCMin+1),
+    mStatisticsType(StatisticsType::GausFit),
+    mThreadPool(0),
     mPedestal(padSubset),
     mNoise(padSubset),
     mADCdata()
@@ -54,6 +60,26 @@ Int_t CalibPedestal::updateROC(const Int_t roc, const Int_t row, const Int_t pad
   return 0;
 }
 
+//______________________________________________________________________________
+Int_t CalibPedestal::updateROC(const Int_t roc, const Int_t row, const Int_t pad,
+                               const Int_t firstTimeBin, gsl::span<const float> signals)
+{
+  const Int_t first = std::max(mFirstTimeBin - firstTimeBin, 0);
+  const Int_t last  = std::min(mLastTimeBin - firstTimeBin, Int_t(signals.size()) - 1);
+  if (first > last) return 0;
+
+  const GlobalPadNumber padInROC = mMapper.getPadNumberInROC(PadROCPos(roc, row, pad));
+  float* padHistogram = getVector(ROC(roc), kTRUE)->data() + padInROC * mNumberOfADCs;
+
+  for (Int_t i=first; i<=last; ++i) {
+    // the unsigned comparison also rejects values below mADCMin
+    const unsigned bin = unsigned(Int_t(signals[i]) - mADCMin);
+    if (bin < unsigned(mNumberOfADCs)) ++padHistogram[bin];
+  }
+
+  return 0;
+}
+
 //______________________________________________________________________________
 CalibPedestal::vectorType* CalibPedestal::getVector(ROC roc, bool create/*=kFALSE*/)
 {
@@ -73,38 +99,46 @@ CalibPedestal::vectorType* CalibPedestal::getVector(ROC roc, bool create/*=kFALS
 //______________________________________________________________________________
 void CalibPedestal::analyse()
 {
-  ROC roc;
-
-  std::vector<float> fitValues;
-
-  for (auto& vecPtr : mADCdata) {
-    auto vec = vecPtr.get();
-    if (!vec) {
-      ++roc;
-      continue;
-    }
-
-    CalROC& calROCPedestal = mPedestal.getCalArray(roc);
-    CalROC& calROCNoise = mNoise.getCalArray(roc);
-
-    float *array = vec->data();
+  // the readout chambers are taken one after the other by the threads, each with its own fit buffer
+  std::vector<std::vector<float>> fitValues(mThreadPool.getNumThreads());
+  mThreadPool.run(ROC::MaxROC, [this, &fitValues](unsigned workerID, size_t roc) {
+    analyseROC(ROC(roc), fitValues[workerID]);
+  });
+}
 
-    const size_t numberOfPads = (roc.rocType() == RocType::IROC) ? mMapper.getPadsInIROC() : mMapper.getPadsInOROC();
+//______________________________________________________________________________
+void CalibPedestal::analyseROC(ROC roc, std::vector<float>& fitValues)
+{
+  const vectorType* vec = mADCdata[roc].get();
+  if (!vec) return;
 
-    for (Int_t ichannel=0; ichannel<numberOfPads; ++ichannel) {
-      size_t offset = ichannel * mNumberOfADCs;
-      fitGaus(mNumberOfADCs, array+offset, float(mADCMin), float(mADCMax+1), fitValues);
+  CalROC& calROCPedestal = mPedestal.getCalArray(roc);
+  CalROC& calROCNoise = mNoise.getCalArray(roc);
 
-      const float pedestal = fitValues[1];
-      const float noise    = fitValues[2];
-      calROCPedestal.setValue(ichannel, pedestal);
-      calROCNoise.setValue(ichannel, noise);
+  const float *array = vec->data();
 
-      //printf("roc: %2d, channel: %4d, pedestal: %.2f, noise: %.2f\n", roc.getRoc(), ichannel, pedestal, noise);
+  const size_t numberOfPads = (roc.rocType() == RocType::IROC) ? mMapper.getPadsInIROC() : mMapper.getPadsInOROC();
 
+  for (size_t ichannel=0; ichannel<numberOfPads; ++ichannel) {
+    size_t offset = ichannel * mNumberOfADCs;
+
+    float pedestal = 0.f;
+    float noise    = 0.f;
+    if (mStatisticsType == StatisticsType::GausFit) {
+      fitGausThreadSafe(size_t(mNumberOfADCs), array+offset, float(mADCMin), float(mADCMax+1), fitValues);
+      pedestal = fitValues[1];
+      noise    = fitValues[2];
+    } else {
+      const StatisticsData data = getStatisticsData(array+offset, mNumberOfADCs, double(mADCMin), double(mADCMax+1));
+      if (data.mSum > 0) {
+        pedestal = data.mCOG;
+        noise    = data.mStdDev;
+      }
     }
+    calROCPedestal.setValue(ichannel, pedestal);
+    calROCNoise.setValue(ichannel, noise);
 
-    ++roc;
+    //printf("roc: %2d, channel: %4d, pedestal: %.2f, noise: %.2f\n", roc.getRoc(), ichannel, pedestal, noise);
   }
 }
 
@@ -116,7 +150,7 @@ void CalibPedestal::resetData()
     if (!vec) {
       continue;
     }
-    vec->clear();
+    std::fill(vec->begin(), vec->end(), 0.f);
   }
 }
 
@@ -93,6 +93,40 @@ Int_t CalibPulser::updateROC(const Int_t roc, const Int_t row, const Int_t pad,
   return 1;
 }
 
+//______________________________________________________________________________
+Int_t CalibPulser::updateROC(const Int_t roc, const Int_t row, const Int_t pad,
+                             const Int_t firstTimeBin, gsl::span<const float> signals)
+{
+  // ===| range checks |========================================================
+  const Int_t first = std::max(mFirstTimeBin - firstTimeBin, 0);
+  const Int_t last  = std::min(mLastTimeBin - firstTimeBin, Int_t(signals.size()) - 1);
+  if (first > last) return 0;
+
+  const float pedestal = mPedestal ? mPedestal->getValue(ROC(roc), row, pad) : 0.f;
+
+  // ===| temporary calibration data |==========================================
+  // only created if at least one signal is in the adc range
+  VectorType* adcData = nullptr;
+
+  Int_t nSignals = 0;
+  for (Int_t i=first; i<=last; ++i) {
+    const float signal = signals[i];
+    if (signal<mADCMin || signal>mADCMax) continue;
+
+    if (!adcData) {
+      adcData = &mPulserData[PadROCPos(roc, row, pad)];
+      // accept first and last time bin, so difference +1
+      if ( !adcData->size() ) adcData->resize(mLastTimeBin-mFirstTimeBin+1);
+    }
+
+    // ===| correct the signal |================================================
+    (*adcData)[firstTimeBin+i-mFirstTimeBin] = signal - pedestal;
+    ++nSignals;
+  }
+
+  return nSignals;
+}
+
 //______________________________________________________________________________
 void CalibPulser::endReader()
 {
@@ -38,7 +38,7 @@ public:
     }
   }
   void integrateCluster(int sector, int row, float pad, unsigned int charge) {
-    int ipad = ipad + 0.5;
+    int ipad = pad + 0.5;
     if (ipad < 0) ipad = 0;
     int maxPad = o2::TPC::Mapper::instance().getNumberOfPadsInRowSector(row);
     if (ipad >= maxPad) ipad = maxPad - 1;
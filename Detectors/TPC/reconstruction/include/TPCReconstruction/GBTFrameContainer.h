@@ -16,6 +16,7 @@
 
 #include "TPCBase/Digit.h"
 #include "TPCBase/Mapper.h"
+#include "TPCBase/ThreadPool.h"
 #include "TPCReconstruction/AdcClockMonitor.h"
 #include "TPCReconstruction/GBTFrame.h"
 #include "TPCReconstruction/HalfSAMPAData.h"
@@ -119,6 +120,9 @@ class GBTFrameContainer {
     void addGBTFramesFromFile(std::string fileName);
 
     /// Add all frames from file to conatiner
+    ///
+    /// The file is memory mapped and the frames are decoded in blocks, the 5 half SAMPA
+    /// streams of a block are decoded in parallel.
     /// @param fileName Path to file
     /// @param type rorc type of data
     /// @param frames Frames to read from file (-1 -> all)
@@ -140,6 +144,10 @@ class GBTFrameContainer {
     /// @param val Set it to true or false
     void setEnableCompileAdcValues(bool val)    { mEnableCompileAdcValues = val; };
 
+    /// Set number of parallel threads for the decoding of frames from binary files
+    /// @param threads Number to be set, if 0 hardware default value is used
+    void setNumThreads(unsigned threads)        { mThreadPool.setNumThreads(threads); };
+
     /// Option to store the inserted GBT frames
     /// @param val Set it to true or false
     void setEnableStoreGBTFrames(bool val)      { mEnableStoreGBTFrames = val; if(!mEnableStoreGBTFrames) mGBTFrames.resize(2);  };
@@ -210,6 +218,35 @@ class GBTFrameContainer {
     /// @param iFrame GBT Frame to be processed (ordering is important!!)
     void compileAdcValues(std::vector<GBTFrame>::iterator iFrame);
 
+    /// Computes the two ADC values of a half SAMPA in a frame
+    /// @param frame GBT Frame
+    /// @param prevFrame GBT Frame before frame
+    /// @param iHalfSampa Half SAMPA
+    /// @param position Position of the data in the frame, as found by the sync pattern monitor
+    /// @param value1 First ADC value
+    /// @param value2 Second ADC value
+    /// @return False for an unknown position
+    bool compileAdcValues(const GBTFrame& frame, const GBTFrame& prevFrame, short iHalfSampa, short position,
+                          short& value1, short& value2) const;
+
+    /// Adds a frame to the block of frames to be decoded, decodes the block when it is full
+    /// @param word3 Word 3 of GBT frame
+    /// @param word2 Word 2 of GBT frame
+    /// @param word1 Word 1 of GBT frame
+    /// @param word0 Word 0 of GBT frame
+    void addGBTFrameToBlock(unsigned word3, unsigned word2, unsigned word1, unsigned word0);
+
+    /// Decodes the frames of the block, the first frame of the block is the last frame of the previous block
+    void processFrameBlock();
+
+    /// Searches the sync pattern and compiles the ADC values of one half SAMPA for all frames of the block
+    /// @param iHalfSampa Half SAMPA
+    void processHalfSampaStream(short iHalfSampa);
+
+    /// Checks the ADC clock of one SAMPA for all frames of the block
+    /// @param iSampa SAMPA
+    void checkAdcClockStream(short iSampa);
+
     void resetAdcClock();
     void resetSyncPattern();
     void resetAdcValues();
@@ -231,8 +268,14 @@ class GBTFrameContainer {
     int mSampaVersion;                              ///< Version of SAMPA chip
     int mTimebin;                                   ///< Timebin of last digits extraction
     int mGBTFramesAnalyzed;
+    ThreadPool mThreadPool;                         ///< Threads decoding the streams of a block
 
     std::array<std::array<short, 16>, 5> mTmpData;
+
+    std::vector<GBTFrame> mFrameBlock;                      ///< Block of frames to be decoded, starting with the last decoded frame
+    std::array<std::vector<short>, 5> mBlockAdcValues;      ///< ADC values of the block for each half SAMPA
+    std::array<std::vector<short>, 5> mBlockPositions;      ///< Sync pattern position in each frame of the block for each half SAMPA
+    std::array<std::vector<int>, 3> mBlockAdcClockErrors;   ///< Frames of the block with ADC clock error for each SAMPA
 };
 
 //template<typename... Args>
@@ -16,6 +16,7 @@
 
 #include <vector>
 #include "TPCReconstruction/DigitalCurrentClusterIntegrator.h"
+#include "TPCBase/ThreadPool.h"
 #include "DataFormatsTPC/ClusterNative.h"
 
 namespace o2
@@ -31,6 +32,7 @@ namespace o2 { namespace dataformats { template <typename TruthElement> class MC
 namespace o2 { namespace TPC {
 
 //Class to convert a list of input buffers containing TPC clusters of type ClusterHardware to type ClusterNative.
+//The 8 kb pages of the input are decoded in parallel, the clusters are sorted into the output buffers of their sector and row with a counting sort.
 class HardwareClusterDecoder
 {
 public:
@@ -41,11 +43,15 @@ public:
                      std::vector<o2::TPC::ClusterNativeContainer>& outputClusters,
                      const std::vector<o2::dataformats::MCTruthContainer<o2::MCCompLabel>>* inMCLabels = nullptr,
                      std::vector<o2::dataformats::MCTruthContainer<o2::MCCompLabel>>* outMCLabels = nullptr);
-  static void sortClustersAndMC(std::vector<o2::TPC::ClusterNative> clusters,
-                                o2::dataformats::MCTruthContainer<o2::MCCompLabel> mcTruth);
+  static void sortClustersAndMC(std::vector<o2::TPC::ClusterNative>& clusters,
+                                o2::dataformats::MCTruthContainer<o2::MCCompLabel>& mcTruth);
+
+  //Set the number of threads decoding the pages, 0 uses the hardware concurrency
+  void setNumThreads(unsigned int nThreads) { mThreadPool.setNumThreads(nThreads); }
 
  private:
   std::unique_ptr<DigitalCurrentClusterIntegrator> mIntegrator;
+  ThreadPool mThreadPool{ 0 }; //Threads decoding the pages
 };
 
 }}
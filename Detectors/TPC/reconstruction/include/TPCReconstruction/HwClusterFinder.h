@@ -27,6 +27,9 @@ class Cluster;
 
 /// \class HwClusterFinder
 /// \brief Class for TPC HW cluster finder
+///
+/// The time bins are kept in a ring buffer, a new time bin replaces the oldest one. Charges, event numbers and
+/// digit indices are stored in separate arrays, such that the peak search can test several pads at once.
 class HwClusterFinder {
   public:
     /// Mini digit struct, consisting of charge, event number and digit index.
@@ -37,6 +40,7 @@ class HwClusterFinder {
       int index;
 
       MiniDigit() : charge(0), event(-1), index(-1) {};
+      MiniDigit(float c, int e, int i) : charge(c), event(e), index(i) {};
       MiniDigit(const MiniDigit& other) : charge(other.charge), event(other.event), index(other.index) {};
       void clear() { charge = 0; event = -1; index = -1; };
     };
@@ -146,6 +150,27 @@ class HwClusterFinder {
     /// \return MiniDigit to be used for cluster. Will be outerCharge, if requirements fulfilled, otherwise "0-MiniDigit"
     bool chargeForCluster(float outerCharge, float innerCharge);
 
+    /// Search for peak candidates in a time bin, several pads are tested at once
+    /// \param offsets Offsets of the time bins before, at and after the tested time bin in the local storage
+    /// \param firstPad First pad to be tested
+    /// \param lastPad Last pad to be tested
+    /// \return Bit mask of the pads fulfilling the peak conditions, bit 0 is firstPad
+    unsigned findPeakCandidates(const unsigned* offsets, int firstPad, int lastPad) const;
+
+    /// Offset of a time bin in the local storage
+    /// \param time Time bin relative to the oldest one in the local storage
+    /// \return Offset of the first pad of the time bin
+    unsigned getTimebinOffset(int time) const;
+
+    /// Get a digit of the local storage
+    /// \param offset Offset of the digit in the local storage
+    /// \return Copy of the digit
+    MiniDigit getDigit(unsigned offset) const { return MiniDigit(mCharge[offset], mEvent[offset], mIndex[offset]); }
+
+    /// Clear a digit of the local storage
+    /// \param offset Offset of the digit in the local storage
+    void clearDigit(unsigned offset) { mCharge[offset] = 0; mEvent[offset] = -1; mIndex[offset] = -1; }
+
     /// Prints 5x5 matrix of internal storage around given parameters
     /// \param time relative time bin of center
     /// \param pad relative pad number of center
@@ -163,6 +188,8 @@ class HwClusterFinder {
     unsigned short mRow;                    ///< Row number
     unsigned short mPads;                   ///< Size of CF in pad direction
     unsigned short mTimebins;               ///< Size of CF in time direction
+    unsigned short mPadStride;              ///< Distance of two time bins in the local storage, larger than mPads to allow vector loads
+    unsigned short mFirstTimebin;           ///< Position of the oldest time bin in the ring buffer
     unsigned short mClusterSizePads;        ///< Size of cluster in pad direction
     unsigned short mClusterSizeTime;        ///< Size of cluster in time direction
     float mDiffThreshold;                   ///< Charge difference threshold, not yet used
@@ -171,7 +198,9 @@ class HwClusterFinder {
     unsigned mTimebinsAfterLastProcessing;  ///< Number of time bins added after last processing
     std::weak_ptr<HwClusterFinder> mNextCF; ///< Not owning pointer to neighboring cluster finder (on the "left" side)
 
-    std::vector<std::unique_ptr<std::vector<MiniDigit>>> mData;         ///< local data storage
+    std::vector<float> mCharge;                                         ///< local data storage, charges of the ring buffer of time bins
+    std::vector<int> mEvent;                                            ///< local data storage, event numbers of the ring buffer of time bins
+    std::vector<int> mIndex;                                            ///< local data storage, digit indices of the ring buffer of time bins
     std::vector<std::vector<MiniDigit>> mTmpCluster;                    ///< local temporary cluster data storage
     std::vector<o2::TPC::Cluster> mClusterContainer;                    ///< Container for found clusters
     std::vector<std::vector<std::pair<int,int>>> mClusterDigitIndices;  ///< Container for digit indices associated with found clusters
@@ -185,19 +214,29 @@ inline void HwClusterFinder::addTimebin(std::vector<MiniDigit>::iterator timebin
   ++mTimebinsAfterLastProcessing;
 
   //
-  // reordering of the local array
+  // the new time bin replaces the oldest one in the ring buffer
   //
-  std::rotate(mData.begin(), mData.begin() + 1, mData.end());
+  const unsigned offset = mFirstTimebin * mPadStride;
+  mFirstTimebin = (mFirstTimebin + 1 == mTimebins) ? 0 : mFirstTimebin + 1;
 
   //
   // fillin with data
-  // 
-  if (zeroBin) {
-    for (auto &digi : *mData.back()) digi.clear();
-  } else {
-    std::copy(timebin,timebin+length,mData.back()->begin());
-    mData.back()->resize(mPads,MiniDigit());
+  //
+  if (zeroBin) length = 0;
+  length = std::min(length, static_cast<int>(mPads));
+  for (int p = 0; p < length; ++p, ++timebin) {
+    mCharge[offset+p] = timebin->charge;
+    mEvent[offset+p] = timebin->event;
+    mIndex[offset+p] = timebin->index;
   }
+  for (int p = length; p < mPads; ++p) clearDigit(offset+p);
+}
+
+//________________________________________________________________________
+inline unsigned HwClusterFinder::getTimebinOffset(int time) const
+{
+  const int slot = mFirstTimebin + time;
+  return ((slot >= mTimebins) ? slot - mTimebins : slot) * mPadStride;
 }
 
 }
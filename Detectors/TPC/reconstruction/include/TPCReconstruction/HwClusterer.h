@@ -15,8 +15,10 @@
 #define ALICEO2_TPC_HWClusterer_H_
 
 #include "TPCReconstruction/Clusterer.h"
+#include "TPCReconstruction/HwClusterFinder.h"
 #include "DataFormatsTPC/Cluster.h"
 #include "TPCBase/CalDet.h"
+#include "TPCBase/ThreadPool.h"
 
 #include "SimulationDataFormat/MCTruthContainer.h"
 #include "SimulationDataFormat/MCCompLabel.h"
@@ -24,18 +26,23 @@
 #include <vector>
 #include <map>
 #include <utility>
-#include <tuple>
 #include <memory>
 
 namespace o2{
 namespace TPC {
 
 class ClustererTask;
-class HwClusterFinder;
 class Digit;
 
 /// \class HwClusterer
 /// \brief Class for TPC HW cluster finding
+///
+/// The CRUs are processed in parallel by a pool of threads which lives as long as the clusterer. The CRUs are
+/// handed out one by one, such that idle threads take over the remaining work. Each thread writes the clusters
+/// and MC labels into its own arena, they are merged in CRU order afterwards.
+///
+/// The digits are staged sorted by CRU and row in flat arrays, each row is then filled into a contiguous
+/// (time bin, pad) charge matrix from which the cluster finders take their time bins.
 class HwClusterer : public Clusterer {
 
   using MCLabelContainer = o2::dataformats::MCTruthContainer<o2::MCCompLabel>;
@@ -111,8 +118,9 @@ class HwClusterer : public Clusterer {
     void setCRUMax(int cru) { mCRUMax = cru; };
 
     /// Set number of parallel threads
+    /// The pool is resized at the next call of Process
     /// \param threads Number to be set, if 0 hardware default value is used
-    void setNumThreads(unsigned threads);
+    void setNumThreads(unsigned threads) { mThreadPool.setNumThreads(threads); };
 
   private:
 
@@ -120,15 +128,12 @@ class HwClusterer : public Clusterer {
      * Helper functions
      */
 
-    /// Configuration struct for the processDigits function
+    /// Configuration struct for the processCRU function
     struct CfConfig {
-      unsigned iThreadID;               ///< Index of thread
-      unsigned iThreadMax;              ///< Total number of started threads
-      unsigned iCRUMin;                 ///< Minimum CRU number to process
-      unsigned iCRUMax;                 ///< Maximum CRU number to process
       unsigned iMaxPads;                ///< Maximum number of pads per row
       int iMinTimeBin;                  ///< Minumum digit time bin
       int iMaxTimeBin;                  ///< Maximum digit time bin
+      int iEventCount;                  ///< Event count of the digits
       bool iEnableNoiseSim;             ///< Noise simulation enable switch
       bool iEnablePedestalSubtraction;  ///< Pedestal subtraction enable switch
       bool iIsContinuousReadout;        ///< Continous simulation switch
@@ -136,23 +141,57 @@ class HwClusterer : public Clusterer {
       std::shared_ptr<CalDet<float>> iPedestalObject;   ///< Pointer to pedestal object
     };
 
-    /// Processing the digits, made static to allow for multithreading
-    /// \param digits Reference to digit container
-    /// \param clusterFinder Reference to container holding all cluster finder instances
-    /// \param cluster Reference to container for found clusters
-    /// \param label Reference to container for MC labels of found clusters
+    /// Output arena and scratch buffers of one worker thread, reused for all calls
+    struct WorkerOutput {
+      std::vector<Cluster> clusters;                            ///< Clusters found by the worker, grouped by CRU
+      std::vector<MCCompLabel> labels;                          ///< MC labels of the clusters, sorted by occurrence for each cluster
+      std::vector<unsigned> labelCounts;                        ///< Number of MC labels of each cluster
+      std::vector<HwClusterFinder::MiniDigit> bins;             ///< Charges of one row, pads of one time bin after the other
+      std::map<MCCompLabel,int> labelCount;                     ///< Buffer to count the MC labels of a cluster
+    };
+
+    /// Digits of the present call, sorted by CRU and row, as structure of arrays
+    struct DigitStaging {
+      std::vector<unsigned> rowBegin;   ///< Index of the first digit of each row, the rows of all CRUs one after the other
+      std::vector<int> time;            ///< Time bin of the digits
+      std::vector<int> pad;             ///< Pad of the digits
+      std::vector<float> charge;        ///< Charge of the digits
+      std::vector<int> index;           ///< Index of the digits in the input, -1 without MC truth
+    };
+
+    /// Location of the clusters of one CRU in the output arenas
+    struct CRUOutput {
+      unsigned worker;          ///< Worker which processed the CRU
+      size_t clusterBegin;      ///< Index of the first cluster in the arena of the worker
+      size_t clusterEnd;        ///< Index after the last cluster in the arena of the worker
+      size_t labelBegin;        ///< Index of the first MC label in the arena of the worker
+    };
+
+    /// Sort the digits by CRU and row into the staging arrays
+    /// \param nDigits Number of input digits
+    /// \param getDigit Accessor of the input digit with given index
+    /// \param storeIndex Switch to store the digit indices, needed for the MC truth
+    /// \param iTimeBinMin Minimum time bin to be processed, earlier digits are skipped
+    /// \param iTimeBinMax Maximum time bin of the digits, is updated
+    template <typename DigitAccessor>
+    void stageDigits(size_t nDigits, DigitAccessor getDigit, bool storeIndex, int iTimeBinMin, int& iTimeBinMax);
+
+    /// Processing the digits of one CRU
+    /// \param iCRU CRU to be processed
     /// \param config Configuration for the cluster finding
-    static void processDigits(
-        const std::vector<std::vector<std::vector<std::tuple<Digit const*, int, int>>>>& digits,
-        const std::vector<std::vector<std::vector<std::shared_ptr<HwClusterFinder>>>>& clusterFinder,
-              std::vector<std::vector<Cluster>>& cluster,
-              std::vector<std::vector<std::vector<std::pair<int,int>>>>& label,
-              CfConfig config);
+    /// \param output Output arena of the worker processing the CRU
+    void processCRU(unsigned iCRU, const CfConfig& config, WorkerOutput& output);
+
+    /// Compute the MC labels of a cluster and append them to the arena of the worker
+    /// \param digitIndices Indices and event counts of the digits used for the cluster
+    /// \param output Output arena of the worker
+    void addClusterLabels(const std::vector<std::pair<int,int>>& digitIndices, WorkerOutput& output) const;
 
     /// Handling of the parallel cluster finder threads
     /// \param iTimeBinMin Minimum time bin to be processed
     /// \param iTimeBinMax Maximum time bin to be processed
-    void ProcessTimeBins(int iTimeBinMin, int iTimeBinMax);
+    /// \param eventCount Event count of the digits
+    void ProcessTimeBins(int iTimeBinMin, int iTimeBinMax, int eventCount);
 
     /*
      * class members
@@ -166,14 +205,17 @@ class HwClusterer : public Clusterer {
     unsigned mCRUMax;                       ///< Maximum CRU ID to be processed
     unsigned mPadsPerCF;                    ///< Number of pads per cluster finder instance
     unsigned mTimebinsPerCF;                ///< Number of time bins per cluster finder instance
-    unsigned mNumThreads;                   ///< Number of parallel processing threads
     float mMinQDiff;                        ///< Minimum charge difference between neighboring pads / time bins
 
     std::vector<std::vector<std::vector<std::shared_ptr<HwClusterFinder>>>> mClusterFinder;     ///< Cluster finder container for each row in each CRU
-    std::vector<std::vector<std::vector<std::tuple<Digit const*, int, int>>>> mDigitContainer;  ///< Sorted digit container for each row in each CRU. Tuple consists of pointer to digit, original digit index and event count
+    std::vector<unsigned> mRowOffset;                                                           ///< Index of the first row of each CRU in the digit staging
+    DigitStaging mDigitStaging;                                                                 //!<! Digits of the present call, sorted by CRU and row
+
+    CfConfig mCfConfig;                                 //!<! Configuration of the present call, read by the workers
+    std::vector<WorkerOutput> mWorkerOutput;            //!<! Output arena of each worker
+    std::vector<CRUOutput> mCRUOutput;                  //!<! Location of the clusters of each CRU in the output arenas
 
-    std::vector<std::vector<Cluster>> mClusterStorage;                                          ///< Cluster storage for each CRU
-    std::vector<std::vector<std::vector<std::pair<int,int>>>> mClusterDigitIndexStorage;        ///< Container for digit indices, used in found clusters. Pair consists of original digit index and event count
+    ThreadPool mThreadPool;                             //!<! Pool of worker threads, the calling thread is worker 0
 
     std::vector<Cluster>* mClusterArray;        ///< Pointer to output cluster storage
     MCLabelContainer* mClusterMcLabelArray;     ///< Pointer to MC Label storage
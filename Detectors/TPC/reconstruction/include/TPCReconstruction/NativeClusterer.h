@@ -0,0 +1,158 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file NativeClusterer.h
+/// \brief Streaming TPC cluster finder writing ClusterNative
+#ifndef ALICEO2_TPC_NativeClusterer_H_
+#define ALICEO2_TPC_NativeClusterer_H_
+
+#include "TPCReconstruction/Clusterer.h"
+#include "DataFormatsTPC/ClusterNative.h"
+#include "TPCBase/ThreadPool.h"
+
+#include "SimulationDataFormat/MCTruthContainer.h"
+#include "SimulationDataFormat/MCCompLabel.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace o2{
+namespace TPC {
+
+class Digit;
+
+/// \class NativeClusterer
+/// \brief Cluster finder for zero suppressed digits, writing the clusters in the ClusterNative format
+///
+/// The clusters are written directly into one ClusterNativeContainer for each sector and global pad row, which
+/// are sorted as required by the tracking. The access structure for the tracking points into these containers.
+/// The sectors are processed in parallel by a pool of threads which lives as long as the clusterer.
+///
+/// The peak finding follows the HwClusterFinder: a cluster is a local maximum in a 3x3 matrix of pads and
+/// time bins with at least one neighbouring time bin with signal, the outer cells of the 5x5 matrix are added
+/// if the neighbouring inner cell is above threshold.
+///
+/// In continuous readout each call of Process is a time window following the previous one. The last time bins
+/// of a window are kept and the clusters around them are found with the next window, or with finishStream.
+class NativeClusterer : public Clusterer {
+  public:
+
+    /// Constructor
+    /// \param clusterOutput Containers to be filled with clusters, one for each sector and global pad row
+    /// \param labelOutput MC labels of the clusters, one container for each container of clusters
+    /// \param minQMax Minimum peak charge for cluster
+    /// \param requirePositiveCharge Positive charge is required
+    /// \param requireNeighbouringPad Requires at least one neighbouring pad with charge
+    NativeClusterer(
+        std::vector<ClusterNativeContainer>* clusterOutput,
+        std::vector<MCLabelContainer>* labelOutput = nullptr,
+        int minQMax = 5,
+        bool requirePositiveCharge = true,
+        bool requireNeighbouringPad = false);
+
+    /// Destructor
+    ~NativeClusterer() override = default;
+
+    /// Find the clusters of the digits of one time window
+    /// \param digits Container with TPC digits
+    /// \param mcDigitTruth MC Digit Truth container
+    /// \param eventCount event counter
+    void Process(std::vector<o2::TPC::Digit> const &digits, MCLabelContainer const* mcDigitTruth, int eventCount) override;
+    void Process(std::vector<std::unique_ptr<Digit>>& digits, MCLabelContainer const* mcDigitTruth, int eventCount) override;
+
+    /// Find the clusters in the time bins kept from the last time window, the next call starts a new stream
+    void finishStream();
+
+    /// Access structure for the tracking, pointing into the output containers
+    /// \return Access structure, valid until the next call of Process
+    std::unique_ptr<ClusterNativeAccessFullTPC> getClusterAccess();
+
+    /// Switch for triggered / continuous readout
+    /// \param isContinuous - false for triggered readout, true for continuous readout
+    void setContinuousReadout(bool isContinuous) { mIsContinuousReadout = isContinuous; };
+
+    /// Set number of parallel threads
+    /// The pool is resized at the next call of Process
+    /// \param threads Number to be set, if 0 hardware default value is used
+    void setNumThreads(unsigned threads) { mThreadPool.setNumThreads(threads); };
+
+  private:
+
+    /// Digit sorted into its pad row
+    struct StagedDigit {
+      int time;                 ///< Time bin
+      int pad;                  ///< Pad in the row
+      float charge;             ///< Charge
+      int index;                ///< Index of the digit in the input, -1 without MC truth
+      int event;                ///< Event count of the input
+    };
+
+    /// Scratch buffers of one worker thread
+    struct WorkerBuffers {
+      std::vector<float> charge;                ///< Charges of one row, pads of one time bin after the other
+      std::vector<int> digit;                   ///< Staged digit of each cell, -1 for empty cells
+      std::vector<ClusterNative> clusters;      ///< Clusters of one row before sorting
+      std::vector<MCCompLabel> labels;          ///< MC labels of the clusters of one row
+      std::vector<unsigned> labelBegin;         ///< Index of the first MC label of each cluster, one more entry than clusters
+      std::vector<unsigned> order;              ///< Sorted order of the clusters
+      std::map<MCCompLabel,int> labelCount;     ///< Buffer to count the MC labels of a cluster
+    };
+
+    /// Sort the digits into the pad rows, together with the digits kept from the last window
+    /// \param nDigits Number of input digits
+    /// \param getDigit Accessor of the input digit with given index
+    /// \param storeIndex Switch to store the digit indices, needed for the MC truth
+    /// \param eventCount Event count of the digits
+    template <typename DigitAccessor>
+    void stageDigits(size_t nDigits, DigitAccessor getDigit, bool storeIndex, int eventCount);
+
+    /// Find the clusters of all sectors
+    /// \param lastWindow No time bins are kept for the next window
+    void processWindow(bool lastWindow);
+
+    /// Find the clusters of one pad row
+    /// \param sector Sector
+    /// \param row Global pad row in the sector
+    /// \param buffers Scratch buffers of the worker
+    void processRow(int sector, int row, WorkerBuffers& buffers);
+
+    /// Compute the MC labels of a cluster and append them to the buffer
+    /// \param digits Indices of the staged digits of the cluster
+    /// \param nDigits Number of digits
+    /// \param buffers Scratch buffers of the worker
+    void addClusterLabels(const int* digits, int nDigits, WorkerBuffers& buffers) const;
+
+    /*
+     * class members
+     */
+    bool mIsContinuousReadout;              ///< Switch for continuous readout
+    int mLastTimebin;                       ///< Last time bin of the previous window
+    int mTimeBinMin;                        ///< First time bin of the present window
+    int mTimeBinMax;                        ///< Last time bin of the present window
+    bool mLastWindow;                       ///< No time bins are kept after the present window
+
+    std::vector<ClusterNativeContainer>* mClusterOutput;    ///< Pointer to output cluster storage
+    std::vector<MCLabelContainer>* mLabelOutput;            ///< Pointer to MC label storage
+
+    std::vector<unsigned> mRowBegin;                        //!<! Index of the first staged digit of each pad row of all sectors
+    std::vector<StagedDigit> mStagedDigits;                 //!<! Digits of the present window sorted by pad row
+    std::vector<std::vector<StagedDigit>> mKeptDigits;      //!<! Digits of the last time bins of each pad row of all sectors, for the next window
+    std::vector<WorkerBuffers> mWorkerBuffers;              //!<! Scratch buffers of each worker
+    ThreadPool mThreadPool;                                 //!<! Pool of worker threads, the calling thread is worker 0
+
+    std::map<int, std::unique_ptr<MCLabelContainer>> mLastMcDigitTruth; //!<! Buffer for digit MC truth information
+};
+
+}
+}
+
+
+#endif
@@ -14,6 +14,9 @@
 /// \file RawReader.h
 /// \author Sebastian Klewin (Sebastian.Klewin@cern.ch)
 
+#include <array>
+#include <cstdint>
+#include <future>
 #include <string>
 #include <vector>
 #include <map>
@@ -46,15 +49,15 @@ class RawReader {
 
       /// Get the time stamp
       /// @return corrected header time stamp
-      uint64_t timeStamp() { return (timeStamp_w << 32) | (timeStamp_w >> 32);}
+      uint64_t timeStamp() const { return (timeStamp_w << 32) | (timeStamp_w >> 32);}
 
       /// Get event counter
       /// @return corrected event counter
-      uint64_t eventCount() { return (eventCount_w << 32) | (eventCount_w >> 32);}
+      uint64_t eventCount() const { return (eventCount_w << 32) | (eventCount_w >> 32);}
 
       /// Get reserved data field
       /// @return corrected data field
-      uint64_t reserved_2() { return (reserved_2_w << 32) | (reserved_2_w >> 32);}
+      uint64_t reserved_2() const { return (reserved_2_w << 32) | (reserved_2_w >> 32);}
 
       /// Default constructor
       Header() {};
@@ -154,14 +157,20 @@ class RawReader {
 
     /// Get data
     /// @param padPos local pad position (row starts with 0 in each region)
-    /// @return shared pointer to data vector, each element is one time bin
+    /// @return shared pointer to a copy of the data, each element is one time bin
     std::shared_ptr<std::vector<uint16_t>> getData(const PadPos& padPos);
 
     /// Get data of next pad position
     /// @param padPos local pad position (row starts with 0 in each region)
-    /// @return shared pointer to data vector, each element is one time bin
+    /// @return shared pointer to a copy of the data, each element is one time bin
     std::shared_ptr<std::vector<uint16_t>> getNextData(PadPos& padPos);
 
+    /// Get data of next pad position without copying
+    /// @param padPos local pad position (row starts with 0 in each region)
+    /// @param nTimeBins number of time bins of the data
+    /// @return pointer to the data, each element is one time bin, valid until the next event is loaded, nullptr after the last pad
+    const uint16_t* getNextPadData(PadPos& padPos, size_t& nTimeBins);
+
     int getRegion() const { return mRegion; };
     int getLink() const { return mLink; };
     int getEventNumber() const { return mLastEvent; };
@@ -186,6 +195,11 @@ class RawReader {
     /// Set the SAMPA version
     /// @param sampaVersion Version to be set
     void setSampaVersion(int sampaVerson) { mSampaVersion = sampaVerson; };
+
+    /// Read the data of the following event in the background after an event was loaded
+    /// @param prefetch Enables the read ahead
+    void setPrefetchNextEvent(bool prefetch) { mPrefetchNextEvent = prefetch; };
+
     /// Returns some information about the event, e.g. the header
     /// @param event Event number
     /// @return shared pointer to vector with event informations
@@ -201,12 +215,44 @@ class RawReader {
 
   private:
 
-    bool decodeRawGBTFrames(EventInfo eventInfo);
-    bool decodePreprocessedData(EventInfo eventInfo);
+    /// Number of channels of one link, 5 half SAMPAs with 16 channels each
+    static constexpr int NCHANNELS = 80;
+
+    /// Data of an event read ahead in the background, not shared between copies of the reader
+    struct EventPrefetch {
+      int64_t event = -1;                                     ///< Event number of the data
+      std::future<std::vector<std::vector<uint32_t>>> words;  ///< Words of each entry of the event info
+
+      EventPrefetch() = default;
+      EventPrefetch(const EventPrefetch&) {};
+      EventPrefetch& operator=(const EventPrefetch&) { return *this; };
+    };
+
+    /// Reads the payload of an event from the file
+    /// @param eventInfo Information about the event
+    /// @param words Buffer to be filled with the payload
+    /// @return Indicator of success
+    static bool readEventWords(const EventInfo& eventInfo, std::vector<uint32_t>& words);
+
+    /// Initializes the pad position of each channel of the link
+    void initChannelMap();
+
+    /// Prepares the data storage for a new event
+    /// @param eventInfos Information about the event
+    void resetData(const std::vector<EventInfo>& eventInfos);
+
+    /// Stores the ADC value of a channel in the next time bin
+    /// @param channel Channel of the link, 16 for each half SAMPA
+    /// @param value ADC value
+    void addAdcValue(int channel, uint16_t value);
+
+    bool decodeRawGBTFrames(const EventInfo& eventInfo, const std::vector<uint32_t>& words);
+    bool decodePreprocessedData(const EventInfo& eventInfo, const std::vector<uint32_t>& words);
 
     bool mUseRawInMode3;                ///< in readout mode 3 decode GBT frames
     bool mApplyChannelMask;             ///< apply channel mask
     bool mCheckAdcClock;                ///< check the ADC clock
+    bool mPrefetchNextEvent;            ///< read the following event in the background
     int mRegion;                        ///< Region of the data
     int mLink;                          ///< FEC of the data
     int mRun;                           ///< Run number
@@ -214,8 +260,16 @@ class RawReader {
     int64_t mLastEvent;                 ///< Number of last loaded event
     std::array<uint64_t,5> mTimestampOfFirstData;   ///< Time stamp of first decoded ADC value, individually for each half SAMPA
     std::map<uint64_t, std::shared_ptr<std::vector<EventInfo>>> mEvents;                ///< all "event data" - headers, file path, etc. NOT actual data
-    std::map<PadPos,std::shared_ptr<std::vector<uint16_t>>> mData;                      ///< ADC values of last loaded Event
-    std::map<PadPos,std::shared_ptr<std::vector<uint16_t>>>::iterator mDataIterator;    ///< Iterator to last requested data
+    std::vector<uint16_t> mData;                                                        ///< ADC values of last loaded Event, the time bins of one channel after the other
+    size_t mTimeBinsMax;                                                                ///< Maximum number of time bins of a channel in mData
+    std::array<uint32_t,NCHANNELS> mTimeBins;                                           ///< Number of time bins of each channel in the last loaded Event
+    std::array<bool,NCHANNELS> mChannelActive;                                          ///< Channels which are not masked
+    std::array<PadPos,NCHANNELS> mChannelPadPos;                                        ///< Pad position of each channel
+    std::array<uint8_t,NCHANNELS> mChannelOrder;                                        ///< Channels sorted by pad position
+    bool mChannelMapInitialized;                                                        ///< Pad positions of the channels are set
+    int mNextChannel;                                                                   ///< Position in mChannelOrder of next requested data
+    std::vector<std::vector<uint32_t>> mEventWords;                                     ///< Buffer for the words of the event to be decoded
+    EventPrefetch mPrefetch;                                                            ///< Read ahead of the following event
     std::array<short,5> mSyncPos;                                                       ///< positions of the sync pattern (for readout mode 3)
 
     std::shared_ptr<CalDet<bool>> mChannelMask;                                         ///< Channel mask
@@ -236,21 +290,42 @@ std::shared_ptr<std::vector<RawReader::EventInfo>> RawReader::getEventInfo(uint6
 
 inline
 std::shared_ptr<std::vector<uint16_t>> RawReader::getData(const PadPos& padPos) {
-  mDataIterator = mData.find(padPos);
-  if (mDataIterator == mData.end()) {
-    std::shared_ptr<std::vector<uint16_t>> emptyVecPtr(new std::vector<uint16_t>);
-    return emptyVecPtr;
+  for (mNextChannel = 0; mNextChannel < NCHANNELS; ++mNextChannel) {
+    const int channel = mChannelOrder[mNextChannel];
+    if (mTimeBins[channel] > 0 && mChannelPadPos[channel] == padPos) {
+      const uint16_t* data = &mData[channel*mTimeBinsMax];
+      return std::make_shared<std::vector<uint16_t>>(data, data + mTimeBins[channel]);
+    }
   }
-  return mDataIterator->second;
+  std::shared_ptr<std::vector<uint16_t>> emptyVecPtr(new std::vector<uint16_t>);
+  return emptyVecPtr;
 };
 
 inline
 std::shared_ptr<std::vector<uint16_t>> RawReader::getNextData(PadPos& padPos) {
-  if (mDataIterator == mData.end()) return nullptr;
-  std::map<PadPos,std::shared_ptr<std::vector<uint16_t>>>::iterator last = mDataIterator;
-  mDataIterator++;
-  padPos = last->first;
-  return last->second;
+  size_t nTimeBins;
+  const uint16_t* data = getNextPadData(padPos, nTimeBins);
+  if (data == nullptr) return nullptr;
+  return std::make_shared<std::vector<uint16_t>>(data, data + nTimeBins);
+};
+
+inline
+const uint16_t* RawReader::getNextPadData(PadPos& padPos, size_t& nTimeBins) {
+  for (; mNextChannel < NCHANNELS; ++mNextChannel) {
+    const int channel = mChannelOrder[mNextChannel];
+    if (mTimeBins[channel] == 0) continue;
+    ++mNextChannel;
+    padPos = mChannelPadPos[channel];
+    nTimeBins = mTimeBins[channel];
+    return &mData[channel*mTimeBinsMax];
+  }
+  nTimeBins = 0;
+  return nullptr;
+};
+
+inline
+void RawReader::addAdcValue(int channel, uint16_t value) {
+  mData[channel*mTimeBinsMax + mTimeBins[channel]++] = value;
 };
 
 inline
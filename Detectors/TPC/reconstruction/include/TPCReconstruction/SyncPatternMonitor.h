@@ -94,6 +94,14 @@ class SyncPatternMonitor {
 
 inline
 short SyncPatternMonitor::addSequence(const short hw0, const short hw1, const short hw2, const short hw3) {
+  // Outside of a pattern only the first pattern word changes the state, which
+  // is checked for all 4 half words at once
+  if (mPosition == SYNC_START &&
+      ((hw0 == SYNC_PATTERN[SYNC_START]) | (hw1 == SYNC_PATTERN[SYNC_START]) |
+       (hw2 == SYNC_PATTERN[SYNC_START]) | (hw3 == SYNC_PATTERN[SYNC_START])) == 0) {
+    mCheckedWords += 4;
+    return mPatternFound;
+  }
   checkWord(hw0,1); checkWord(hw1,2);
   checkWord(hw2,3); checkWord(hw3,0);
   return mPatternFound; //getPosition();
@@ -18,6 +18,7 @@
 #include "DataFormatsTPC/Cluster.h"
 #include "DataFormatsTPC/ClusterNative.h"
 #include "DataFormatsTPC/TrackTPC.h"
+#include "TPCBase/ThreadPool.h"
 
 class TChain;
 class AliHLTTPCCAO2Interface;
@@ -62,6 +63,19 @@ public:
   float getTFReferenceLength() {return sContinuousTFReferenceLength;} //Return reference time frame length used to obtain Z from T in continuous data
   int getNTracksASide() {return mNTracksASide;}
 
+  /// Processing time in seconds of the stages of the last runTracking call
+  struct Timing {
+    double conversion = 0.; ///< conversion of the Cluster input to ClusterNative, 0 for ClusterNative input
+    double input = 0.;      ///< filling the per sector cluster data of the CA tracker
+    double tracking = 0.;   ///< sector tracking and merging in the CA library
+    double output = 0.;     ///< conversion of the merged tracks to TrackTPC
+  };
+  const Timing& getTiming() const { return mTiming; }
+
+  /// Set the number of threads for the per sector input and the per track output conversion
+  /// \param nThreads number of threads, 0 uses the hardware concurrency
+  void setNumThreads(unsigned int nThreads) { mThreadPool.setNumThreads(nThreads); }
+
 private:
   int runTracking(TChain* inputClustersChain, const std::vector<Cluster>* inputClustersArray, std::vector<TrackTPC>* outputTracks);
   int convertClusters(TChain* inputClustersChain, const std::vector<Cluster>* inputClustersArray,
@@ -80,6 +94,8 @@ private:
   static constexpr float sContinuousTFReferenceLength = 0.023 * 5e6;
   static constexpr float sTrackMCMaxFake = 0.1;
   int mNTracksASide = 0;
+  ThreadPool mThreadPool; // Threads of the per sector input and the per track output conversion
+  Timing mTiming;
 };
 
 }
@@ -12,10 +12,17 @@
 /// \author Sebastian Klewin
 
 #include "TPCReconstruction/GBTFrameContainer.h"
+#include "TPCBase/MappedFile.h"
+#include <algorithm>
 #include <bitset>
 
 using namespace o2::TPC;
 
+namespace {
+/// Number of frames decoded together
+constexpr size_t kFrameBlockSize = 16384;
+}
+
 GBTFrameContainer::GBTFrameContainer() : GBTFrameContainer(0, 0) {}
 GBTFrameContainer::GBTFrameContainer(int cru, int link) : GBTFrameContainer(0, cru, link, -1) {}
 GBTFrameContainer::GBTFrameContainer(int size, int cru, int link, int sampaVersion)
@@ -33,7 +40,9 @@ GBTFrameContainer::GBTFrameContainer(int size, int cru, int link, int sampaVersi
     mCRU(cru),
     mLink(link),
     mSampaVersion(sampaVersion),
-    mTimebin(0)
+    mTimebin(0),
+    mThreadPool(std::min(std::thread::hardware_concurrency(), 5u)),
+    mFrameBlock()
 {
   mGBTFrames.reserve(size);
 
@@ -90,35 +99,57 @@ void GBTFrameContainer::addGBTFramesFromFile(std::string fileName)
 void GBTFrameContainer::addGBTFramesFromBinaryFile(std::string fileName, std::string type, int frames)
 {
   std::cout << "Reading from file " << fileName << std::endl;
-  std::ifstream file(fileName);
+  const MappedFile file(fileName);
 
-  if (!file.is_open()) {
+  if (!file.isOpen()) {
     LOG(ERROR) << "Can't read file " << fileName << FairLogger::endl;
     return;
   }
 
+  const uint32_t* data = reinterpret_cast<const uint32_t*>(file.data());
+  const uint32_t* const dataEnd = data + file.size() / sizeof(uint32_t);
+  auto readWords = [&data, dataEnd](size_t n) -> const uint32_t* {
+    if (static_cast<size_t>(dataEnd - data) < n) return nullptr;
+    const uint32_t* words = data;
+    data += n;
+    return words;
+  };
+
+  /*
+   * the block starts with the last frame decoded before
+   */
+  mFrameBlock.clear();
+  mFrameBlock.reserve(kFrameBlockSize+1);
+  mFrameBlock.emplace_back(mGBTFrames.empty() ? GBTFrame() : mGBTFrames.back());
+  auto frameLimitReached = [this, frames]() {
+    return (frames != -1) && (mGBTFramesAnalyzed + static_cast<int>(mFrameBlock.size()) - 1 >= frames);
+  };
+
   uint32_t rawData;
   uint32_t rawMarker;
-  uint32_t words[8];
+  const uint32_t* words;
   if (type == "grorc") {
-    while (!file.eof() && ((frames == -1) || (mGBTFramesAnalyzed < frames))) {
-      file.read((char*)&rawData,sizeof(rawData));
+    while (!frameLimitReached() && (words = readWords(1))) {
+      rawData = words[0];
       rawMarker = rawData & 0xFFFF0000;
       if ((rawMarker == 0xDEF10000) || (rawMarker == 0xDEF40000)) {
-        file.read((char*)&words,3*sizeof(words[0]));
-        addGBTFrame(rawData, words[0], words[1], words[2]);
+        if (!(words = readWords(3))) break;
+        addGBTFrameToBlock(rawData, words[0], words[1], words[2]);
       }
     }
   } else if (type == "trorc") {
-    while (!file.eof() && ((frames == -1) || (mGBTFramesAnalyzed < frames))) {
-      file.read((char*)&words,4*sizeof(words[0]));
-      addGBTFrame(words[0], words[1], words[2], words[3]);
+    while (!frameLimitReached() && (words = readWords(4))) {
+      addGBTFrameToBlock(words[0], words[1], words[2], words[3]);
     }
   } else if (type == "trorc2") {
     //
     // reading header
     //
-    file.read((char*)&words,8*sizeof(words[0]));
+    words = readWords(8);
+    if (!words) {
+      LOG(ERROR) << "File " << fileName << " is too short for the header" << FairLogger::endl;
+      return;
+    }
 
     // decoding header
     uint32_t headerVersion = (words[0] >> 24) & 0xF;
@@ -142,8 +173,8 @@ void GBTFrameContainer::addGBTFramesFromBinaryFile(std::string fileName, std::st
       switch (readoutMode) {
         case 1: {// raw GBT frames
           for (int i=0; i<(n_words-8); i= i+4) {
-            file.read((char*)&words,4*sizeof(words[0]));
-            addGBTFrame(words[0], words[1], words[2], words[3]);
+            if (!(words = readWords(4))) break;
+            addGBTFrameToBlock(words[0], words[1], words[2], words[3]);
           }
           break;
           }
@@ -156,7 +187,7 @@ void GBTFrameContainer::addGBTFramesFromBinaryFile(std::string fileName, std::st
           std::array<std::array<uint32_t,16>,5> adcValues;
 
           for (int i=0; i<(n_words-8); i= i+4) {
-            file.read((char*)&words,4*sizeof(words[0]));
+            if (!(words = readWords(4))) break;
 
             ids[4] = (words[0] >> 4) & 0xF;
             ids[3] = (words[0] >> 8) & 0xF;
@@ -207,7 +238,7 @@ void GBTFrameContainer::addGBTFramesFromBinaryFile(std::string fileName, std::st
           std::array<std::array<uint32_t,16>,5> adcValues;
 
           for (int i=0; i<(n_words-8); i= i+4) {
-            file.read((char*)&words,8*sizeof(words[0]));
+            if (!(words = readWords(8))) break;
 
             ids[4] = (words[4] >> 4) & 0xF;
             ids[3] = (words[4] >> 8) & 0xF;
@@ -241,23 +272,135 @@ void GBTFrameContainer::addGBTFramesFromBinaryFile(std::string fileName, std::st
           mAdcMutex.unlock();
           break;
           }
-          //          for (int i=0; i<(n_words-8); i= i+8) {
-          //            file.read((char*)&words,8*sizeof(words[0]));
-          //            addGBTFrame(words[0],words[1],words[2],words[3]);
-          //          }
-          //          break;
 
           default:
             break;
       }
     }
-    //    while (!file.eof() && ((frames == -1) || (mGBTFramesAnalyzed < frames))) {
-    //      file.read((char*)&words,8*sizeof(words[0]));
-    //      addGBTFrame(words[0],words[1],words[2],words[3]);
-    //    }
   }
+
+  // remaining frames
+  processFrameBlock();
+}
+
+void GBTFrameContainer::addGBTFrameToBlock(unsigned word3, unsigned word2, unsigned word1, unsigned word0)
+{
+  mFrameBlock.emplace_back(word3, word2, word1, word0);
+  if (mFrameBlock.size() > kFrameBlockSize) processFrameBlock();
+}
+
+void GBTFrameContainer::processFrameBlock()
+{
+  const size_t nFrames = mFrameBlock.size() - 1;
+  if (nFrames == 0) return;
+
+  /*
+   * the half SAMPAs and the ADC clocks of the SAMPAs are independent of each
+   * other, the streams are handed out to the threads one by one
+   */
+  const unsigned nTasks = mEnableAdcClockWarning ? 8 : 5;
+  mThreadPool.run(nTasks, [this](unsigned, size_t task) {
+    if (task < 5) processHalfSampaStream(task);
+    else checkAdcClockStream(task - 5);
+  });
+
+  /*
+   * warnings in the order of the frames
+   */
+  if (mEnableAdcClockWarning) {
+    for (short iSampa = 0; iSampa < 3; ++iSampa) {
+      for (const int frame : mBlockAdcClockErrors[iSampa]) {
+        LOG(WARNING) << "ADC clock error of SAMPA " << iSampa << " in GBT Frame " << mGBTFramesAnalyzed + frame << FairLogger::endl;
+      }
+    }
+  }
+  if (mEnableSyncPatternWarning) {
+    const auto& positions = mBlockPositions;
+    for (size_t iFrame = 0; iFrame < nFrames; ++iFrame) {
+      if (positions[0][iFrame] != positions[1][iFrame]) {
+        LOG(WARNING) << "The two half words from SAMPA 0 don't start at the same position, lower bits start at "
+                     << positions[0][iFrame] << ", higher bits at " << positions[1][iFrame] << FairLogger::endl;
+      }
+      if (positions[2][iFrame] != positions[3][iFrame]) {
+        LOG(WARNING) << "The two half words from SAMPA 1 don't start at the same position, lower bits start at "
+                     << positions[2][iFrame] << ", higher bits at " << positions[3][iFrame] << FairLogger::endl;
+      }
+      if (positions[0][iFrame] != positions[2][iFrame] || positions[0][iFrame] != positions[4][iFrame]) {
+        LOG(WARNING) << "The three SAMPAs don't have the same position, SAMPA0 = " << positions[0][iFrame]
+                     << ", SAMPA1 = " << positions[2][iFrame] << ", SAMPA2 = " << positions[4][iFrame]
+                     << FairLogger::endl;
+      }
+    }
+  }
+
+  if (mEnableCompileAdcValues) {
+    mAdcMutex.lock();
+    for (short iHalfSampa = 0; iHalfSampa < 5; ++iHalfSampa) {
+      for (const short value : mBlockAdcValues[iHalfSampa]) mAdcValues[iHalfSampa]->emplace(value);
+    }
+    mAdcMutex.unlock();
+  }
+
+  mGBTFramesAnalyzed += nFrames;
+
+  /*
+   * without storing, the container holds the last two frames
+   */
+  if (mEnableStoreGBTFrames) {
+    mGBTFrames.insert(mGBTFrames.end(), mFrameBlock.begin()+1, mFrameBlock.end());
+  } else {
+    mGBTFrames.assign(mFrameBlock.end()-2, mFrameBlock.end());
+  }
+
+  mFrameBlock.front() = mFrameBlock.back();
+  mFrameBlock.resize(1);
 }
 
+void GBTFrameContainer::processHalfSampaStream(short iHalfSampa)
+{
+  const short sampa = iHalfSampa / 2;
+  const short lowHigh = iHalfSampa % 2;
+  auto& syncPattern = mSyncPattern[iHalfSampa];
+  auto& adcValues = mBlockAdcValues[iHalfSampa];
+  auto& positions = mBlockPositions[iHalfSampa];
+  adcValues.clear();
+  positions.clear();
+
+  short value1;
+  short value2;
+  const short invert = (mSampaVersion == 1 || mSampaVersion == 2) ? (1 << 9) : 0; // Invert bit 9 vor SAMPA v1 and v2
+  for (size_t iFrame = 1; iFrame < mFrameBlock.size(); ++iFrame) {
+    const GBTFrame& frame = mFrameBlock[iFrame];
+    mPositionForHalfSampa[iHalfSampa+5] = mPositionForHalfSampa[iHalfSampa];
+    if (syncPattern.addSequence(
+        frame.getHalfWord(sampa,0,lowHigh),
+        frame.getHalfWord(sampa,1,lowHigh),
+        frame.getHalfWord(sampa,2,lowHigh),
+        frame.getHalfWord(sampa,3,lowHigh))) {
+      mPositionForHalfSampa[iHalfSampa] = syncPattern.getPosition();
+    }
+    if (mEnableSyncPatternWarning) positions.emplace_back(mPositionForHalfSampa[iHalfSampa]);
+
+    if (!mEnableCompileAdcValues) continue;
+    if (mPositionForHalfSampa[iHalfSampa] == -1) continue;
+    if (mPositionForHalfSampa[iHalfSampa+5] == -1) continue;
+    if (!compileAdcValues(frame, mFrameBlock[iFrame-1], iHalfSampa, mPositionForHalfSampa[iHalfSampa], value1, value2)) {
+      LOG(ERROR) << "Position " << mPositionForHalfSampa[iHalfSampa] << " not known." << FairLogger::endl;
+      continue;
+    }
+    adcValues.emplace_back(value1 ^ invert);
+    adcValues.emplace_back(value2 ^ invert);
+  }
+}
+
+void GBTFrameContainer::checkAdcClockStream(short iSampa)
+{
+  auto& errors = mBlockAdcClockErrors[iSampa];
+  errors.clear();
+  for (size_t iFrame = 1; iFrame < mFrameBlock.size(); ++iFrame) {
+    if (mAdcClock[iSampa].addSequence(mFrameBlock[iFrame].getAdcClock(iSampa))) errors.emplace_back(iFrame - 1);
+  }
+}
 
 //void GBTFrameContainer::fillOutputContainer(TClonesArray* output)
 //{
@@ -316,38 +459,10 @@ void GBTFrameContainer::compileAdcValues(std::vector<GBTFrame>::iterator iFrame)
     if (mPositionForHalfSampa[iHalfSampa] == -1) continue;
     if (mPositionForHalfSampa[iHalfSampa+5] == -1) continue;
 
-    switch(mPositionForHalfSampa[iHalfSampa]) {
-      case 0:
-        value1 = (iFrame->getHalfWord(iHalfSampa / 2, 1, iHalfSampa % 2) << 5) |
-                 iFrame->getHalfWord(iHalfSampa / 2, 0, iHalfSampa % 2);
-        value2 = (iFrame->getHalfWord(iHalfSampa / 2, 3, iHalfSampa % 2) << 5) |
-                 iFrame->getHalfWord(iHalfSampa / 2, 2, iHalfSampa % 2);
-        break;
-
-      case 1:
-        value1 = ((iFrame - 1)->getHalfWord(iHalfSampa / 2, 2, iHalfSampa % 2) << 5) |
-                 (iFrame - 1)->getHalfWord(iHalfSampa / 2, 1, iHalfSampa % 2);
-        value2 = (iFrame->getHalfWord(iHalfSampa / 2, 0, iHalfSampa % 2) << 5) |
-                 (iFrame - 1)->getHalfWord(iHalfSampa / 2, 3, iHalfSampa % 2);
-        break;
-
-      case 2:
-        value1 = ((iFrame - 1)->getHalfWord(iHalfSampa / 2, 3, iHalfSampa % 2) << 5) |
-                 (iFrame - 1)->getHalfWord(iHalfSampa / 2, 2, iHalfSampa % 2);
-        value2 = (iFrame->getHalfWord(iHalfSampa / 2, 1, iHalfSampa % 2) << 5) |
-                 iFrame->getHalfWord(iHalfSampa / 2, 0, iHalfSampa % 2);
-        break;
-
-      case 3:
-        value1 = (iFrame->getHalfWord(iHalfSampa / 2, 0, iHalfSampa % 2) << 5) |
-                 (iFrame - 1)->getHalfWord(iHalfSampa / 2, 3, iHalfSampa % 2);
-        value2 = (iFrame->getHalfWord(iHalfSampa / 2, 2, iHalfSampa % 2) << 5) |
-                 iFrame->getHalfWord(iHalfSampa / 2, 1, iHalfSampa % 2);
-        break;
-
-      default:
-        LOG(ERROR) << "Position " << mPositionForHalfSampa[iHalfSampa] << " not known." << FairLogger::endl;
-        return;
+    if (!compileAdcValues(*iFrame, *(iFrame - 1), iHalfSampa, mPositionForHalfSampa[iHalfSampa], value1, value2)) {
+      LOG(ERROR) << "Position " << mPositionForHalfSampa[iHalfSampa] << " not known." << FairLogger::endl;
+      mAdcMutex.unlock();
+      return;
     }
 
     if (mSampaVersion == 1 || mSampaVersion == 2) {
@@ -364,6 +479,45 @@ void GBTFrameContainer::compileAdcValues(std::vector<GBTFrame>::iterator iFrame)
   mAdcMutex.unlock();
 }
 
+bool GBTFrameContainer::compileAdcValues(const GBTFrame& frame, const GBTFrame& prevFrame, short iHalfSampa,
+                                         short position, short& value1, short& value2) const
+{
+  const short sampa = iHalfSampa / 2;
+  const short lowHigh = iHalfSampa % 2;
+  switch(position) {
+    case 0:
+      value1 = (frame.getHalfWord(sampa, 1, lowHigh) << 5) |
+               frame.getHalfWord(sampa, 0, lowHigh);
+      value2 = (frame.getHalfWord(sampa, 3, lowHigh) << 5) |
+               frame.getHalfWord(sampa, 2, lowHigh);
+      return true;
+
+    case 1:
+      value1 = (prevFrame.getHalfWord(sampa, 2, lowHigh) << 5) |
+               prevFrame.getHalfWord(sampa, 1, lowHigh);
+      value2 = (frame.getHalfWord(sampa, 0, lowHigh) << 5) |
+               prevFrame.getHalfWord(sampa, 3, lowHigh);
+      return true;
+
+    case 2:
+      value1 = (prevFrame.getHalfWord(sampa, 3, lowHigh) << 5) |
+               prevFrame.getHalfWord(sampa, 2, lowHigh);
+      value2 = (frame.getHalfWord(sampa, 1, lowHigh) << 5) |
+               frame.getHalfWord(sampa, 0, lowHigh);
+      return true;
+
+    case 3:
+      value1 = (frame.getHalfWord(sampa, 0, lowHigh) << 5) |
+               prevFrame.getHalfWord(sampa, 3, lowHigh);
+      value2 = (frame.getHalfWord(sampa, 2, lowHigh) << 5) |
+               frame.getHalfWord(sampa, 1, lowHigh);
+      return true;
+
+    default:
+      return false;
+  }
+}
+
 void GBTFrameContainer::checkAdcClock(std::vector<GBTFrame>::iterator iFrame)
 {
   if (mAdcClock[0].addSequence(iFrame->getAdcClock(0)))
@@ -17,7 +17,10 @@
 #include "DataFormatsTPC/Constants.h"
 #include "TPCBase/Mapper.h"
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <vector>
+#include <Vc/Vc>
 #include "FairLogger.h"
 
 #include "SimulationDataFormat/MCTruthContainer.h"
@@ -32,105 +35,216 @@ using namespace o2::dataformats;
 
 using MCLabelContainer = MCTruthContainer<MCCompLabel>;
 
+namespace
+{
+constexpr int PageSize = 8192; //TODO: FIXME: Use the size of the actual packet in the RDH
+constexpr int MaxClustersPerPage = (PageSize - sizeof(ClusterHardwareContainer)) / sizeof(ClusterHardware);
+constexpr int MaxRowsPerPage = 256; // local row of ClusterHardware is 8 bit
+
+//Input page with the first global row of its CRU
+struct Page {
+  const ClusterHardwareContainer* container;
+  int input;      //Index of the input buffer
+  int sector;
+  int rowOffset;  //Global row of local row 0
+  int nRows;      //Number of rows of the pad region
+};
+
+//Decode all clusters of a page. The float math of the ClusterHardware getters is done in SIMD vectors,
+//the packing uses the ClusterNative setters. Each cluster is written to the next slot of the output of its row.
+void decodePage(const ClusterHardwareContainer& cont, ClusterNative** rowOutput)
+{
+  using Vc::float_v;
+  constexpr int MaxSize = (MaxClustersPerPage + float_v::Size - 1) / float_v::Size * float_v::Size;
+  float padPre[MaxSize], timePre[MaxSize], sigmaPad2Pre[MaxSize], sigmaTime2Pre[MaxSize], qTot[MaxSize], qTot2[MaxSize];
+  float pad[MaxSize], time[MaxSize], sigmaPad[MaxSize], sigmaTime[MaxSize];
+
+  const int n = cont.numberOfClusters;
+  const int nVectors = (n + float_v::Size - 1) / float_v::Size * float_v::Size;
+  for (int k = 0; k < n; k++) {
+    const ClusterHardware& cIn = cont.clusters[k];
+    padPre[k] = cIn.padPre;
+    timePre[k] = cIn.timePre;
+    sigmaPad2Pre[k] = cIn.sigmaPad2Pre;
+    sigmaTime2Pre[k] = cIn.sigmaTime2Pre;
+    qTot[k] = cIn.qTot;
+    qTot2[k] = cIn.qTot * cIn.qTot;
+  }
+  for (int k = n; k < nVectors; k++) {
+    padPre[k] = timePre[k] = sigmaPad2Pre[k] = sigmaTime2Pre[k] = 0.f;
+    qTot[k] = qTot2[k] = 1.f;
+  }
+
+  const float_v timeBinOffset(float(cont.timeBinOffset));
+  for (int k = 0; k < nVectors; k += float_v::Size) {
+    const float_v vPadPre(padPre + k, Vc::Unaligned);
+    const float_v vTimePre(timePre + k, Vc::Unaligned);
+    const float_v vQTot(qTot + k, Vc::Unaligned);
+    const float_v vQTot2(qTot2 + k, Vc::Unaligned);
+    (vPadPre / vQTot).store(pad + k, Vc::Unaligned);
+    (vTimePre / vQTot + timeBinOffset).store(time + k, Vc::Unaligned);
+    Vc::sqrt((float_v(sigmaPad2Pre + k, Vc::Unaligned) - vPadPre * vPadPre) / vQTot2).store(sigmaPad + k, Vc::Unaligned);
+    Vc::sqrt((float_v(sigmaTime2Pre + k, Vc::Unaligned) - vTimePre * vTimePre) / vQTot2).store(sigmaTime + k, Vc::Unaligned);
+  }
+
+  for (int k = 0; k < n; k++) {
+    const ClusterHardware& cIn = cont.clusters[k];
+    ClusterNative& cOut = *(rowOutput[cIn.row]++);
+    cOut.setPad(pad[k]);
+    cOut.setTimeFlags(time[k], cIn.flags);
+    cOut.setSigmaPad(sigmaPad[k]);
+    cOut.setSigmaTime(sigmaTime[k]);
+    cOut.qMax = cIn.qMax;
+    cOut.qTot = cIn.qTot;
+  }
+}
+}
+
 int HardwareClusterDecoder::decodeClusters(std::vector<std::pair<const ClusterHardwareContainer*, std::size_t>>& inputClusters, std::vector<ClusterNativeContainer>& outputClusters, const std::vector<MCLabelContainer>* inMCLabels, std::vector<MCLabelContainer>* outMCLabels)
 {
   if (mIntegrator == nullptr) mIntegrator.reset(new DigitalCurrentClusterIntegrator);
   if (!inMCLabels) outMCLabels = nullptr;
-  int nRowClusters[Constants::MAXSECTOR][Constants::MAXGLOBALPADROW] = {0};
-  int containerRowCluster[Constants::MAXSECTOR][Constants::MAXGLOBALPADROW] =  {0};
   Mapper& mapper = Mapper::instance();
-  int numberOfOutputContainers = 0;
-  for (int loop = 0;loop < 2;loop++)
+
+  //Collect all pages with the geometry of their CRU
+  std::vector<Page> pages;
+  for (int i = 0;i < inputClusters.size();i++)
   {
-    for (int i = 0;i < inputClusters.size();i++)
+    if (outMCLabels && inputClusters[i].second > 1)
+    {
+      LOG(ERROR) << "Decoding of ClusterHardware to ClusterNative with MC labels is yet only support for single 8kb pages of ClusterHardwareContainer\n";
+      return(1);
+    }
+    for (int j = 0;j < inputClusters[i].second;j++)
     {
-      if (outMCLabels && inputClusters[i].second > 1)
+      const char* tmpPtr = reinterpret_cast<const char*> (inputClusters[i].first);
+      tmpPtr += j * PageSize;
+      const ClusterHardwareContainer* cont = reinterpret_cast<const ClusterHardwareContainer*> (tmpPtr);
+      if (cont->numberOfClusters > MaxClustersPerPage)
       {
-        LOG(ERROR) << "Decoding of ClusterHardware to ClusterNative with MC labels is yet only support for single 8kb pages of ClusterHardwareContainer\n";
+        LOG(ERROR) << "ClusterHardwareContainer with " << cont->numberOfClusters << " clusters exceeds the page size\n";
         return(1);
       }
-      for (int j = 0;j < inputClusters[i].second;j++)
-      {
-        const char* tmpPtr = reinterpret_cast<const char*> (inputClusters[i].first);
-        tmpPtr += j * 8192; //TODO: FIXME: Compute correct offset based on the size of the actual packet in the RDH
-        const ClusterHardwareContainer& cont = *(reinterpret_cast<const ClusterHardwareContainer*> (tmpPtr));
-        const CRU cru(cont.CRU);
-        const Sector sector = cru.sector();
-        const PadRegionInfo& region = mapper.getPadRegionInfo(cru.region());
-        const int rowOffset = region.getGlobalRowOffset();
-
-        for (int k = 0;k < cont.numberOfClusters;k++)
-        {
-          const int padRowGlobal = rowOffset + cont.clusters[k].row;
-          int& nCls = nRowClusters[sector][padRowGlobal];
-          if (loop == 1)
-          {
-            //Fill cluster in the respective output buffer
-            const ClusterHardware& cIn = cont.clusters[k];
-            ClusterNative& cOut = outputClusters[containerRowCluster[sector][padRowGlobal]].clusters[nCls];
-            MCLabelContainer& mcOut = (*outMCLabels)[containerRowCluster[sector][padRowGlobal]];
-            float pad = cIn.getPad();
-            cOut.setPad(pad);
-            cOut.setTimeFlags(cIn.getTimeLocal() + cont.timeBinOffset, cIn.flags);
-            cOut.setSigmaPad(std::sqrt(cIn.getSigmaPad2()));
-            cOut.setSigmaTime(std::sqrt(cIn.getSigmaTime2()));
-            cOut.qMax = cIn.qMax;
-            cOut.qTot = cIn.qTot;
-            mIntegrator->integrateCluster(sector, padRowGlobal, pad, cIn.qTot);
-            if (outMCLabels)
-            {
-              for (const auto& element : (*inMCLabels)[i].getLabels(k)) {
-                mcOut.addElement(nCls, element);
-              }
-            }
-          }
-          else
-          {
-            //Count how many output buffers we need (and how large they are below)
-            if (nCls == 0) numberOfOutputContainers++;
-          }
-          nCls++;
-        }
-      }
+      const CRU cru(cont->CRU);
+      const PadRegionInfo& region = mapper.getPadRegionInfo(cru.region());
+      pages.push_back({cont, i, cru.sector(), region.getGlobalRowOffset(), region.getNumberOfPadRows()});
     }
-    if (loop == 1)
+  }
+  const int nPages = pages.size();
+
+  //Count the clusters of each page in each local row
+  std::vector<unsigned int> pageRows(nPages * MaxRowsPerPage, 0);
+  std::atomic<bool> invalidRow(false);
+  mThreadPool.run(nPages, [&](unsigned, size_t p) {
+    const Page& page = pages[p];
+    unsigned int* counts = &pageRows[p * MaxRowsPerPage];
+    for (int k = 0;k < page.container->numberOfClusters;k++)
     {
-      //We are done with filling the buffers, sort all output buffers
-      for (int i = 0;i < outputClusters.size();i++)
-      {
-        if (outMCLabels) {
-          sortClustersAndMC(outputClusters[i].clusters, (*outMCLabels)[i]);
-        } else {
-          auto& cl = outputClusters[i].clusters;
-          std::sort(cl.data(), cl.data() + cl.size(), ClusterNativeContainer::sortComparison);
-        }
-      }
+      const int row = page.container->clusters[k].row;
+      if (row >= page.nRows) invalidRow = true;
+      counts[row]++;
+    }
+  });
+  if (invalidRow)
+  {
+    LOG(ERROR) << "ClusterHardware with a row outside of the pad region of its CRU\n";
+    return(1);
+  }
+
+  //Counting sort: number of clusters per sector and row, and the first position of each page in the output of its rows
+  unsigned int nRowClusters[Constants::MAXSECTOR][Constants::MAXGLOBALPADROW] = {0};
+  for (int p = 0;p < nPages;p++)
+  {
+    const Page& page = pages[p];
+    unsigned int* rows = &pageRows[p * MaxRowsPerPage];
+    for (int row = 0;row < page.nRows;row++)
+    {
+      unsigned int& nCls = nRowClusters[page.sector][page.rowOffset + row];
+      const unsigned int count = rows[row];
+      rows[row] = nCls;
+      nCls += count;
+    }
+  }
+
+  //Allocate the output buffers, one per sector and row with clusters
+  int containerRowCluster[Constants::MAXSECTOR][Constants::MAXGLOBALPADROW] = {0};
+  int numberOfOutputContainers = 0;
+  for (int i = 0;i < Constants::MAXSECTOR;i++)
+  {
+    for (int j = 0;j < Constants::MAXGLOBALPADROW;j++)
+    {
+      if (nRowClusters[i][j]) numberOfOutputContainers++;
+    }
+  }
+  outputClusters.resize(numberOfOutputContainers);
+  if (outMCLabels)
+  {
+    outMCLabels->clear();
+    outMCLabels->resize(numberOfOutputContainers);
+  }
+  numberOfOutputContainers = 0;
+  for (int i = 0;i < Constants::MAXSECTOR;i++)
+  {
+    for (int j = 0;j < Constants::MAXGLOBALPADROW;j++)
+    {
+      if (nRowClusters[i][j] == 0) continue;
+      outputClusters[numberOfOutputContainers].clusters.resize(nRowClusters[i][j]);
+      outputClusters[numberOfOutputContainers].sector = i;
+      outputClusters[numberOfOutputContainers].globalPadRow = j;
+      containerRowCluster[i][j] = numberOfOutputContainers++;
+      mIntegrator->initRow(i, j);
+    }
+  }
+
+  //Decode the pages in parallel, each page writes its own part of the output buffers
+  mThreadPool.run(nPages, [&](unsigned, size_t p) {
+    const Page& page = pages[p];
+    const unsigned int* rows = &pageRows[p * MaxRowsPerPage];
+    ClusterNative* rowOutput[MaxRowsPerPage];
+    for (int row = 0;row < page.nRows;row++)
+    {
+      const int globalRow = page.rowOffset + row;
+      if (nRowClusters[page.sector][globalRow] == 0) continue;
+      rowOutput[row] = outputClusters[containerRowCluster[page.sector][globalRow]].clusters.data() + rows[row];
     }
-    else
+    decodePage(*page.container, rowOutput);
+  });
+
+  //The MC labels are added in input order, which is the order of the clusters in each output buffer
+  if (outMCLabels)
+  {
+    for (int p = 0;p < nPages;p++)
     {
-      //Now we know the size of all output buffers, allocate them
-      outputClusters.resize(numberOfOutputContainers);
-      if (outMCLabels) outMCLabels->resize(numberOfOutputContainers);
-      numberOfOutputContainers = 0;
-      for (int i = 0;i < Constants::MAXSECTOR;i++)
+      const Page& page = pages[p];
+      unsigned int* rows = &pageRows[p * MaxRowsPerPage];
+      for (int k = 0;k < page.container->numberOfClusters;k++)
       {
-        for (int j = 0;j < Constants::MAXGLOBALPADROW;j++)
-        {
-          if (nRowClusters[i][j] == 0) continue;
-          outputClusters[numberOfOutputContainers].clusters.resize(nRowClusters[i][j]);
-          outputClusters[numberOfOutputContainers].sector = i;
-          outputClusters[numberOfOutputContainers].globalPadRow = j;
-          containerRowCluster[i][j] = numberOfOutputContainers++;
-          mIntegrator->initRow(i, j);
+        const int row = page.container->clusters[k].row;
+        MCLabelContainer& mcOut = (*outMCLabels)[containerRowCluster[page.sector][page.rowOffset + row]];
+        for (const auto& element : (*inMCLabels)[page.input].getLabels(k)) {
+          mcOut.addElement(rows[row], element);
         }
+        rows[row]++;
       }
-      memset(nRowClusters, 0, sizeof(nRowClusters));
     }
   }
+
+  //Sort all output buffers and integrate the cluster charges, each buffer belongs to a different row
+  mThreadPool.run(numberOfOutputContainers, [&](unsigned, size_t i) {
+    auto& cl = outputClusters[i].clusters;
+    if (outMCLabels) {
+      sortClustersAndMC(cl, (*outMCLabels)[i]);
+    } else {
+      std::sort(cl.data(), cl.data() + cl.size(), ClusterNativeContainer::sortComparison);
+    }
+    for (const auto& cluster : cl) {
+      mIntegrator->integrateCluster(outputClusters[i].sector, outputClusters[i].globalPadRow, cluster.getPad(), cluster.qTot);
+    }
+  });
   return(0);
 }
 
-void HardwareClusterDecoder::sortClustersAndMC(std::vector<ClusterNative> clusters, MCLabelContainer mcTruth)
+void HardwareClusterDecoder::sortClustersAndMC(std::vector<ClusterNative>& clusters, MCLabelContainer& mcTruth)
 {
   std::vector<unsigned int> indizes(clusters.size());
   for (int i = 0;i < indizes.size();i++) indizes[i] = i;
@@ -139,6 +253,8 @@ void HardwareClusterDecoder::sortClustersAndMC(std::vector<ClusterNative> cluste
   });
   std::vector<ClusterNative> tmpCl = std::move(clusters);
   MCLabelContainer tmpMC = std::move(mcTruth);
+  clusters.resize(tmpCl.size());
+  mcTruth.clear();
   for (int i = 0;i < clusters.size();i++)
   {
     clusters[i] = tmpCl[indizes[i]];
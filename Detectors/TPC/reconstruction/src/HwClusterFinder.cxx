@@ -18,8 +18,11 @@
 
 #include "FairLogger.h"
 
+#include <Vc/Vc>
+
 
 using namespace o2::TPC;
+using Vc::float_v;
 
 
 //________________________________________________________________________
@@ -37,6 +40,8 @@ HwClusterFinder::HwClusterFinder(
   , mRow(row)
   , mPads(pads)
   , mTimebins(timebins)
+  , mPadStride(0)
+  , mFirstTimebin(0)
   , mClusterSizePads(5)
   , mClusterSizeTime(5)
   , mDiffThreshold(diffThreshold)   // not yet used
@@ -44,7 +49,9 @@ HwClusterFinder::HwClusterFinder(
   , mGlobalTimeOfLast(0)
   , mTimebinsAfterLastProcessing(0)
   , mNextCF()
-  , mData()   // couldn't find a way to initialize a vector of unique_ptr's here
+  , mCharge()
+  , mEvent()
+  , mIndex()
   , mTmpCluster(5, std::vector<MiniDigit>(5, MiniDigit()))
   , mClusterContainer()
   , mClusterDigitIndices()
@@ -60,15 +67,21 @@ HwClusterFinder::HwClusterFinder(
     mTimebins = mClusterSizeTime;
   }
 
-  for (short t = 0; t < mTimebins; ++t)
-    mData.emplace_back(std::make_unique<std::vector<MiniDigit>>(pads, MiniDigit()));
-
+  //
+  // each time bin is followed by one vector width of empty pads, such that
+  // vector loads at the last pads stay inside the storage
+  //
+  mPadStride = mPads + float_v::Size;
+  mCharge.resize(mTimebins*mPadStride, 0);
+  mEvent.resize(mTimebins*mPadStride, -1);
+  mIndex.resize(mTimebins*mPadStride, -1);
 }
 
 //________________________________________________________________________
 void HwClusterFinder::addZeroTimebin(unsigned globalTime, int length)
 {
-  addTimebin((*mData.begin())->begin() /* some iterator, is not used */,globalTime,length,true);
+  std::vector<MiniDigit> empty; /* some iterator, is not used */
+  addTimebin(empty.begin(),globalTime,length,true);
 }
 
 //________________________________________________________________________
@@ -76,8 +89,9 @@ void HwClusterFinder::printLocalStorage()
 {
   for (short t = 0; t < mTimebins; ++t){
     LOG(DEBUG) << "t " << t << ":\t";
-    for (auto &digi : *mData[t])
-      LOG(DEBUG) << digi.charge << "\t";
+    const unsigned offset = getTimebinOffset(t);
+    for (short p = 0; p < mPads; ++p)
+      LOG(DEBUG) << mCharge[offset+p] << "\t";
     LOG(DEBUG) << FairLogger::endl;
   }
   LOG(DEBUG) << FairLogger::endl;
@@ -130,11 +144,20 @@ bool HwClusterFinder::findCluster()
   // peak finding
   //
   short t,p,tt,pp;
+  unsigned offsets[5];
+  const float* q[5];
   for (t=tMin; t<=tMax; ++t) {
-    for (p=pMin; p<=pMax; ++p) {
-        //printf("t:%d, p:%d\n",t,p);
+    //
+    // time bins t-2 ... t+2 in the ring buffer
+    //
+    for (tt=0; tt<5; ++tt) {
+      offsets[tt] = getTimebinOffset(t+(tt-2));
+      q[tt] = &mCharge[offsets[tt]];
+    }
+
+    for (short firstPad=pMin; firstPad<=pMax; firstPad+=float_v::Size) {
       //
-      // find peak in 3x3 matrix
+      // find peak in 3x3 matrix, float_v::Size pads are tested at once
       //
       //    --->  pad direction
       //    o o o o o    |
@@ -143,171 +166,165 @@ bool HwClusterFinder::findCluster()
       //    o i i i o
       //    o o o o o
       //
-      if (mData[t  ]->at(p).charge < mChargeThreshold) continue;
-
-      // Require at least one neighboring time bin with signal
-      if (mRequireNeighbouringTimebin   && (mData[t-1]->at(p  ).charge <= 0 && mData[t+1]->at(p  ).charge <= 0)) continue;
-      // Require at least one neighboring pad with signal
-      if (mRequireNeighbouringPad       && (mData[t  ]->at(p-1).charge <= 0 && mData[t  ]->at(p+1).charge <= 0)) continue;
-
-      // check for local maximum
-      if (mData[t-1]->at(p  ).charge >=  mData[t]->at(p).charge) continue;
-      if (mData[t+1]->at(p  ).charge >   mData[t]->at(p).charge) continue;
-      if (mData[t  ]->at(p-1).charge >=  mData[t]->at(p).charge) continue;
-      if (mData[t  ]->at(p+1).charge >   mData[t]->at(p).charge) continue;
-      if (mData[t-1]->at(p-1).charge >=  mData[t]->at(p).charge) continue;
-      if (mData[t+1]->at(p+1).charge >   mData[t]->at(p).charge) continue;
-      if (mData[t+1]->at(p-1).charge >   mData[t]->at(p).charge) continue;
-      if (mData[t-1]->at(p+1).charge >=  mData[t]->at(p).charge) continue;
+      unsigned candidates = findPeakCandidates(&offsets[1], firstPad, pMax);
+      for (short lane=0; candidates != 0; ++lane, candidates >>= 1) {
+        if ((candidates & 1) == 0) continue;
+        p = firstPad + lane;
 //      printf("##\n");
 //      printf("## cluster found at t=%d, p=%d (in row %d of CRU %d)\n",t,p,mRow,mCRU);
 //      printf("##\n");
 //      printCluster(t,p);
 
-      //
-      // cluster was found!!
-      //
+        //
+        // cluster was found!!
+        //
 
-      // prepare temp storage
-      for (tt=0; tt<mClusterSizeTime; ++tt) {
-        for (pp=0; pp<mClusterSizePads; ++pp){
-          mTmpCluster[tt][pp] = MiniDigit();
+        // prepare temp storage
+        for (tt=0; tt<mClusterSizeTime; ++tt) {
+          for (pp=0; pp<mClusterSizePads; ++pp){
+            mTmpCluster[tt][pp] = MiniDigit();
+          }
         }
-      }
 
-      //
-      // Cluster peak (C) and surrounding inner 3x3 matrix (i) is always
-      // used taken for the found cluster
-      //
-      for (tt=1; tt<4; ++tt) {
-        for (pp=1; pp<4; ++pp) {
-          if ( mRequirePositiveCharge && mData[t+(tt-2)]->at(p+(pp-2)).charge < 0) continue;
-          mTmpCluster[tt][pp] = mData[t+(tt-2)]->at(p+(pp-2));
-//          mData[t+(tt-2)][p+(pp-2)] = 0;
+        //
+        // Cluster peak (C) and surrounding inner 3x3 matrix (i) is always
+        // used taken for the found cluster
+        //
+        for (tt=1; tt<4; ++tt) {
+          for (pp=1; pp<4; ++pp) {
+            if ( mRequirePositiveCharge && q[tt][p+(pp-2)] < 0) continue;
+            mTmpCluster[tt][pp] = getDigit(offsets[tt]+p+(pp-2));
+          }
         }
-      }
 
-      //
-      // The outer cells of the 5x5 matrix (o) are taken only if the
-      // neighboring inner cell (i) has a signal above threshold.
-      //
+        //
+        // The outer cells of the 5x5 matrix (o) are taken only if the
+        // neighboring inner cell (i) has a signal above threshold.
+        //
 
-      //
-      // The cells of the "inner cross" have here only 1 neighbour.
-      // [t]
-      //  0         o
-      //  1         i
-      //  2     o i C i o
-      //  3         i
-      //  4         o
-      //
-      //    [p] 0 1 2 3 4
-
-      //                  o                       i                                mTmpCluster[t][p]
-      if(chargeForCluster(mData[t-2]->at(p  ).charge, mData[t-1]->at(p  ).charge)) mTmpCluster[0][2] = mData[t-2]->at(p  );   // t-X -> older
-      if(chargeForCluster(mData[t+2]->at(p  ).charge, mData[t+1]->at(p  ).charge)) mTmpCluster[4][2] = mData[t+2]->at(p  );   // t+X -> newer
-      if(chargeForCluster(mData[t  ]->at(p-2).charge, mData[t  ]->at(p-1).charge)) mTmpCluster[2][0] = mData[t  ]->at(p-2);
-      if(chargeForCluster(mData[t  ]->at(p+2).charge, mData[t  ]->at(p+1).charge)) mTmpCluster[2][4] = mData[t  ]->at(p+2);
-
-
-      // The cells of the corners have 3 neighbours.
-      //    o o   o o
-      //    o i   i o
-      //        C
-      //    o i   i o
-      //    o o   o o
-
-      // bottom left
-      if(chargeForCluster(mData[t+1]->at(p-2).charge,mData[t+1]->at(p-1).charge)) mTmpCluster[3][0] = mData[t+1]->at(p-2);
-      if(chargeForCluster(mData[t+2]->at(p-2).charge,mData[t+1]->at(p-1).charge)) mTmpCluster[4][0] = mData[t+2]->at(p-2);
-      if(chargeForCluster(mData[t+2]->at(p-1).charge,mData[t+1]->at(p-1).charge)) mTmpCluster[4][1] = mData[t+2]->at(p-1);
-      // bottom right
-      if(chargeForCluster(mData[t+2]->at(p+1).charge,mData[t+1]->at(p+1).charge)) mTmpCluster[4][3] = mData[t+2]->at(p+1);
-      if(chargeForCluster(mData[t+2]->at(p+2).charge,mData[t+1]->at(p+1).charge)) mTmpCluster[4][4] = mData[t+2]->at(p+2);
-      if(chargeForCluster(mData[t+1]->at(p+2).charge,mData[t+1]->at(p+1).charge)) mTmpCluster[3][4] = mData[t+1]->at(p+2);
-      // top right
-      if(chargeForCluster(mData[t-1]->at(p+2).charge,mData[t-1]->at(p+1).charge)) mTmpCluster[1][4] = mData[t-1]->at(p+2);
-      if(chargeForCluster(mData[t-2]->at(p+2).charge,mData[t-1]->at(p+1).charge)) mTmpCluster[0][4] = mData[t-2]->at(p+2);
-      if(chargeForCluster(mData[t-2]->at(p+1).charge,mData[t-1]->at(p+1).charge)) mTmpCluster[0][3] = mData[t-2]->at(p+1);
-      // top left
-      if(chargeForCluster(mData[t-2]->at(p-1).charge,mData[t-1]->at(p-1).charge)) mTmpCluster[0][1] = mData[t-2]->at(p-1);
-      if(chargeForCluster(mData[t-2]->at(p-2).charge,mData[t-1]->at(p-1).charge)) mTmpCluster[0][0] = mData[t-2]->at(p-2);
-      if(chargeForCluster(mData[t-1]->at(p-2).charge,mData[t-1]->at(p-1).charge)) mTmpCluster[1][0] = mData[t-1]->at(p-2);
+        //
+        // The cells of the "inner cross" have here only 1 neighbour.
+        // [t]
+        //  0         o
+        //  1         i
+        //  2     o i C i o
+        //  3         i
+        //  4         o
+        //
+        //    [p] 0 1 2 3 4
+
+        //                  o          i                                            mTmpCluster[t][p]
+        if(chargeForCluster(q[0][p  ], q[1][p  ])) mTmpCluster[0][2] = getDigit(offsets[0]+p  );   // t-X -> older
+        if(chargeForCluster(q[4][p  ], q[3][p  ])) mTmpCluster[4][2] = getDigit(offsets[4]+p  );   // t+X -> newer
+        if(chargeForCluster(q[2][p-2], q[2][p-1])) mTmpCluster[2][0] = getDigit(offsets[2]+p-2);
+        if(chargeForCluster(q[2][p+2], q[2][p+1])) mTmpCluster[2][4] = getDigit(offsets[2]+p+2);
+
+
+        // The cells of the corners have 3 neighbours.
+        //    o o   o o
+        //    o i   i o
+        //        C
+        //    o i   i o
+        //    o o   o o
+
+        // bottom left
+        if(chargeForCluster(q[3][p-2], q[3][p-1])) mTmpCluster[3][0] = getDigit(offsets[3]+p-2);
+        if(chargeForCluster(q[4][p-2], q[3][p-1])) mTmpCluster[4][0] = getDigit(offsets[4]+p-2);
+        if(chargeForCluster(q[4][p-1], q[3][p-1])) mTmpCluster[4][1] = getDigit(offsets[4]+p-1);
+        // bottom right
+        if(chargeForCluster(q[4][p+1], q[3][p+1])) mTmpCluster[4][3] = getDigit(offsets[4]+p+1);
+        if(chargeForCluster(q[4][p+2], q[3][p+1])) mTmpCluster[4][4] = getDigit(offsets[4]+p+2);
+        if(chargeForCluster(q[3][p+2], q[3][p+1])) mTmpCluster[3][4] = getDigit(offsets[3]+p+2);
+        // top right
+        if(chargeForCluster(q[1][p+2], q[1][p+1])) mTmpCluster[1][4] = getDigit(offsets[1]+p+2);
+        if(chargeForCluster(q[0][p+2], q[1][p+1])) mTmpCluster[0][4] = getDigit(offsets[0]+p+2);
+        if(chargeForCluster(q[0][p+1], q[1][p+1])) mTmpCluster[0][3] = getDigit(offsets[0]+p+1);
+        // top left
+        if(chargeForCluster(q[0][p-1], q[1][p-1])) mTmpCluster[0][1] = getDigit(offsets[0]+p-1);
+        if(chargeForCluster(q[0][p-2], q[1][p-1])) mTmpCluster[0][0] = getDigit(offsets[0]+p-2);
+        if(chargeForCluster(q[1][p-2], q[1][p-1])) mTmpCluster[1][0] = getDigit(offsets[1]+p-2);
 
-      //
-      // calculate cluster Properties
-      //
+        //
+        // calculate cluster Properties
+        //
 
-      qMax = mTmpCluster[2][2].charge;
-      qTot = 0;
-      meanP = 0;
-      meanT = 0;
-      sigmaP = 0;
-      sigmaT = 0;
-      minP = mClusterSizePads;
-      minT = mClusterSizeTime;
-      maxP = 0;
-      maxT = 0;
-      mClusterDigitIndices.emplace_back();
-      for (tt = 0; tt < mClusterSizeTime; ++tt) {
-        deltaT = tt - mClusterSizeTime/2;
-        for (pp = 0; pp < mClusterSizePads; ++pp) {
-          deltaP = pp - mClusterSizePads/2;
-
-          charge = mTmpCluster[tt][pp].charge;
-          if (charge > 0 || mTmpCluster[tt][pp].event >= 0)
-            mClusterDigitIndices.back().emplace_back(std::make_pair(mTmpCluster[tt][pp].index, mTmpCluster[tt][pp].event));
-
-          qTot += charge;
-
-          meanP += charge * static_cast<float>(deltaP);
-          meanT += charge * static_cast<float>(deltaT);
-
-          sigmaP += charge * static_cast<float>(deltaP)*static_cast<float>(deltaP);
-          sigmaT += charge * static_cast<float>(deltaT)*static_cast<float>(deltaT);
-
-          if (charge > 0) {
-            minP = std::min(minP,pp); maxP = std::max(maxP,pp);
-            minT = std::min(minT,tt); maxT = std::max(maxT,tt);
+        qMax = mTmpCluster[2][2].charge;
+        qTot = 0;
+        meanP = 0;
+        meanT = 0;
+        sigmaP = 0;
+        sigmaT = 0;
+        minP = mClusterSizePads;
+        minT = mClusterSizeTime;
+        maxP = 0;
+        maxT = 0;
+        mClusterDigitIndices.emplace_back();
+        for (tt = 0; tt < mClusterSizeTime; ++tt) {
+          deltaT = tt - mClusterSizeTime/2;
+          for (pp = 0; pp < mClusterSizePads; ++pp) {
+            deltaP = pp - mClusterSizePads/2;
+
+            charge = mTmpCluster[tt][pp].charge;
+            if (charge > 0 || mTmpCluster[tt][pp].event >= 0)
+              mClusterDigitIndices.back().emplace_back(std::make_pair(mTmpCluster[tt][pp].index, mTmpCluster[tt][pp].event));
+
+            qTot += charge;
+
+            meanP += charge * static_cast<float>(deltaP);
+            meanT += charge * static_cast<float>(deltaT);
+
+            sigmaP += charge * static_cast<float>(deltaP)*static_cast<float>(deltaP);
+            sigmaT += charge * static_cast<float>(deltaT)*static_cast<float>(deltaT);
+
+            if (charge > 0) {
+              minP = std::min(minP,pp); maxP = std::max(maxP,pp);
+              minT = std::min(minT,tt); maxT = std::max(maxT,tt);
+            }
           }
         }
-      }
 
-      if (qTot > 0) {
-        meanP  /= qTot;
-        meanT  /= qTot;
-        sigmaP /= qTot;
-        sigmaT /= qTot;
+        if (qTot > 0) {
+          meanP  /= qTot;
+          meanT  /= qTot;
+          sigmaP /= qTot;
+          sigmaT /= qTot;
 
-        sigmaP = std::sqrt(sigmaP - (meanP*meanP));
-        sigmaT = std::sqrt(sigmaT - (meanT*meanT));
+          sigmaP = std::sqrt(sigmaP - (meanP*meanP));
+          sigmaT = std::sqrt(sigmaT - (meanT*meanT));
 
-        meanP += p+mPadOffset;
-        meanT += mGlobalTimeOfLast-(mTimebins-1)+t;
-      }
+          meanP += p+mPadOffset;
+          meanT += mGlobalTimeOfLast-(mTimebins-1)+t;
+        }
 
-      ++foundNclusters;
-      mClusterContainer.emplace_back(mCRU, mRow, qTot, qMax, meanP, sigmaP, meanT, sigmaT);
+        ++foundNclusters;
+        mClusterContainer.emplace_back(mCRU, mRow, qTot, qMax, meanP, sigmaP, meanT, sigmaT);
 
-      if (mAssignChargeUnique) {
-        if (p < (pMin+4)) {
-          // If the cluster peak is in one of the 6 leftmost pads, the Cluster Finder
-          // on the left has to know about it to ignore the already used pads.
-          if (auto next = mNextCF.lock()) {
-            next->clusterAlreadyUsed(t,p+mPadOffset);//,mTmpCluster);
+        if (mAssignChargeUnique) {
+          if (p < (pMin+4)) {
+            // If the cluster peak is in one of the 6 leftmost pads, the Cluster Finder
+            // on the left has to know about it to ignore the already used pads.
+            if (auto next = mNextCF.lock()) {
+              next->clusterAlreadyUsed(t,p+mPadOffset);//,mTmpCluster);
+            }
           }
-        }
 
 
-        //
-        // subtract found cluster from storage
-        //
-        // TODO: really nexessary?? or just set to 0
-        for (tt=0; tt<5; ++tt) {
-          for (pp=0; pp<5; ++pp) {
-            //mData[t+(tt-2)][p+(pp-2)].charge -= mTmpCluster[tt][pp];
-            mData[t+(tt-2)]->at(p+(pp-2)).clear();
+          //
+          // subtract found cluster from storage
+          //
+          // TODO: really nexessary?? or just set to 0
+          for (tt=0; tt<5; ++tt) {
+            for (pp=0; pp<5; ++pp) {
+              //mData[t+(tt-2)][p+(pp-2)].charge -= mTmpCluster[tt][pp];
+              clearDigit(offsets[tt]+p+(pp-2));
+            }
           }
+
+          //
+          // the removed charges change the peak conditions of the
+          // following pads, they are tested again
+          //
+          candidates = findPeakCandidates(&offsets[1], firstPad, pMax) >> lane;
         }
       }
     }
@@ -317,6 +334,43 @@ bool HwClusterFinder::findCluster()
   return false;
 }
 
+//________________________________________________________________________
+unsigned HwClusterFinder::findPeakCandidates(const unsigned* offsets, int firstPad, int lastPad) const
+{
+  const float* before = &mCharge[offsets[0]+firstPad];
+  const float* at     = &mCharge[offsets[1]+firstPad];
+  const float* after  = &mCharge[offsets[2]+firstPad];
+
+  const float_v charge(at, Vc::Unaligned);
+  const float_v chargeBefore(before, Vc::Unaligned);
+  const float_v chargeAfter(after, Vc::Unaligned);
+  const float_v chargeLeft(at-1, Vc::Unaligned);
+  const float_v chargeRight(at+1, Vc::Unaligned);
+
+  // same conditions as for a single pad, the negations keep the behaviour for NaN charges
+  Vc::float_m peak = !(charge < mChargeThreshold);
+
+  // Require at least one neighboring time bin with signal
+  if (mRequireNeighbouringTimebin) peak &= !(chargeBefore <= 0.f && chargeAfter <= 0.f);
+  // Require at least one neighboring pad with signal
+  if (mRequireNeighbouringPad) peak &= !(chargeLeft <= 0.f && chargeRight <= 0.f);
+
+  // check for local maximum
+  peak &= !(chargeBefore >= charge);
+  peak &= !(chargeAfter  >  charge);
+  peak &= !(chargeLeft   >= charge);
+  peak &= !(chargeRight  >  charge);
+  peak &= !(float_v(before-1, Vc::Unaligned) >= charge);
+  peak &= !(float_v(after+1,  Vc::Unaligned) >  charge);
+  peak &= !(float_v(after-1,  Vc::Unaligned) >  charge);
+  peak &= !(float_v(before+1, Vc::Unaligned) >= charge);
+
+  unsigned candidates = static_cast<unsigned>(peak.toInt());
+  const int nPads = lastPad - firstPad + 1;
+  if (nPads < static_cast<int>(float_v::Size)) candidates &= (1u << nPads) - 1;
+  return candidates;
+}
+
 //________________________________________________________________________
 bool HwClusterFinder::chargeForCluster(float outerCharge, float innerCharge)
 {
@@ -341,7 +395,7 @@ void HwClusterFinder::clusterAlreadyUsed(short time, short pad)
       if (p < 0 || p >= mPads) continue;
 
       //mData[t][p].charge -= cluster[t-time+2][p-localPad+2].charge;
-      mData[t]->at(p).clear();
+      clearDigit(getTimebinOffset(t)+p);
     }
   }
 }
@@ -349,8 +403,9 @@ void HwClusterFinder::clusterAlreadyUsed(short time, short pad)
 //________________________________________________________________________
 void HwClusterFinder::reset(unsigned globalTimeAfterReset)
 {
-  for(auto &tb : mData)
-    for (auto &digi : *tb) digi.clear();
+  std::fill(mCharge.begin(), mCharge.end(), 0);
+  std::fill(mEvent.begin(), mEvent.end(), -1);
+  std::fill(mIndex.begin(), mIndex.end(), -1);
 
   mGlobalTimeOfLast = globalTimeAfterReset;
 }
@@ -362,7 +417,7 @@ void HwClusterFinder::printCluster(short time, short pad)
   for (t = time-2; t <= time+2; ++t) {
     LOG(DEBUG) << "t " << t << ":\t";
     for (p = pad-2; p <= pad+2; ++p) {
-      LOG(DEBUG) << mData[t]->at(p).charge << "\t";
+      LOG(DEBUG) << mCharge[getTimebinOffset(t)+p] << "\t";
     }
     LOG(DEBUG) << FairLogger::endl;
   }
@@ -22,11 +22,8 @@
 #include "FairLogger.h"
 #include "TMath.h"
 
-#include <mutex>
+#include <algorithm>
 #include <set>
-#include <thread>
-
-std::mutex g_display_mutex;
 
 using namespace o2::TPC;
 
@@ -47,12 +44,14 @@ HwClusterer::HwClusterer(std::vector<o2::TPC::Cluster> *clusterOutput,
   , mCRUMax(cruMax)
   , mPadsPerCF(padsPerCF)
   , mTimebinsPerCF(timebinsPerCF)
-  , mNumThreads(std::thread::hardware_concurrency())
   , mMinQDiff(minQDiff)
   , mClusterFinder()
-  , mDigitContainer()
-  , mClusterStorage()
-  , mClusterDigitIndexStorage()
+  , mRowOffset()
+  , mDigitStaging()
+  , mCfConfig()
+  , mWorkerOutput()
+  , mCRUOutput()
+  , mThreadPool(0)
   , mClusterArray(clusterOutput)
   , mClusterMcLabelArray(labelOutput)
   , mNoiseObject(nullptr)
@@ -89,21 +88,20 @@ HwClusterer::HwClusterer(std::vector<o2::TPC::Cluster> *clusterOutput,
 
 
   /*
-   * vector of HwCluster vectors, one vector for each CRU (possible thread)
-   * to store the clusters found there
+   * location of the found clusters of each CRU in the output arenas of the
+   * worker threads
    */
-  mClusterStorage.resize(mCRUMax+1);
-  mClusterDigitIndexStorage.resize(mCRUMax+1);
+  mCRUOutput.resize(mCRUMax+1);
 
 
   /*
-   * vector of digit vectors, one vector for each CRU (possible thread) to
-   * store there only those digits which are relevant for this particular
-   * CRU (thread)
+   * the digits are staged sorted by CRU and row, all rows of all CRUs are
+   * numbered one after the other
    */
-  mDigitContainer.resize(mCRUMax+1);
+  mRowOffset.resize(mCRUMax+2, 0);
   for (unsigned iCRU = mCRUMin; iCRU <= mCRUMax; ++iCRU)
-    mDigitContainer[iCRU].resize(mapper.getNumberOfRowsPartition(iCRU));
+    mRowOffset[iCRU+1] = mRowOffset[iCRU] + mapper.getNumberOfRowsPartition(iCRU);
+  mDigitStaging.rowBegin.resize(mRowOffset[mCRUMax+1]+1, 0);
 
 }
 
@@ -116,76 +114,98 @@ HwClusterer::~HwClusterer()
 }
 
 //________________________________________________________________________
-void HwClusterer::processDigits(
-    const std::vector<std::vector<std::vector<std::tuple<Digit const*, int, int>>>>& digits,
-    const std::vector<std::vector<std::vector<std::shared_ptr<HwClusterFinder>>>>& clusterFinder,
-          std::vector<std::vector<Cluster>>& cluster,
-          std::vector<std::vector<std::vector<std::pair<int,int>>>>& label,
-    const CfConfig config)
+void HwClusterer::processCRU(unsigned iCRU, const CfConfig& config, WorkerOutput& output)
 {
-//  std::thread::id this_id = std::this_thread::get_id();
-//  g_display_mutex.lock();
-//  std::cout << "thread " << this_id << " started.\n";
-//  g_display_mutex.unlock();
+  CRUOutput& cruOutput = mCRUOutput[iCRU];
+  cruOutput.clusterBegin = cruOutput.clusterEnd = output.clusters.size();
+  cruOutput.labelBegin = output.labels.size();
 
   int timeDiff = (config.iMaxTimeBin+1) - config.iMinTimeBin;
   if (timeDiff < 0) return;
   const Mapper& mapper = Mapper::instance();
-  std::vector<std::vector<HwClusterFinder::MiniDigit>> iAllBins(timeDiff,std::vector<HwClusterFinder::MiniDigit>(config.iMaxPads));
+  auto& iAllBins = output.bins;
+  const size_t nBins = static_cast<size_t>(timeDiff) * config.iMaxPads;
+  if (iAllBins.size() < nBins) {
+    iAllBins.resize(nBins);
+  }
+  const auto& digits = mDigitStaging;
+  const auto& clusterFinder = mClusterFinder;
 
-  for (unsigned iCRU = config.iCRUMin; iCRU <= config.iCRUMax; ++iCRU) {
-    if (iCRU % config.iThreadMax != config.iThreadID) continue;
+  for (int iRow = 0; iRow < mapper.getNumberOfRowsPartition(iCRU); iRow++){
 
-    for (int iRow = 0; iRow < mapper.getNumberOfRowsPartition(iCRU); iRow++){
+    /*
+     * prepare local storage
+     */
+    short t,p;
+    if (timeDiff > 0 && config.iEnableNoiseSim && config.iNoiseObject != nullptr) {
+      for (p=config.iMaxPads; p--;) {
+        iAllBins[p] = HwClusterFinder::MiniDigit(config.iNoiseObject->getValue(CRU(iCRU),iRow,p), -1, -1);
+      }
+      for (t=1; t<timeDiff; ++t) {
+        std::copy(iAllBins.begin(), iAllBins.begin()+config.iMaxPads, iAllBins.begin()+t*config.iMaxPads);
+      }
+    } else {
+      std::fill(iAllBins.begin(),iAllBins.begin()+nBins,HwClusterFinder::MiniDigit());
+    }
 
-      /*
-       * prepare local storage
-       */
-      short t,p;
-      if (config.iEnableNoiseSim && config.iNoiseObject != nullptr) {
-        for (t=timeDiff; t--;) {
-          for (p=config.iMaxPads; p--;) {
-            iAllBins[t][p].charge = config.iNoiseObject->getValue(CRU(iCRU),iRow,p);
-            iAllBins[t][p].index = -1;
-            iAllBins[t][p].event = -1;
-          }
-        }
-      } else {
-        for (auto &bins : iAllBins) std::fill(bins.begin(),bins.end(),HwClusterFinder::MiniDigit());
-//        std::fill(&iAllBins[0][0], &iAllBins[0][0]+timeDiff*config.iMaxPads, HwClusterFinder::MiniDigit());
+    /*
+     * fill in digits
+     */
+    const unsigned rowIndex = mRowOffset[iCRU] + iRow;
+    for (unsigned iDigit = digits.rowBegin[rowIndex]; iDigit < digits.rowBegin[rowIndex+1]; ++iDigit){
+      const Int_t iTime         = digits.time[iDigit];
+      const Int_t iPad          = digits.pad[iDigit] + 2;  // offset to have 2 empty pads on the "left side"
+      const Float_t charge      = digits.charge[iDigit];
+
+      //      std::cout << iCRU << " " << iRow << " " << iPad << " " << iTime << " (" << iTime-minTime << "," << timeDiff << ") " << charge << std::endl;
+      auto& bin = iAllBins[(iTime-config.iMinTimeBin)*config.iMaxPads + iPad];
+      bin.charge += charge;
+      bin.index = digits.index[iDigit];
+      bin.event = config.iEventCount;
+      if (config.iEnablePedestalSubtraction && config.iPedestalObject != nullptr) {
+        const float pedestal = config.iPedestalObject->getValue(CRU(iCRU),iRow,iPad-2);
+        //printf("digit: %.2f, pedestal: %.2f\n", bin.charge, pedestal);
+        bin.charge -= pedestal;
+      }
+    }
+
+    /*
+     * copy data to cluster finders
+     */
+    const unsigned iPadsPerCF = static_cast<const unsigned>(clusterFinder[iCRU][iRow][0]->getNpads());
+    const unsigned iTimebinsPerCF = static_cast<const unsigned>(clusterFinder[iCRU][iRow][0]->getNtimebins());
+    std::vector<std::vector<std::shared_ptr<HwClusterFinder>>::const_reverse_iterator> cfWithCluster;
+    int time;
+    unsigned pad;
+    for (time = 0; time < timeDiff; ++time){    // ordering important!!
+      for (pad = 0; pad < config.iMaxPads; pad = pad + (iPadsPerCF -2 -2 )) {
+        const Short_t cf = pad / (iPadsPerCF-2-2);
+        clusterFinder[iCRU][iRow][cf]->addTimebin(iAllBins.begin()+time*config.iMaxPads+pad,time+config.iMinTimeBin,(config.iMaxPads-pad)>=iPadsPerCF?iPadsPerCF:(config.iMaxPads-pad));
       }
 
       /*
-       * fill in digits
+       * search for clusters and store reference to CF if one was found
        */
-      for (auto& digit : digits[iCRU][iRow]){
-        const Int_t iTime         = std::get<0>(digit)->getTimeStamp();
-        const Int_t iPad          = std::get<0>(digit)->getPad() + 2;  // offset to have 2 empty pads on the "left side"
-        const Float_t charge      = std::get<0>(digit)->getChargeFloat();
-
-        //      std::cout << iCRU << " " << iRow << " " << iPad << " " << iTime << " (" << iTime-minTime << "," << timeDiff << ") " << charge << std::endl;
-        iAllBins[iTime-config.iMinTimeBin][iPad].charge += charge;
-        iAllBins[iTime-config.iMinTimeBin][iPad].index = std::get<1>(digit);
-        iAllBins[iTime-config.iMinTimeBin][iPad].event = std::get<2>(digit);
-        if (config.iEnablePedestalSubtraction && config.iPedestalObject != nullptr) {
-          const float pedestal = config.iPedestalObject->getValue(CRU(iCRU),iRow,iPad-2);
-          //printf("digit: %.2f, pedestal: %.2f\n", iAllBins[iTime-config.iMinTimeBin][iPad], pedestal);
-          iAllBins[iTime-config.iMinTimeBin][iPad].charge -= pedestal;
+      if (clusterFinder[iCRU][iRow][0]->getTimebinsAfterLastProcessing() == iTimebinsPerCF-2 -2)  {
+        /*
+         * ordering is important: from right to left, so that the CFs could inform each other if cluster was found
+         */
+        for (auto rit = clusterFinder[iCRU][iRow].crbegin(); rit != clusterFinder[iCRU][iRow].crend(); ++rit) {
+          if ((*rit)->findCluster()) {
+            cfWithCluster.push_back(rit);
+          }
         }
       }
+    }
 
-      /*
-       * copy data to cluster finders
-       */
-      const unsigned iPadsPerCF = static_cast<const unsigned>(clusterFinder[iCRU][iRow][0]->getNpads());
-      const unsigned iTimebinsPerCF = static_cast<const unsigned>(clusterFinder[iCRU][iRow][0]->getNtimebins());
-      std::vector<std::vector<std::shared_ptr<HwClusterFinder>>::const_reverse_iterator> cfWithCluster;
-      int time;
-      unsigned pad;
-      for (time = 0; time < timeDiff; ++time){    // ordering important!!
-        for (pad = 0; pad < config.iMaxPads; pad = pad + (iPadsPerCF -2 -2 )) {
-          const Short_t cf = pad / (iPadsPerCF-2-2);
-          clusterFinder[iCRU][iRow][cf]->addTimebin(iAllBins[time].begin()+pad,time+config.iMinTimeBin,(config.iMaxPads-pad)>=iPadsPerCF?iPadsPerCF:(config.iMaxPads-pad));
+    /*
+     * add empty timebins to find last clusters
+     */
+    if (!config.iIsContinuousReadout) {
+      // +2 so that for sure all data is processed
+      for (time = 0; time < clusterFinder[iCRU][iRow][0]->getNtimebins()+2; ++time){
+        for (auto rit = clusterFinder[iCRU][iRow].crbegin(); rit != clusterFinder[iCRU][iRow].crend(); ++rit) {
+          (*rit)->addZeroTimebin(time+timeDiff+config.iMinTimeBin,iPadsPerCF);
         }
 
         /*
@@ -202,117 +222,97 @@ void HwClusterer::processDigits(
           }
         }
       }
-
-      /*
-       * add empty timebins to find last clusters
-       */
-      if (!config.iIsContinuousReadout) {
-        // +2 so that for sure all data is processed
-        for (time = 0; time < clusterFinder[iCRU][iRow][0]->getNtimebins()+2; ++time){
-          for (auto rit = clusterFinder[iCRU][iRow].crbegin(); rit != clusterFinder[iCRU][iRow].crend(); ++rit) {
-            (*rit)->addZeroTimebin(time+timeDiff+config.iMinTimeBin,iPadsPerCF);
-          }
-
-          /*
-           * search for clusters and store reference to CF if one was found
-           */
-          if (clusterFinder[iCRU][iRow][0]->getTimebinsAfterLastProcessing() == iTimebinsPerCF-2 -2)  {
-            /*
-             * ordering is important: from right to left, so that the CFs could inform each other if cluster was found
-             */
-            for (auto rit = clusterFinder[iCRU][iRow].crbegin(); rit != clusterFinder[iCRU][iRow].crend(); ++rit) {
-              if ((*rit)->findCluster()) {
-                cfWithCluster.push_back(rit);
-              }
-            }
-          }
-        }
-        for (auto rit = clusterFinder[iCRU][iRow].crbegin(); rit != clusterFinder[iCRU][iRow].crend(); ++rit) {
-          (*rit)->setTimebinsAfterLastProcessing(0);
-        }
+      for (auto rit = clusterFinder[iCRU][iRow].crbegin(); rit != clusterFinder[iCRU][iRow].crend(); ++rit) {
+        (*rit)->setTimebinsAfterLastProcessing(0);
       }
+    }
 
-      /*
-       * collect found cluster
-       */
-      for (auto &cf_rit : cfWithCluster) {
-        auto cc = (*cf_rit)->getClusterContainer();
-        for (auto& c : *cc) cluster[iCRU].push_back(c);
+    /*
+     * collect found cluster
+     */
+    for (auto &cf_rit : cfWithCluster) {
+      auto cc = (*cf_rit)->getClusterContainer();
+      for (auto& c : *cc) output.clusters.push_back(c);
 
-        auto ll = (*cf_rit)->getClusterDigitIndices();
-        for (auto& l : *ll) {
-          label[iCRU].push_back(l);
+      if (mClusterMcLabelArray != nullptr) {
+        for (auto& digitIndices : *(*cf_rit)->getClusterDigitIndices()) {
+          addClusterLabels(digitIndices, output);
         }
-
-        (*cf_rit)->clearClusterContainer();
       }
 
+      (*cf_rit)->clearClusterContainer();
     }
+
   }
 
-//  g_display_mutex.lock();
-//  std::cout << "thread " << this_id << " finished.\n";
-//  g_display_mutex.unlock();
+  cruOutput.clusterEnd = output.clusters.size();
 }
 
 //________________________________________________________________________
-void HwClusterer::Process(std::vector<o2::TPC::Digit> const &digits, MCLabelContainer const* mcDigitTruth, int eventCount)
+template <typename DigitAccessor>
+void HwClusterer::stageDigits(size_t nDigits, DigitAccessor getDigit, bool storeIndex, int iTimeBinMin, int& iTimeBinMax)
 {
-  mClusterArray->clear();
-  if(mClusterMcLabelArray) mClusterMcLabelArray->clear();
-
-
-  /*
-   * clear old storages
-   */
-  for (auto& cs : mClusterStorage) cs.clear();
-  for (auto& cdis : mClusterDigitIndexStorage) cdis.clear();
-  for (auto& dc : mDigitContainer ) {
-    for (auto& dcc : dc) dcc.clear();
-  }
-
-  int iTimeBin;
-  int iTimeBinMin = (mIsContinuousReadout)?mLastTimebin + 1 : 0;
-  //int iTimeBinMin = mLastTimebin + 1;
-  int iTimeBinMax = mLastTimebin;
-
   /*
-   * Loop over digits
+   * counting sort by CRU and row, first count the digits of each row ...
    */
-  int digitIndex = 0;
-  for (const auto& digit : digits) {
-
-    /*
-     * add current digit to storage
-     */
-
-    iTimeBin = digit.getTimeStamp();
+  auto& rowBegin = mDigitStaging.rowBegin;
+  std::fill(rowBegin.begin(), rowBegin.end(), 0);
+  for (size_t digitIndex = 0; digitIndex < nDigits; ++digitIndex) {
+    const Digit& digit = getDigit(digitIndex);
+    const int iTimeBin = digit.getTimeStamp();
     if (digit.getCRU() < static_cast<int>(mCRUMin) || digit.getCRU() > static_cast<int>(mCRUMax)) {
       LOG(DEBUG) << "Digit [" << digitIndex << "] is out of CRU range (" << digit.getCRU() << " < " << mCRUMin << " or > " << mCRUMax << ")" << FairLogger::endl;
-      // Necessary because MCTruthContainer requires continuous indexing
-      ++digitIndex;
       continue;
     }
     if (iTimeBin < iTimeBinMin) {
       LOG(DEBUG) << "Digit [" << digitIndex << "] time stamp too small (" << iTimeBin << " < " << iTimeBinMin << ")" << FairLogger::endl;
-      // Necessary because MCTruthContainer requires continuous indexing
-      ++digitIndex;
       continue;
     }
-
     iTimeBinMax = std::max(iTimeBinMax,iTimeBin);
-    if (mcDigitTruth == nullptr)
-      mDigitContainer[digit.getCRU()][digit.getRow()].emplace_back(std::make_tuple(&digit,-1,eventCount));
-    else {
-      mDigitContainer[digit.getCRU()][digit.getRow()].emplace_back(std::make_tuple(&digit,digitIndex,eventCount));
-    }
-    ++digitIndex;
+    ++rowBegin[mRowOffset[digit.getCRU()] + digit.getRow() + 1];
   }
+  for (size_t row = 1; row < rowBegin.size(); ++row) rowBegin[row] += rowBegin[row-1];
+
+  /*
+   * ... then fill them in, the input order is kept within each row
+   */
+  const size_t nStaged = rowBegin.back();
+  mDigitStaging.time.resize(nStaged);
+  mDigitStaging.pad.resize(nStaged);
+  mDigitStaging.charge.resize(nStaged);
+  mDigitStaging.index.resize(nStaged);
+  std::vector<unsigned> next(rowBegin.begin(), rowBegin.end() - 1);
+  for (size_t digitIndex = 0; digitIndex < nDigits; ++digitIndex) {
+    const Digit& digit = getDigit(digitIndex);
+    if (digit.getCRU() < static_cast<int>(mCRUMin) || digit.getCRU() > static_cast<int>(mCRUMax)) continue;
+    if (digit.getTimeStamp() < iTimeBinMin) continue;
+
+    // the original digit index is needed for the MC truth, which requires continuous indexing
+    const unsigned i = next[mRowOffset[digit.getCRU()] + digit.getRow()]++;
+    mDigitStaging.time[i] = digit.getTimeStamp();
+    mDigitStaging.pad[i] = digit.getPad();
+    mDigitStaging.charge[i] = digit.getChargeFloat();
+    mDigitStaging.index[i] = storeIndex ? static_cast<int>(digitIndex) : -1;
+  }
+}
+
+//________________________________________________________________________
+void HwClusterer::Process(std::vector<o2::TPC::Digit> const &digits, MCLabelContainer const* mcDigitTruth, int eventCount)
+{
+  mClusterArray->clear();
+  if(mClusterMcLabelArray) mClusterMcLabelArray->clear();
+
+  int iTimeBinMin = (mIsContinuousReadout)?mLastTimebin + 1 : 0;
+  //int iTimeBinMin = mLastTimebin + 1;
+  int iTimeBinMax = mLastTimebin;
+
+  stageDigits(digits.size(), [&digits](size_t i) -> const Digit& { return digits[i]; },
+              mcDigitTruth != nullptr, iTimeBinMin, iTimeBinMax);
 
   if (mcDigitTruth != nullptr && mClusterMcLabelArray != nullptr )
     mLastMcDigitTruth[eventCount] = std::make_unique<MCLabelContainer>(*mcDigitTruth);
 
-  ProcessTimeBins(iTimeBinMin, iTimeBinMax);
+  ProcessTimeBins(iTimeBinMin, iTimeBinMax, eventCount);
 
   mLastMcDigitTruth.erase(eventCount-mTimebinsPerCF);
 
@@ -325,144 +325,116 @@ void HwClusterer::Process(std::vector<std::unique_ptr<Digit>>& digits, MCLabelCo
   mClusterArray->clear();
   if(mClusterMcLabelArray) mClusterMcLabelArray->clear();
 
-  /*
-   * clear old storages
-   */
-  for (auto& cs : mClusterStorage) cs.clear();
-  for (auto& cdis : mClusterDigitIndexStorage) cdis.clear();
-  for (auto& dc : mDigitContainer ) {
-    for (auto& dcc : dc) dcc.clear();
-  }
-
-  int iTimeBin;
   int iTimeBinMin = (mIsContinuousReadout)?mLastTimebin + 1 : 0;
   int iTimeBinMax = mLastTimebin;
 
-  /*
-   * Loop over digits
-   */
-  int digitIndex = 0;
-  for (auto& digit_ptr : digits) {
-    Digit* digit = digit_ptr.get();
-
-    /*
-     * add current digit to storage
-     */
-    iTimeBin = digit->getTimeStamp();
-    if (digit->getCRU() < static_cast<int>(mCRUMin) || digit->getCRU() > static_cast<int>(mCRUMax)) {
-      LOG(DEBUG) << "Digit [" << digitIndex << "] is out of CRU range (" << digit->getCRU() << " < " << mCRUMin << " or > " << mCRUMax << ")" << FairLogger::endl;
-      // Necessary because MCTruthContainer requires continuous indexing
-      ++digitIndex;
-      continue;
-    }
-    if (iTimeBin < iTimeBinMin) {
-      LOG(DEBUG) << "Digit [" << digitIndex << "] time stamp too small (" << iTimeBin << " < " << iTimeBinMin << ")" << FairLogger::endl;
-      // Necessary because MCTruthContainer requires continuous indexing
-      ++digitIndex;
-      continue;
-    }
-
-    iTimeBinMax = std::max(iTimeBinMax,iTimeBin);
-    if (mcDigitTruth == nullptr)
-      mDigitContainer[digit->getCRU()][digit->getRow()].emplace_back(std::make_tuple(digit,-1,eventCount));
-    else {
-      mDigitContainer[digit->getCRU()][digit->getRow()].emplace_back(std::make_tuple(digit,digitIndex,eventCount));
-    }
-    ++digitIndex;
-  }
+  stageDigits(digits.size(), [&digits](size_t i) -> const Digit& { return *digits[i]; },
+              mcDigitTruth != nullptr, iTimeBinMin, iTimeBinMax);
 
   if (mcDigitTruth != nullptr && mClusterMcLabelArray != nullptr )
     mLastMcDigitTruth[eventCount] = std::make_unique<MCLabelContainer>(*mcDigitTruth);
 
-  ProcessTimeBins(iTimeBinMin, iTimeBinMax);
+  ProcessTimeBins(iTimeBinMin, iTimeBinMax, eventCount);
 
   mLastMcDigitTruth.erase(eventCount-mTimebinsPerCF);
 
   LOG(DEBUG) << "Event ranged from time bin " << iTimeBinMin << " to " << iTimeBinMax << "." << FairLogger::endl;
 }
 
-void HwClusterer::ProcessTimeBins(int iTimeBinMin, int iTimeBinMax)
+//________________________________________________________________________
+void HwClusterer::ProcessTimeBins(int iTimeBinMin, int iTimeBinMax, int eventCount)
 {
-
-   /*
-   * vector to store threads for parallel processing
-   */
-  std::vector<std::thread> thread_vector;
-
-  LOG(DEBUG) << "Starting " << mNumThreads << " threads, hardware supports " << std::thread::hardware_concurrency() << " parallel threads." << FairLogger::endl;
-
-  for (unsigned threadId = 0; threadId < std::min(mNumThreads, mCRUMax + 1); ++threadId) {
-    struct CfConfig cfConfig = {
-      threadId,
-      mNumThreads,
-      mCRUMin,
-      mCRUMax,
-      static_cast<unsigned>(mPadsMax)+2+2,
-      iTimeBinMin,
-      iTimeBinMax,
-      mEnableNoiseSim,
-      mEnablePedestalSubtraction,
-      mIsContinuousReadout,
-      mNoiseObject,
-      mPedestalObject
-    };
-    thread_vector.emplace_back(
-        processDigits,                          // function name
-        std::ref(mDigitContainer),              // digit container for individual CRUs
-        std::ref(mClusterFinder),               // cluster finder for individual CRUs
-        std::ref(mClusterStorage),              // container to store found clusters
-        std::ref(mClusterDigitIndexStorage),    // container to store found cluster MC Labels
-        cfConfig                                // configuration
-        );
+  mCfConfig = {
+    static_cast<unsigned>(mPadsMax)+2+2,
+    iTimeBinMin,
+    iTimeBinMax,
+    eventCount,
+    mEnableNoiseSim,
+    mEnablePedestalSubtraction,
+    mIsContinuousReadout,
+    mNoiseObject,
+    mPedestalObject
+  };
+
+  const unsigned nCRUs = mCRUMax - mCRUMin + 1;
+  const unsigned nWorkers = mThreadPool.getNumWorkers(nCRUs);
+  LOG(DEBUG) << "Processing with " << nWorkers << " threads, hardware supports " << std::thread::hardware_concurrency() << " parallel threads." << FairLogger::endl;
+
+  mWorkerOutput.resize(nWorkers);
+  for (auto& output : mWorkerOutput) {
+    output.clusters.clear();
+    output.labels.clear();
+    output.labelCounts.clear();
   }
 
+  /*
+   * the CRUs are handed out one by one, the calling thread takes part in the
+   * processing
+   */
+  mThreadPool.run(nCRUs, [this](unsigned workerID, size_t i) {
+    const unsigned iCRU = mCRUMin + i;
+    mCRUOutput[iCRU].worker = workerID;
+    processCRU(iCRU, mCfConfig, mWorkerOutput[workerID]);
+  });
 
   /*
-   * wait for threads to join
+   * merge the clusters of the individual workers in CRU order, the position of
+   * the clusters of each CRU in the output is given by the prefix sum of the
+   * number of clusters of the preceding CRUs
    */
-  for (std::thread& t: thread_vector) {
-    t.join();
+  std::vector<size_t> clusterOffset(mCRUMax+2, 0);
+  for (unsigned cru = mCRUMin; cru <= mCRUMax; ++cru) {
+    clusterOffset[cru+1] = clusterOffset[cru] + (mCRUOutput[cru].clusterEnd - mCRUOutput[cru].clusterBegin);
+  }
+  const size_t firstCluster = mClusterArray->size();
+  mClusterArray->resize(firstCluster + clusterOffset[mCRUMax+1]);
+  for (unsigned cru = mCRUMin; cru <= mCRUMax; ++cru) {
+    const CRUOutput& cruOutput = mCRUOutput[cru];
+    const auto& clusters = mWorkerOutput[cruOutput.worker].clusters;
+    std::copy(clusters.begin() + cruOutput.clusterBegin, clusters.begin() + cruOutput.clusterEnd,
+              mClusterArray->begin() + firstCluster + clusterOffset[cru]);
   }
 
   /*
-   * collect clusters from individual cluster finder
+   * MC labels have to be added in cluster order
    */
-
-  // map to count unique MC labels
-  std::map<MCCompLabel,int> labelCount;
-
-  // multiset to sort labels according to occurrence
-  auto mcComp = [](const std::pair<MCCompLabel, int>& a, const std::pair<MCCompLabel, int>& b) { return a.second > b.second;};
-  std::multiset<std::pair<MCCompLabel,int>,decltype(mcComp)> labelSort(mcComp);
-
-  // for each CRU
-  for (unsigned cru = 0; cru < mClusterStorage.size(); ++cru) {
-    std::vector<Cluster>* clustersFromCRU = &mClusterStorage[cru];
-    std::vector<std::vector<std::pair<int,int>>>* labelsFromCRU = &mClusterDigitIndexStorage[cru];
-
-    // for each found cluster
-    for(unsigned c = 0; c < clustersFromCRU->size(); ++c) {
-      const auto clusterPos = mClusterArray->size();
-      mClusterArray->emplace_back(clustersFromCRU->at(c));
-      if (mClusterMcLabelArray == nullptr) continue;
-      labelCount.clear();
-      labelSort.clear();
-
-      // for each used digit
-      for (auto &digitIndex : labelsFromCRU->at(c)) {
-        if (digitIndex.first < 0) continue;
-        for (auto &l : mLastMcDigitTruth[digitIndex.second]->getLabels(digitIndex.first)) {
-          labelCount[l]++;
+  if (mClusterMcLabelArray != nullptr) {
+    for (unsigned cru = mCRUMin; cru <= mCRUMax; ++cru) {
+      const CRUOutput& cruOutput = mCRUOutput[cru];
+      const WorkerOutput& output = mWorkerOutput[cruOutput.worker];
+      size_t label = cruOutput.labelBegin;
+      for (size_t c = cruOutput.clusterBegin; c < cruOutput.clusterEnd; ++c) {
+        const auto clusterPos = firstCluster + clusterOffset[cru] + (c - cruOutput.clusterBegin);
+        for (unsigned l = 0; l < output.labelCounts[c]; ++l) {
+          mClusterMcLabelArray->addElement(clusterPos, output.labels[label++]);
         }
       }
-      for (auto &l : labelCount) labelSort.insert(l);
-      for (auto &l : labelSort) mClusterMcLabelArray->addElement(clusterPos,l.first);
     }
   }
 
   mLastTimebin = iTimeBinMax;
 }
 
-void HwClusterer::setNumThreads(unsigned threads) {
-  mNumThreads = (threads == 0) ? std::thread::hardware_concurrency() : threads;
+//________________________________________________________________________
+void HwClusterer::addClusterLabels(const std::vector<std::pair<int,int>>& digitIndices, WorkerOutput& output) const
+{
+  auto& labelCount = output.labelCount;
+  labelCount.clear();
+
+  // for each used digit
+  for (auto &digitIndex : digitIndices) {
+    if (digitIndex.first < 0) continue;
+    const auto truth = mLastMcDigitTruth.find(digitIndex.second);
+    if (truth == mLastMcDigitTruth.end()) continue;
+    for (auto &l : truth->second->getLabels(digitIndex.first)) {
+      labelCount[l]++;
+    }
+  }
+
+  // sort labels according to occurrence, labels with equal occurrence stay in label order
+  const size_t first = output.labels.size();
+  for (auto &l : labelCount) output.labels.push_back(l.first);
+  std::stable_sort(output.labels.begin() + first, output.labels.end(),
+      [&labelCount](const MCCompLabel& a, const MCCompLabel& b) { return labelCount.at(a) > labelCount.at(b); });
+  output.labelCounts.push_back(labelCount.size());
 }
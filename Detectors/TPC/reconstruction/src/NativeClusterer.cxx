@@ -0,0 +1,410 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file NativeClusterer.cxx
+/// \brief Streaming TPC cluster finder writing ClusterNative
+
+#include "TPCReconstruction/NativeClusterer.h"
+#include "DataFormatsTPC/Constants.h"
+#include "DataFormatsTPC/Helpers.h"
+#include "TPCBase/CRU.h"
+#include "TPCBase/Digit.h"
+#include "TPCBase/Mapper.h"
+
+#include "FairLogger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+using namespace o2::TPC;
+
+namespace {
+/// Number of time bins before and after a cluster peak used for the cluster
+constexpr int kClusterHalfSize = 2;
+
+/// Charge in the integer format of ClusterNative
+uint16_t packCharge(float charge)
+{
+  return static_cast<uint16_t>(std::min(std::max(charge, 0.f), 65535.f) + 0.5f);
+}
+}
+
+//________________________________________________________________________
+NativeClusterer::NativeClusterer(std::vector<ClusterNativeContainer>* clusterOutput,
+    std::vector<MCLabelContainer>* labelOutput, int minQMax,
+    bool requirePositiveCharge, bool requireNeighbouringPad)
+  : Clusterer(Constants::MAXGLOBALPADROW,138,1024,minQMax,requirePositiveCharge,requireNeighbouringPad)
+  , mIsContinuousReadout(true)
+  , mLastTimebin(-1)
+  , mTimeBinMin(0)
+  , mTimeBinMax(-1)
+  , mLastWindow(false)
+  , mClusterOutput(clusterOutput)
+  , mLabelOutput(labelOutput)
+  , mRowBegin(Constants::MAXSECTOR*Constants::MAXGLOBALPADROW+1, 0)
+  , mStagedDigits()
+  , mKeptDigits(Constants::MAXSECTOR*Constants::MAXGLOBALPADROW)
+  , mWorkerBuffers()
+  , mThreadPool(0)
+  , mLastMcDigitTruth()
+{
+  /*
+   * one output container for each pad row of each sector, also for rows
+   * without clusters, such that the sectors can be filled in parallel
+   */
+  mClusterOutput->resize(Constants::MAXSECTOR*Constants::MAXGLOBALPADROW);
+  for (int sector = 0; sector < Constants::MAXSECTOR; ++sector) {
+    for (int row = 0; row < Constants::MAXGLOBALPADROW; ++row) {
+      auto& container = (*mClusterOutput)[sector*Constants::MAXGLOBALPADROW + row];
+      container.sector = sector;
+      container.globalPadRow = row;
+      container.clusters.clear();
+    }
+  }
+  if (mLabelOutput) mLabelOutput->resize(mClusterOutput->size());
+}
+
+//________________________________________________________________________
+template <typename DigitAccessor>
+void NativeClusterer::stageDigits(size_t nDigits, DigitAccessor getDigit, bool storeIndex, int eventCount)
+{
+  const Mapper& mapper = Mapper::instance();
+  mTimeBinMin = (mIsContinuousReadout) ? mLastTimebin + 1 : 0;
+  mTimeBinMax = mTimeBinMin - 1;
+
+  /*
+   * pad row of a digit in the sector, -1 if the digit is not processed
+   */
+  auto getRowIndex = [this, &mapper](const Digit& digit) {
+    const CRU cru(digit.getCRU());
+    if (digit.getTimeStamp() < mTimeBinMin || digit.getRow() >= mapper.getNumberOfRowsRegion(cru.region())) return -1;
+    const int row = mapper.getGlobalRowOffsetRegion(cru.region()) + digit.getRow();
+    if (digit.getPad() < 0 || digit.getPad() >= mapper.getNumberOfPadsInRowSector(row)) return -1;
+    return static_cast<int>(cru.sector().getSector())*Constants::MAXGLOBALPADROW + row;
+  };
+
+  /*
+   * counting sort by pad row, the digits kept from the last window come
+   * first, the input order is kept within each row
+   */
+  std::fill(mRowBegin.begin(), mRowBegin.end(), 0);
+  for (size_t row = 0; row < mKeptDigits.size(); ++row) mRowBegin[row+1] = mKeptDigits[row].size();
+  for (size_t digitIndex = 0; digitIndex < nDigits; ++digitIndex) {
+    const Digit& digit = getDigit(digitIndex);
+    const int row = getRowIndex(digit);
+    if (row < 0) {
+      LOG(DEBUG) << "Digit [" << digitIndex << "] is skipped (CRU " << digit.getCRU() << ", row " << digit.getRow()
+                 << ", pad " << digit.getPad() << ", time " << digit.getTimeStamp() << ")" << FairLogger::endl;
+      continue;
+    }
+    mTimeBinMax = std::max(mTimeBinMax, digit.getTimeStamp());
+    ++mRowBegin[row+1];
+  }
+  for (size_t row = 1; row < mRowBegin.size(); ++row) mRowBegin[row] += mRowBegin[row-1];
+
+  mStagedDigits.resize(mRowBegin.back());
+  std::vector<unsigned> next(mRowBegin.begin(), mRowBegin.end() - 1);
+  for (size_t row = 0; row < mKeptDigits.size(); ++row) {
+    std::copy(mKeptDigits[row].begin(), mKeptDigits[row].end(), mStagedDigits.begin() + next[row]);
+    next[row] += mKeptDigits[row].size();
+  }
+  for (size_t digitIndex = 0; digitIndex < nDigits; ++digitIndex) {
+    const Digit& digit = getDigit(digitIndex);
+    const int row = getRowIndex(digit);
+    if (row < 0) continue;
+    // the original digit index is needed for the MC truth, which requires continuous indexing
+    mStagedDigits[next[row]++] = {digit.getTimeStamp(), digit.getPad(), digit.getChargeFloat(),
+                                  storeIndex ? static_cast<int>(digitIndex) : -1, eventCount};
+  }
+}
+
+//________________________________________________________________________
+void NativeClusterer::Process(std::vector<o2::TPC::Digit> const &digits, MCLabelContainer const* mcDigitTruth, int eventCount)
+{
+  stageDigits(digits.size(), [&digits](size_t i) -> const Digit& { return digits[i]; },
+              mcDigitTruth != nullptr, eventCount);
+
+  if (mcDigitTruth != nullptr && mLabelOutput != nullptr)
+    mLastMcDigitTruth[eventCount] = std::make_unique<MCLabelContainer>(*mcDigitTruth);
+
+  processWindow(!mIsContinuousReadout);
+}
+
+//________________________________________________________________________
+void NativeClusterer::Process(std::vector<std::unique_ptr<Digit>>& digits, MCLabelContainer const* mcDigitTruth, int eventCount)
+{
+  stageDigits(digits.size(), [&digits](size_t i) -> const Digit& { return *digits[i]; },
+              mcDigitTruth != nullptr, eventCount);
+
+  if (mcDigitTruth != nullptr && mLabelOutput != nullptr)
+    mLastMcDigitTruth[eventCount] = std::make_unique<MCLabelContainer>(*mcDigitTruth);
+
+  processWindow(!mIsContinuousReadout);
+}
+
+//________________________________________________________________________
+void NativeClusterer::finishStream()
+{
+  const std::vector<Digit> noDigits;
+  stageDigits(0, [&noDigits](size_t i) -> const Digit& { return noDigits[i]; }, false, 0);
+  processWindow(true);
+}
+
+//________________________________________________________________________
+std::unique_ptr<ClusterNativeAccessFullTPC> NativeClusterer::getClusterAccess()
+{
+  return TPCClusterFormatHelper::accessNativeContainerArray(*mClusterOutput, mLabelOutput);
+}
+
+//________________________________________________________________________
+void NativeClusterer::processWindow(bool lastWindow)
+{
+  mLastWindow = lastWindow;
+
+  /*
+   * the sectors are handed out one by one, the calling thread takes part in
+   * the processing
+   */
+  mWorkerBuffers.resize(mThreadPool.getNumWorkers(Constants::MAXSECTOR));
+  mThreadPool.run(Constants::MAXSECTOR, [this](unsigned worker, size_t sector) {
+    for (int row = 0; row < Constants::MAXGLOBALPADROW; ++row) {
+      processRow(sector, row, mWorkerBuffers[worker]);
+    }
+  });
+
+  mLastTimebin = lastWindow ? -1 : mTimeBinMax;
+
+  /*
+   * only the MC truth of the kept digits is needed for the next window
+   */
+  std::set<int> keptEvents;
+  for (const auto& row : mKeptDigits) {
+    for (const auto& digit : row) keptEvents.insert(digit.event);
+  }
+  for (auto truth = mLastMcDigitTruth.begin(); truth != mLastMcDigitTruth.end();) {
+    if (keptEvents.count(truth->first) == 0) truth = mLastMcDigitTruth.erase(truth);
+    else ++truth;
+  }
+}
+
+//________________________________________________________________________
+void NativeClusterer::processRow(int sector, int row, WorkerBuffers& buffers)
+{
+  const int rowIndex = sector*Constants::MAXGLOBALPADROW + row;
+  auto& output = (*mClusterOutput)[rowIndex].clusters;
+  output.clear();
+  if (mLabelOutput) (*mLabelOutput)[rowIndex].clear();
+  auto& kept = mKeptDigits[rowIndex];
+  kept.clear();
+
+  const unsigned digitBegin = mRowBegin[rowIndex];
+  const unsigned digitEnd = mRowBegin[rowIndex+1];
+  if (digitBegin == digitEnd) return;
+
+  /*
+   * charge matrix of the time bins with digits of this row, with 2 empty
+   * time bins and pads on each side
+   */
+  int timeFirst = mStagedDigits[digitBegin].time;
+  int timeLast = timeFirst;
+  for (unsigned i = digitBegin; i < digitEnd; ++i) {
+    timeFirst = std::min(timeFirst, mStagedDigits[i].time);
+    timeLast = std::max(timeLast, mStagedDigits[i].time);
+  }
+  timeFirst -= kClusterHalfSize;
+  timeLast += kClusterHalfSize;
+  const int nPads = Mapper::instance().getNumberOfPadsInRowSector(row) + 2*kClusterHalfSize;
+  const int nTimeBins = timeLast - timeFirst + 1;
+
+  auto& charge = buffers.charge;
+  auto& cellDigit = buffers.digit;
+  charge.assign(nTimeBins*nPads, 0.f);
+  cellDigit.assign(nTimeBins*nPads, -1);
+  for (unsigned i = digitBegin; i < digitEnd; ++i) {
+    const auto& digit = mStagedDigits[i];
+    const int cell = (digit.time - timeFirst)*nPads + digit.pad + kClusterHalfSize;
+    charge[cell] += digit.charge;
+    cellDigit[cell] = i;
+  }
+
+  /*
+   * time bins of the peaks in this window, in continuous readout the peaks
+   * in the last time bins need the time bins of the next window
+   */
+  const int peakFirst = std::max(timeFirst + kClusterHalfSize, mTimeBinMin - kClusterHalfSize) - timeFirst;
+  const int peakLast = (mLastWindow ? timeLast - kClusterHalfSize : std::min(timeLast, mTimeBinMax) - kClusterHalfSize) - timeFirst;
+
+  buffers.clusters.clear();
+  buffers.labels.clear();
+  buffers.labelBegin.assign(1, 0);
+  float cellCharge[5][5];
+  int clusterDigits[25];
+  for (int t = peakFirst; t <= peakLast; ++t) {
+    const float* q[5];
+    const int* d[5];
+    for (int tt = 0; tt < 5; ++tt) {
+      q[tt] = &charge[(t+tt-2)*nPads];
+      d[tt] = &cellDigit[(t+tt-2)*nPads];
+    }
+
+    for (int p = kClusterHalfSize; p < nPads - kClusterHalfSize; ++p) {
+      //
+      // find peak in 3x3 matrix
+      //
+      //    --->  pad direction
+      //    o o o o o    |
+      //    o i i i o    |
+      //    o i C i o    V Time direction
+      //    o i i i o
+      //    o o o o o
+      //
+      const float qPeak = q[2][p];
+      if (qPeak < mMinQMax) continue;
+      // Require at least one neighboring time bin with signal
+      if (q[1][p] <= 0 && q[3][p] <= 0) continue;
+      // Require at least one neighboring pad with signal
+      if (mRequireNeighbouringPad && q[2][p-1] <= 0 && q[2][p+1] <= 0) continue;
+      // check for local maximum, of equal charges the later time bin and the right pad is taken
+      if (q[1][p  ] >= qPeak || q[3][p  ] > qPeak || q[2][p-1] >= qPeak || q[2][p+1] > qPeak ||
+          q[1][p-1] >= qPeak || q[3][p+1] > qPeak || q[3][p-1] > qPeak  || q[1][p+1] >= qPeak) continue;
+
+      //
+      // the inner 3x3 matrix is always taken, the outer cells only if the
+      // neighbouring inner cell is above threshold
+      //
+      for (int tt = 0; tt < 5; ++tt) {
+        for (int pp = 0; pp < 5; ++pp) {
+          cellCharge[tt][pp] = 0.f;
+        }
+      }
+      int nDigits = 0;
+      auto takeCell = [&](int tt, int pp) {
+        const float cell = q[tt][p+pp-2];
+        if (mRequirePositiveCharge && cell < 0) return;
+        cellCharge[tt][pp] = cell;
+        if (d[tt][p+pp-2] >= 0) clusterDigits[nDigits++] = d[tt][p+pp-2];
+      };
+      // same condition as HwClusterFinder::chargeForCluster
+      auto takeOuterCell = [&](int tt, int pp, int innerT, int innerP) {
+        if (mRequirePositiveCharge && q[tt][p+pp-2] > 0 && q[innerT][p+innerP-2] > mMinQMax) takeCell(tt, pp);
+      };
+      for (int tt = 1; tt < 4; ++tt) {
+        for (int pp = 1; pp < 4; ++pp) {
+          takeCell(tt, pp);
+        }
+      }
+      // inner cross
+      takeOuterCell(0, 2, 1, 2);
+      takeOuterCell(4, 2, 3, 2);
+      takeOuterCell(2, 0, 2, 1);
+      takeOuterCell(2, 4, 2, 3);
+      // corners
+      for (int tt : {0, 1, 3, 4}) {
+        for (int pp : {0, 1, 3, 4}) {
+          if (tt == 0 || tt == 4 || pp == 0 || pp == 4) {
+            takeOuterCell(tt, pp, tt < 2 ? 1 : 3, pp < 2 ? 1 : 3);
+          }
+        }
+      }
+
+      //
+      // cluster properties
+      //
+      float qTot = 0, meanP = 0, meanT = 0, sigmaP = 0, sigmaT = 0;
+      for (int tt = 0; tt < 5; ++tt) {
+        const float deltaT = tt - 2;
+        for (int pp = 0; pp < 5; ++pp) {
+          const float deltaP = pp - 2;
+          const float cell = cellCharge[tt][pp];
+          qTot += cell;
+          meanP += cell * deltaP;
+          meanT += cell * deltaT;
+          sigmaP += cell * deltaP * deltaP;
+          sigmaT += cell * deltaT * deltaT;
+        }
+      }
+      if (qTot > 0) {
+        meanP /= qTot;
+        meanT /= qTot;
+        sigmaP = std::sqrt(sigmaP / qTot - meanP * meanP);
+        sigmaT = std::sqrt(sigmaT / qTot - meanT * meanT);
+      }
+
+      buffers.clusters.emplace_back();
+      ClusterNative& cluster = buffers.clusters.back();
+      cluster.setTimeFlags(timeFirst + t + meanT, 0);
+      cluster.setPad(p - kClusterHalfSize + meanP);
+      cluster.setSigmaTime(sigmaT);
+      cluster.setSigmaPad(sigmaP);
+      cluster.qMax = packCharge(qPeak);
+      cluster.qTot = packCharge(qTot);
+
+      if (mLabelOutput != nullptr) {
+        addClusterLabels(clusterDigits, nDigits, buffers);
+      }
+    }
+  }
+
+  /*
+   * the digits of the last time bins are needed for the peaks of the next
+   * window
+   */
+  if (!mLastWindow) {
+    for (unsigned i = digitBegin; i < digitEnd; ++i) {
+      if (mStagedDigits[i].time > mTimeBinMax - 2*kClusterHalfSize) kept.push_back(mStagedDigits[i]);
+    }
+  }
+
+  /*
+   * write the clusters sorted by time and pad
+   */
+  const auto& clusters = buffers.clusters;
+  auto& order = buffers.order;
+  order.resize(clusters.size());
+  for (unsigned i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&clusters](unsigned a, unsigned b) {
+    return ClusterNativeContainer::sortComparison(clusters[a], clusters[b]);
+  });
+  output.reserve(clusters.size());
+  for (unsigned i = 0; i < order.size(); ++i) {
+    output.push_back(clusters[order[i]]);
+    if (mLabelOutput != nullptr) {
+      for (unsigned l = buffers.labelBegin[order[i]]; l < buffers.labelBegin[order[i]+1]; ++l) {
+        (*mLabelOutput)[rowIndex].addElement(i, buffers.labels[l]);
+      }
+    }
+  }
+}
+
+//________________________________________________________________________
+void NativeClusterer::addClusterLabels(const int* digits, int nDigits, WorkerBuffers& buffers) const
+{
+  auto& labelCount = buffers.labelCount;
+  labelCount.clear();
+
+  // for each used digit
+  for (int i = 0; i < nDigits; ++i) {
+    const auto& digit = mStagedDigits[digits[i]];
+    if (digit.index < 0) continue;
+    const auto truth = mLastMcDigitTruth.find(digit.event);
+    if (truth == mLastMcDigitTruth.end()) continue;
+    for (auto &l : truth->second->getLabels(digit.index)) {
+      labelCount[l]++;
+    }
+  }
+
+  // sort labels according to occurrence, labels with equal occurrence stay in label order
+  const size_t first = buffers.labels.size();
+  for (auto &l : labelCount) buffers.labels.push_back(l.first);
+  std::stable_sort(buffers.labels.begin() + first, buffers.labels.end(),
+      [&labelCount](const MCCompLabel& a, const MCCompLabel& b) { return labelCount.at(a) > labelCount.at(b); });
+  buffers.labelBegin.push_back(buffers.labels.size());
+}
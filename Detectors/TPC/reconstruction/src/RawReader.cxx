@@ -13,7 +13,9 @@
 
 #include <boost/tokenizer.hpp>
 #include <boost/lexical_cast.hpp>
-#include <list>
+#include <algorithm>
+#include <fstream>
+#include <numeric>
 
 #include "TPCReconstruction/RawReader.h"
 #include "TPCReconstruction/GBTFrame.h"
@@ -26,10 +28,13 @@
 
 using namespace o2::TPC;
 
+constexpr int RawReader::NCHANNELS;
+
 RawReader::RawReader(int region, int link, int run, int sampaVersion)
   : mUseRawInMode3(true),
     mApplyChannelMask(false),
     mCheckAdcClock(false),
+    mPrefetchNextEvent(true),
     mRegion(region),
     mLink(link),
     mRun(run),
@@ -38,13 +43,23 @@ RawReader::RawReader(int region, int link, int run, int sampaVersion)
     mTimestampOfFirstData({ 0, 0, 0, 0, 0 }),
     mEvents(),
     mData(),
-    mDataIterator(mData.end()),
+    mTimeBinsMax(0),
+    mTimeBins(),
+    mChannelActive(),
+    mChannelPadPos(),
+    mChannelOrder(),
+    mChannelMapInitialized(false),
+    mNextChannel(NCHANNELS),
+    mEventWords(),
+    mPrefetch(),
     mSyncPos(),
     mChannelMask(nullptr),
     mAdcError(std::make_shared<std::vector<std::tuple<short, short, short>>>()),
     mEventSynchronizer(std::make_shared<RawReaderEventSync>())
 {
   mSyncPos.fill(-1);
+  mTimeBins.fill(0);
+  mChannelActive.fill(true);
 }
 
 bool RawReader::addInputFile(const std::vector<std::string>* infiles) {
@@ -191,35 +206,55 @@ bool RawReader::loadEvent(int64_t event) {
     loadEvent(getFirstEvent());
     LOG(DEBUG) << "Continue with event " << event << FairLogger::endl;
   }
-  mData.clear();
+  mTimeBins.fill(0);
+  mNextChannel = NCHANNELS;
 
   auto ev = mEvents.find(event);
 
   if (ev == mEvents.end()) return false;
   mLastEvent = event;
 
-  for (auto &eventInfo : *(ev->second)) {
+  //
+  // take the words from the read ahead, if it was started for this event
+  //
+  const std::vector<EventInfo>& eventInfos = *(ev->second);
+  bool prefetched = false;
+  if (mPrefetch.event == event && mPrefetch.words.valid()) {
+    mEventWords = mPrefetch.words.get();
+    prefetched = true;
+  }
+  mPrefetch.event = -1;
+  mEventWords.resize(eventInfos.size());
+  for (size_t i = 0; i < eventInfos.size(); ++i) {
+    if (prefetched && mEventWords[i].size() == static_cast<size_t>(eventInfos[i].header.nWords-8)) continue;
+    if (!readEventWords(eventInfos[i], mEventWords[i])) return false;
+  }
+
+  resetData(eventInfos);
+
+  for (size_t i = 0; i < eventInfos.size(); ++i) {
+    const EventInfo& eventInfo = eventInfos[i];
     switch (eventInfo.header.dataType) {
       case 1: // RAW GBT frames
         {
           LOG(DEBUG) << "Data of readout mode 1 (RAW GBT frames)" << FairLogger::endl;
-          if (!decodeRawGBTFrames(eventInfo)) return false;
+          if (!decodeRawGBTFrames(eventInfo, mEventWords[i])) return false;
           break;
         }
       case 2: // Decoded data
         {
           LOG(DEBUG) << "Data of readout mode 2 (decoded data)" << FairLogger::endl;
-          if (!decodePreprocessedData(eventInfo)) return false;
+          if (!decodePreprocessedData(eventInfo, mEventWords[i])) return false;
           break;
         }
       case 3: // both, RAW GBT frames and decoded data
         {
           if (mUseRawInMode3) {
             LOG(DEBUG) << "Data of readout mode 3 (decoding RAW GBT frames)" << FairLogger::endl;
-            if (!decodeRawGBTFrames(eventInfo)) return false;
+            if (!decodeRawGBTFrames(eventInfo, mEventWords[i])) return false;
           } else {
             LOG(DEBUG) << "Data of readout mode 3 (using decoded data)" << FairLogger::endl;
-            if (!decodePreprocessedData(eventInfo)) return false;
+            if (!decodePreprocessedData(eventInfo, mEventWords[i])) return false;
           }
           break;
         }
@@ -231,41 +266,95 @@ bool RawReader::loadEvent(int64_t event) {
     }
   }
 
-  mDataIterator = mData.begin();
+  //
+  // read the following event while this one is processed, the read ahead
+  // works on a copy of the event infos, addInputFile may still append to them
+  //
+  auto nextEv = mEvents.find(event+1);
+  if (mPrefetchNextEvent && nextEv != mEvents.end()) {
+    mPrefetch.event = event+1;
+    mPrefetch.words = std::async(std::launch::async, [eventInfos = *(nextEv->second)]() {
+      std::vector<std::vector<uint32_t>> words(eventInfos.size());
+      for (size_t i = 0; i < eventInfos.size(); ++i) {
+        if (!readEventWords(eventInfos[i], words[i])) words[i].clear();
+      }
+      return words;
+    });
+  }
+
+  mNextChannel = 0;
   LOG(DEBUG) << FairLogger::endl;
   LOG(DEBUG) << FairLogger::endl;
   return true;
 }
 
-bool RawReader::decodePreprocessedData(EventInfo eventInfo) {
-  std::ifstream file(eventInfo.path);
+bool RawReader::readEventWords(const EventInfo& eventInfo, std::vector<uint32_t>& words) {
+  std::ifstream file(eventInfo.path, std::ios::binary);
   if (!file.is_open()) {
     LOG(ERROR) << "Can't read file " << eventInfo.path << FairLogger::endl;
     return false;
   }
 
-  int nWords = eventInfo.header.nWords-8;
-  uint32_t words[nWords];
+  const int nWords = eventInfo.header.nWords-8;
+  words.resize(nWords);
   LOG(DEBUG) << "reading " << nWords << " words from position " << eventInfo.posInFile << " in file " << eventInfo.path << FairLogger::endl;
   file.seekg(eventInfo.posInFile);
-  file.read((char*)&words, nWords*sizeof(words[0]));
+  file.read((char*)words.data(), nWords*sizeof(words[0]));
+  return true;
+}
 
+void RawReader::initChannelMap() {
   const Mapper& mapper = Mapper::instance();
 
-  std::array<char,5> sampas;
-  std::array<char,5> sampaChannelStart;
-  for (char i=0; i<5; ++i) {
-    sampas[i] = (i == 4) ? 2 : (mRegion%2) ? i/2+3 : i/2;
-    sampaChannelStart[i] = (i == 4) ?   // 5th half SAMPA corresponds to  SAMPA2
-      ((mRegion%2) ? 16 : 0) :          // every even CRU receives channel 0-15 from SAMPA 2, the odd ones channel 16-31
-      ((i%2) ? 16 : 0);                 // every even half SAMPA containes channel 0-15, the odd ones channel 16-31
+  for (int i=0; i<5; ++i) {
+    const int sampa = (i == 4) ? 2 : (mRegion%2) ? i/2+3 : i/2;
+    const int sampaChannelStart = (i == 4) ?   // 5th half SAMPA corresponds to  SAMPA2
+      ((mRegion%2) ? 16 : 0) :                 // every even CRU receives channel 0-15 from SAMPA 2, the odd ones channel 16-31
+      ((i%2) ? 16 : 0);                        // every even half SAMPA containes channel 0-15, the odd ones channel 16-31
+    for (int k=0; k<16; ++k) {
+      mChannelPadPos[i*16+k] = mapper.padPosRegion(mRegion, mLink, sampa, k+sampaChannelStart);
+    }
   }
 
+  // data is returned ordered by pad position
+  std::iota(mChannelOrder.begin(), mChannelOrder.end(), 0);
+  std::stable_sort(mChannelOrder.begin(), mChannelOrder.end(),
+      [this](uint8_t a, uint8_t b) { return mChannelPadPos[a] < mChannelPadPos[b]; });
+  mChannelMapInitialized = true;
+}
+
+void RawReader::resetData(const std::vector<EventInfo>& eventInfos) {
+  if (!mChannelMapInitialized) initChannelMap();
+
+  //
+  // upper limit of the time bins, one for 8 GBT frames or for each word of decoded data
+  //
+  size_t timeBinsMax = 0;
+  for (const auto& eventInfo : eventInfos) {
+    const int indexStep = (eventInfo.header.dataType == 3) ? 8 : 4;
+    const bool raw = (eventInfo.header.dataType == 1) || (eventInfo.header.dataType == 3 && mUseRawInMode3);
+    const size_t nFrames = (eventInfo.header.nWords-8) / indexStep;
+    timeBinsMax += raw ? nFrames/8 + 1 : nFrames + 1;
+  }
+  mTimeBinsMax = timeBinsMax;
+  if (mData.size() < NCHANNELS*mTimeBinsMax) mData.resize(NCHANNELS*mTimeBinsMax);
+  mTimeBins.fill(0);
+
+  for (int channel=0; channel<NCHANNELS; ++channel) {
+    const PadPos& padPos = mChannelPadPos[channel];
+    mChannelActive[channel] = !(mApplyChannelMask &&          // channel mask should be applied
+                                (mChannelMask != nullptr) &&  // channel mask is available
+                                !mChannelMask->getValue(CRU(mRegion),padPos.getPad(),padPos.getRow())); // channel mask
+  }
+}
+
+bool RawReader::decodePreprocessedData(const EventInfo& eventInfo, const std::vector<uint32_t>& words) {
+  const int nWords = words.size();
 
   std::array<uint32_t,5> ids;
   std::array<bool,5> writeValue;
   writeValue.fill(false);
-  std::array<std::array<uint16_t,16>,5> adcValues;
+  std::array<std::array<uint16_t,16>,5> adcValues{};
 
 
   int indexStep = (eventInfo.header.dataType == 3) ? 8 : 4;
@@ -314,18 +403,8 @@ bool RawReader::decodePreprocessedData(EventInfo eventInfo) {
     for (char j=0; j<5; ++j) {
       if (writeValue[j] & (ids[j] == 0xF)) {
         for (int k=0; k<16; ++k) {
-          const PadPos padPos = mapper.padPosRegion(
-              mRegion, mLink,sampas[j],k+sampaChannelStart[j]);
-
-          if (mApplyChannelMask &&          // channel mask should be applied
-              (mChannelMask != nullptr) &&  // channel mask is available
-              !mChannelMask->getValue(CRU(mRegion),padPos.getPad(),padPos.getRow())) { // channel mask
-              continue;
-          }
-
-//          auto ins = mData.insert(std::make_pair(padPos, std::shared_ptr<std::vector<uint16_t>>(new std::vector<uint16_t>)));
-          auto ins = mData.insert(std::make_pair(padPos, std::make_shared<std::vector<uint16_t>>()));
-          ins.first->second->push_back(adcValues[j][k]);
+          if (!mChannelActive[j*16+k]) continue;
+          addAdcValue(j*16+k, adcValues[j][k]);
         }
       }
     }
@@ -334,30 +413,9 @@ bool RawReader::decodePreprocessedData(EventInfo eventInfo) {
   return true;
 }
 
-bool RawReader::decodeRawGBTFrames(EventInfo eventInfo) {
-  std::ifstream file(eventInfo.path);
-  if (!file.is_open()) {
-    LOG(ERROR) << "Can't read file " << eventInfo.path << FairLogger::endl;
-    return false;
-  }
-
-  int nWords = eventInfo.header.nWords-8;
-  uint32_t words[nWords];
-  LOG(DEBUG) << "reading " << nWords << " words from position " << eventInfo.posInFile << " in file " << eventInfo.path << FairLogger::endl;
+bool RawReader::decodeRawGBTFrames(const EventInfo& eventInfo, const std::vector<uint32_t>& words) {
+  const int nWords = words.size();
   LOG(DEBUG) << "Header time stamp is " << eventInfo.header.timeStamp() << FairLogger::endl;
-  file.seekg(eventInfo.posInFile);
-  file.read((char*)&words, nWords*sizeof(words[0]));
-
-  const Mapper& mapper = Mapper::instance();
-
-  std::array<char,5> sampas;
-  std::array<char,5> sampaChannelStart;
-  for (char i=0; i<5; ++i) {
-    sampas[i] = (i == 4) ? 2 : (mRegion%2) ? i/2+3 : i/2;
-    sampaChannelStart[i] = (i == 4) ?   // 5th half SAMPA corresponds to  SAMPA2
-      ((mRegion%2) ? 16 : 0) :          // every even CRU receives channel 0-15 from SAMPA 2, the odd ones channel 16-31
-      ((i%2) ? 16 : 0);                 // every even half SAMPA containes channel 0-15, the odd ones channel 16-31
-  }
 
   std::array<SyncPatternMonitor,5> syncMon{
     SyncPatternMonitor((mRegion%2) ? 3 : 0,0),
@@ -372,7 +430,8 @@ bool RawReader::decodeRawGBTFrames(EventInfo eventInfo) {
   std::array<bool,3> adcClockFound{false, false, false};
 
   std::array<short,5> lastSyncPos;
-  std::array<std::list<uint16_t>,5> adcValues;
+  std::array<std::array<uint16_t,16>,5> adcValues;
+  std::array<int,5> nAdcValues{0, 0, 0, 0, 0};
   mAdcError->clear();
   uint64_t timebin = 0;
 
@@ -476,32 +535,21 @@ bool RawReader::decodeRawGBTFrames(EventInfo eventInfo) {
       }
 
       if (mSampaVersion == 1 || mSampaVersion == 2) {
-        adcValues[iHalfSampa].emplace_back(value1 ^ (1 << 9)); // Invert bit 9 vor SAMPA v1 and v2
-        adcValues[iHalfSampa].emplace_back(value2 ^ (1 << 9)); // Invert bit 9 vor SAMPA v1 and v2
+        adcValues[iHalfSampa][nAdcValues[iHalfSampa]++] = value1 ^ (1 << 9); // Invert bit 9 vor SAMPA v1 and v2
+        adcValues[iHalfSampa][nAdcValues[iHalfSampa]++] = value2 ^ (1 << 9); // Invert bit 9 vor SAMPA v1 and v2
       } else {
-        adcValues[iHalfSampa].emplace_back(value1);
-        adcValues[iHalfSampa].emplace_back(value2);
+        adcValues[iHalfSampa][nAdcValues[iHalfSampa]++] = value1;
+        adcValues[iHalfSampa][nAdcValues[iHalfSampa]++] = value2;
       }
     }
 
     for (char j=0; j<5; ++j) {
-      if (adcValues[j].size() == 16) {
+      if (nAdcValues[j] == 16) {
         for (int k=0; k<16; ++k) {
-          const PadPos padPos = mapper.padPosRegion(
-              mRegion, mLink,sampas[j],k+sampaChannelStart[j]);
-
-          if (mApplyChannelMask &&          // channel mask should be applied
-              (mChannelMask != nullptr) &&  // channel mask is available
-              !mChannelMask->getValue(CRU(mRegion),padPos.getPad(),padPos.getRow())) {     // channel mask
-            adcValues[j].pop_front();           // discard value
-            continue;
-          }
-
-          //          auto ins = mData.insert(std::make_pair(padPos, std::shared_ptr<std::vector<uint16_t>>(new std::vector<uint16_t>)));
-          auto ins = mData.insert(std::make_pair(padPos, std::make_shared<std::vector<uint16_t>>()));
-          ins.first->second->push_back(adcValues[j].front());
-          adcValues[j].pop_front();
+          if (!mChannelActive[j*16+k]) continue;  // masked channel, value is discarded
+          addAdcValue(j*16+k, adcValues[j][k]);
         }
+        nAdcValues[j] = 0;
       }
     }
   }
@@ -26,6 +26,10 @@
 #include "TPCBase/ParameterGas.h"
 #include "TPCBase/Sector.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+
 // The AliHLTTPCCAO2Interface.h needs certain macro definitions.
 // The AliHLTTPCCAO2Interface will only be included once here, all O2 TPC tracking will run through this TPCCATracking
 // class.
@@ -42,7 +46,22 @@ using namespace o2::dataformats;
 
 using MCLabelContainer = MCTruthContainer<MCCompLabel>;
 
-TPCCATracking::TPCCATracking() : mTrackingCAO2Interface(), mClusterData_UPTR(), mClusterData(nullptr) {}
+namespace
+{
+double secondsSince(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+}
+
+TPCCATracking::TPCCATracking()
+  : mTrackingCAO2Interface(),
+    mClusterData_UPTR(),
+    mClusterData(nullptr),
+    mThreadPool(0),
+    mTiming()
+{
+}
 TPCCATracking::~TPCCATracking() { deinitialize(); }
 int TPCCATracking::initialize(const char* options)
 {
@@ -79,57 +98,65 @@ int TPCCATracking::convertClusters(TChain* inputClustersChain, const std::vector
     numChunks = 1;
   }
 
+  // Single pass over the input, remembering the sector and row of each cluster.
+  // The clusters are then distributed to their rows in input order.
   Mapper& mapper = Mapper::instance();
-  for (int iter = 0; iter < 2; iter++) {
-    for (int i = 0; i < Sector::MAXSECTOR; i++) {
-      for (int j = 0; j < Constants::MAXGLOBALPADROW; j++) {
-        outputClusters.nClusters[i][j] = 0;
-      }
+  std::vector<ClusterNative> converted;
+  std::vector<unsigned short> rowIndex; // sector * MAXGLOBALPADROW + row
+  for (int iChunk = 0; iChunk < numChunks; iChunk++) {
+    if (inputClustersChain) {
+      inputClustersChain->GetEntry(iChunk);
     }
-
-    unsigned int nClusters = 0;
-    for (int iChunk = 0; iChunk < numChunks; iChunk++) {
-      if (inputClustersChain) {
-        inputClustersChain->GetEntry(iChunk);
-      }
-      for (int icluster = 0; icluster < inputClustersArray->size(); ++icluster) {
-        const auto& cluster = (*inputClustersArray)[icluster];
-        const CRU cru(cluster.getCRU());
-        const Sector sector = cru.sector();
-        const PadRegionInfo& region = mapper.getPadRegionInfo(cru.region());
-        const int rowInSector = cluster.getRow() + region.getGlobalRowOffset();
-
-        if (iter == 1) {
-          ClusterNative& oCluster =
-            outputClusters.clusters[sector][rowInSector][outputClusters.nClusters[sector][rowInSector]];
-          oCluster.setTimeFlags(cluster.getTimeMean(), 0);
-          oCluster.setPad(cluster.getPadMean());
-          oCluster.setSigmaTime(cluster.getTimeSigma());
-          oCluster.setSigmaPad(cluster.getPadSigma());
-          oCluster.qTot = cluster.getQmax();
-          oCluster.qMax = cluster.getQ();
-        }
-        outputClusters.nClusters[sector][rowInSector]++;
-      }
-      nClusters += inputClustersArray->size();
+    converted.reserve(converted.size() + inputClustersArray->size());
+    rowIndex.reserve(rowIndex.size() + inputClustersArray->size());
+    for (const auto& cluster : *inputClustersArray) {
+      const CRU cru(cluster.getCRU());
+      const Sector sector = cru.sector();
+      const PadRegionInfo& region = mapper.getPadRegionInfo(cru.region());
+      const int rowInSector = cluster.getRow() + region.getGlobalRowOffset();
+
+      ClusterNative oCluster;
+      oCluster.setTimeFlags(cluster.getTimeMean(), 0);
+      oCluster.setPad(cluster.getPadMean());
+      oCluster.setSigmaTime(cluster.getTimeSigma());
+      oCluster.setSigmaPad(cluster.getPadSigma());
+      oCluster.qTot = cluster.getQmax();
+      oCluster.qMax = cluster.getQ();
+      converted.emplace_back(oCluster);
+      rowIndex.emplace_back(sector * Constants::MAXGLOBALPADROW + rowInSector);
     }
-    if (iter == 0) {
-      clusterMemory.reset(new ClusterNative[nClusters]);
-      unsigned int pos = 0;
-      for (int i = 0; i < Sector::MAXSECTOR; i++) {
-        for (int j = 0; j < Constants::MAXGLOBALPADROW; j++) {
-          outputClusters.clusters[i][j] = &clusterMemory[pos];
-          pos += outputClusters.nClusters[i][j];
-        }
-      }
+  }
+
+  for (int i = 0; i < Sector::MAXSECTOR; i++) {
+    for (int j = 0; j < Constants::MAXGLOBALPADROW; j++) {
+      outputClusters.nClusters[i][j] = 0;
     }
   }
+  for (const auto index : rowIndex) {
+    outputClusters.nClusters[index / Constants::MAXGLOBALPADROW][index % Constants::MAXGLOBALPADROW]++;
+  }
+
+  clusterMemory.reset(new ClusterNative[converted.size()]);
+  unsigned int pos = 0;
   for (int i = 0; i < Sector::MAXSECTOR; i++) {
+    for (int j = 0; j < Constants::MAXGLOBALPADROW; j++) {
+      outputClusters.clusters[i][j] = &clusterMemory[pos];
+      pos += outputClusters.nClusters[i][j];
+      outputClusters.nClusters[i][j] = 0;
+    }
+  }
+  for (size_t icluster = 0; icluster < converted.size(); icluster++) {
+    const int i = rowIndex[icluster] / Constants::MAXGLOBALPADROW;
+    const int j = rowIndex[icluster] % Constants::MAXGLOBALPADROW;
+    outputClusters.clusters[i][j][outputClusters.nClusters[i][j]++] = converted[icluster];
+  }
+
+  mThreadPool.run(Sector::MAXSECTOR, [&outputClusters](unsigned, int i) {
     for (int j = 0; j < Constants::MAXGLOBALPADROW; j++) {
       std::sort(outputClusters.clusters[i][j], outputClusters.clusters[i][j] + outputClusters.nClusters[i][j],
                 ClusterNativeContainer::sortComparison);
     }
-  }
+  });
 
   return (0);
 }
@@ -141,11 +168,15 @@ int TPCCATracking::runTracking(const ClusterNativeAccessFullTPC& clusters, std::
   const static ParameterGas& gasParam = ParameterGas::defaultInstance();
   const static ParameterElectronics& elParam = ParameterElectronics::defaultInstance();
 
+  mTiming = Timing();
+  auto start = std::chrono::steady_clock::now();
+
   int nClusters[Sector::MAXSECTOR] = {};
-  int nClustersConverted = 0;
+  int nClustersRemoved[Sector::MAXSECTOR] = {};
   int nClustersTotal = 0;
   float vzbin = (elParam.getZBinWidth() * gasParam.getVdrift());
   float vzbinInv = 1.f / vzbin;
+  const bool continuous = mTrackingCAO2Interface->GetParamContinuous();
 
   Mapper& mapper = Mapper::instance();
   for (int i = 0; i < Sector::MAXSECTOR; i++) {
@@ -158,19 +189,27 @@ int TPCCATracking::runTracking(const ClusterNativeAccessFullTPC& clusters, std::
       nClusters[i] += clusters.nClusters[i][j];
     }
     nClustersTotal += nClusters[i];
+  }
 
-    mClusterData[i].StartReading(i, nClusters[i]);
+  // pad region of each global pad row, the same in all sectors
+  std::array<int, Constants::MAXGLOBALPADROW> rowRegion;
+  for (int j = 0, regionNumber = 0; j < Constants::MAXGLOBALPADROW; j++) {
+    while (j > mapper.getGlobalRowOffsetRegion(regionNumber) + mapper.getNumberOfRowsRegion(regionNumber))
+      regionNumber++;
+    rowRegion[j] = regionNumber;
+  }
+
+  // the sectors are filled independently, the clusters are read in place from the input
+  mThreadPool.run(Sector::MAXSECTOR, [&](unsigned, int i) {
+    AliHLTTPCCAClusterData& cd = mClusterData[i];
+    cd.StartReading(i, nClusters[i]);
 
     for (int j = 0; j < Constants::MAXGLOBALPADROW; j++) {
       Sector sector = i;
-      int regionNumber = 0;
-      while (j > mapper.getGlobalRowOffsetRegion(regionNumber) + mapper.getNumberOfRowsRegion(regionNumber))
-        regionNumber++;
-      CRU cru(sector, regionNumber);
+      CRU cru(sector, rowRegion[j]);
       const PadRegionInfo& region = mapper.getPadRegionInfo(cru.region());
       for (int k = 0; k < clusters.nClusters[i][j]; k++) {
         const ClusterNative& cluster = clusters.clusters[i][j][k];
-        AliHLTTPCCAClusterData& cd = mClusterData[i];
         AliHLTTPCCAClusterData::Data& hltCluster = cd.Clusters()[cd.NumberOfClusters()];
 
         const float padY = cluster.getPad();
@@ -180,16 +219,14 @@ int TPCCATracking::runTracking(const ClusterNativeAccessFullTPC& clusters, std::
         const float localY = padCentre.Y() - (padY - padNumber) * region.getPadWidth();
         const float localYfactor = (cru.side() == Side::A) ? -1.f : 1.f;
         float zPositionAbs = cluster.getTime() * vzbin;
-        if (!mTrackingCAO2Interface->GetParamContinuous())
+        if (!continuous)
           zPositionAbs = detParam.getTPClength() - zPositionAbs;
         else
           zPositionAbs = sContinuousTFReferenceLength * vzbin - zPositionAbs;
 
         // sanity checks
-        if (zPositionAbs < 0 ||
-            (!mTrackingCAO2Interface->GetParamContinuous() && zPositionAbs > detParam.getTPClength())) {
-          LOG(INFO) << "Removing cluster " << i << " time: " << cluster.getTime() << ", abs. z: " << zPositionAbs
-                    << "\n";
+        if (zPositionAbs < 0 || (!continuous && zPositionAbs > detParam.getTPClength())) {
+          nClustersRemoved[i]++;
           continue;
         }
 
@@ -201,19 +238,30 @@ int TPCCATracking::runTracking(const ClusterNativeAccessFullTPC& clusters, std::
         hltCluster.fId = (i << 24) | (j << 16) | (k);
 
         cd.SetNumberOfClusters(cd.NumberOfClusters() + 1);
-        nClustersConverted++;
       }
     }
+  });
+
+  int nClustersConverted = nClustersTotal;
+  for (int i = 0; i < Sector::MAXSECTOR; i++) {
+    if (nClustersRemoved[i]) {
+      LOG(INFO) << "Removed " << nClustersRemoved[i] << " clusters with invalid z in sector " << i << "\n";
+    }
+    nClustersConverted -= nClustersRemoved[i];
   }
 
   if (nClustersTotal != nClustersConverted) {
     LOG(INFO) << "Passed " << nClustersConverted << " (out of " << nClustersTotal << ") clusters to CA tracker\n";
   }
+  mTiming.input = secondsSince(start);
 
   const AliHLTTPCGMMergedTrack* tracks;
   int nTracks;
   const AliHLTTPCGMMergedTrackHit* trackClusters;
+  start = std::chrono::steady_clock::now();
   int retVal = mTrackingCAO2Interface->RunTracking(mClusterData, tracks, nTracks, trackClusters);
+  mTiming.tracking = secondsSince(start);
+  start = std::chrono::steady_clock::now();
   if (retVal == 0) {
     std::vector<std::pair<int, float>> trackSort(nTracks);
     int tmp = 0, tmp2 = 0;
@@ -232,14 +280,16 @@ int TPCCATracking::runTracking(const ClusterNativeAccessFullTPC& clusters, std::
 
     outputTracks->resize(nTracks);
 
-    for (int iTmp = 0; iTmp < nTracks; iTmp++) {
+    // the tracks are converted independently, the MC labels are added in track order afterwards
+    std::vector<MCCompLabel> trackLabels(outputTracksMCTruth ? nTracks : 0);
+    mThreadPool.run(nTracks, [&](unsigned, int iTmp) {
       auto& oTrack = (*outputTracks)[iTmp];
       const int i = trackSort[iTmp].first;
       float time0 = 0.f, tFwd = 0.f, tBwd = 0.f;
       float zTrack = tracks[i].GetParam().GetZ();
 
       float zHigh = 0, zLow = 0;
-      if (mTrackingCAO2Interface->GetParamContinuous()) {
+      if (continuous) {
         float zoffset = tracks[i].CSide() ? -tracks[i].GetParam().GetZOffset() : tracks[i].GetParam().GetZOffset();
         time0 = sContinuousTFReferenceLength - zoffset * vzbinInv;
 
@@ -349,12 +399,18 @@ int TPCCATracking::runTracking(const ClusterNativeAccessFullTPC& clusters, std::
         MCCompLabel& bestLabel = labels[bestLabelNum].first;
         if (bestLabelCount < (1.f - sTrackMCMaxFake) * tracks[i].NClusters())
           bestLabel.set(-bestLabel.getTrackID(), bestLabel.getEventID(), bestLabel.getSourceID());
-        outputTracksMCTruth->addElement(iTmp, bestLabel);
+        trackLabels[iTmp] = bestLabel;
       }
-      int lastSector = trackClusters[tracks[i].FirstClusterRef() + tracks[i].NClusters() - 1].fId >> 24;
+    });
+
+    for (int iTmp = 0; iTmp < (int)trackLabels.size(); iTmp++) {
+      outputTracksMCTruth->addElement(iTmp, trackLabels[iTmp]);
     }
   }
   mTrackingCAO2Interface->Cleanup();
+  mTiming.output = secondsSince(start);
+  LOG(DEBUG) << "CA tracking times: input " << mTiming.input * 1000. << " ms, tracking " << mTiming.tracking * 1000.
+             << " ms, output " << mTiming.output * 1000. << " ms\n";
   return (retVal);
 }
 
@@ -365,12 +421,16 @@ int TPCCATracking::runTracking(TChain* inputClustersChain, const std::vector<o2:
     return (1);
   int retVal = 0;
 
+  const auto start = std::chrono::steady_clock::now();
   std::unique_ptr<ClusterNative[]> clusterMemory;
   ClusterNativeAccessFullTPC clusters;
   retVal = convertClusters(inputClustersChain, inputClustersArray, clusters, clusterMemory);
   if (retVal)
     return (retVal);
-  return (runTracking(clusters, outputTracks));
+  const double conversion = secondsSince(start);
+  retVal = runTracking(clusters, outputTracks);
+  mTiming.conversion = conversion;
+  return (retVal);
 }
 
 float TPCCATracking::getPseudoVDrift()
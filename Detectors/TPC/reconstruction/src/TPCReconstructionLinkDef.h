@@ -31,6 +31,7 @@
 #pragma link C++ class o2::TPC::HwClusterer+;
 #pragma link C++ class o2::TPC::HwClusterFinder+;
 #pragma link C++ class o2::TPC::HwFixedPoint+;
+#pragma link C++ class o2::TPC::NativeClusterer+;
 
 #pragma link C++ class std::vector<o2::TPC::Cluster>+;
 #pragma link C++ class std::vector<o2::TPC::TrackTPC>+;
@@ -0,0 +1,51 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ClustererTestHelpers.h
+/// \brief Input digits shared by the tests of the TPC cluster finders
+
+#ifndef ALICEO2_TPC_CLUSTERERTESTHELPERS_H_
+#define ALICEO2_TPC_CLUSTERERTESTHELPERS_H_
+
+#include "TPCBase/Digit.h"
+#include "SimulationDataFormat/MCTruthContainer.h"
+#include "SimulationDataFormat/MCCompLabel.h"
+
+#include <cmath>
+#include <vector>
+
+namespace o2 {
+namespace TPC {
+
+  /// Gaussian charge clouds in several CRUs, each with the MC label of its own track
+  inline void makeDigits(std::vector<Digit>& digits, o2::dataformats::MCTruthContainer<o2::MCCompLabel>& labels)
+  {
+    int track = 0;
+    for (int cru = 0; cru < 40; cru += 3) {
+      for (int cluster = 0; cluster < 4; ++cluster) {
+        const int row = 2 + cluster;
+        const int padCentre = 10 + 20 * cluster;
+        const int timeCentre = 20 + 15 * cluster + cru % 7;
+        for (int pad = padCentre - 2; pad <= padCentre + 2; ++pad) {
+          for (int time = timeCentre - 2; time <= timeCentre + 2; ++time) {
+            const float charge = 100.f * std::exp(-0.5f * ((pad - padCentre) * (pad - padCentre) + (time - timeCentre) * (time - timeCentre)));
+            labels.addElement(digits.size(), MCCompLabel(track, 0));
+            digits.emplace_back(cru, charge, row, pad, time);
+          }
+        }
+        ++track;
+      }
+    }
+  }
+
+}
+}
+
+#endif
@@ -0,0 +1,88 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchTPCHardwareClusterDecoder.cxx
+/// \brief Benchmark of the TPC HardwareClusterDecoder
+///
+/// Full 8 kB pages of random clusters in random CRUs are decoded to ClusterNative. The throughput
+/// is given in clusters per second, running the benchmark on different revisions compares the implementations.
+
+#include "benchmark/benchmark.h"
+
+#include "TPCReconstruction/HardwareClusterDecoder.h"
+#include "DataFormatsTPC/ClusterHardware.h"
+#include "DataFormatsTPC/Constants.h"
+#include "TPCBase/CRU.h"
+#include "TPCBase/Mapper.h"
+
+#include <random>
+#include <vector>
+
+using namespace o2::TPC;
+
+namespace {
+/// Size of the pages of ClusterHardwareContainer
+constexpr int kPageSize = 8192;
+
+/// Pages completely filled with clusters, returns the total number of clusters
+size_t makePages(std::vector<char>& buffer, int nPages)
+{
+  const Mapper& mapper = Mapper::instance();
+  const int nClusters = (kPageSize - sizeof(ClusterHardwareContainer)) / sizeof(ClusterHardware);
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> pad(0.f, 100.f);
+  std::uniform_real_distribution<float> time(0.f, 500.f);
+  std::uniform_int_distribution<int> charge(10, 1000);
+
+  buffer.assign(size_t(nPages) * kPageSize, 0);
+  for (int p = 0; p < nPages; ++p) {
+    auto* cont = reinterpret_cast<ClusterHardwareContainer*>(&buffer[size_t(p) * kPageSize]);
+    cont->CRU = generator() % (Constants::MAXSECTOR * CRU::CRUperSector);
+    cont->timeBinOffset = 1000 * p;
+    cont->numberOfClusters = nClusters;
+    const int nRows = mapper.getPadRegionInfo(CRU(cont->CRU).region()).getNumberOfPadRows();
+    for (int k = 0; k < nClusters; ++k) {
+      ClusterHardware& cluster = cont->clusters[k];
+      const float clusterPad = pad(generator);
+      const float clusterTime = time(generator);
+      cluster.qTot = charge(generator);
+      cluster.qMax = cluster.qTot / 5;
+      cluster.row = generator() % nRows;
+      cluster.flags = 0;
+      cluster.padPre = clusterPad * cluster.qTot;
+      cluster.timePre = clusterTime * cluster.qTot;
+      cluster.sigmaPad2Pre = (clusterPad * clusterPad + 0.5f) * cluster.qTot * cluster.qTot;
+      cluster.sigmaTime2Pre = (clusterTime * clusterTime + 0.5f) * cluster.qTot * cluster.qTot;
+    }
+  }
+  return size_t(nPages) * nClusters;
+}
+} // namespace
+
+static void BM_HardwareClusterDecoder(benchmark::State& state)
+{
+  std::vector<char> buffer;
+  const size_t nClusters = makePages(buffer, state.range(0));
+  std::vector<std::pair<const ClusterHardwareContainer*, std::size_t>> input = {
+    { reinterpret_cast<const ClusterHardwareContainer*>(buffer.data()), size_t(state.range(0)) }
+  };
+  std::vector<ClusterNativeContainer> clusters;
+  HardwareClusterDecoder decoder;
+  decoder.setNumThreads(state.range(1));
+  for (auto _ : state) {
+    decoder.decodeClusters(input, clusters);
+    benchmark::DoNotOptimize(clusters.data());
+  }
+  state.SetItemsProcessed(state.iterations() * nClusters);
+}
+
+BENCHMARK(BM_HardwareClusterDecoder)->Args({100, 1})->Args({10000, 1})->Args({10000, 0})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,84 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchTPCHwClusterer.cxx
+/// \brief Benchmark of the TPC HwClusterer
+///
+/// Gaussian clusters on top of noise digits are distributed over the CRUs of one sector. The throughput
+/// is given in digits per second, running the benchmark on different revisions compares the implementations.
+
+#include "benchmark/benchmark.h"
+
+#include "TPCReconstruction/HwClusterer.h"
+#include "TPCBase/CRU.h"
+#include "TPCBase/Digit.h"
+#include "TPCBase/Mapper.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace o2::TPC;
+
+namespace {
+/// Number of time bins of the generated digits
+constexpr int kTimeBins = 500;
+
+/// Clusters of 5x5 digits with random position and amplitude, and single noise digits, in the CRUs of sector 0
+std::vector<Digit> makeDigits(int nClustersPerCRU)
+{
+  const Mapper& mapper = Mapper::instance();
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> amplitude(20.f, 200.f);
+  std::uniform_int_distribution<int> time(2, kTimeBins - 3);
+  std::normal_distribution<float> noise(2.f, 1.f);
+
+  std::vector<Digit> digits;
+  for (int cru = 0; cru < CRU::CRUperSector; ++cru) {
+    const int nRows = mapper.getNumberOfRowsPartition(cru);
+    std::uniform_int_distribution<int> row(0, nRows - 1);
+    for (int cluster = 0; cluster < nClustersPerCRU; ++cluster) {
+      const int clusterRow = row(generator);
+      const int nPads = mapper.getNumberOfPadsInRowPartition(cru, clusterRow);
+      const int padCentre = std::uniform_int_distribution<int>(2, nPads - 3)(generator);
+      const int timeCentre = time(generator);
+      const float clusterAmplitude = amplitude(generator);
+      for (int pad = padCentre - 2; pad <= padCentre + 2; ++pad) {
+        for (int t = timeCentre - 2; t <= timeCentre + 2; ++t) {
+          const float charge = clusterAmplitude *
+            std::exp(-0.5f * ((pad - padCentre) * (pad - padCentre) + (t - timeCentre) * (t - timeCentre)));
+          digits.emplace_back(cru, charge, clusterRow, pad, t);
+        }
+      }
+      // noise digit somewhere else in the row
+      digits.emplace_back(cru, std::abs(noise(generator)), clusterRow, padCentre / 2, time(generator));
+    }
+  }
+  return digits;
+}
+} // namespace
+
+static void BM_HwClusterer(benchmark::State& state)
+{
+  const auto digits = makeDigits(state.range(0));
+  std::vector<Cluster> clusters;
+  HwClusterer clusterer(&clusters, nullptr, 0, CRU::CRUperSector - 1, 0, true, false, false);
+  clusterer.setContinuousReadout(false);
+  clusterer.setNumThreads(state.range(1));
+  for (auto _ : state) {
+    clusterer.Process(digits, nullptr, 0);
+    benchmark::DoNotOptimize(clusters.data());
+  }
+  state.SetItemsProcessed(state.iterations() * digits.size());
+}
+
+BENCHMARK(BM_HwClusterer)->Args({100, 1})->Args({1000, 1})->Args({1000, 0})->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,137 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTPCGBTFrameContainer.cxx
+/// \brief This task tests the block decoding of GBT frames from binary files against the decoding frame by frame
+
+#define BOOST_TEST_MODULE Test TPC GBTFrameContainer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TPCReconstruction/GBTFrameContainer.h"
+#include "TPCReconstruction/HalfSAMPAData.h"
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace o2 {
+namespace TPC {
+
+  const std::string kFileName = "testTPCGBTFrameContainer.bin";
+
+  /// GBT frames as 4 words each, with random ADC values after a sync pattern in each half SAMPA
+  /// The sync patterns start at different positions, half SAMPA 3 has a second one
+  std::vector<unsigned> makeWords(int nFrames)
+  {
+    const short A = 0x15, B = 0x0A;
+    const short sync[32] = { A, A, B, B, A, A, B, B, A, A, B, B, A, A, B, B, A, A, A, A, B, B, B, B, A, A, A, A, B, B, B, B };
+    std::mt19937 generator(1);
+    std::vector<std::vector<short>> halfWords(5);
+    for (int i = 0; i < 5; ++i) {
+      auto& hw = halfWords[i];
+      const int noise = 40 + 3 * i + (i == 1 ? 1 : 0);
+      for (int k = 0; k < noise; ++k) hw.push_back(generator() % 32);
+      hw.insert(hw.end(), sync, sync + 32);
+      while (hw.size() < 4u * nFrames) {
+        const int adc = generator() % 1024;
+        hw.push_back(adc & 0x1F);
+        hw.push_back(adc >> 5);
+        if (i == 3 && hw.size() > 2u * nFrames && hw.size() < 2u * nFrames + 3) hw.insert(hw.end(), sync, sync + 32);
+      }
+      hw.resize(4 * nFrames);
+    }
+
+    // ADC clock with one error in SAMPA 1
+    unsigned clock = 0xFFFF0000u >> 3;
+    std::vector<unsigned> words;
+    for (int f = 0; f < nFrames; ++f) {
+      const short c = (clock >> 28) & 0xF;
+      clock = (clock << 4) | (clock >> 28);
+      const auto& s = halfWords;
+      GBTFrame frame(s[0][4*f], s[0][4*f+1], s[0][4*f+2], s[0][4*f+3], s[1][4*f], s[1][4*f+1], s[1][4*f+2], s[1][4*f+3],
+                     s[2][4*f], s[2][4*f+1], s[2][4*f+2], s[2][4*f+3], s[3][4*f], s[3][4*f+1], s[3][4*f+2], s[3][4*f+3],
+                     s[4][4*f], s[4][4*f+1], s[4][4*f+2], s[4][4*f+3], c, (f == nFrames / 3) ? 0x5 : c, c);
+      unsigned w3, w2, w1, w0;
+      frame.getGBTFrame(w3, w2, w1, w0);
+      words.insert(words.end(), { w3, w2, w1, w0 });
+    }
+    return words;
+  }
+
+  /// All decoded ADC values of the container, half SAMPA after half SAMPA
+  std::vector<std::vector<short>> drain(GBTFrameContainer& container)
+  {
+    std::vector<std::vector<short>> values;
+    std::vector<HalfSAMPAData> data;
+    while (container.getData(data)) {
+      for (auto& halfSampa : data) values.emplace_back(halfSampa.getData().begin(), halfSampa.getData().end());
+      data.clear();
+    }
+    return values;
+  }
+
+  /// \brief The block decoding of a binary file gives the ADC values of the decoding frame by frame, with and without storing the frames
+  BOOST_AUTO_TEST_CASE(GBTFrameContainer_block_test)
+  {
+    // more than two blocks of frames
+    const int nFrames = 40000;
+    const auto words = makeWords(nFrames);
+    {
+      std::ofstream file(kFileName, std::ios::binary);
+      file.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(unsigned));
+    }
+
+    for (bool store : { true, false }) {
+      for (int sampaVersion : { -1, 2 }) {
+        GBTFrameContainer perFrame(0, 0, 0, sampaVersion);
+        perFrame.setEnableStoreGBTFrames(store);
+        for (size_t i = 0; i < words.size(); i += 4) perFrame.addGBTFrame(words[i], words[i+1], words[i+2], words[i+3]);
+        const auto reference = drain(perFrame);
+        BOOST_REQUIRE(!reference.empty());
+
+        for (unsigned nThreads : { 1u, 5u }) {
+          GBTFrameContainer block(0, 0, 0, sampaVersion);
+          block.setEnableStoreGBTFrames(store);
+          block.setNumThreads(nThreads);
+          block.addGBTFramesFromBinaryFile(kFileName, "trorc");
+          BOOST_CHECK_EQUAL(block.getNFramesAnalyzed(), perFrame.getNFramesAnalyzed());
+          BOOST_CHECK_EQUAL(block.getSize(), perFrame.getSize());
+          BOOST_CHECK(drain(block) == reference);
+        }
+
+        // a limited number of frames from the file, the rest frame by frame
+        GBTFrameContainer mixed(0, 0, 0, sampaVersion);
+        mixed.setEnableStoreGBTFrames(store);
+        mixed.addGBTFramesFromBinaryFile(kFileName, "trorc", nFrames / 2);
+        BOOST_CHECK_EQUAL(mixed.getNFramesAnalyzed(), nFrames / 2);
+        for (size_t i = 4 * (nFrames / 2); i < words.size(); i += 4) mixed.addGBTFrame(words[i], words[i+1], words[i+2], words[i+3]);
+        BOOST_CHECK(drain(mixed) == reference);
+      }
+    }
+    std::remove(kFileName.c_str());
+  }
+
+  /// \brief Missing and empty files add no frames
+  BOOST_AUTO_TEST_CASE(GBTFrameContainer_file_test)
+  {
+    GBTFrameContainer container(0, 0, 0);
+    container.addGBTFramesFromBinaryFile("testTPCGBTFrameContainer.missing", "trorc");
+    BOOST_CHECK_EQUAL(container.getNFramesAnalyzed(), 0);
+
+    { std::ofstream file(kFileName, std::ios::binary); }
+    container.addGBTFramesFromBinaryFile(kFileName, "trorc");
+    BOOST_CHECK_EQUAL(container.getNFramesAnalyzed(), 0);
+    std::remove(kFileName.c_str());
+  }
+}
+}
@@ -0,0 +1,176 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTPCHardwareClusterDecoder.cxx
+/// \brief This task tests the decoding of ClusterHardware pages to ClusterNative
+
+#define BOOST_TEST_MODULE Test TPC HardwareClusterDecoder
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TPCReconstruction/HardwareClusterDecoder.h"
+#include "DataFormatsTPC/ClusterHardware.h"
+#include "DataFormatsTPC/Constants.h"
+#include "SimulationDataFormat/MCTruthContainer.h"
+#include "SimulationDataFormat/MCCompLabel.h"
+#include "TPCBase/CRU.h"
+#include "TPCBase/Mapper.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace o2 {
+namespace TPC {
+
+  using MCLabelContainer = o2::dataformats::MCTruthContainer<o2::MCCompLabel>;
+
+  constexpr int kPageSize = 8192;
+
+  /// Pages of 8 kB, each filled with random clusters of a random CRU
+  std::vector<char> makePages(int nPages)
+  {
+    const Mapper& mapper = Mapper::instance();
+    const int maxClusters = (kPageSize - sizeof(ClusterHardwareContainer)) / sizeof(ClusterHardware);
+    std::mt19937 generator(42);
+    std::vector<char> buffer(nPages * kPageSize);
+    for (int p = 0; p < nPages; ++p) {
+      auto* cont = reinterpret_cast<ClusterHardwareContainer*>(&buffer[p * kPageSize]);
+      cont->CRU = generator() % (Constants::MAXSECTOR * CRU::CRUperSector);
+      cont->timeBinOffset = generator() % 100000;
+      cont->numberOfClusters = maxClusters / 2 + generator() % (maxClusters / 2 + 1);
+      const int nRows = mapper.getPadRegionInfo(CRU(cont->CRU).region()).getNumberOfPadRows();
+      for (int k = 0; k < cont->numberOfClusters; ++k) {
+        ClusterHardware& cluster = cont->clusters[k];
+        const float pad = (generator() % 1300) / 10.f;
+        const float time = (generator() % 5000) / 10.f;
+        cluster.qTot = 10 + generator() % 1000;
+        cluster.qMax = generator() % 200;
+        cluster.row = generator() % nRows;
+        cluster.flags = generator() % 4;
+        cluster.padPre = pad * cluster.qTot;
+        cluster.timePre = time * cluster.qTot;
+        cluster.sigmaPad2Pre = (pad * pad + 0.6f) * cluster.qTot * cluster.qTot;
+        cluster.sigmaTime2Pre = (time * time + 0.8f) * cluster.qTot * cluster.qTot;
+      }
+    }
+    return buffer;
+  }
+
+  const ClusterHardwareContainer* getPage(const std::vector<char>& buffer, int page)
+  {
+    return reinterpret_cast<const ClusterHardwareContainer*>(&buffer[page * kPageSize]);
+  }
+
+  /// \brief All clusters are decoded into the sorted buffer of their sector and global row
+  BOOST_AUTO_TEST_CASE(HardwareClusterDecoder_decode_test)
+  {
+    const int nPages = 40;
+    const auto buffer = makePages(nPages);
+    std::vector<std::pair<const ClusterHardwareContainer*, std::size_t>> input = { { getPage(buffer, 0), nPages } };
+
+    std::vector<ClusterNativeContainer> containers;
+    HardwareClusterDecoder decoder;
+    BOOST_REQUIRE_EQUAL(decoder.decodeClusters(input, containers), 0);
+
+    size_t nClusters = 0, nDecoded = 0;
+    const Mapper& mapper = Mapper::instance();
+    for (int p = 0; p < nPages; ++p) {
+      const auto* cont = getPage(buffer, p);
+      const CRU cru(cont->CRU);
+      const int rowOffset = mapper.getPadRegionInfo(cru.region()).getGlobalRowOffset();
+      for (int k = 0; k < cont->numberOfClusters; ++k) {
+        ++nClusters;
+        const ClusterHardware& cluster = cont->clusters[k];
+        const float time = cluster.getTimeLocal() + cont->timeBinOffset;
+        bool found = false;
+        for (const auto& container : containers) {
+          if (container.sector != cru.sector().getSector() || container.globalPadRow != rowOffset + cluster.row) continue;
+          for (const auto& decoded : container.clusters) {
+            if (decoded.qTot != cluster.qTot || decoded.qMax != cluster.qMax || decoded.getFlags() != cluster.flags ||
+                std::abs(decoded.getPad() - cluster.getPad()) > 0.05f || std::abs(decoded.getTime() - time) > 0.05f) continue;
+            found = true;
+            BOOST_CHECK_CLOSE(decoded.getSigmaPad(), std::sqrt(cluster.getSigmaPad2()), 5.);
+            BOOST_CHECK_CLOSE(decoded.getSigmaTime(), std::sqrt(cluster.getSigmaTime2()), 5.);
+            break;
+          }
+        }
+        BOOST_CHECK(found);
+      }
+    }
+    for (const auto& container : containers) {
+      BOOST_CHECK(!container.clusters.empty());
+      nDecoded += container.clusters.size();
+      for (size_t c = 1; c < container.clusters.size(); ++c) {
+        BOOST_CHECK(!ClusterNativeContainer::sortComparison(container.clusters[c], container.clusters[c-1]));
+      }
+    }
+    BOOST_CHECK_EQUAL(nDecoded, nClusters);
+  }
+
+  /// \brief The output is the same for any number of threads, the MC labels stay with their clusters
+  BOOST_AUTO_TEST_CASE(HardwareClusterDecoder_threads_mc_test)
+  {
+    const int nPages = 40;
+    const auto buffer = makePages(nPages);
+
+    // MC labels are only supported for single pages, the track ID encodes the page and the cluster
+    std::vector<std::pair<const ClusterHardwareContainer*, std::size_t>> input;
+    std::vector<MCLabelContainer> inLabels(nPages);
+    for (int p = 0; p < nPages; ++p) {
+      const auto* cont = getPage(buffer, p);
+      input.emplace_back(cont, 1);
+      for (int k = 0; k < cont->numberOfClusters; ++k) {
+        inLabels[p].addElement(k, MCCompLabel(p * 1000 + k, 0));
+        if (k % 3 == 0) inLabels[p].addElement(k, MCCompLabel(p * 1000 + k, 1));
+      }
+    }
+
+    std::vector<ClusterNativeContainer> reference;
+    std::vector<MCLabelContainer> referenceLabels;
+    HardwareClusterDecoder decoder;
+    decoder.setNumThreads(1);
+    BOOST_REQUIRE_EQUAL(decoder.decodeClusters(input, reference, &inLabels, &referenceLabels), 0);
+    BOOST_REQUIRE_EQUAL(referenceLabels.size(), reference.size());
+
+    for (size_t i = 0; i < reference.size(); ++i) {
+      for (size_t c = 0; c < reference[i].clusters.size(); ++c) {
+        const auto labels = referenceLabels[i].getLabels(c);
+        BOOST_REQUIRE(labels.size() > 0);
+        const int page = labels[0].getTrackID() / 1000;
+        const int k = labels[0].getTrackID() % 1000;
+        const ClusterHardware& cluster = getPage(buffer, page)->clusters[k];
+        BOOST_CHECK_EQUAL(reference[i].clusters[c].qTot, cluster.qTot);
+        BOOST_CHECK_EQUAL(reference[i].clusters[c].qMax, cluster.qMax);
+        BOOST_CHECK_EQUAL(labels.size(), (k % 3 == 0) ? 2 : 1);
+      }
+    }
+
+    for (unsigned nThreads : {4u, 64u}) {
+      std::vector<ClusterNativeContainer> containers;
+      std::vector<MCLabelContainer> labels;
+      decoder.setNumThreads(nThreads);
+      BOOST_REQUIRE_EQUAL(decoder.decodeClusters(input, containers, &inLabels, &labels), 0);
+      BOOST_REQUIRE_EQUAL(containers.size(), reference.size());
+      for (size_t i = 0; i < containers.size(); ++i) {
+        BOOST_CHECK_EQUAL(int(containers[i].sector), int(reference[i].sector));
+        BOOST_CHECK_EQUAL(int(containers[i].globalPadRow), int(reference[i].globalPadRow));
+        BOOST_REQUIRE_EQUAL(containers[i].clusters.size(), reference[i].clusters.size());
+        for (size_t c = 0; c < containers[i].clusters.size(); ++c) {
+          BOOST_CHECK_EQUAL(containers[i].clusters[c].getPad(), reference[i].clusters[c].getPad());
+          BOOST_CHECK_EQUAL(containers[i].clusters[c].getTime(), reference[i].clusters[c].getTime());
+          BOOST_CHECK_EQUAL(containers[i].clusters[c].qTot, reference[i].clusters[c].qTot);
+          BOOST_CHECK_EQUAL(labels[i].getLabels(c)[0].getTrackID(), referenceLabels[i].getLabels(c)[0].getTrackID());
+        }
+      }
+    }
+  }
+}
+}
@@ -0,0 +1,109 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTPCHwClusterer.cxx
+/// \brief This task tests the parallel processing of the HwClusterer
+
+#define BOOST_TEST_MODULE Test TPC HwClusterer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TPCReconstruction/HwClusterer.h"
+#include "TPCBase/Digit.h"
+#include "ClustererTestHelpers.h"
+
+#include <cmath>
+#include <vector>
+
+namespace o2 {
+namespace TPC {
+
+  using MCLabelContainer = o2::dataformats::MCTruthContainer<o2::MCCompLabel>;
+
+  /// \brief The clusters and their MC labels are the same for any number of threads
+  BOOST_AUTO_TEST_CASE(HwClusterer_threads_test)
+  {
+    std::vector<Digit> digits;
+    MCLabelContainer digitLabels;
+    makeDigits(digits, digitLabels);
+
+    std::vector<Cluster> referenceClusters;
+    MCLabelContainer referenceLabels;
+    {
+      HwClusterer clusterer(&referenceClusters, &referenceLabels, 0, 39, 0, true, false, false);
+      clusterer.setContinuousReadout(false);
+      clusterer.setNumThreads(1);
+      clusterer.Process(digits, &digitLabels, 0);
+    }
+    BOOST_REQUIRE(!referenceClusters.empty());
+    BOOST_CHECK_EQUAL(referenceLabels.getIndexedSize(), referenceClusters.size());
+
+    for (unsigned nThreads : {2u, 5u, 64u}) {
+      std::vector<Cluster> clusters;
+      MCLabelContainer labels;
+      HwClusterer clusterer(&clusters, &labels, 0, 39, 0, true, false, false);
+      clusterer.setContinuousReadout(false);
+      clusterer.setNumThreads(nThreads);
+
+      // the pool is reused for several calls
+      for (int event = 0; event < 3; ++event) {
+        clusterer.Process(digits, &digitLabels, 0);
+
+        BOOST_REQUIRE_EQUAL(clusters.size(), referenceClusters.size());
+        for (size_t c = 0; c < clusters.size(); ++c) {
+          BOOST_CHECK_EQUAL(clusters[c].getCRU(), referenceClusters[c].getCRU());
+          BOOST_CHECK_EQUAL(clusters[c].getRow(), referenceClusters[c].getRow());
+          BOOST_CHECK_EQUAL(clusters[c].getQ(), referenceClusters[c].getQ());
+          BOOST_CHECK_EQUAL(clusters[c].getPadMean(), referenceClusters[c].getPadMean());
+          BOOST_CHECK_EQUAL(clusters[c].getTimeMean(), referenceClusters[c].getTimeMean());
+
+          const auto reference = referenceLabels.getLabels(c);
+          const auto found = labels.getLabels(c);
+          BOOST_REQUIRE_EQUAL(found.size(), reference.size());
+          for (size_t l = 0; l < found.size(); ++l) {
+            BOOST_CHECK(found[l] == reference[l]);
+          }
+        }
+      }
+    }
+  }
+
+  /// \brief Both input formats of the digits give the same clusters
+  BOOST_AUTO_TEST_CASE(HwClusterer_input_test)
+  {
+    std::vector<Digit> digits;
+    MCLabelContainer digitLabels;
+    makeDigits(digits, digitLabels);
+
+    std::vector<std::unique_ptr<Digit>> digitPointers;
+    for (const auto& digit : digits) {
+      digitPointers.emplace_back(std::make_unique<Digit>(digit));
+    }
+
+    std::vector<Cluster> clusters, clustersFromPointers;
+    MCLabelContainer labels, labelsFromPointers;
+    HwClusterer clusterer(&clusters, &labels, 0, 39, 0, true, false, false);
+    clusterer.setContinuousReadout(false);
+    clusterer.Process(digits, &digitLabels, 0);
+    HwClusterer clustererFromPointers(&clustersFromPointers, &labelsFromPointers, 0, 39, 0, true, false, false);
+    clustererFromPointers.setContinuousReadout(false);
+    clustererFromPointers.Process(digitPointers, &digitLabels, 0);
+
+    BOOST_REQUIRE(!clusters.empty());
+    BOOST_REQUIRE_EQUAL(clustersFromPointers.size(), clusters.size());
+    for (size_t c = 0; c < clusters.size(); ++c) {
+      BOOST_CHECK_EQUAL(clustersFromPointers[c].getQ(), clusters[c].getQ());
+      BOOST_CHECK_EQUAL(clustersFromPointers[c].getPadMean(), clusters[c].getPadMean());
+      BOOST_CHECK_EQUAL(clustersFromPointers[c].getTimeMean(), clusters[c].getTimeMean());
+      BOOST_CHECK_EQUAL(labelsFromPointers.getLabels(c).size(), labels.getLabels(c).size());
+    }
+  }
+}
+}
@@ -0,0 +1,168 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTPCNativeClusterer.cxx
+/// \brief This task tests the NativeClusterer against the HwClusterer
+
+#define BOOST_TEST_MODULE Test TPC NativeClusterer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TPCReconstruction/NativeClusterer.h"
+#include "TPCReconstruction/HwClusterer.h"
+#include "TPCBase/CRU.h"
+#include "TPCBase/Digit.h"
+#include "TPCBase/Mapper.h"
+#include "DataFormatsTPC/Constants.h"
+#include "ClustererTestHelpers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace o2 {
+namespace TPC {
+
+  using MCLabelContainer = o2::dataformats::MCTruthContainer<o2::MCCompLabel>;
+
+  /// Number of clusters in all containers
+  size_t countClusters(const std::vector<ClusterNativeContainer>& containers)
+  {
+    size_t nClusters = 0;
+    for (const auto& container : containers) nClusters += container.clusters.size();
+    return nClusters;
+  }
+
+  /// \brief The clusters are the ones of the HwClusterer, written into the containers of their pad rows
+  BOOST_AUTO_TEST_CASE(NativeClusterer_hwclusterer_test)
+  {
+    std::vector<Digit> digits;
+    MCLabelContainer digitLabels;
+    makeDigits(digits, digitLabels);
+
+    std::vector<Cluster> hwClusters;
+    HwClusterer hwClusterer(&hwClusters, nullptr, 0, 39, 0, true, false, false);
+    hwClusterer.setContinuousReadout(false);
+    hwClusterer.Process(digits, nullptr, 0);
+
+    std::vector<ClusterNativeContainer> containers;
+    std::vector<MCLabelContainer> labels;
+    NativeClusterer clusterer(&containers, &labels);
+    clusterer.setContinuousReadout(false);
+    clusterer.Process(digits, &digitLabels, 0);
+
+    BOOST_REQUIRE(!hwClusters.empty());
+    BOOST_CHECK_EQUAL(countClusters(containers), hwClusters.size());
+
+    const Mapper& mapper = Mapper::instance();
+    for (const auto& hwCluster : hwClusters) {
+      const CRU cru(hwCluster.getCRU());
+      const int row = mapper.getGlobalRowOffsetRegion(cru.region()) + hwCluster.getRow();
+      const int rowIndex = cru.sector().getSector() * Constants::MAXGLOBALPADROW + row;
+      const auto& container = containers[rowIndex];
+      BOOST_CHECK_EQUAL(int(container.sector), int(cru.sector().getSector()));
+      BOOST_CHECK_EQUAL(int(container.globalPadRow), row);
+
+      bool found = false;
+      for (size_t c = 0; c < container.clusters.size(); ++c) {
+        const auto& cluster = container.clusters[c];
+        if (std::abs(cluster.getPad() - hwCluster.getPadMean()) > 0.05f ||
+            std::abs(cluster.getTime() - hwCluster.getTimeMean()) > 0.05f) continue;
+        found = true;
+        BOOST_CHECK_CLOSE(float(cluster.qTot), hwCluster.getQ(), 1.);
+        BOOST_CHECK_CLOSE(float(cluster.qMax), hwCluster.getQmax(), 1.);
+        BOOST_CHECK_EQUAL(labels[rowIndex].getLabels(c).size(), 1);
+      }
+      BOOST_CHECK(found);
+    }
+
+    // clusters in each row are sorted for the tracking
+    for (const auto& container : containers) {
+      for (size_t c = 1; c < container.clusters.size(); ++c) {
+        BOOST_CHECK(!ClusterNativeContainer::sortComparison(container.clusters[c], container.clusters[c-1]));
+      }
+    }
+
+    const auto access = clusterer.getClusterAccess();
+    size_t nAccessClusters = 0;
+    for (int sector = 0; sector < Constants::MAXSECTOR; ++sector) {
+      for (int row = 0; row < Constants::MAXGLOBALPADROW; ++row) nAccessClusters += access->nClusters[sector][row];
+    }
+    BOOST_CHECK_EQUAL(nAccessClusters, hwClusters.size());
+  }
+
+  /// \brief The clusters are the same for any number of threads and in continuous readout split into time windows
+  BOOST_AUTO_TEST_CASE(NativeClusterer_stream_test)
+  {
+    std::vector<Digit> digits;
+    MCLabelContainer digitLabels;
+    makeDigits(digits, digitLabels);
+
+    std::vector<ClusterNativeContainer> reference;
+    {
+      NativeClusterer clusterer(&reference);
+      clusterer.setContinuousReadout(false);
+      clusterer.setNumThreads(1);
+      clusterer.Process(digits, nullptr, 0);
+    }
+    BOOST_REQUIRE(countClusters(reference) > 0);
+
+    auto checkEqual = [&reference](const std::vector<ClusterNativeContainer>& containers) {
+      BOOST_REQUIRE_EQUAL(containers.size(), reference.size());
+      for (size_t row = 0; row < containers.size(); ++row) {
+        BOOST_REQUIRE_EQUAL(containers[row].clusters.size(), reference[row].clusters.size());
+        for (size_t c = 0; c < containers[row].clusters.size(); ++c) {
+          const auto& cluster = containers[row].clusters[c];
+          const auto& referenceCluster = reference[row].clusters[c];
+          BOOST_CHECK_EQUAL(cluster.getPad(), referenceCluster.getPad());
+          BOOST_CHECK_EQUAL(cluster.getTime(), referenceCluster.getTime());
+          BOOST_CHECK_EQUAL(cluster.qTot, referenceCluster.qTot);
+          BOOST_CHECK_EQUAL(cluster.qMax, referenceCluster.qMax);
+        }
+      }
+    };
+
+    for (unsigned nThreads : {4u, 64u}) {
+      std::vector<ClusterNativeContainer> containers;
+      NativeClusterer clusterer(&containers);
+      clusterer.setContinuousReadout(false);
+      clusterer.setNumThreads(nThreads);
+      clusterer.Process(digits, nullptr, 0);
+      checkEqual(containers);
+    }
+
+    // the time windows end within the clusters
+    std::vector<Digit> firstWindow, secondWindow;
+    for (const auto& digit : digits) {
+      if (digit.getTimeStamp() <= 43) firstWindow.push_back(digit);
+      else secondWindow.push_back(digit);
+    }
+    std::vector<ClusterNativeContainer> containers;
+    std::vector<ClusterNativeContainer> collected(reference.size());
+    NativeClusterer clusterer(&containers);
+    clusterer.setContinuousReadout(true);
+    auto collect = [&containers, &collected]() {
+      for (size_t row = 0; row < containers.size(); ++row) {
+        collected[row].clusters.insert(collected[row].clusters.end(), containers[row].clusters.begin(), containers[row].clusters.end());
+      }
+    };
+    clusterer.Process(firstWindow, nullptr, 0);
+    collect();
+    clusterer.Process(secondWindow, nullptr, 1);
+    collect();
+    clusterer.finishStream();
+    collect();
+    for (auto& container : collected) {
+      std::stable_sort(container.clusters.begin(), container.clusters.end(), ClusterNativeContainer::sortComparison);
+    }
+    checkEqual(collected);
+  }
+}
+}
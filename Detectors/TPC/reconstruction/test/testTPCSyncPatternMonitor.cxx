@@ -21,6 +21,7 @@
 #include <vector>
 #include <iostream>
 #include <iomanip>
+#include <random>
 
 namespace o2 {
 namespace TPC {
@@ -115,5 +116,61 @@ namespace TPC {
     }
   }
 
+
+  /// @brief Test 4 random streams of pattern words, the check of 4 half words at once gives the result of checking word by word
+  BOOST_AUTO_TEST_CASE(SyncPatternMonitor_test4)
+  {
+    SyncPatternMonitor mon;
+    const std::vector<short> SYNC_PATTERN {
+      mon.getPatternA(),mon.getPatternA(), mon.getPatternB(), mon.getPatternB(),
+      mon.getPatternA(),mon.getPatternA(), mon.getPatternB(), mon.getPatternB(),
+      mon.getPatternA(),mon.getPatternA(), mon.getPatternB(), mon.getPatternB(),
+      mon.getPatternA(),mon.getPatternA(), mon.getPatternB(), mon.getPatternB(),
+      mon.getPatternA(),mon.getPatternA(), mon.getPatternA(), mon.getPatternA(),
+      mon.getPatternB(),mon.getPatternB(), mon.getPatternB(), mon.getPatternB(),
+      mon.getPatternA(),mon.getPatternA(), mon.getPatternA(), mon.getPatternA(),
+      mon.getPatternB(),mon.getPatternB(), mon.getPatternB(), mon.getPatternB()
+    };
+
+    // word by word reference of the pattern search
+    struct Reference {
+      const std::vector<short>& pattern;
+      short syncStart;
+      short position;
+      short found;
+      void checkWord(short hw, short pos) {
+        if (hw == pattern[position]) ++position;
+        else if (! (position == syncStart+2 && hw == pattern[position-1])) position = syncStart;
+        if (position == 32) {
+          found = pos;
+          position = syncStart;
+        }
+      }
+    };
+
+    std::mt19937 generator(7);
+    for (int stream = 0; stream < 20; ++stream) {
+      // mostly pattern words, such that the pattern search is often in progress, with complete patterns at random positions
+      std::vector<short> words;
+      while (words.size() < 4000) {
+        if (generator() % 50 == 0) {
+          words.insert(words.end(), SYNC_PATTERN.begin() + mon.getSyncStart(), SYNC_PATTERN.end());
+        } else {
+          const unsigned r = generator() % 3;
+          words.push_back(r == 0 ? mon.getPatternA() : (r == 1 ? mon.getPatternB() : static_cast<short>(generator() % 32)));
+        }
+      }
+
+      mon.reset();
+      Reference ref{SYNC_PATTERN, mon.getSyncStart(), mon.getSyncStart(), -1};
+      for (size_t i = 0; i + 4 <= words.size(); i += 4) {
+        mon.addSequence(words[i],words[i+1],words[i+2],words[i+3]);
+        ref.checkWord(words[i],1); ref.checkWord(words[i+1],2);
+        ref.checkWord(words[i+2],3); ref.checkWord(words[i+3],0);
+        BOOST_REQUIRE_EQUAL(mon.getPosition(),ref.found);
+      }
+    }
+  }
+
 }
 }
@@ -26,8 +26,9 @@
 
 #include "Vc/Vc"
 
+#include "TPCBase/CalDet.h"
 #include "TPCBase/PadSecPos.h"
-#include "TPCBase/RandomRing.h"
+#include "TPCBase/RandomStream.h"
 
 using float_v = Vc::float_v;
 
@@ -45,13 +46,51 @@ class Baseline {
     };
 
     /// Default constructor
-    Baseline() : mBaselineType{BaselineType::Random}, mMeanNoise{0.8}, mMeanPedestal{70}, mPedestalSpread{10}, mRandomNoiseRing(RandomRing::RandomType::Gaus) {};
+    Baseline() : mBaselineType{BaselineType::Random}, mMeanNoise{0.8}, mMeanPedestal{70}, mPedestalSpread{10}, mRandomNoise(RandomStream::RandomType::Gaus),
+                 mPedestalMap(PadSubset::Region), mNoiseMap(PadSubset::Region), mVersion{0} { initMaps(); };
 
     /// setter for mean noise
     void setMeanNoise(float meanNoise)
     {
         mMeanNoise = meanNoise;
+        initMaps();
     }
+
+    /// setter for the mean pedestal and its spread
+    /// @param [in] meanPedestal average pedestal value
+    /// @param [in] pedestalSpread spread of the pedestal values
+    void setMeanPedestal(float meanPedestal, float pedestalSpread)
+    {
+        mMeanPedestal = meanPedestal;
+        mPedestalSpread = pedestalSpread;
+        initMaps();
+    }
+
+    /// Set the pad-wise pedestals, e.g. from the calibration data base
+    /// The BaselineType is changed to DataBase
+    /// @param [in] pedestals pedestal map of any pad subset type
+    void setPedestalMap(const CalPad& pedestals);
+
+    /// Set the pad-wise noise, e.g. from the calibration data base
+    /// The BaselineType is changed to DataBase
+    /// @param [in] noise noise map of any pad subset type
+    void setNoiseMap(const CalPad& noise);
+
+    /// Pad-wise pedestals
+    /// The map is organised in pad regions, such that the values of the pads of one CRU are contiguous
+    /// @return pedestal map
+    const CalPad& getPedestalMap() const { return mPedestalMap; }
+
+    /// Pad-wise noise
+    /// The map is organised in pad regions, such that the values of the pads of one CRU are contiguous
+    /// @return noise map
+    const CalPad& getNoiseMap() const { return mNoiseMap; }
+
+    /// Version of the pedestal and noise maps, changed with every modification of the maps
+    /// Users holding copies of the maps compare it to decide whether to update them
+    /// @return version of the maps
+    unsigned int getVersion() const { return mVersion; }
+
     /// Noise for specific pad in a sector, for configured BaselineType
     /// @param [in] padSecPos sector, pad and row information
     /// @return noise value for specific pad
@@ -73,7 +112,10 @@ class Baseline {
     float         mMeanNoise;       ///< Average value for random noise generation
     float         mMeanPedestal;    ///< Average pedestal value
     float         mPedestalSpread;  ///< Spread of the pedestal values
-    RandomRing    mRandomNoiseRing; ///< Ring with random number for noise
+    RandomStream  mRandomNoise;     ///< Stream of random numbers for noise
+    CalPad        mPedestalMap;     ///< Pad-wise pedestals per pad region
+    CalPad        mNoiseMap;        ///< Pad-wise noise per pad region
+    unsigned int  mVersion;         ///< Version of the maps, incremented with every modification
 
 
     // =========================================================================
@@ -86,6 +128,14 @@ class Baseline {
     /// disallow assignment operator
     void operator=(const Baseline &) {}
 
+    /// Fill the pedestal and noise maps for the BaselineType Random
+    void initMaps();
+
+    /// Copy a map into a map organised in pad regions
+    /// @param [in] input map of any pad subset type
+    /// @param [out] output map organised in pad regions
+    static void copyMap(const CalPad& input, CalPad& output);
+
     /// Radom noise value with sigma mMeanNoise
     /// @return Radom noise value with sigma mMeanNoise
     float getRandomNoise();
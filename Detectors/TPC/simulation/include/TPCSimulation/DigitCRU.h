@@ -15,22 +15,32 @@
 #ifndef ALICEO2_TPC_DigitCRU_H_
 #define ALICEO2_TPC_DigitCRU_H_
 
-#include "TPCSimulation/DigitTime.h"
+#include "TPCBase/CRU.h"
+#include "TPCBase/RandomStream.h"
 #include "TPCSimulation/CommonModeContainer.h"
+#include "SimulationDataFormat/MCTruthContainer.h"
+#include "SimulationDataFormat/MCCompLabel.h"
 
-#include <deque>
+#include <utility>
+#include <vector>
 
 namespace o2 {
 namespace TPC {
 
+class Digit;
+class DigitMCMetaData;
+
 /// \class DigitCRU
-/// This is the second class of the intermediate Digit Containers, in which all incoming electrons from the hits are sorted into after amplification
-/// The structure assures proper sorting of the Digits when later on written out for further processing.
-/// This class holds the Time Bin containers and is contained within the Digit Container.
+/// This is the intermediate Digit Container of one CRU, in which all incoming electrons from the hits are sorted into after amplification
+/// The charges are accumulated in a ring buffer of time bins, each time bin holding a dense array with the charge of all pads of the CRU.
+/// The MC labels are kept in a side table per time bin, linked from the pads.
+/// Writing out the digits is a linear sweep over the time bins and pads, which assures proper sorting of the Digits.
+/// The conversion to ADC counts is done for all pads of a time bin at once, using the pedestal and noise maps of the CRU.
+/// The maps are copied from the Baseline of the SAMPAProcessing and updated at the read out whenever the Baseline was modified.
 
 class DigitCRU{
   public:
-    
+
     /// Constructor
     /// \param mCRU CRU ID
     DigitCRU(int mCRU, CommonModeContainer &commonModeCont);
@@ -42,28 +52,29 @@ class DigitCRU{
     void reset();
 
     /// Get the number of entries in the container
-    /// \return Number of entries in the time bin container
+    /// \return Number of time bins with signal
     int getNentries() const;
 
     /// Get the size of the container
-    /// \return Size of the time bin container
+    /// \return Number of time bins in the ring buffer
     size_t getSize() const {return mTimeBins.size();}
 
-    /// Get the container
-    /// \return container
-    const std::deque<std::unique_ptr<DigitTime>>& getTimeBinContainer() const { return mTimeBins; }
-
     /// Get the CRU ID
     /// \return CRU ID
     int getCRUID() const {return mCRU;}
 
-    /// Add digit to the row container
+    /// Get the memory allocated by the container
+    /// \return Allocated memory in bytes
+    size_t getMemoryUsage() const;
+
+    /// Add digit to the container
+    /// \param eventID MC Event ID
     /// \param hitID MC Hit ID
     /// \param timeBin Time bin of the digit
     /// \param row Pad row of digit
     /// \param pad Pad of digit
     /// \param charge Charge of the digit
-    void setDigit(size_t hitID, int timeBin, int row, int pad, float charge);
+    void setDigit(size_t eventID, size_t hitID, int timeBin, int row, int pad, float charge);
 
     /// Fill output vector
     /// \param output Output container
@@ -73,43 +84,70 @@ class DigitCRU{
     /// \param eventTime time stamp of the event
     /// \param isContinuous Switch for continuous readout
     void fillOutputContainer(std::vector<o2::TPC::Digit> *output, o2::dataformats::MCTruthContainer<o2::MCCompLabel> &mcTruth,
-			     std::vector<o2::TPC::DigitMCMetaData> *debug, int cru, int eventTime=0, bool isContinuous=true);
+                             std::vector<o2::TPC::DigitMCMetaData> *debug, int cru, int eventTime=0, bool isContinuous=true);
 
   private:
-    int                    mFirstTimeBin;
-    int                    mEffectiveTimeBin;
-    int                    mNTimeBins;        ///< Maximal number of time bins in that CRU
+    /// MC label of a pad, the labels of a pad form a singly linked list
+    struct MCLabelEntry {
+      MCCompLabel label;  ///< MC label
+      int nOccurrences;   ///< Number of signals with this label
+      int next;           ///< Index of the next label of the same pad, -1 for the last one
+    };
+
+    /// One time bin of the ring buffer
+    struct TimeBin {
+      int timeBin = -1;                  ///< Time bin stored in this slot, -1 if the slot is empty
+      std::vector<float> charge;         ///< Accumulated charge per pad, padded to full Vc vectors
+      std::vector<int> firstLabel;       ///< Index of the first MC label per pad, -1 if the pad has no signal
+      std::vector<MCLabelEntry> labels;  ///< MC labels of all pads in this time bin
+    };
+
+    /// Enlarge the ring buffer such that it holds timeBin
+    /// \param timeBin Time bin to be stored
+    void growRingBuffer(int timeBin);
+
+    /// Copy the pedestal and noise maps of the CRU from the Baseline
+    void updateBaseline();
+
+    /// Write out the digits of one time bin and clear it
+    void fillOutputContainer(TimeBin &timeBin, std::vector<o2::TPC::Digit> *output, o2::dataformats::MCTruthContainer<o2::MCCompLabel> &mcTruth,
+                             std::vector<o2::TPC::DigitMCMetaData> *debug, int cru);
+
+    int                    mFirstTimeBin;     ///< First time bin which has not been written out yet
+    int                    mLastTimeBin;      ///< Last time bin with signal
+    int                    mNTimeBins;        ///< Initial number of time bins in the ring buffer
     unsigned short         mCRU;              ///< CRU of the ADC value
-    std::deque<std::unique_ptr<DigitTime>> mTimeBins;         ///< Time bin Container for the ADC value
+    size_t                 mReadout;          ///< Number of triggered read outs, part of the key of the noise
+    unsigned int           mBaselineVersion;  ///< Version of the Baseline the pedestal and noise maps were copied from
+    std::vector<int>       mRowOffset;        ///< Index of the first pad of each row in the dense pad arrays
+    std::vector<unsigned char> mPadRow;       ///< Row of each pad in the dense pad arrays
+    std::vector<unsigned char> mPadInRow;     ///< Pad number in the row of each pad in the dense pad arrays
+    std::vector<float>     mPedestal;         ///< Pedestal of each pad, padded to full Vc vectors
+    std::vector<float>     mNoise;            ///< Noise of each pad, padded to full Vc vectors
+    std::vector<float>     mADC;              ///< Buffer for the ADC values of one time bin
+    std::vector<float>     mNoiseValue;       ///< Buffer for the noise values of one time bin, for the debug output
+    RandomStream           mRandomNoise;      ///< Stream of random numbers for the noise
+    std::vector<TimeBin>   mTimeBins;         ///< Ring buffer of time bins, time bin t is stored at t % size
+    std::vector<std::pair<MCCompLabel, int>> mLabelBuffer; ///< Buffer to sort the MC labels of one pad
     CommonModeContainer    &mCommonModeContainer; ///< Reference to the common mode container
 };
-    
+
 inline
-DigitCRU::DigitCRU(int CRU, CommonModeContainer &commonModeCont)
-  : mFirstTimeBin(0),
-    mEffectiveTimeBin(0),
-    mNTimeBins(500),
-    mCRU(CRU),
-    mTimeBins(),
-    mCommonModeContainer(commonModeCont)
-{}
-    
-inline 
 void DigitCRU::reset()
 {
-//  for(auto &aTime : mTimeBins) {
-//    if(aTime == nullptr) continue;
-//    aTime->reset();
-//  }
-  mTimeBins.clear();
+  for(auto &aTime : mTimeBins) {
+    aTime = TimeBin();
+  }
+  mFirstTimeBin = 0;
+  mLastTimeBin = -1;
 }
-    
-inline 
+
+inline
 int DigitCRU::getNentries() const
 {
   int counter = 0;
   for(auto &aTime : mTimeBins) {
-    if(aTime == nullptr) continue;
+    if(aTime.timeBin < 0) continue;
     ++counter;
   }
   return counter;
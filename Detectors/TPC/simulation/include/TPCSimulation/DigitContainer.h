@@ -19,6 +19,11 @@
 #include "TPCSimulation/DigitCRU.h"
 #include "TPCSimulation/CommonModeContainer.h"
 
+#include "FairRootManager.h"
+
+#include <array>
+#include <memory>
+
 namespace o2 {
 namespace TPC {
 
@@ -49,7 +54,12 @@ class DigitContainer{
     /// \return Number of entries in the CRU container
     int getNentries() const;
 
+    /// Get the memory allocated by the CRU containers
+    /// \return Allocated memory in bytes
+    size_t getMemoryUsage() const;
+
     /// Add digit to the container
+    /// The MC event ID is taken from the current entry of the FairRootManager
     /// \param hitID MC Hit ID
     /// \param cru CRU of the digit
     /// \param row Pad row of digit
@@ -58,6 +68,16 @@ class DigitContainer{
     /// \param charge Charge of the digit
     void addDigit(size_t hitID, int cru, int timeBin, int row, int pad, float charge);
 
+    /// Add digit to the container
+    /// \param eventID MC Event ID
+    /// \param hitID MC Hit ID
+    /// \param cru CRU of the digit
+    /// \param row Pad row of digit
+    /// \param pad Pad of digit
+    /// \param timeBin Time bin of the digit
+    /// \param charge Charge of the digit
+    void addDigit(size_t eventID, size_t hitID, int cru, int timeBin, int row, int pad, float charge);
+
     /// Fill output vector
     /// \param output Output container
     /// \param mcTruth MC Truth container
@@ -100,6 +120,17 @@ int DigitContainer::getNentries() const
   return counter;
 }
 
+inline
+size_t DigitContainer::getMemoryUsage() const
+{
+  size_t memory = 0;
+  for(auto &aCRU : mCRU) {
+    if(aCRU == nullptr) continue;
+    memory += aCRU->getMemoryUsage();
+  }
+  return memory;
+}
+
 }
 }
 
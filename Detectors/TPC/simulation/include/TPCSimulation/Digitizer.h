@@ -16,6 +16,9 @@
 #define ALICEO2_TPC_Digitizer_H_
 
 #include "TPCSimulation/DigitContainer.h"
+#include "TPCSimulation/ElectronCloud.h"
+#include "TPCSimulation/ElectronTransport.h"
+#include "TPCSimulation/GEMAmplification.h"
 #include "TPCSimulation/PadResponse.h"
 #include "TPCSimulation/Point.h"
 #include "TPCBase/ParameterDetector.h"
@@ -23,8 +26,10 @@
 #include "TPCBase/ParameterGas.h"
 
 #include "TPCBase/Mapper.h"
+#include "TPCBase/Sector.h"
 
 #include <cmath>
+#include <memory>
 
 using std::vector;
 
@@ -68,11 +73,57 @@ class Digitizer {
     /// Initializer
     void init();
 
+    /// Create an independent copy of an initialized digitizer
+    /// The copy has its own random streams and no digit container.
+    /// It is used to process several sectors in parallel.
+    /// \return copy of the digitizer
+    std::unique_ptr<Digitizer> clone() const;
+
     /// Steer conversion of points to digits
     /// \param points Container with TPC points
     /// \return digits container
     DigitContainer* Process(const std::vector<o2::TPC::HitGroup>& hits, float eventTime);
 
+    /// Signal which is to be added to a different container than the one being filled
+    struct ForeignSignal {
+      int trackID;  ///< MC track ID
+      int cru;      ///< CRU of the signal
+      int timeBin;  ///< Time bin of the signal
+      int row;      ///< Pad row of the signal
+      int pad;      ///< Pad of the signal
+      float charge; ///< Charge of the signal
+    };
+
+    /// Steer conversion of the points of one sector to digits
+    /// Only the state of this Digitizer and the given containers is modified, such that several
+    /// Digitizers can process different sectors in parallel.
+    /// \param container Container to which the signal is added
+    /// \param hits Container with TPC points of the sector
+    /// \param sector Sector the hits belong to
+    /// \param eventTime Time of the event in us
+    /// \param eventID MC event ID used for the labels
+    /// \param foreignSignals If not nullptr, signals which due to diffusion end up in another sector are stored here instead of in the container
+    void Process(DigitContainer &container, const std::vector<o2::TPC::HitGroup>& hits, const Sector &sector, float eventTime,
+                 int eventID, std::vector<ForeignSignal> *foreignSignals = nullptr);
+
+    /// Drift, diffusion, attachment and GEM amplification of the electrons of the hits of one sector
+    /// The result does not depend on the time of the collision and can be shaped into digits with replay
+    /// for any interaction time, e.g. when an event is used several times as pile-up background.
+    /// \param cloud Electron cloud which is filled, previous content is removed
+    /// \param hits Container with TPC points of the sector
+    /// \param sector Sector the hits belong to
+    /// \param eventID MC event ID, used for the random streams and the labels
+    void transport(ElectronCloud &cloud, const std::vector<o2::TPC::HitGroup>& hits, const Sector &sector, int eventID);
+
+    /// Shaping of the electrons of a cloud into digits for a given interaction time
+    /// Only the state of this Digitizer and the given containers is modified, such that several
+    /// Digitizers can process different sectors in parallel.
+    /// \param container Container to which the signal is added
+    /// \param cloud Electron cloud from transport
+    /// \param eventTime Time of the event in us
+    /// \param foreignSignals If not nullptr, signals which due to diffusion end up in another sector than the one of the cloud are stored here instead of in the container
+    void replay(DigitContainer &container, const ElectronCloud &cloud, float eventTime, std::vector<ForeignSignal> *foreignSignals = nullptr);
+
     DigitContainer *getDigitContainer() const { return mDigitContainer; }
 
     /// Enable the debug output after application of the PRF
@@ -122,6 +173,31 @@ class Digitizer {
     Digitizer &operator=(const Digitizer &);
 
     DigitContainer          *mDigitContainer;   ///< Container for the Digits
+    std::unique_ptr<GEMAmplification>  mGEMAmplification;  ///< Amplification in the GEM stack
+    std::unique_ptr<ElectronTransport> mElectronTransport; ///< Drift and diffusion of the electrons
+    std::vector<float>      mSignalArray;       ///< Buffer for the shaped signal
+    std::vector<float, Vc::Allocator<float>> mElectronX;    ///< x positions of the electrons of one hit after the drift
+    std::vector<float, Vc::Allocator<float>> mElectronY;    ///< y positions of the electrons of one hit after the drift
+    std::vector<float, Vc::Allocator<float>> mElectronZ;    ///< z positions of the electrons of one hit after the drift
+    std::vector<float, Vc::Allocator<float>> mElectronTime; ///< Drift times of the electrons of one hit
+    std::vector<int>        mElectronCRU;       ///< CRUs of the electrons of one hit, -1 if not on a pad
+    std::vector<int>        mElectronRow;       ///< Pad rows of the electrons of one hit
+    std::vector<int>        mElectronPad;       ///< Pads of the electrons of one hit
+    std::vector<float>      mElectronPadFraction; ///< Positions inside the pad along the row of the electrons of one hit
+    std::vector<float>      mElectronRowFraction; ///< Positions inside the pad across the row of the electrons of one hit
+    std::vector<int>        mElectronGain;      ///< Number of electrons after the GEM amplification for the electrons of one hit
+
+    /// Charge arriving at a pad within one sub-bin of the shaping table
+    struct ShapingCell {
+      int cru;      ///< CRU of the pad
+      int row;      ///< Pad row
+      int pad;      ///< Pad
+      int timeBin;  ///< Time bin of the arrival of the charge
+      int subBin;   ///< Sub-bin of the shaping table
+      float charge; ///< ADC value of the charge
+    };
+    std::vector<ShapingCell> mShapingCells;     ///< Charge of the electrons of one hit before the shaping
+    ElectronCloud           mElectronCloud;     ///< Electrons of the hits being processed
 
     std::unique_ptr<TTree>  mDebugTreePRF;      ///< Output tree for the output after the PRF
     static bool             mDebugFlagPRF;      ///< Flag for debug output after the PRF
@@ -15,12 +15,16 @@
 #ifndef ALICEO2_TPC_DigitizerTask_H_
 #define ALICEO2_TPC_DigitizerTask_H_
 
+#include <array>
 #include <cstdio>
+#include <memory>
 #include <string>
+#include <vector>
 #include "FairTask.h"
 #include "FairLogger.h"
 #include "TPCSimulation/Digitizer.h"
 #include "TPCBase/Sector.h"
+#include "TPCBase/ThreadPool.h"
 #include "SimulationDataFormat/MCTruthContainer.h"
 
 namespace o2 {
@@ -57,6 +61,12 @@ class DigitizerTask : public FairTask{
     /// Set the maximal number of written out time bins
     /// \param nTimeBinsMax Maximal number of time bins to be written out
     void setMaximalTimeBinWriteOut(int i) { mTimeBinMax = i; }
+
+    /// Set number of parallel threads
+    /// The sectors are distributed over the threads, the result does not depend on the number of threads.
+    /// Each thread uses its own copy of the Digitizer.
+    /// \param threads Number to be set, if 0 hardware default value is used
+    void setNumThreads(unsigned threads) { mThreadPool.setNumThreads(threads); }
       
     /// Digitization
     /// \param option Option
@@ -70,8 +80,31 @@ class DigitizerTask : public FairTask{
     /// \param numberOfEvents number of event times to simulate
     void initBunchTrainStructure(const size_t numberOfEvents);
   private:
-    Digitizer           *mDigitizer;    ///< Digitization process
-    DigitContainer      *mDigitContainer;
+    /// Digitize the hits of all selected sectors, distributing the sectors over the threads
+    /// \param eventTime Time of the event in us
+    /// \param eventID MC event ID
+    void processSectors(float eventTime, int eventID);
+
+    /// Fill the digits of all sectors into the output containers, ordered by CRU
+    /// \param eventTimeBin Time bin up to which the digits are written out
+    void fillOutputContainers(int eventTimeBin);
+
+    /// Get the container of a sector, create it if needed
+    /// \param sector Sector
+    /// \return Digit container of the sector
+    DigitContainer& getSectorContainer(int sector);
+
+    Digitizer           *mDigitizer;    ///< Digitization process, prototype of the per-thread Digitizers
+
+    std::vector<std::unique_ptr<Digitizer>> mThreadDigitizers; ///< Digitizers of the processing threads
+    std::array<std::unique_ptr<DigitContainer>, Sector::MAXSECTOR> mSectorDigitContainers; ///< Digit containers of the individual sectors
+    std::array<std::vector<Digitizer::ForeignSignal>, Sector::MAXSECTOR> mForeignSignals; ///< Signals which diffused out of the processed sector
+    std::vector<int>    mSectors;      ///< Sectors to be processed
+    ThreadPool          mThreadPool;   //!< Parallel processing threads
+
+    double              mProcessingTime = 0.;     ///< Accumulated digitization time in s
+    size_t              mNProcessedEvents = 0;    ///< Number of digitized events
+    size_t              mMaxBufferMemory = 0;     ///< Peak memory of the intermediate digit buffers in bytes
       
     std::vector<o2::TPC::Digit> *mDigitsArray = nullptr;  ///< Array of the Digits, passed from the digitization
     o2::dataformats::MCTruthContainer<o2::MCCompLabel> *mMCTruthArray = nullptr; ///< Array for MCTruth information associated to digits in mDigitsArrray. Passed from the digitization
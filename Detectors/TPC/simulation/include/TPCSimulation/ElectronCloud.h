@@ -0,0 +1,151 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ElectronCloud.h
+/// \brief Definition of the cache of transported and amplified electrons
+
+#ifndef ALICEO2_TPC_ElectronCloud_H_
+#define ALICEO2_TPC_ElectronCloud_H_
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace o2 {
+namespace TPC {
+
+/// \class ElectronCloud
+/// Electrons of the hits of one MC event in one sector after drift, diffusion, attachment and GEM amplification.
+/// None of these steps depends on the time of the collision, hence the cloud can be shaped into digits for any
+/// interaction time (Digitizer::replay) by only shifting the arrival times of the electrons. An event which is
+/// used several times as pile-up background is thus transported only once.
+/// The clouds can be written to and read from a compact binary format, several clouds can be stored in one file.
+
+class ElectronCloud {
+  public:
+
+    /// Electrons of one hit
+    struct Hit {
+      int trackID;          ///< MC track ID
+      uint32_t nElectrons;  ///< Number of electrons of the hit stored in the cloud
+    };
+
+    /// Electron arriving at a pad
+    struct Electron {
+      uint16_t cru;         ///< CRU of the pad
+      uint8_t row;          ///< Pad row in the pad region
+      uint8_t pad;          ///< Pad in the row
+      uint16_t padFraction; ///< Position inside the pad along the row in units of 1/65536 of the pad width
+      uint16_t rowFraction; ///< Position inside the pad across the row in units of 1/65536 of the pad height
+      float time;           ///< Arrival time with respect to the collision in us
+      float nElectrons;     ///< Number of electrons after the GEM amplification
+
+      /// \return Position inside the pad along the row in units of the pad width, in [0, 1)
+      float getPadFraction() const { return padFraction * (1.f / 65536.f); }
+
+      /// \return Position inside the pad across the row in units of the pad height, in [0, 1)
+      float getRowFraction() const { return rowFraction * (1.f / 65536.f); }
+    };
+
+    /// Default constructor
+    ElectronCloud() = default;
+
+    /// Remove all electrons and set the source of the cloud
+    /// \param eventID MC event ID of the hits
+    /// \param sector Sector of the hits
+    void reset(int eventID, int sector);
+
+    /// Start a new hit, the electrons added afterwards belong to it
+    /// \param trackID MC track ID of the hit
+    void addHit(int trackID) { mHits.push_back({trackID, 0}); }
+
+    /// Add an electron to the last hit
+    /// \param cru CRU of the pad
+    /// \param row Pad row in the pad region
+    /// \param pad Pad in the row
+    /// \param padFraction Position inside the pad along the row in units of the pad width, in [0, 1)
+    /// \param rowFraction Position inside the pad across the row in units of the pad height, in [0, 1)
+    /// \param time Arrival time with respect to the collision in us
+    /// \param nElectrons Number of electrons after the GEM amplification
+    void addElectron(int cru, int row, int pad, float padFraction, float rowFraction, float time, float nElectrons)
+    {
+      mElectrons.push_back({static_cast<uint16_t>(cru), static_cast<uint8_t>(row), static_cast<uint8_t>(pad),
+                            static_cast<uint16_t>(padFraction * 65536.f), static_cast<uint16_t>(rowFraction * 65536.f), time, nElectrons});
+      ++mHits.back().nElectrons;
+    }
+
+    /// Remove the last hit if it has no electrons
+    void removeEmptyHit()
+    {
+      if(!mHits.empty() && mHits.back().nElectrons == 0) mHits.pop_back();
+    }
+
+    /// \return MC event ID of the hits
+    int getEventID() const { return mEventID; }
+
+    /// \return Sector of the hits
+    int getSector() const { return mSector; }
+
+    /// \return Hits of the cloud, their electrons are stored one after the other
+    const std::vector<Hit>& getHits() const { return mHits; }
+
+    /// \return Electrons of all hits
+    const std::vector<Electron>& getElectrons() const { return mElectrons; }
+
+    /// Get the memory allocated by the cloud
+    /// \return Allocated memory in bytes
+    size_t getMemoryUsage() const { return mHits.capacity() * sizeof(Hit) + mElectrons.capacity() * sizeof(Electron); }
+
+    /// Write the cloud in the binary format
+    /// \param stream Output stream
+    /// \return true if the cloud was written successfully
+    bool write(std::ostream &stream) const;
+
+    /// Read the next cloud in the binary format
+    /// \param stream Input stream
+    /// \return false at the end of the stream or if the data is not valid
+    bool read(std::istream &stream);
+
+    /// Write a set of clouds to a file
+    /// \param fileName Name of the file
+    /// \param clouds Clouds to be written
+    /// \return true if all clouds were written successfully
+    static bool writeToFile(const std::string &fileName, const std::vector<ElectronCloud> &clouds);
+
+    /// Read all clouds of a file
+    /// \param fileName Name of the file
+    /// \param clouds Container to which the clouds are appended
+    /// \return true if the file was read successfully
+    static bool readFromFile(const std::string &fileName, std::vector<ElectronCloud> &clouds);
+
+  private:
+    static constexpr uint32_t Magic = 0x45435054;  ///< "TPCE" in little endian, identifies the binary format
+    static constexpr uint32_t Version = 2;         ///< Version of the binary format
+
+    int mEventID{0};                               ///< MC event ID of the hits
+    int mSector{0};                                ///< Sector of the hits
+    std::vector<Hit> mHits;                        ///< Hits with electrons on the pads
+    std::vector<Electron> mElectrons;              ///< Electrons of all hits
+};
+
+inline
+void ElectronCloud::reset(int eventID, int sector)
+{
+  mEventID = eventID;
+  mSector = sector;
+  mHits.clear();
+  mElectrons.clear();
+}
+
+}
+}
+
+#endif // ALICEO2_TPC_ElectronCloud_H_
@@ -17,7 +17,7 @@
 
 #include "TPCBase/ParameterGas.h"
 
-#include "TPCBase/RandomRing.h"
+#include "TPCBase/RandomStream.h"
 #include "TPCBase/Mapper.h"
 
 namespace o2 {
@@ -42,17 +42,39 @@ class ElectronTransport
     /// \return GlobalPosition3D with position of the electrons after the drift taking into account diffusion
     GlobalPosition3D getElectronDrift(GlobalPosition3D posEle);
 
+    /// Drift of a batch of electrons starting at the same position, taking into account diffusion
+    /// The electrons are processed Vc::float_v::Size at a time.
+    /// \param posEle GlobalPosition3D with start position of the electrons
+    /// \param nElectrons Number of electrons
+    /// \param x Output x positions of the electrons after the drift
+    /// \param y Output y positions of the electrons after the drift
+    /// \param z Output z positions of the electrons after the drift
+    /// The output arrays must be aligned for Vc and hold nElectrons rounded up to a multiple of Vc::float_v::Size entries
+    void getElectronDrift(const GlobalPosition3D &posEle, size_t nElectrons, float *x, float *y, float *z);
+
     /// Attachment probability for a given drift time
     /// \param driftTime Drift time of the electron
     /// \return Boolean whether the electron is attached (and lost) or not
     bool isElectronAttachment(float driftTime);
 
+    /// Attachment probability for a vector of drift times
+    /// \param driftTime Drift times of the electrons
+    /// \return Mask of the electrons which are attached (and lost)
+    float_v::mask_type isElectronAttachment(const float_v &driftTime);
+
+    /// Restart the random streams with keys derived from the event, sector and hit
+    /// Used to obtain reproducible random sequences independent of the processing order
+    /// \param event MC event ID
+    /// \param sector Sector
+    /// \param hit Number of the hit in the sector
+    void setRandomKeys(uint64_t event, uint64_t sector, uint64_t hit);
+
 
   private:
-    /// Circular random buffer containing random values of the Gauss distribution to take into account diffusion of the electrons
-    RandomRing     mRandomGaus;
-    /// Circular random buffer containing flat random values to take into account electron attachement during drift
-    RandomRing     mRandomFlat;
+    /// Random stream of values of the Gauss distribution to take into account diffusion of the electrons
+    RandomStream   mRandomGaus;
+    /// Random stream of flat values to take into account electron attachement during drift
+    RandomStream   mRandomFlat;
 };
 
 inline
@@ -64,6 +86,20 @@ bool ElectronTransport::isElectronAttachment(float driftTime)
   }
   else return false;    /// not attached
 }
+
+inline
+float_v::mask_type ElectronTransport::isElectronAttachment(const float_v &driftTime)
+{
+  const static ParameterGas &gasParam = ParameterGas::defaultInstance();
+  return mRandomFlat.getNextValueVc() < gasParam.getAttachmentCoefficient() * gasParam.getOxygenContent() * driftTime;
+}
+
+inline
+void ElectronTransport::setRandomKeys(uint64_t event, uint64_t sector, uint64_t hit)
+{
+  mRandomGaus.setKey(RandomStream::makeKey(event, sector, hit, 0));
+  mRandomFlat.setKey(RandomStream::makeKey(event, sector, hit, 1));
+}
 }
 }
 
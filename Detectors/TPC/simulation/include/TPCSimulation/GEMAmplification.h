@@ -15,7 +15,9 @@
 #ifndef ALICEO2_TPC_GEMAmplification_H_
 #define ALICEO2_TPC_GEMAmplification_H_
 
-#include "TPCBase/RandomRing.h"
+#include "TPCBase/RandomStream.h"
+
+#include <array>
 
 namespace o2 {
 namespace TPC {
@@ -38,6 +40,12 @@ class GEMAmplification
     /// \param nElectrons Number of electrons arriving at the first amplification stage (GEM1)
     /// \return Number of electrons after amplification in a full stack of four GEM foils
     int getStackAmplification(int nElectrons = 1);
+
+    /// Compute the number of electrons after amplification in a full stack of four GEM foils for a batch of single electrons
+    /// The collection and multiplication in the first GEM are processed Vc::float_v::Size electrons at a time
+    /// \param nElectrons Number of single electrons arriving at the first amplification stage (GEM1)
+    /// \param nElectronsOut Output number of electrons after amplification for each of the incoming electrons
+    void getStackAmplification(size_t nElectrons, int *nElectronsOut);
       
     /// Compute the number of electrons after amplification in a single GEM foil
     /// taking into account collection and extraction efficiencies and fluctuations of the GEM amplification
@@ -59,13 +67,20 @@ class GEMAmplification
     /// \return Number of electrons after amplification in the GEM
     int getGEMMultiplication(int nElectrons, int GEM);
 
+    /// Restart the random streams with keys derived from the event, sector and hit
+    /// Used to obtain reproducible random sequences independent of the processing order
+    /// \param event MC event ID
+    /// \param sector Sector
+    /// \param hit Number of the hit in the sector
+    void setRandomKeys(uint64_t event, uint64_t sector, uint64_t hit);
+
   private:
-    /// Circular random buffer containing random Gaus values for gain fluctuation if the number of electrons is larger (central limit theorem)
-    RandomRing     mRandomGaus;
-    /// Circular random buffer containing flat random values for the collection/extraction
-    RandomRing     mRandomFlat;
-    /// Container with random Polya distributions, one for each GEM in the stack
-    std::array<RandomRing, 4> mGain;
+    /// Random stream of Gaus values for gain fluctuation if the number of electrons is larger (central limit theorem)
+    RandomStream   mRandomGaus;
+    /// Random stream of flat values for the collection/extraction
+    RandomStream   mRandomFlat;
+    /// Random streams following the Polya distributions, one for each GEM in the stack
+    std::array<RandomStream, 4> mGain;
 };
   
 }
@@ -19,6 +19,10 @@
 
 #include "TPCBase/Mapper.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace o2 {
 namespace TPC {
 
@@ -27,9 +31,30 @@ namespace TPC {
 /// The actual Pad Response Function (PRF) is simulated with Garfield++/COMSOL and dumped to a file.
 /// This file is read by this class and dumped to a TGraph2D for each pad size individually (IROC / OROC1-2 / OROC3).
 /// The pad response is then computed by evaluating this TGraph2D for a given pad size by evaluating the PRF at the electron position with respect to the pad centre.
+///
+/// For the digitization the PRF is tabulated per pad region as kernels of the fraction of the charge induced on the
+/// 3x3 pads around the pad of the electron, in bins of the position of the electron inside its pad. Beyond one
+/// neighbouring pad the PRF is negligible. The kernels are normalized, such that the charge is conserved.
 
 class PadResponse {
   public:
+    /// Number of pads of a kernel in each direction
+    static constexpr int KernelSize = 3;
+
+    /// Number of pads of a kernel
+    static constexpr int KernelCells = KernelSize * KernelSize;
+
+    /// Number of bins of the position inside the pad of the tabulated kernels, in each direction
+    static constexpr int NKernelBins = 16;
+
+    /// Fraction of the charge of an electron induced on a pad
+    struct PadSignal {
+      int cru;       ///< CRU of the pad
+      int row;       ///< Pad row in the pad region
+      int pad;       ///< Pad in the row
+      float weight;  ///< Fraction of the charge
+    };
+
     /// Default constructor
     PadResponse();
 
@@ -48,7 +73,34 @@ class PadResponse {
     /// \return Normalized pad response
     float getPadResponse(GlobalPosition3D posEle, DigitPos digiPadPos) const;
 
+    /// Tabulated fractions of the charge induced on the pads around the pad of an electron
+    /// \param region Pad region of the electron
+    /// \param padFraction Position of the electron inside the pad along the row in units of the pad width, in [0, 1)
+    /// \param rowFraction Position of the electron inside the pad across the row in units of the pad height, in [0, 1)
+    /// \return KernelCells weights, the one of the pad with row offset dRow and pad offset dPad is at (dRow + 1) * KernelSize + dPad + 1
+    const float* getKernel(int region, float padFraction, float rowFraction) const
+    {
+      const int padBin = static_cast<int>(padFraction * NKernelBins);
+      const int rowBin = static_cast<int>(rowFraction * NKernelBins);
+      return &mKernels[((region * NKernelBins + rowBin) * NKernelBins + padBin) * KernelCells];
+    }
+
+    /// Compute the pads with signal due to an electron
+    /// Pads of neighbouring pad regions of the same ROC are taken into account, signals outside the ROC are lost
+    /// \param cru CRU of the electron
+    /// \param row Pad row of the electron in the pad region
+    /// \param pad Pad of the electron
+    /// \param padFraction Position of the electron inside the pad along the row in units of the pad width, in [0, 1)
+    /// \param rowFraction Position of the electron inside the pad across the row in units of the pad height, in [0, 1)
+    /// \param signals Output array of at least KernelCells pads
+    /// \return Number of pads with signal
+    int getPadSignals(int cru, int row, int pad, float padFraction, float rowFraction, PadSignal *signals) const;
+
   private:
+    /// Tabulate the kernels for all pad regions
+    void initKernels();
+
+    std::vector<float> mKernels;       ///< Kernels per pad region and bin of the position inside the pad
     std::unique_ptr<TGraph2D> mIROC;   ///< TGraph2D holding the PRF for the IROC (4x7.5 mm2 pads)
     std::unique_ptr<TGraph2D> mOROC12; ///< TGraph2D holding the PRF for the OROC1 and OROC2 (6x10 mm2 pads)
     std::unique_ptr<TGraph2D> mOROC3;  ///< TGraph2D holding the PRF for the OROC3 (6x15 mm2 pads)
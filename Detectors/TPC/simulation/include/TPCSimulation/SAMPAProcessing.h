@@ -19,10 +19,16 @@
 
 #include "TPCBase/PadSecPos.h"
 #include "TPCBase/ParameterElectronics.h"
+#include "TPCBase/RandomStream.h"
 #include "TPCSimulation/Baseline.h"
 
 #include "TSpline.h"
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
 namespace o2 {
 namespace TPC {
     
@@ -49,22 +55,64 @@ class SAMPAProcessing
     /// For larger input values the SAMPA response is not linear which is taken into account by this function
     /// \param signal Input signal
     /// \return ADC value of the (saturated) SAMPA
-    const float getADCSaturation(const float signal) const;
+    float getADCSaturation(const float signal) const;
 
-    /// Make the full signal including noise and pedestals from the Baseline class
-    /// \param ADCcounts ADC value of the signal (common mode already subtracted)
-    /// \param padSecPos PadSecPos of the signal
-    /// \return ADC value after application of noise, pedestal and saturation
-    static float makeSignal(float ADCcounts, const PadSecPos &padSecPos, float &pedestal, float &noise);
+    /// For larger input values the SAMPA response is not linear which is taken into account by this function (vectorized)
+    /// \param signal Input signal
+    /// \return ADC value of the (saturated) SAMPA
+    Vc::float_v getADCSaturation(const Vc::float_v signal) const;
+
+    /// Make the full signal of all pads of a CRU in one time bin, including common mode, noise, pedestals and saturation
+    /// The ADC values are given after pedestal subtraction, values below the zero suppression threshold are to be discarded
+    /// \param nPads Number of pads, must be a multiple of Vc::float_v::Size
+    /// \param charge ADC value of the signal per pad
+    /// \param commonMode Common mode signal of the CRU in this time bin
+    /// \param pedestal Pedestal per pad
+    /// \param noise Noise per pad
+    /// \param random Stream of gaussian random numbers for the noise
+    /// \param adc Output ADC value per pad
+    /// \param noiseValue If not nullptr, the noise added to each pad is stored here
+    void makeSignal(size_t nPads, const float *charge, float commonMode, const float *pedestal, const float *noise,
+                    RandomStream &random, float *adc, float *noiseValue = nullptr) const;
+
+    /// Get the zero suppression threshold
+    /// \return Zero suppression threshold [ADC counts], only signals above the threshold are written out
+    float getZeroSuppressionThreshold() const { return mZeroSuppressionThreshold; }
+
+    /// Set the zero suppression threshold
+    /// \param threshold Zero suppression threshold [ADC counts]
+    void setZeroSuppressionThreshold(float threshold) { mZeroSuppressionThreshold = threshold; }
+
+    /// Get the baseline, i.e. the pedestal and noise maps
+    /// \return Baseline
+    Baseline& getBaseline() { return mBaseline; }
+    const Baseline& getBaseline() const { return mBaseline; }
 
     /// A delta signal is shaped by the FECs and thus spread over several time bins
     /// This function returns an array with the signal spread into the following time bins
+    /// The pulse shape is interpolated from the shaping table
     /// \param ADCsignal Signal of the incoming charge
     /// \param driftTime t0 of the incoming charge
-    /// \return Array with the shaped signal
-    /// \todo the size of the array should be retrieved from ParameterElectronics::getNShapedPoints()
+    /// \param signalArray Array with the shaped signal, resized to ParameterElectronics::getNShapedPoints()
     static void getShapedSignal(float ADCsignal, float driftTime, std::vector<float> &signalArray);
 
+    /// Split the arrival time of a charge into its time bin and the position within the time bin in units of the shaping table
+    /// The shaped signal is (1-weight) * getShapingTable(subBin) + weight * getShapingTable(subBin+1)
+    /// \param time Arrival time of the charge
+    /// \param timeBin Time bin of the charge
+    /// \param subBin Sub-bin of the shaping table
+    /// \param weight Weight of the sub-bin subBin+1
+    void getSubBin(float time, int &timeBin, int &subBin, float &weight) const;
+
+    /// Get the tabulated pulse shape of a unit ADC signal
+    /// \param subBin Sub-bin of the arrival time of the charge within its time bin, 0 to getNSubBins()
+    /// \return Pointer to the signal in the ParameterElectronics::getNShapedPoints() following time bins
+    const float* getShapingTable(int subBin) const { return &mShapingTable[subBin*mNShapedPoints]; }
+
+    /// Get the number of sub-bins per time bin of the shaping table
+    /// \return Number of sub-bins
+    static constexpr int getNSubBins() { return NSubBins; }
+
     /// Value of the Gamma4 shaping function at a given time (vectorized)
     /// \param time Time of the ADC value with respect to the first bin in the pulse
     /// \param startTime First bin in the pulse
@@ -78,13 +126,29 @@ class SAMPAProcessing
     SAMPAProcessing(const SAMPAProcessing&) {}
     void operator=(const SAMPAProcessing&) {}
 
+    static constexpr int NSubBins = 64;               ///< Number of sub-bins per time bin of the shaping table
+
     std::unique_ptr<TSpline3>   mSaturationSpline;   ///< TSpline3 which holds the saturation curve
+    std::vector<float>          mSaturationX;        ///< Knots of the saturation curve, followed by a sentinel
+    std::vector<float>          mSaturationCoeff[4]; ///< Polynomial coefficients of the saturation curve per knot
+    std::vector<float>          mSaturationLUT;      ///< Knot below the lower edge of each bin of an equidistant grid
+    float                       mSaturationLUTStep;  ///< Bin width of the equidistant grid, at most half the knot distance
+    Baseline                    mBaseline;           ///< Pedestal and noise maps
+    float                       mZeroSuppressionThreshold; ///< Zero suppression threshold [ADC counts]
+    std::vector<float>          mShapingTable;       ///< Pulse shape of a unit signal for NSubBins+1 arrival times within a time bin
+    int                         mNShapedPoints;      ///< Number of time bins of the pulse shape
+
+    /// Fill the shaping table from the Gamma4 shaping function
+    void initShapingTable();
 
     /// Import the saturation curve from a .dat file to a TSpline3
     /// \param file Name of the .dat file
     /// \param spline TSpline3 to which the saturation curve will be written
     /// \return Boolean if succesful or not
     bool importSaturationCurve(std::string file);
+
+    /// Tabulate the polynomial coefficients of the saturation curve for the evaluation with Vc
+    void initSaturationTable();
 };
 
 template<typename T>
@@ -97,28 +161,37 @@ T SAMPAProcessing::getADCvalue(T nElectrons)
 }
 
 inline
-float SAMPAProcessing::makeSignal(float ADCcounts, const PadSecPos& padSecPos, float &pedestal, float &noise)
+float SAMPAProcessing::getADCSaturation(const float signal) const
 {
-  SAMPAProcessing &sampa = SAMPAProcessing::instance();
-  static Baseline baseline;
-  float signal = ADCcounts;
-  /// \todo Pedestal to be implemented in baseline class
-//  pedestal = baseline.getPedestal(padSecPos);
-  noise = baseline.getNoise(padSecPos);
-//  signal += noise;
-//  signal += pedestal;
-  return sampa.getADCSaturation(signal);
+  const static ParameterElectronics &eleParam = ParameterElectronics::defaultInstance();
+  /// The knot is looked up in the equidistant grid, the cubic polynomial of the spline is then evaluated
+  const float maxBin = static_cast<float>(mSaturationLUT.size() - 1);
+  const int bin = static_cast<int>(std::min(std::max(std::floor((signal - mSaturationX[0]) / mSaturationLUTStep), 0.f), maxBin));
+  int knot = static_cast<int>(mSaturationLUT[bin]);
+  if (signal >= mSaturationX[knot + 1]) ++knot;
+  if (signal < mSaturationX[knot] && knot > 0) --knot;
+  const float dx = signal - mSaturationX[knot];
+  const float saturatedSignal = mSaturationCoeff[0][knot] + dx * (mSaturationCoeff[1][knot] + dx * (mSaturationCoeff[2][knot] + dx * mSaturationCoeff[3][knot]));
+  const float adcSaturation = eleParam.getADCSaturation();
+  if(saturatedSignal > adcSaturation-1) return adcSaturation-1;
+  return saturatedSignal;
 }
 
 inline
-const float SAMPAProcessing::getADCSaturation(const float signal) const
+Vc::float_v SAMPAProcessing::getADCSaturation(const Vc::float_v signal) const
 {
+  using IndexType = Vc::float_v::IndexType;
   const static ParameterElectronics &eleParam = ParameterElectronics::defaultInstance();
-  /// \todo Performance of TSpline?
-  const float saturatedSignal = mSaturationSpline->Eval(signal);
-  const float adcSaturation = eleParam.getADCSaturation();
-  if(saturatedSignal > adcSaturation-1) return adcSaturation-1;
-  return saturatedSignal;
+  const Vc::float_v maxBin(static_cast<float>(mSaturationLUT.size() - 1));
+  const Vc::float_v bin = Vc::min(Vc::max(Vc::floor((signal - mSaturationX[0]) / mSaturationLUTStep), Vc::float_v::Zero()), maxBin);
+  Vc::float_v knot(&mSaturationLUT[0], Vc::simd_cast<IndexType>(bin));
+  knot(signal >= Vc::float_v(&mSaturationX[0], Vc::simd_cast<IndexType>(knot + 1.f))) += 1.f;
+  knot(signal < Vc::float_v(&mSaturationX[0], Vc::simd_cast<IndexType>(knot)) && knot > 0.f) -= 1.f;
+  const IndexType index = Vc::simd_cast<IndexType>(knot);
+  const Vc::float_v dx = signal - Vc::float_v(&mSaturationX[0], index);
+  const Vc::float_v saturatedSignal = Vc::float_v(&mSaturationCoeff[0][0], index) + dx * (Vc::float_v(&mSaturationCoeff[1][0], index)
+                                      + dx * (Vc::float_v(&mSaturationCoeff[2][0], index) + dx * Vc::float_v(&mSaturationCoeff[3][0], index)));
+  return Vc::min(saturatedSignal, Vc::float_v(eleParam.getADCSaturation() - 1));
 }
 
 template<typename T>
@@ -15,10 +15,69 @@
 
 #include "TPCSimulation/Baseline.h"
 
+#include "TPCBase/CRU.h"
+#include "TPCBase/Mapper.h"
 #include "TPCBase/PadSecPos.h"
 
+#include <algorithm>
+
 using namespace o2::TPC;
 
+//______________________________________________________________________________
+void Baseline::initMaps()
+{
+  if (mBaselineType != BaselineType::Random) {
+    return;
+  }
+  ++mVersion;
+  // the pedestals are fixed for a given configuration, hence a fixed key per CRU
+  RandomStream random(RandomStream::RandomType::Gaus);
+  for (auto& calArray : mPedestalMap.getData()) {
+    random.setKey(RandomStream::makeKey(0, calArray.getPadSubsetNumber(), 0, 9));
+    for (auto& pedestal : calArray.getData()) {
+      pedestal = mMeanPedestal + mPedestalSpread * random.getNextValue();
+    }
+  }
+  for (auto& calArray : mNoiseMap.getData()) {
+    std::fill(calArray.getData().begin(), calArray.getData().end(), mMeanNoise);
+  }
+}
+
+//______________________________________________________________________________
+void Baseline::copyMap(const CalPad& input, CalPad& output)
+{
+  if (input.getPadSubset() == PadSubset::Region) {
+    output = input;
+    return;
+  }
+  const Mapper& mapper = Mapper::instance();
+  for (auto& calArray : output.getData()) {
+    const CRU cru(calArray.getPadSubsetNumber());
+    const auto& regionInfo = mapper.getPadRegionInfo(cru.region());
+    for (int row = 0; row < regionInfo.getNumberOfPadRows(); ++row) {
+      for (int pad = 0; pad < regionInfo.getPadsInRowRegion(row); ++pad) {
+        calArray.setValue(row, pad, input.getValue(cru, row, pad));
+      }
+    }
+  }
+}
+
+//______________________________________________________________________________
+void Baseline::setPedestalMap(const CalPad& pedestals)
+{
+  mBaselineType = BaselineType::DataBase;
+  copyMap(pedestals, mPedestalMap);
+  ++mVersion;
+}
+
+//______________________________________________________________________________
+void Baseline::setNoiseMap(const CalPad& noise)
+{
+  mBaselineType = BaselineType::DataBase;
+  copyMap(noise, mNoiseMap);
+  ++mVersion;
+}
+
 float Baseline::getNoise(const PadSecPos& padSecPos)
 {
   switch (mBaselineType) {
@@ -59,7 +118,7 @@ float_v Baseline::getNoiseVc(const PadSecPos& padSecPos)
 //______________________________________________________________________________
 float Baseline::getRandomNoise()
 {
-  return mRandomNoiseRing.getNextValue()*mMeanNoise;
+  return mRandomNoise.getNextValue()*mMeanNoise;
 }
 
 //______________________________________________________________________________
@@ -77,7 +136,7 @@ float Baseline::getNoiseFromDataBase(const PadSecPos& padSecPos)
 //______________________________________________________________________________
 float_v Baseline::getRandomNoiseVc()
 {
-  return mRandomNoiseRing.getNextValueVc()*mMeanNoise;
+  return mRandomNoise.getNextValueVc()*mMeanNoise;
 }
 
 //______________________________________________________________________________
@@ -13,57 +13,203 @@
 /// \author Andi Mathis, TU München, andreas.mathis@ph.tum.de
 
 #include "TPCSimulation/DigitCRU.h"
-#include "TPCSimulation/DigitTime.h"
+#include "TPCSimulation/DigitMCMetaData.h"
+#include "TPCSimulation/SAMPAProcessing.h"
+#include "TPCBase/Digit.h"
 #include "TPCBase/Mapper.h"
 
 #include "FairLogger.h"
 
+#include <algorithm>
+
 using namespace o2::TPC;
 
-void DigitCRU::setDigit(size_t hitID, int timeBin, int row, int pad, float charge)
+DigitCRU::DigitCRU(int cru, CommonModeContainer &commonModeCont)
+  : mFirstTimeBin(0),
+    mLastTimeBin(-1),
+    mNTimeBins(500),
+    mCRU(cru),
+    mReadout(0),
+    mBaselineVersion(0),
+    mRowOffset(),
+    mPadRow(),
+    mPadInRow(),
+    mPedestal(),
+    mNoise(),
+    mADC(),
+    mNoiseValue(),
+    mRandomNoise(RandomStream::RandomType::Gaus),
+    mTimeBins(),
+    mLabelBuffer(),
+    mCommonModeContainer(commonModeCont)
 {
-  mEffectiveTimeBin = timeBin - mFirstTimeBin;
-  if(mEffectiveTimeBin < 0.) {
+  const Mapper& mapper = Mapper::instance();
+  const auto& regionInfo = mapper.getPadRegionInfo(CRU(mCRU).region());
+  int nPads = 0;
+  for(int row=0; row<regionInfo.getNumberOfPadRows(); ++row) {
+    mRowOffset.push_back(nPads);
+    for(int pad=0; pad<regionInfo.getPadsInRowRegion(row); ++pad) {
+      mPadRow.push_back(row);
+      mPadInRow.push_back(pad);
+    }
+    nPads += regionInfo.getPadsInRowRegion(row);
+  }
+
+  /// The pad arrays are padded to full Vc vectors
+  const size_t nPadsPadded = (nPads + Vc::float_v::Size - 1) / Vc::float_v::Size * Vc::float_v::Size;
+  mADC.resize(nPadsPadded);
+  mNoiseValue.resize(nPadsPadded);
+  updateBaseline();
+}
+
+void DigitCRU::updateBaseline()
+{
+  /// The pedestal and noise maps of a pad region have the same pad ordering as the dense pad arrays
+  const Baseline& baseline = SAMPAProcessing::instance().getBaseline();
+  const auto& pedestals = baseline.getPedestalMap().getCalArray(mCRU).getData();
+  const auto& noise = baseline.getNoiseMap().getCalArray(mCRU).getData();
+  mPedestal.assign(pedestals.begin(), pedestals.end());
+  mPedestal.resize(mADC.size(), 0.f);
+  mNoise.assign(noise.begin(), noise.end());
+  mNoise.resize(mADC.size(), 0.f);
+  mBaselineVersion = baseline.getVersion();
+}
+
+void DigitCRU::setDigit(size_t eventID, size_t hitID, int timeBin, int row, int pad, float charge)
+{
+  if(timeBin < mFirstTimeBin) {
     LOG(FATAL) << "TPC DigitCRU buffer misaligned ";
     LOG(DEBUG) << "for hit " << hitID << " CRU " <<mCRU << " TimeBin " << timeBin << " First TimeBin " << mFirstTimeBin << " Row " << row << " Pad " << pad;
     LOG(FATAL) << FairLogger::endl;
     return;
   }
-  /// If time bin outside specified range, the range of the vector is extended by one full drift time.
-  while(getSize() <= mEffectiveTimeBin) {
-    mTimeBins.resize(getSize() + mNTimeBins);
+
+  /// If the time bin is outside the range of the ring buffer, it is enlarged
+  if(timeBin - mFirstTimeBin >= static_cast<int>(mTimeBins.size())) {
+    growRingBuffer(timeBin);
+  }
+
+  auto &aTime = mTimeBins[timeBin % mTimeBins.size()];
+  if(aTime.timeBin != timeBin) {
+    /// The buffers of a time bin are allocated on first use and reused afterwards
+    aTime.timeBin = timeBin;
+    if(aTime.charge.empty()) {
+      aTime.charge.resize(mPedestal.size(), 0.f);
+      aTime.firstLabel.resize(mPadRow.size(), -1);
+    }
   }
-  /// Check whether the container at this spot already contains an entry
-  DigitTime *result = mTimeBins[mEffectiveTimeBin].get();
-  if(result != nullptr) {
-    mTimeBins[mEffectiveTimeBin]->setDigit(hitID, mCRU, row, pad, charge);
+  mLastTimeBin = std::max(mLastTimeBin, timeBin);
+
+  const int padIndex = mRowOffset[row] + pad;
+  aTime.charge[padIndex] += charge;
+
+  /// Count the MC label, a pad usually has only very few different labels
+  const MCCompLabel label(hitID, eventID);
+  int *index = &aTime.firstLabel[padIndex];
+  while(*index >= 0) {
+    auto &entry = aTime.labels[*index];
+    if(entry.label == label) {
+      ++entry.nOccurrences;
+      return;
+    }
+    index = &entry.next;
   }
-  else {
-    const Mapper& mapper = Mapper::instance();
-    mTimeBins[mEffectiveTimeBin] = std::make_unique<DigitTime> (timeBin, mapper.getPadRegionInfo(CRU(mCRU).region()).getNumberOfPadRows());
-    mTimeBins[mEffectiveTimeBin]->setDigit(hitID, mCRU, row, pad, charge);
+  *index = aTime.labels.size();
+  aTime.labels.push_back({label, 1, -1});
+}
+
+void DigitCRU::growRingBuffer(int timeBin)
+{
+  size_t size = std::max<size_t>(mTimeBins.size(), mNTimeBins);
+  while(static_cast<int>(size) <= timeBin - mFirstTimeBin) {
+    size *= 2;
+  }
+  std::vector<TimeBin> timeBins(size);
+  for(auto &aTime : mTimeBins) {
+    if(aTime.timeBin < 0) continue;
+    timeBins[aTime.timeBin % size] = std::move(aTime);
   }
+  mTimeBins.swap(timeBins);
+}
+
+size_t DigitCRU::getMemoryUsage() const
+{
+  size_t memory = mTimeBins.capacity() * sizeof(TimeBin)
+                  + (mPedestal.capacity() + mNoise.capacity() + mADC.capacity() + mNoiseValue.capacity()) * sizeof(float);
+  for(auto &aTime : mTimeBins) {
+    memory += aTime.charge.capacity() * sizeof(float) + aTime.firstLabel.capacity() * sizeof(int)
+              + aTime.labels.capacity() * sizeof(MCLabelEntry);
+  }
+  return memory;
 }
 
 void DigitCRU::fillOutputContainer(std::vector<o2::TPC::Digit> *output, o2::dataformats::MCTruthContainer<o2::MCCompLabel> &mcTruth,
                                    std::vector<o2::TPC::DigitMCMetaData> *debug, int cru, int eventTime, bool isContinuous)
 {
-  int nProcessedTimeBins = 0;
-  for(auto &aTime : mTimeBins) {
-    /// the time bins between the last event and the timing of this event are uncorrelated and can be written out
-    /// OR the readout is triggered (i.e. not continuous) and we can dump everything in any case
-    if( ( nProcessedTimeBins + mFirstTimeBin < eventTime ) || !isContinuous) {
-      ++nProcessedTimeBins;
-      if(aTime == nullptr) continue;
-      aTime->fillOutputContainer(output, mcTruth, debug, cru, aTime->getTimeBin(), mCommonModeContainer.getCommonMode(cru, aTime->getTimeBin()));
-    }
-    else break;
+  /// the time bins between the last event and the timing of this event are uncorrelated and can be written out
+  /// OR the readout is triggered (i.e. not continuous) and we can dump everything in any case
+  const int lastTimeBin = isContinuous ? std::min(eventTime, mLastTimeBin + 1) : mLastTimeBin + 1;
+
+  /// the pedestal and noise maps may have been changed since the last read out
+  if(mBaselineVersion != SAMPAProcessing::instance().getBaseline().getVersion()) {
+    updateBaseline();
+  }
+  for(int timeBin = mFirstTimeBin; timeBin < lastTimeBin; ++timeBin) {
+    auto &aTime = mTimeBins[timeBin % mTimeBins.size()];
+    if(aTime.timeBin != timeBin) continue;
+    fillOutputContainer(aTime, output, mcTruth, debug, cru);
   }
-  if(nProcessedTimeBins > 0) {
-    mFirstTimeBin += nProcessedTimeBins;
-    while(nProcessedTimeBins--) {
-      mTimeBins.pop_front();
+  mFirstTimeBin = std::max(mFirstTimeBin, lastTimeBin);
+  if(!isContinuous) {
+    mFirstTimeBin = 0;
+    mLastTimeBin = -1;
+    ++mReadout;
+  }
+}
+
+void DigitCRU::fillOutputContainer(TimeBin &aTime, std::vector<o2::TPC::Digit> *output, o2::dataformats::MCTruthContainer<o2::MCCompLabel> &mcTruth,
+                                   std::vector<o2::TPC::DigitMCMetaData> *debug, int cru)
+{
+  const int timeBin = aTime.timeBin;
+  const float commonMode = mCommonModeContainer.getCommonMode(cru, timeBin);
+  const SAMPAProcessing& sampa = SAMPAProcessing::instance();
+
+  /// The charges of all pads are converted into ADC counts in a single pass, applying common mode, noise, pedestal and saturation of the SAMPA
+  /// The noise only depends on the read out, the CRU and the time bin
+  /// In continuous mode the time bins are unique, in triggered mode they restart with each event and the read out is counted
+  mRandomNoise.setKey(RandomStream::makeKey(mReadout, cru, timeBin, 8));
+  sampa.makeSignal(mADC.size(), aTime.charge.data(), commonMode, mPedestal.data(), mNoise.data(), mRandomNoise, mADC.data(),
+                   (debug != nullptr) ? mNoiseValue.data() : nullptr);
+  const float threshold = sampa.getZeroSuppressionThreshold();
+
+  for(size_t padIndex=0; padIndex<aTime.firstLabel.size(); ++padIndex) {
+    if(aTime.firstLabel[padIndex] < 0) continue;
+    const float adc = mADC[padIndex];
+    if(adc <= threshold) continue;
+
+    /// Sort the MC labels according to their occurrence
+    mLabelBuffer.clear();
+    for(int index = aTime.firstLabel[padIndex]; index >= 0; index = aTime.labels[index].next) {
+      mLabelBuffer.emplace_back(aTime.labels[index].label, aTime.labels[index].nOccurrences);
+    }
+    using P = std::pair<MCCompLabel, int>;
+    std::sort(mLabelBuffer.begin(), mLabelBuffer.end(), [](const P& a, const P& b) { return a.second > b.second;});
+
+    /// Write out the Digit
+    const auto digiPos = output->size();
+    output->emplace_back(cru, adc, mPadRow[padIndex], mPadInRow[padIndex], timeBin); /// create Digit and append to container
+
+    for(auto &mcLabel : mLabelBuffer) {
+      mcTruth.addElement(digiPos, mcLabel.first); /// add MCTruth output
+    }
+    if(debug!=nullptr) {
+      debug->emplace_back(aTime.charge[padIndex], commonMode, mPedestal[padIndex], mNoiseValue[padIndex]); /// create DigitMCMetaData
     }
   }
-  if(!isContinuous) mFirstTimeBin = 0;
+
+  /// Clear the time bin, keeping the allocated buffers for reuse
+  std::fill(aTime.charge.begin(), aTime.charge.end(), 0.f);
+  std::fill(aTime.firstLabel.begin(), aTime.firstLabel.end(), -1);
+  aTime.labels.clear();
+  aTime.timeBin = -1;
 }
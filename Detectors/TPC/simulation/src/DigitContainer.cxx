@@ -19,16 +19,22 @@
 using namespace o2::TPC;
 
 void DigitContainer::addDigit(size_t hitID, int cru, int timeBin, int row, int pad, float charge)
+{
+  static FairRootManager *mgr = FairRootManager::Instance();
+  addDigit(mgr->GetEntryNr(), hitID, cru, timeBin, row, pad, charge);
+}
+
+void DigitContainer::addDigit(size_t eventID, size_t hitID, int cru, int timeBin, int row, int pad, float charge)
 {
   /// Check whether the container at this spot already contains an entry
   DigitCRU *result = mCRU[cru].get();
   if(result != nullptr){
-    mCRU[cru]->setDigit(hitID, timeBin, row, pad, charge);
+    mCRU[cru]->setDigit(eventID, hitID, timeBin, row, pad, charge);
   }
   else{
     const Mapper& mapper = Mapper::instance();
     mCRU[cru] = std::make_unique<DigitCRU>(cru, mCommonModeContainer);
-    mCRU[cru]->setDigit(hitID, timeBin, row, pad, charge);
+    mCRU[cru]->setDigit(eventID, hitID, timeBin, row, pad, charge);
   }
   /// Take care of the common mode
   mCommonModeContainer.addDigit(cru, timeBin, charge);
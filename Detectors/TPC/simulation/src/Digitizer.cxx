@@ -23,6 +23,9 @@
 
 #include "FairLogger.h"
 
+#include <algorithm>
+#include <tuple>
+
 ClassImp(o2::TPC::Digitizer)
 
 using namespace o2::TPC;
@@ -32,6 +35,21 @@ bool o2::TPC::Digitizer::mIsContinuous = true;
 
 Digitizer::Digitizer()
   : mDigitContainer(nullptr),
+    mGEMAmplification(),
+    mElectronTransport(),
+    mSignalArray(),
+    mElectronX(),
+    mElectronY(),
+    mElectronZ(),
+    mElectronTime(),
+    mElectronCRU(),
+    mElectronRow(),
+    mElectronPad(),
+    mElectronPadFraction(),
+    mElectronRowFraction(),
+    mElectronGain(),
+    mShapingCells(),
+    mElectronCloud(),
     mDebugTreePRF(nullptr)
 {}
 
@@ -46,113 +64,236 @@ void Digitizer::init()
   /// \todo get rid of new? check with Mohammad
   mDigitContainer = new DigitContainer();
 
+  if(!mGEMAmplification) {
+    mGEMAmplification = std::make_unique<GEMAmplification>();
+  }
+  if(!mElectronTransport) {
+    mElectronTransport = std::make_unique<ElectronTransport>();
+  }
+
 //  mDebugTreePRF = std::unique_ptr<TTree> (new TTree("PRFdebug", "PRFdebug"));
 //  mDebugTreePRF->Branch("GEMresponse", &GEMresponse, "CRU:timeBin:row:pad:nElectrons");
 }
 
+std::unique_ptr<Digitizer> Digitizer::clone() const
+{
+  auto digitizer = std::make_unique<Digitizer>();
+  if(mGEMAmplification) {
+    digitizer->mGEMAmplification = std::make_unique<GEMAmplification>(*mGEMAmplification);
+  }
+  if(mElectronTransport) {
+    digitizer->mElectronTransport = std::make_unique<ElectronTransport>(*mElectronTransport);
+  }
+  return digitizer;
+}
+
 DigitContainer* Digitizer::Process(const std::vector<o2::TPC::HitGroup>& hits, float eventTime)
 {
-//  mDigitContainer->reset();
+  FairRootManager *mgr = FairRootManager::Instance();
+  /// the hits are not necessarily from a single sector, hence all signals go to the own container
+  Process(*mDigitContainer, hits, Sector(0), eventTime, mgr->GetEntryNr(), nullptr);
+  return mDigitContainer;
+}
+
+void Digitizer::Process(DigitContainer &container, const std::vector<o2::TPC::HitGroup>& hits, const Sector &sector, float eventTime,
+                        int eventID, std::vector<ForeignSignal> *foreignSignals)
+{
+  transport(mElectronCloud, hits, sector, eventID);
+  replay(container, mElectronCloud, eventTime, foreignSignals);
+}
+
+void Digitizer::transport(ElectronCloud &cloud, const std::vector<o2::TPC::HitGroup>& hits, const Sector &sector, int eventID)
+{
   const static Mapper& mapper = Mapper::instance();
   const static ParameterDetector &detParam = ParameterDetector::defaultInstance();
-  const static ParameterElectronics &eleParam = ParameterElectronics::defaultInstance();
-  FairRootManager *mgr = FairRootManager::Instance();
+  const static ParameterGas &gasParam = ParameterGas::defaultInstance();
 
-  // TODO: temporary hack
-  //const float eventTime = ( mIsContinuous) ? mgr->GetEventTime() * 0.001 : 0.f; /// transform in us
-  if (!mIsContinuous) eventTime = 0.f; /// transform in us
+  GEMAmplification &gemAmplification = *mGEMAmplification;
+  ElectronTransport &electronTransport = *mElectronTransport;
 
-  /// \todo static_thread for thread savety?
-  static GEMAmplification gemAmplification;
-  static ElectronTransport electronTransport;
-  static PadResponse padResponse;
+  const float tpcLength = detParam.getTPClength();
+  const float vDrift = gasParam.getVdrift();
 
-  const int nShapedPoints = eleParam.getNShapedPoints();
-  static std::vector<float> signalArray;
-  signalArray.resize(nShapedPoints);
+  cloud.reset(eventID, sector.getSector());
 
-  static size_t hitCounter=0;
+  /// The random streams are restarted for each hit with keys derived from the event, the sector and the number of the hit
+  /// in the sector. The result is thus independent of the order in which sectors and events are processed.
+  uint64_t hitCounter = 0;
   for(auto& inputgroup : hits) {
     //    auto *inputgroup = static_cast<HitGroup*>(pointObject);
     const int MCTrackID = inputgroup.GetTrackID();
     for(size_t hitindex = 0; hitindex < inputgroup.getSize(); ++hitindex){
       const auto& eh = inputgroup.getHit(hitindex);
+      electronTransport.setRandomKeys(eventID, sector.getSector(), hitCounter);
+      gemAmplification.setRandomKeys(eventID, sector.getSector(), hitCounter);
+      ++hitCounter;
 
       const GlobalPosition3D posEle(eh.GetX(), eh.GetY(), eh.GetZ());
 
       // The energy loss stored is really nElectrons
       const int nPrimaryElectrons = static_cast<int>(eh.GetEnergyLoss());
+      if(nPrimaryElectrons <= 0) continue;
+
+      /// All electrons of the hit are processed together, stage by stage, in SoA buffers
+      const size_t nPadded = (nPrimaryElectrons + float_v::Size - 1) / float_v::Size * float_v::Size;
+      mElectronX.resize(nPadded);
+      mElectronY.resize(nPadded);
+      mElectronZ.resize(nPadded);
+      mElectronTime.resize(nPadded);
+
+      /// Drift and Diffusion
+      electronTransport.getElectronDrift(posEle, nPrimaryElectrons, mElectronX.data(), mElectronY.data(), mElectronZ.data());
+
+      /// Attachment and removal of the electrons that end up outside the active volume
+      /// The surviving electrons are moved to the front of the buffers
+      const float_v hitTime(static_cast<float>(eh.GetTime() * 0.001)); /// in us
+      size_t nElectrons = 0;
+      for(size_t i=0; i<nPadded; i+=float_v::Size) {
+        const float_v posX(&mElectronX[i], Vc::Aligned);
+        const float_v posY(&mElectronY[i], Vc::Aligned);
+        const float_v posZ(&mElectronZ[i], Vc::Aligned);
+        const float_v absZ = Vc::abs(posZ);
+        const float_v driftTime = (tpcLength - absZ) / vDrift + hitTime;
+        const float_v::mask_type survives = !electronTransport.isElectronAttachment(driftTime) && (absZ <= tpcLength) &&
+                                            (float_v::IndexesFromZero() + static_cast<float>(i) < static_cast<float>(nPrimaryElectrons));
+        for(size_t lane=0; lane<float_v::Size; ++lane) {
+          if(!survives[lane]) continue;
+          mElectronX[nElectrons] = posX[lane];
+          mElectronY[nElectrons] = posY[lane];
+          mElectronZ[nElectrons] = posZ[lane];
+          mElectronTime[nElectrons] = driftTime[lane];
+          ++nElectrons;
+        }
+      }
 
-      /// Loop over electrons
-      /// \todo can be vectorized?
-      /// \todo split transport and signal formation in two separate loops?
-      for(int iEle=0; iEle < nPrimaryElectrons; ++iEle) {
-
-        /// Drift and Diffusion
-        const GlobalPosition3D posEleDiff = electronTransport.getElectronDrift(posEle);
-
-        /// \todo Time management in continuous mode (adding the time of the event?)
-        const float driftTime = getTime(posEleDiff.Z()) + eh.GetTime() * 0.001; /// in us
-        const float absoluteTime = driftTime + eventTime;
-
-        /// Attachment
-        if(electronTransport.isElectronAttachment(driftTime)) continue;
-
-        /// Remove electrons that end up outside the active volume
-        /// \todo should go to mapper?
-        if(std::abs(posEleDiff.Z()) > detParam.getTPClength()) continue;
+      /// Mapping of the electrons to the pads
+      mElectronCRU.resize(nElectrons);
+      mElectronRow.resize(nElectrons);
+      mElectronPad.resize(nElectrons);
+      mElectronPadFraction.resize(nElectrons);
+      mElectronRowFraction.resize(nElectrons);
+      mapper.findDigitPosFromGlobalPositions(nElectrons, mElectronX.data(), mElectronY.data(), mElectronZ.data(),
+                                             mElectronCRU.data(), mElectronRow.data(), mElectronPad.data(),
+                                             mElectronPadFraction.data(), mElectronRowFraction.data());
+      size_t nElectronsOnPads = 0;
+      for(size_t i=0; i<nElectrons; ++i) {
+        if(mElectronCRU[i] < 0) continue;
+        mElectronCRU[nElectronsOnPads] = mElectronCRU[i];
+        mElectronRow[nElectronsOnPads] = mElectronRow[i];
+        mElectronPad[nElectronsOnPads] = mElectronPad[i];
+        mElectronPadFraction[nElectronsOnPads] = mElectronPadFraction[i];
+        mElectronRowFraction[nElectronsOnPads] = mElectronRowFraction[i];
+        mElectronTime[nElectronsOnPads] = mElectronTime[i];
+        ++nElectronsOnPads;
+      }
 
-        const DigitPos digiPadPos = mapper.findDigitPosFromGlobalPosition(posEleDiff);
-        if(!digiPadPos.isValid()) continue;
+      /// Amplification in the GEM stack
+      mElectronGain.resize(nElectronsOnPads);
+      gemAmplification.getStackAmplification(nElectronsOnPads, mElectronGain.data());
 
-        const int nElectronsGEM = gemAmplification.getStackAmplification();
-        if ( nElectronsGEM ==0 ) continue;
+      /// Only the electrons which make it through the GEM stack are kept
+      cloud.addHit(MCTrackID);
+      for(size_t iEle=0; iEle < nElectronsOnPads; ++iEle) {
+        if(mElectronGain[iEle] == 0) continue;
+        cloud.addElectron(mElectronCRU[iEle], mElectronRow[iEle], mElectronPad[iEle], mElectronPadFraction[iEle],
+                          mElectronRowFraction[iEle], mElectronTime[iEle], mElectronGain[iEle]);
+      }
+      cloud.removeEmptyHit();
+    /// end of loop over electrons
+    }
+  }
+  /// end of loop over points
+}
 
-        /// Loop over all individual pads with signal due to pad response function
-        /// Currently the PRF is not applied yet due to some problems with the mapper
-        /// which results in most of the cases in a normalized pad response = 0
-        /// \todo Problems of the mapper to be fixed
-        /// \todo Mapper should provide a functionality which finds the adjacent pads of a given pad
-        // for(int ipad = -2; ipad<3; ++ipad) {
-        //   for(int irow = -2; irow<3; ++irow) {
-        //     PadPos padPos(digiPadPos.getPadPos().getRow() + irow, digiPadPos.getPadPos().getPad() + ipad);
-        //     DigitPos digiPos(digiPadPos.getCRU(), padPos);
+void Digitizer::replay(DigitContainer &container, const ElectronCloud &cloud, float eventTime,
+                       std::vector<ForeignSignal> *foreignSignals)
+{
+  const static ParameterElectronics &eleParam = ParameterElectronics::defaultInstance();
+  const static SAMPAProcessing &sampa = SAMPAProcessing::instance();
+  const static PadResponse padResponse;
 
-        DigitPos digiPos = digiPadPos;
-        if (!digiPos.isValid()) continue;
-        // const float normalizedPadResponse = padResponse.getPadResponse(posEleDiff, digiPos);
+  // TODO: temporary hack
+  //const float eventTime = ( mIsContinuous) ? mgr->GetEventTime() * 0.001 : 0.f; /// transform in us
+  if (!mIsContinuous) eventTime = 0.f; /// transform in us
 
-        const float normalizedPadResponse = 1.f;
-        if (normalizedPadResponse <= 0) continue;
-        const int pad = digiPos.getPadPos().getPad();
-        const int row = digiPos.getPadPos().getRow();
+  const int nShapedPoints = eleParam.getNShapedPoints();
+  mSignalArray.resize(nShapedPoints);
+
+  const int eventID = cloud.getEventID();
+  const int sector = cloud.getSector();
+  const ElectronCloud::Electron *electron = cloud.getElectrons().data();
+
+  for(const auto &hit : cloud.getHits()) {
+    const int MCTrackID = hit.trackID;
+    const ElectronCloud::Electron *hitElectrons = electron;
+    electron += hit.nElectrons;
+
+    /// Signal formation
+    /// The shaping is linear, hence the charge of all electrons arriving at the same pad within the same sub-bin
+    /// of the shaping table is summed up first and shaped only once
+    mShapingCells.clear();
+    for(size_t iEle=0; iEle < hit.nElectrons; ++iEle) {
+      const ElectronCloud::Electron &ele = hitElectrons[iEle];
+      const float nElectronsGEM = ele.nElectrons;
+
+      const float absoluteTime = ele.time + eventTime;
+      int timeBin, subBin;
+      float weight;
+      sampa.getSubBin(absoluteTime, timeBin, subBin, weight);
+      const float ADCsignal = SAMPAProcessing::getADCvalue(nElectronsGEM);
+
+      /// Induction of the signal on the pads around the pad of the electron (pad response function)
+      PadResponse::PadSignal padSignals[PadResponse::KernelCells];
+      const int nPadSignals = padResponse.getPadSignals(ele.cru, ele.row, ele.pad, ele.getPadFraction(), ele.getRowFraction(), padSignals);
+      for(int iPad=0; iPad < nPadSignals; ++iPad) {
+        const PadResponse::PadSignal &padSignal = padSignals[iPad];
+        const float normalizedPadResponse = padSignal.weight;
 
         if(mDebugFlagPRF) {
           /// \todo Write out the debug output
-          GEMresponse.CRU = digiPos.getCRU().number();
+          GEMresponse.CRU = padSignal.cru;
           GEMresponse.time = absoluteTime;
-          GEMresponse.row = row;
-          GEMresponse.pad = pad;
+          GEMresponse.row = padSignal.row;
+          GEMresponse.pad = padSignal.pad;
           GEMresponse.nElectrons = nElectronsGEM * normalizedPadResponse;
           //mDebugTreePRF->Fill();
         }
 
-        const float ADCsignal = SAMPAProcessing::getADCvalue(nElectronsGEM * normalizedPadResponse);
-        SAMPAProcessing::getShapedSignal(ADCsignal, absoluteTime, signalArray);
-        for(float i=0; i<nShapedPoints; ++i) {
-          const float time = absoluteTime + i * eleParam.getZBinWidth();
-          mDigitContainer->addDigit(MCTrackID, digiPos.getCRU().number(), getTimeBinFromTime(time), row, pad, signalArray[i]);
+        /// the linear interpolation of the shaping table is done by splitting the charge among the two neighbouring sub-bins
+        const float padADCsignal = ADCsignal * normalizedPadResponse;
+        mShapingCells.push_back({padSignal.cru, padSignal.row, padSignal.pad, timeBin, subBin, padADCsignal * (1.f - weight)});
+        mShapingCells.push_back({padSignal.cru, padSignal.row, padSignal.pad, timeBin, subBin + 1, padADCsignal * weight});
+      }
+    }
+
+    std::sort(mShapingCells.begin(), mShapingCells.end(), [](const ShapingCell &a, const ShapingCell &b) {
+      return std::tie(a.cru, a.row, a.pad, a.timeBin, a.subBin) < std::tie(b.cru, b.row, b.pad, b.timeBin, b.subBin);
+    });
+
+    /// Shaping of the summed up charge, once per pad and time bin of arrival
+    for(size_t iCell=0; iCell < mShapingCells.size();) {
+      const ShapingCell &first = mShapingCells[iCell];
+      std::fill(mSignalArray.begin(), mSignalArray.end(), 0.f);
+      for(; iCell < mShapingCells.size(); ++iCell) {
+        const ShapingCell &cell = mShapingCells[iCell];
+        if(cell.cru != first.cru || cell.row != first.row || cell.pad != first.pad || cell.timeBin != first.timeBin) break;
+        if(cell.charge == 0.f) continue;
+        const float *shape = sampa.getShapingTable(cell.subBin);
+        for(int i=0; i<nShapedPoints; ++i) {
+          mSignalArray[i] += cell.charge * shape[i];
         }
+      }
 
-      // }
-      // }
-      /// end of loop over prf
+      const bool isForeign = (foreignSignals != nullptr) && (CRU(first.cru).sector().getSector() != sector);
+      for(int i=0; i<nShapedPoints; ++i) {
+        if(isForeign) {
+          foreignSignals->push_back({MCTrackID, first.cru, first.timeBin + i, first.row, first.pad, mSignalArray[i]});
+        }
+        else {
+          container.addDigit(eventID, MCTrackID, first.cru, first.timeBin + i, first.row, first.pad, mSignalArray[i]);
+        }
       }
-    /// end of loop over electrons
-    ++hitCounter;
     }
+  /// end of loop over hits
   }
-  /// end of loop over points
-
-  return mDigitContainer;
 }
@@ -27,6 +27,8 @@
 #include "FairLogger.h"
 #include "FairRootManager.h"
 
+#include <algorithm>
+#include <chrono>
 #include <sstream>
 //#include "valgrind/callgrind.h"
 
@@ -38,7 +40,11 @@ using namespace o2::TPC;
 DigitizerTask::DigitizerTask(int sectorid)
   : FairTask("TPCDigitizerTask"),
     mDigitizer(nullptr),
-    mDigitContainer(nullptr),
+    mThreadDigitizers(),
+    mSectorDigitContainers(),
+    mForeignSignals(),
+    mSectors(),
+    mThreadPool(0),
     mDigitsArray(nullptr),
     mMCTruthArray(nullptr),
     mDigitsDebugArray(nullptr),
@@ -73,21 +79,23 @@ InitStatus DigitizerTask::Init()
   }
 
   // in case we are treating a specific sector
+  mSectors.clear();
   if (mHitSector != -1){
-    std::stringstream sectornamestr;
-    sectornamestr << "TPCHitsSector" << mHitSector;
-    LOG(INFO) << "FETCHING HITS FOR SECTOR " << mHitSector << "\n";
-    mSectorHitsArray[mHitSector] = mgr->InitObjectAs<const std::vector<HitGroup>*>(sectornamestr.str().c_str());
+    mSectors.push_back(mHitSector);
   }
   else {
     // in case we are treating all sectors
     for (int s=0;s<Sector::MAXSECTOR;++s){
-      std::stringstream sectornamestr;
-      sectornamestr << "TPCHitsSector" << s;
-      LOG(INFO) << "FETCHING HITS FOR SECTOR " << s << "\n";
-      mSectorHitsArray[s] = mgr->InitObjectAs<const std::vector<HitGroup>*>(sectornamestr.str().c_str());
+      mSectors.push_back(s);
     }
   }
+  for (auto s : mSectors){
+    std::stringstream sectornamestr;
+    sectornamestr << "TPCHitsSector" << s;
+    LOG(INFO) << "FETCHING HITS FOR SECTOR " << s << "\n";
+    mSectorHitsArray[s] = mgr->InitObjectAs<const std::vector<HitGroup>*>(sectornamestr.str().c_str());
+    getSectorContainer(s);
+  }
   
   // Register output container
   mDigitsArray = new std::vector<o2::TPC::Digit>;
@@ -104,10 +112,55 @@ InitStatus DigitizerTask::Init()
   }
   
   mDigitizer->init();
-  mDigitContainer = mDigitizer->getDigitContainer();
   return kSUCCESS;
 }
 
+DigitContainer& DigitizerTask::getSectorContainer(int sector)
+{
+  auto &container = mSectorDigitContainers[sector];
+  if (container == nullptr) {
+    container = std::make_unique<DigitContainer>();
+  }
+  return *container;
+}
+
+void DigitizerTask::processSectors(float eventTime, int eventID)
+{
+  /// Each sector is processed with random numbers determined by the event and the sector only.
+  /// Signals which diffused into a neighbouring sector are collected separately and added
+  /// afterwards in sector order, so that no container is shared between the threads.
+  const unsigned nThreads = mThreadPool.getNumWorkers(mSectors.size());
+
+  /// the per-thread Digitizers are copies of the initialized one, the random numbers only depend on the event, sector and hit
+  while (mThreadDigitizers.size() < nThreads) {
+    mThreadDigitizers.emplace_back(mDigitizer->clone());
+  }
+
+  LOG(DEBUG) << "Processing " << mSectors.size() << " sectors with " << nThreads << " threads" << FairLogger::endl;
+
+  mThreadPool.run(mSectors.size(), [this, eventTime, eventID](unsigned threadId, size_t i) {
+    const int s = mSectors[i];
+    mForeignSignals[s].clear();
+    mThreadDigitizers[threadId]->Process(*mSectorDigitContainers[s], *mSectorHitsArray[s], Sector(s), eventTime, eventID, &mForeignSignals[s]);
+  });
+
+  for (auto s : mSectors) {
+    for (auto &signal : mForeignSignals[s]) {
+      getSectorContainer(CRU(signal.cru).sector().getSector()).addDigit(eventID, signal.trackID, signal.cru, signal.timeBin, signal.row, signal.pad, signal.charge);
+    }
+    mForeignSignals[s].clear();
+  }
+}
+
+void DigitizerTask::fillOutputContainers(int eventTimeBin)
+{
+  /// the CRUs are numbered sector by sector, hence this gives the same ordering as a single container
+  for (auto &container : mSectorDigitContainers) {
+    if (container == nullptr) continue;
+    container->fillOutputContainer(mDigitsArray, *mMCTruthArray, mDigitsDebugArray, eventTimeBin, mIsContinuousReadout);
+  }
+}
+
 void DigitizerTask::Exec(Option_t *option)
 {
   FairRootManager *mgr = FairRootManager::Instance();
@@ -127,22 +180,30 @@ void DigitizerTask::Exec(Option_t *option)
     mDigitsDebugArray->clear();
   }
 
-  if (mHitSector == -1){
-    // treat all sectors
-    for (int s=0; s<Sector::MAXSECTOR; ++s){
-      LOG(DEBUG) << "Processing sector " << s << "\n";
-      mDigitContainer = mDigitizer->Process(*mSectorHitsArray[s], eventTime);
-    }
-  }
-  else {
-    // treat only chosen sector
-    mDigitContainer = mDigitizer->Process(*mSectorHitsArray[mHitSector], eventTime);
+  const auto start = std::chrono::steady_clock::now();
+  processSectors(eventTime, mgr->GetEntryNr());
+
+  /// the buffers are at their largest before the digits are written out
+  size_t bufferMemory = 0;
+  for (auto &container : mSectorDigitContainers) {
+    if (container == nullptr) continue;
+    bufferMemory += container->getMemoryUsage();
   }
-  mDigitContainer->fillOutputContainer(mDigitsArray, *mMCTruthArray, mDigitsDebugArray, eventTimeBin, mIsContinuousReadout);
+  mMaxBufferMemory = std::max(mMaxBufferMemory, bufferMemory);
+
+  fillOutputContainers(eventTimeBin);
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  mProcessingTime += elapsed.count();
+  ++mNProcessedEvents;
+  LOG(DEBUG) << "Digitization took " << elapsed.count() * 1000. << " ms, digit buffers use " << bufferMemory / 1024 << " kB" << FairLogger::endl;
 }
 
 void DigitizerTask::FinishTask()
 {
+  if(mNProcessedEvents > 0) {
+    LOG(INFO) << "TPC digitization of " << mNProcessedEvents << " events: " << mProcessingTime / mNProcessedEvents * 1000.
+              << " ms per event, peak memory of the digit buffers " << mMaxBufferMemory / (1024 * 1024) << " MB" << FairLogger::endl;
+  }
   if(!mIsContinuousReadout) return;
   FairRootManager *mgr = FairRootManager::Instance();
   mgr->SetLastFill(kTRUE); /// necessary, otherwise the data is not written out
@@ -151,7 +212,7 @@ void DigitizerTask::FinishTask()
   if(mDigitDebugOutput) {
     mDigitsDebugArray->clear();
   }
-  mDigitContainer->fillOutputContainer(mDigitsArray, *mMCTruthArray, mDigitsDebugArray, mTimeBinMax, mIsContinuousReadout);
+  fillOutputContainers(mTimeBinMax);
 }
 
 void DigitizerTask::initBunchTrainStructure(const size_t numberOfEvents)
@@ -0,0 +1,110 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ElectronCloud.cxx
+/// \brief Implementation of the cache of transported and amplified electrons
+
+#include "TPCSimulation/ElectronCloud.h"
+
+#include "FairLogger.h"
+
+#include <fstream>
+
+using namespace o2::TPC;
+
+namespace {
+/// Header of a cloud in the binary format
+struct CloudHeader {
+  uint32_t magic;
+  uint32_t version;
+  int32_t eventID;
+  int32_t sector;
+  uint32_t nHits;
+  uint32_t nElectrons;
+};
+}
+
+// the structs are written as they are, make sure they have no padding
+static_assert(sizeof(ElectronCloud::Hit) == 8, "unexpected padding in ElectronCloud::Hit");
+static_assert(sizeof(ElectronCloud::Electron) == 16, "unexpected padding in ElectronCloud::Electron");
+
+constexpr uint32_t ElectronCloud::Magic;
+constexpr uint32_t ElectronCloud::Version;
+
+bool ElectronCloud::write(std::ostream &stream) const
+{
+  const CloudHeader header{Magic, Version, mEventID, mSector, static_cast<uint32_t>(mHits.size()),
+                           static_cast<uint32_t>(mElectrons.size())};
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  stream.write(reinterpret_cast<const char*>(mHits.data()), mHits.size() * sizeof(Hit));
+  stream.write(reinterpret_cast<const char*>(mElectrons.data()), mElectrons.size() * sizeof(Electron));
+  return stream.good();
+}
+
+bool ElectronCloud::read(std::istream &stream)
+{
+  CloudHeader header;
+  if(!stream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    if(stream.gcount() != 0) {
+      LOG(ERROR) << "TPC ElectronCloud: truncated header" << FairLogger::endl;
+    }
+    return false;
+  }
+  if(header.magic != Magic || header.version != Version) {
+    LOG(ERROR) << "TPC ElectronCloud: unknown binary format (magic " << header.magic << ", version " << header.version << ")"
+               << FairLogger::endl;
+    return false;
+  }
+  reset(header.eventID, header.sector);
+  mHits.resize(header.nHits);
+  mElectrons.resize(header.nElectrons);
+  stream.read(reinterpret_cast<char*>(mHits.data()), mHits.size() * sizeof(Hit));
+  stream.read(reinterpret_cast<char*>(mElectrons.data()), mElectrons.size() * sizeof(Electron));
+  if(!stream) {
+    LOG(ERROR) << "TPC ElectronCloud: truncated cloud of event " << header.eventID << " in sector " << header.sector
+               << FairLogger::endl;
+    reset(0, 0);
+    return false;
+  }
+  return true;
+}
+
+bool ElectronCloud::writeToFile(const std::string &fileName, const std::vector<ElectronCloud> &clouds)
+{
+  std::ofstream file(fileName, std::ios::binary);
+  if(!file.is_open()) {
+    LOG(ERROR) << "TPC ElectronCloud: cannot open file " << fileName << FairLogger::endl;
+    return false;
+  }
+  for(const auto &cloud : clouds) {
+    if(!cloud.write(file)) {
+      LOG(ERROR) << "TPC ElectronCloud: error writing to file " << fileName << FairLogger::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ElectronCloud::readFromFile(const std::string &fileName, std::vector<ElectronCloud> &clouds)
+{
+  std::ifstream file(fileName, std::ios::binary);
+  if(!file.is_open()) {
+    LOG(ERROR) << "TPC ElectronCloud: cannot open file " << fileName << FairLogger::endl;
+    return false;
+  }
+  ElectronCloud cloud;
+  while(file.peek() != std::ifstream::traits_type::eof()) {
+    if(!cloud.read(file)) {
+      return false;
+    }
+    clouds.push_back(std::move(cloud));
+  }
+  return true;
+}
@@ -23,8 +23,9 @@ ElectronTransport::ElectronTransport()
   : mRandomGaus(),
     mRandomFlat()
 {
-  mRandomGaus.initialize(RandomRing::RandomType::Gaus);
-  mRandomFlat.initialize(RandomRing::RandomType::Flat);
+  mRandomGaus.initialize(RandomStream::RandomType::Gaus);
+  mRandomFlat.initialize(RandomStream::RandomType::Flat);
+  setRandomKeys(0, 0, 0);
 }
 
 ElectronTransport::~ElectronTransport()
@@ -49,3 +50,29 @@ GlobalPosition3D ElectronTransport::getElectronDrift(GlobalPosition3D posEle)
                                    (mRandomGaus.getNextValue() * sigL) + posEle.Z());
   return posEleDiffusion;
 }
+
+void ElectronTransport::getElectronDrift(const GlobalPosition3D &posEle, size_t nElectrons, float *x, float *y, float *z)
+{
+  const static ParameterGas &gasParam = ParameterGas::defaultInstance();
+  const static ParameterDetector &detParam = ParameterDetector::defaultInstance();
+  /// All electrons start at the same position, hence the diffusion width is computed once
+  float driftl = detParam.getTPClength()-std::abs(posEle.Z());
+  if(driftl<0.01) {
+    driftl=0.01;
+  }
+  driftl = std::sqrt(driftl);
+  const float_v sigT(driftl*gasParam.getDiffT());
+  const float_v sigL(driftl*gasParam.getDiffL());
+  const float_v startX(posEle.X());
+  const float_v startY(posEle.Y());
+  const float_v startZ(posEle.Z());
+
+  for(size_t i=0; i<nElectrons; i+=float_v::Size) {
+    const float_v posX = mRandomGaus.getNextValueVc() * sigT + startX;
+    const float_v posY = mRandomGaus.getNextValueVc() * sigT + startY;
+    const float_v posZ = mRandomGaus.getNextValueVc() * sigL + startZ;
+    posX.store(x+i, Vc::Aligned);
+    posY.store(y+i, Vc::Aligned);
+    posZ.store(z+i, Vc::Aligned);
+  }
+}
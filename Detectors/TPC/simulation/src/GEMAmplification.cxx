@@ -16,6 +16,7 @@
 #include "TPCBase/ParameterGas.h"
 #include "TPCBase/ParameterGEM.h"
 #include <TStopwatch.h>
+#include <algorithm>
 #include <iostream>
 #include "MathUtils/CachingTF1.h"
 #include <TFile.h>
@@ -69,8 +70,9 @@ GEMAmplification::GEMAmplification()
   }
 
   if(outfile) outfile->Close();
-  mRandomGaus.initialize(RandomRing::RandomType::Gaus);
-  mRandomFlat.initialize(RandomRing::RandomType::Flat);
+  mRandomGaus.initialize(RandomStream::RandomType::Gaus);
+  mRandomFlat.initialize(RandomStream::RandomType::Flat);
+  setRandomKeys(0, 0, 0);
   watch.Stop();
   std::cerr << "GEM SETUP TOOK " << watch.CpuTime() << "\n";
 }
@@ -89,6 +91,33 @@ int GEMAmplification::getStackAmplification(int nElectrons)
   return nElectronsGEM4;
 }
 
+void GEMAmplification::getStackAmplification(size_t nElectrons, int *nElectronsOut)
+{
+  const static ParameterGEM &gemParam = ParameterGEM::defaultInstance();
+  /// The first stage sees exactly one electron, for which the collection is a single comparison with a flat random number
+  /// and the multiplication a single value drawn from the Polya distribution. This is done for float_v::Size electrons at once,
+  /// while the remaining stages depend on the individual number of electrons and are handled one by one.
+  const float collection = gemParam.getCollectionEfficiency(1);
+  const float extraction = gemParam.getExtractionEfficiency(1);
+  for(size_t i=0; i<nElectrons; i+=float_v::Size) {
+    float_v::mask_type collected(true);
+    if(collection < 0.00001) {
+      collected = float_v::mask_type(false);
+    }
+    else if(collection <= 0.99999) {
+      collected = mRandomFlat.getNextValueVc() < collection;
+    }
+    const float_v gain = Vc::iif(collected, mGain[0].getNextValueVc(), float_v::Zero());
+    const size_t nLanes = std::min<size_t>(float_v::size(), nElectrons-i);
+    for(size_t lane=0; lane<nLanes; ++lane) {
+      const int nElectronsGEM1 = getElectronLosses(static_cast<int>(gain[lane]), extraction);
+      const int nElectronsGEM2 = getSingleGEMAmplification(nElectronsGEM1, 2);
+      const int nElectronsGEM3 = getSingleGEMAmplification(nElectronsGEM2, 3);
+      nElectronsOut[i+lane]    = getSingleGEMAmplification(nElectronsGEM3, 4);
+    }
+  }
+}
+
 int GEMAmplification::getSingleGEMAmplification(int nElectrons, int GEM)
 {
   /// The effective gain of the GEM foil is given by three components
@@ -159,3 +188,13 @@ int GEMAmplification::getElectronLosses(int nElectrons, float probability)
   return nElectronsOut;
   }
 }
+
+void GEMAmplification::setRandomKeys(uint64_t event, uint64_t sector, uint64_t hit)
+{
+  /// the stream indices 0 and 1 are used by the ElectronTransport
+  mRandomGaus.setKey(RandomStream::makeKey(event, sector, hit, 2));
+  mRandomFlat.setKey(RandomStream::makeKey(event, sector, hit, 3));
+  for(size_t i=0; i<mGain.size(); ++i) {
+    mGain[i].setKey(RandomStream::makeKey(event, sector, hit, 4+i));
+  }
+}
@@ -25,8 +25,13 @@
 
 using namespace o2::TPC;
 
+constexpr int PadResponse::KernelSize;
+constexpr int PadResponse::KernelCells;
+constexpr int PadResponse::NKernelBins;
+
 PadResponse::PadResponse()
-  : mIROC(),
+  : mKernels(),
+    mIROC(),
     mOROC12(),
     mOROC3()
 {
@@ -37,6 +42,104 @@ PadResponse::PadResponse()
   importPRF("PRF_IROC.dat", mIROC);
   importPRF("PRF_OROC1-2.dat", mOROC12);
   importPRF("PRF_OROC3.dat", mOROC3);
+  initKernels();
+}
+
+void PadResponse::initKernels()
+{
+  const Mapper& mapper = Mapper::instance();
+  const int nRegions = mapper.getNumberOfPadRegions();
+  /// contributions below this fraction of the charge are neglected
+  const float minWeight = 1.e-3f;
+
+  mKernels.assign(nRegions * NKernelBins * NKernelBins * KernelCells, 0.f);
+  for(int region = 0; region < nRegions; ++region) {
+    const PadRegionInfo& regionInfo = mapper.getPadRegionInfo(region);
+    const float padWidth = regionInfo.getPadWidth() * 10.f;   /// pad size in cm, PRF in mm
+    const float padHeight = regionInfo.getPadHeight() * 10.f;
+    const int gemStack = int(CRU(region).gemStack());
+    TGraph2D &grPRF = (gemStack == 0) ? *mIROC : ((gemStack == 1 || gemStack == 2) ? *mOROC12 : *mOROC3);
+    const float maxX = grPRF.GetXmax();
+    const float maxY = grPRF.GetYmax();
+
+    for(int rowBin = 0; rowBin < NKernelBins; ++rowBin) {
+      const float rowFraction = (rowBin + 0.5f) / NKernelBins;
+      for(int padBin = 0; padBin < NKernelBins; ++padBin) {
+        const float padFraction = (padBin + 0.5f) / NKernelBins;
+        float *kernel = &mKernels[((region * NKernelBins + rowBin) * NKernelBins + padBin) * KernelCells];
+        float sum = 0.f;
+        for(int dRow = -1; dRow <= 1; ++dRow) {
+          for(int dPad = -1; dPad <= 1; ++dPad) {
+            /// distance of the electron to the centre of the pad
+            const float offsetX = std::abs(padFraction - 0.5f - dPad) * padWidth;
+            const float offsetY = std::abs(rowFraction - 0.5f - dRow) * padHeight;
+            float weight = (offsetX <= maxX && offsetY <= maxY) ? grPRF.Interpolate(offsetX, offsetY) : 0.f;
+            if(!(weight > 0.f)) weight = 0.f;
+            kernel[(dRow + 1) * KernelSize + dPad + 1] = weight;
+            sum += weight;
+          }
+        }
+        if(sum <= 0.f) {
+          LOG(ERROR) << "TPC::PadResponse - Empty PRF kernel for pad region " << region << FairLogger::endl;
+          kernel[KernelCells / 2] = 1.f;
+          continue;
+        }
+        float sumAboveThreshold = 0.f;
+        for(int i = 0; i < KernelCells; ++i) {
+          if(kernel[i] < minWeight * sum) kernel[i] = 0.f;
+          sumAboveThreshold += kernel[i];
+        }
+        for(int i = 0; i < KernelCells; ++i) {
+          kernel[i] /= sumAboveThreshold;
+        }
+      }
+    }
+  }
+}
+
+int PadResponse::getPadSignals(int cru, int row, int pad, float padFraction, float rowFraction, PadSignal *signals) const
+{
+  const static Mapper& mapper = Mapper::instance();
+  const int region = cru % CRU::CRUperSector;
+  const float *kernel = getKernel(region, padFraction, rowFraction);
+  const int nPads = mapper.getNumberOfPadsInRowRegion(region, row);
+  const float padWidth = mapper.getPadRegionInfo(region).getPadWidth();
+
+  int nSignals = 0;
+  for(int dRow = -1; dRow <= 1; ++dRow) {
+    const float *kernelRow = kernel + (dRow + 1) * KernelSize;
+    if(kernelRow[0] == 0.f && kernelRow[1] == 0.f && kernelRow[2] == 0.f) continue;
+
+    /// the neighbouring row can be in the neighbouring pad region of the same ROC
+    int cruNeighbour = cru;
+    int regionNeighbour = region;
+    int rowNeighbour = row + dRow;
+    if(rowNeighbour < 0) {
+      if(region == 0 || region == CRU::CRUperIROC) continue;
+      --cruNeighbour;
+      --regionNeighbour;
+      rowNeighbour = mapper.getNumberOfRowsRegion(regionNeighbour) - 1;
+    }
+    else if(rowNeighbour >= mapper.getNumberOfRowsRegion(region)) {
+      if(region == CRU::CRUperIROC - 1 || region == CRU::CRUperSector - 1) continue;
+      ++cruNeighbour;
+      ++regionNeighbour;
+      rowNeighbour = 0;
+    }
+    const int nPadsNeighbour = mapper.getNumberOfPadsInRowRegion(regionNeighbour, rowNeighbour);
+    const float widthRatio = padWidth / mapper.getPadRegionInfo(regionNeighbour).getPadWidth();
+
+    for(int dPad = -1; dPad <= 1; ++dPad) {
+      const float weight = kernelRow[dPad + 1];
+      if(weight == 0.f) continue;
+      /// the pads are centred in the rows, the signal goes to the pad below the centre of the kernel cell
+      const float centre = (pad + dPad + 0.5f - nPads / 2) * widthRatio + nPadsNeighbour / 2;
+      const int padNeighbour = static_cast<int>(std::floor(centre));
+      if(padNeighbour < 0 || padNeighbour >= nPadsNeighbour) continue;
+      signals[nSignals++] = {cruNeighbour, rowNeighbour, padNeighbour, weight};
+    }
+  }
+  return nSignals;
 }
 
 bool PadResponse::importPRF(std::string file, std::unique_ptr<TGraph2D> & grPRF) const
@@ -15,8 +15,11 @@
 #include "TPCSimulation/SAMPAProcessing.h"
 #include "TPCSimulation/Digitizer.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <string>
 #include "FairLogger.h"
@@ -24,9 +27,93 @@
 using namespace o2::TPC;
 
 SAMPAProcessing::SAMPAProcessing()
-  : mSaturationSpline()
+  : mSaturationSpline(),
+    mSaturationX(),
+    mSaturationCoeff(),
+    mSaturationLUT(),
+    mSaturationLUTStep(1.f),
+    mBaseline(),
+    mZeroSuppressionThreshold(0.f),
+    mShapingTable(),
+    mNShapedPoints(0)
 {
-  importSaturationCurve("SAMPA_saturation.dat");
+  if (importSaturationCurve("SAMPA_saturation.dat")) {
+    initSaturationTable();
+  }
+  initShapingTable();
+}
+
+void SAMPAProcessing::initSaturationTable()
+{
+  const int nKnots = mSaturationSpline->GetNp();
+  mSaturationX.clear();
+  for (auto &coeff : mSaturationCoeff) {
+    coeff.clear();
+  }
+  for (int knot = 0; knot < nKnots; ++knot) {
+    double x, y, b, c, d;
+    mSaturationSpline->GetCoeff(knot, x, y, b, c, d);
+    mSaturationX.push_back(x);
+    mSaturationCoeff[0].push_back(y);
+    mSaturationCoeff[1].push_back(b);
+    mSaturationCoeff[2].push_back(c);
+    mSaturationCoeff[3].push_back(d);
+  }
+  /// sentinel, such that the knot above the last one can always be looked up
+  mSaturationX.push_back(std::numeric_limits<float>::max());
+
+  /// With bins of at most half the minimal distance of the knots, the knot of a signal
+  /// is either the one of the lower bin edge or the following one
+  float minDistance = std::numeric_limits<float>::max();
+  for (int knot = 1; knot < nKnots; ++knot) {
+    minDistance = std::min(minDistance, mSaturationX[knot] - mSaturationX[knot - 1]);
+  }
+  mSaturationLUTStep = 0.5f * minDistance;
+  const int nBins = static_cast<int>(std::ceil((mSaturationX[nKnots - 1] - mSaturationX[0]) / mSaturationLUTStep)) + 1;
+  mSaturationLUT.resize(nBins);
+  int knot = 0;
+  for (int bin = 0; bin < nBins; ++bin) {
+    const float lowerEdge = mSaturationX[0] + bin * mSaturationLUTStep;
+    while (knot + 1 < nKnots && mSaturationX[knot + 1] <= lowerEdge) {
+      ++knot;
+    }
+    mSaturationLUT[bin] = knot;
+  }
+}
+
+void SAMPAProcessing::makeSignal(size_t nPads, const float *charge, float commonMode, const float *pedestal, const float *noise,
+                                 RandomStream &random, float *adc, float *noiseValue) const
+{
+  /// The common mode is subtracted from the signal, then the noise and the pedestal are added and the saturation is applied.
+  /// The pedestal is finally subtracted again, as done by the zero suppression in the SAMPA.
+  const Vc::float_v vCommonMode(commonMode);
+  for (size_t pad = 0; pad < nPads; pad += Vc::float_v::Size) {
+    const Vc::float_v vPedestal(&pedestal[pad], Vc::Unaligned);
+    const Vc::float_v vNoise = Vc::float_v(&noise[pad], Vc::Unaligned) * random.getNextValueVc();
+    const Vc::float_v vSignal = Vc::float_v(&charge[pad], Vc::Unaligned) - vCommonMode + vNoise + vPedestal;
+    (getADCSaturation(vSignal) - vPedestal).store(&adc[pad], Vc::Unaligned);
+    if (noiseValue != nullptr) {
+      vNoise.store(&noiseValue[pad], Vc::Unaligned);
+    }
+  }
+}
+
+void SAMPAProcessing::initShapingTable()
+{
+  const static ParameterElectronics &eleParam = ParameterElectronics::defaultInstance();
+  mNShapedPoints = eleParam.getNShapedPoints();
+  mShapingTable.resize((NSubBins + 1) * mNShapedPoints);
+  /// Row subBin holds the pulse of a charge arriving subBin/NSubBins time bins after the start of its time bin
+  for (int subBin = 0; subBin <= NSubBins; ++subBin) {
+    const float startTime = static_cast<float>(subBin) / NSubBins * eleParam.getZBinWidth();
+    for (int bin = 0; bin < mNShapedPoints; bin += Vc::float_v::Size) {
+      const Vc::float_v time = (Vc::float_v::IndexesFromZero() + static_cast<float>(bin)) * eleParam.getZBinWidth();
+      const Vc::float_v signal = getGamma4(time, Vc::float_v(startTime), Vc::float_v::One());
+      for (int i = 0; i < static_cast<int>(Vc::float_v::Size) && bin + i < mNShapedPoints; ++i) {
+        mShapingTable[subBin * mNShapedPoints + bin + i] = signal[i];
+      }
+    }
+  }
 }
 
 SAMPAProcessing::~SAMPAProcessing()
@@ -65,20 +152,25 @@ bool SAMPAProcessing::importSaturationCurve(std::string file)
   return true;
 }
 
-void SAMPAProcessing::getShapedSignal(float ADCsignal, float driftTime, std::vector<float> &signalArray)
+void SAMPAProcessing::getSubBin(float time, int &timeBin, int &subBin, float &weight) const
 {
   const static ParameterElectronics &eleParam = ParameterElectronics::defaultInstance();
-  float timeBinTime = Digitizer::getTimeBinTime(driftTime);
-  float offset = driftTime - timeBinTime;
-  for (float bin = 0; bin < eleParam.getNShapedPoints(); bin += Vc::float_v::Size) {
-    Vc::float_v binvector;
-    for (int i = 0; i < Vc::float_v::Size; ++i) {
-      binvector[i] = bin + i;
-    }
-    Vc::float_v time = timeBinTime + binvector * eleParam.getZBinWidth();
-    Vc::float_v signal = getGamma4(time, Vc::float_v(timeBinTime+offset), Vc::float_v(ADCsignal));
-    for (int i = 0; i < Vc::float_v::Size; ++i) {
-      signalArray[bin+i] = signal[i];
-    }
+  timeBin = Digitizer::getTimeBinFromTime(time);
+  const float offset = (time - Digitizer::getTimeFromBin(timeBin)) / eleParam.getZBinWidth() * NSubBins;
+  subBin = std::min(std::max(static_cast<int>(offset), 0), NSubBins - 1);
+  weight = std::min(std::max(offset - subBin, 0.f), 1.f);
+}
+
+void SAMPAProcessing::getShapedSignal(float ADCsignal, float driftTime, std::vector<float> &signalArray)
+{
+  const SAMPAProcessing &sampa = instance();
+  int timeBin, subBin;
+  float weight;
+  sampa.getSubBin(driftTime, timeBin, subBin, weight);
+  const float *lower = sampa.getShapingTable(subBin);
+  const float *upper = sampa.getShapingTable(subBin + 1);
+  signalArray.resize(sampa.mNShapedPoints);
+  for (int i = 0; i < sampa.mNShapedPoints; ++i) {
+    signalArray[i] = ADCsignal * ((1.f - weight) * lower[i] + weight * upper[i]);
   }
 }
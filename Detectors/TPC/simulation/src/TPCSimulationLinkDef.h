@@ -24,9 +24,6 @@
 #pragma link C++ class o2::TPC::DigitCRU+;
 #pragma link C++ class o2::TPC::Digitizer+;
 #pragma link C++ class o2::TPC::DigitizerTask+;
-#pragma link C++ class o2::TPC::DigitPad+;
-#pragma link C++ class o2::TPC::DigitRow+;
-#pragma link C++ class o2::TPC::DigitTime+;
 #pragma link C++ class o2::TPC::ElectronTransport+;
 #pragma link C++ class o2::TPC::GEMAmplification+;
 #pragma link C++ class o2::TPC::PadResponse+;
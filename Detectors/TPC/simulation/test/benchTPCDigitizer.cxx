@@ -0,0 +1,169 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchTPCDigitizer.cxx
+/// \brief Benchmark of the electron transport and amplification in the TPC digitization
+///
+/// The per electron processing (as used before the batched digitizer) is compared to the
+/// batched processing with Vc. The full Digitizer is benchmarked on one sector with a
+/// configurable number of straight tracks, the order of 1000 tracks per sector
+/// corresponds to a central Pb-Pb collision.
+
+#include "benchmark/benchmark.h"
+
+#include "TPCSimulation/DigitContainer.h"
+#include "TPCSimulation/Digitizer.h"
+#include "TPCSimulation/ElectronTransport.h"
+#include "TPCSimulation/GEMAmplification.h"
+#include "TPCSimulation/Point.h"
+#include "TPCBase/ParameterDetector.h"
+#include "TPCBase/ParameterGas.h"
+#include "TPCBase/Sector.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace o2::TPC;
+
+namespace {
+/// Number of primary electrons of a typical hit
+constexpr int kElectronsPerHit = 40;
+
+ElectronTransport& electronTransport()
+{
+  static ElectronTransport transport;
+  return transport;
+}
+
+GEMAmplification& gemAmplification()
+{
+  static GEMAmplification amplification;
+  return amplification;
+}
+
+/// Straight tracks from the vertex through sector 0 (A side), one hit per cm in radius
+std::vector<HitGroup> makeHits(int nTracks)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> phi(0.01f, 0.34f);
+  std::uniform_real_distribution<float> tanLambda(0.f, 0.9f);
+  std::poisson_distribution<short> nElectrons(kElectronsPerHit);
+
+  std::vector<HitGroup> hits;
+  for (int track = 0; track < nTracks; ++track) {
+    hits.emplace_back(track);
+    const float trackPhi = phi(generator);
+    const float trackTanLambda = tanLambda(generator);
+    for (float r = 85.f; r < 245.f; r += 1.f) {
+      hits.back().addHit(r * std::cos(trackPhi), r * std::sin(trackPhi), r * trackTanLambda, 0.f, nElectrons(generator));
+    }
+  }
+  return hits;
+}
+} // namespace
+
+static void BM_ElectronTransportScalar(benchmark::State& state)
+{
+  auto& transport = electronTransport();
+  const GlobalPosition3D posEle(100.f, 10.f, 100.f);
+  const int nElectrons = state.range(0);
+  for (auto _ : state) {
+    int nSurvivors = 0;
+    for (int i = 0; i < nElectrons; ++i) {
+      const GlobalPosition3D posEleDiff = transport.getElectronDrift(posEle);
+      if (transport.isElectronAttachment(Digitizer::getTime(posEleDiff.Z()))) {
+        continue;
+      }
+      ++nSurvivors;
+    }
+    benchmark::DoNotOptimize(nSurvivors);
+  }
+  state.SetItemsProcessed(state.iterations() * nElectrons);
+}
+
+static void BM_ElectronTransportBatched(benchmark::State& state)
+{
+  const static ParameterGas& gasParam = ParameterGas::defaultInstance();
+  const static ParameterDetector& detParam = ParameterDetector::defaultInstance();
+  auto& transport = electronTransport();
+  const GlobalPosition3D posEle(100.f, 10.f, 100.f);
+  const int nElectrons = state.range(0);
+  const size_t nPadded = (nElectrons + float_v::Size - 1) / float_v::Size * float_v::Size;
+  std::vector<float, Vc::Allocator<float>> x(nPadded), y(nPadded), z(nPadded);
+  for (auto _ : state) {
+    transport.getElectronDrift(posEle, nElectrons, x.data(), y.data(), z.data());
+    int nSurvivors = 0;
+    for (size_t i = 0; i < nPadded; i += float_v::Size) {
+      const float_v posZ(&z[i], Vc::Aligned);
+      const float_v driftTime = (detParam.getTPClength() - Vc::abs(posZ)) / gasParam.getVdrift();
+      nSurvivors += (!transport.isElectronAttachment(driftTime)).count();
+    }
+    benchmark::DoNotOptimize(nSurvivors);
+  }
+  state.SetItemsProcessed(state.iterations() * nElectrons);
+}
+
+static void BM_GEMAmplificationScalar(benchmark::State& state)
+{
+  auto& amplification = gemAmplification();
+  const int nElectrons = state.range(0);
+  std::vector<int> gain(nElectrons);
+  for (auto _ : state) {
+    for (int i = 0; i < nElectrons; ++i) {
+      gain[i] = amplification.getStackAmplification();
+    }
+    benchmark::DoNotOptimize(gain.data());
+  }
+  state.SetItemsProcessed(state.iterations() * nElectrons);
+}
+
+static void BM_GEMAmplificationBatched(benchmark::State& state)
+{
+  auto& amplification = gemAmplification();
+  const int nElectrons = state.range(0);
+  std::vector<int> gain(nElectrons);
+  for (auto _ : state) {
+    amplification.getStackAmplification(nElectrons, gain.data());
+    benchmark::DoNotOptimize(gain.data());
+  }
+  state.SetItemsProcessed(state.iterations() * nElectrons);
+}
+
+static void BM_DigitizerProcess(benchmark::State& state)
+{
+  static Digitizer digitizer;
+  static bool initialized = false;
+  if (!initialized) {
+    digitizer.init();
+    initialized = true;
+  }
+  const auto hits = makeHits(state.range(0));
+  size_t nHits = 0;
+  for (auto& group : hits) {
+    nHits += group.getSize();
+  }
+  std::vector<Digitizer::ForeignSignal> foreignSignals;
+  for (auto _ : state) {
+    DigitContainer container;
+    foreignSignals.clear();
+    digitizer.Process(container, hits, Sector(0), 0.f, 0, &foreignSignals);
+    benchmark::DoNotOptimize(container.getNentries());
+  }
+  state.SetItemsProcessed(state.iterations() * nHits);
+}
+
+BENCHMARK(BM_ElectronTransportScalar)->Arg(kElectronsPerHit)->Arg(1000);
+BENCHMARK(BM_ElectronTransportBatched)->Arg(kElectronsPerHit)->Arg(1000);
+BENCHMARK(BM_GEMAmplificationScalar)->Arg(kElectronsPerHit)->Arg(1000);
+BENCHMARK(BM_GEMAmplificationBatched)->Arg(kElectronsPerHit)->Arg(1000);
+BENCHMARK(BM_DigitizerProcess)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
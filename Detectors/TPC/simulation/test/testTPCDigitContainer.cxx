@@ -30,7 +30,9 @@ namespace TPC {
   /// A couple of values are filled into a DigitContainer and we check whether we get the same results after full conversion to digits
   BOOST_AUTO_TEST_CASE(DigitContainer_test1)
   {
-    const SAMPAProcessing& sampa = SAMPAProcessing::instance();
+    SAMPAProcessing& sampa = SAMPAProcessing::instance();
+    /// without noise none of the small signals is lost in the zero suppression
+    sampa.getBaseline().setMeanNoise(0.f);
     static FairRootManager *mgr = FairRootManager::Instance();
     DigitContainer digitContainer;
     o2::dataformats::MCTruthContainer<MCCompLabel> mMCTruthArray;
@@ -51,12 +53,14 @@ namespace TPC {
     /// here the raw pointer is needed owed to the internal handling of the TClonesArrays in FairRoot
     /// Usually the mDigitsArray is what is registered to the FairRootManager
     auto *mDigitsArray = new std::vector<o2::TPC::Digit>;
-    digitContainer.fillOutputContainer(mDigitsArray, mMCTruthArray, nullptr, 1000);
+    auto *mDigitsDebugArray = new std::vector<o2::TPC::DigitMCMetaData>;
+    digitContainer.fillOutputContainer(mDigitsArray, mMCTruthArray, mDigitsDebugArray, 1000);
 
     BOOST_CHECK(CRU.size() == mDigitsArray->size());
 
     int digits = 0;
     for(auto& digit : *mDigitsArray) {
+      auto& digitMetaData = mDigitsDebugArray->at(digits);
       gsl::span<const o2::MCCompLabel> mcArray = mMCTruthArray.getLabels(digits);
       for(int j=0; j<static_cast<int>(mcArray.size()); ++j) {
         BOOST_CHECK(mMCTruthArray.getElement(mMCTruthArray.getMCTruthHeader(digits).index+j).getTrackID() == MCtrack[digits]);
@@ -66,11 +70,13 @@ namespace TPC {
       BOOST_CHECK(digit.getTimeStamp() == Time[digits]);
       BOOST_CHECK(digit.getRow() == Row[digits]);
       BOOST_CHECK(digit.getPad() == Pad[digits]);
-      BOOST_CHECK(digit.getCharge() == static_cast<int>(sampa.getADCSaturation(nEle[digits])));
+      BOOST_CHECK(digitMetaData.getNoise() == 0.f);
+      BOOST_CHECK_CLOSE(digit.getChargeFloat(), sampa.getADCSaturation(nEle[digits] - digitMetaData.getCommonMode() + digitMetaData.getPedestal()) - digitMetaData.getPedestal(), 1E-3);
       ++digits;
     }
 
     delete mDigitsArray;
+    delete mDigitsDebugArray;
   }
 
 
@@ -81,7 +87,8 @@ namespace TPC {
   BOOST_AUTO_TEST_CASE(DigitContainer_test2)
   {
     const Mapper& mapper = Mapper::instance();
-    const SAMPAProcessing& sampa = SAMPAProcessing::instance();
+    SAMPAProcessing& sampa = SAMPAProcessing::instance();
+    sampa.getBaseline().setMeanNoise(0.8f);
     static FairRootManager *mgr = FairRootManager::Instance();
     DigitContainer digitContainer;
     o2::dataformats::MCTruthContainer<o2::MCCompLabel> mMCTruthArray;
@@ -125,12 +132,47 @@ namespace TPC {
       BOOST_CHECK(digit.getTimeStamp() == Time[digits]);
       BOOST_CHECK(digit.getRow() == Row[digits]);
       BOOST_CHECK(digit.getPad() == Pad[digits]);
-      BOOST_CHECK(digit.getCharge() == static_cast<int>(sampa.getADCSaturation(nEleSum - digitMetaData.getCommonMode())));
+      BOOST_CHECK_CLOSE(digit.getChargeFloat(), sampa.getADCSaturation(nEleSum - digitMetaData.getCommonMode() + digitMetaData.getNoise()
+                                                                        + digitMetaData.getPedestal()) - digitMetaData.getPedestal(), 1E-3);
       BOOST_CHECK_CLOSE(digitMetaData.getCommonMode(), nEleSum/static_cast<float>(mapper.getPadsInIROC()), 1E-4);
       ++digits;
     }
 
     delete mDigitsArray;
+    delete mDigitsDebugArray;
+  }
+
+
+  /// \brief Test of the DigitContainer in triggered mode
+  /// The same signal is read out in two triggered events, the noise has to differ between the events
+  /// and a modification of the Baseline in between has to be applied to the already existing CRU containers
+  BOOST_AUTO_TEST_CASE(DigitContainer_test3)
+  {
+    SAMPAProcessing& sampa = SAMPAProcessing::instance();
+    sampa.getBaseline().setMeanNoise(0.8f);
+    DigitContainer digitContainer;
+
+    std::vector<float> noise, pedestal;
+    for(int event=0; event<2; ++event) {
+      if(event == 1) {
+        sampa.getBaseline().setMeanPedestal(100.f, 0.f);
+      }
+      o2::dataformats::MCTruthContainer<o2::MCCompLabel> mMCTruthArray;
+      std::vector<o2::TPC::Digit> mDigitsArray;
+      std::vector<o2::TPC::DigitMCMetaData> mDigitsDebugArray;
+      digitContainer.addDigit(0, 7, 23, 231, 12, 15, 500);
+      digitContainer.fillOutputContainer(&mDigitsArray, mMCTruthArray, &mDigitsDebugArray, 0, false);
+
+      BOOST_REQUIRE(mDigitsDebugArray.size() == 1);
+      noise.push_back(mDigitsDebugArray[0].getNoise());
+      pedestal.push_back(mDigitsDebugArray[0].getPedestal());
+    }
+
+    BOOST_CHECK(noise[0] != noise[1]);
+    BOOST_CHECK(pedestal[0] != 100.f);
+    BOOST_CHECK_CLOSE(pedestal[1], 100.f, 1E-4);
+
+    sampa.getBaseline().setMeanPedestal(70.f, 10.f);
   }
 
 }
@@ -0,0 +1,147 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTPCElectronCloud.cxx
+/// \brief This task tests the cache of transported electrons of the TPC digitization
+
+#define BOOST_TEST_MODULE Test TPC ElectronCloud
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TPCSimulation/DigitContainer.h"
+#include "TPCSimulation/Digitizer.h"
+#include "TPCSimulation/ElectronCloud.h"
+#include "TPCSimulation/Point.h"
+#include "TPCBase/Digit.h"
+#include "TPCBase/Sector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+namespace o2 {
+namespace TPC {
+
+  /// Digits of a DigitContainer, all time bins are written out
+  std::vector<Digit> getDigits(DigitContainer &container)
+  {
+    std::vector<Digit> digits;
+    o2::dataformats::MCTruthContainer<MCCompLabel> mcTruth;
+    container.fillOutputContainer(&digits, mcTruth, nullptr, 0, false);
+    return digits;
+  }
+
+  /// \brief Test of the binary format
+  /// Two clouds are written to a stream and read back
+  BOOST_AUTO_TEST_CASE(ElectronCloud_io_test)
+  {
+    std::vector<ElectronCloud> clouds(2);
+    clouds[0].reset(3, 12);
+    clouds[0].addHit(7);
+    clouds[0].addElectron(125, 10, 20, 0.f, 0.5f, 12.5f, 1500.f);
+    clouds[0].addElectron(126, 0, 3, 0.25f, 0.99999994f, 80.25f, 2000.f);
+    clouds[0].addHit(8);
+    clouds[0].removeEmptyHit();
+    clouds[1].reset(4, 35);
+
+    std::stringstream stream;
+    for(const auto &cloud : clouds) {
+      BOOST_CHECK(cloud.write(stream));
+    }
+
+    ElectronCloud cloud;
+    BOOST_CHECK(cloud.read(stream));
+    BOOST_CHECK(cloud.getEventID() == 3);
+    BOOST_CHECK(cloud.getSector() == 12);
+    BOOST_CHECK(cloud.getHits().size() == 1);
+    BOOST_CHECK(cloud.getHits()[0].trackID == 7);
+    BOOST_CHECK(cloud.getHits()[0].nElectrons == 2);
+    BOOST_CHECK(cloud.getElectrons().size() == 2);
+    const auto &electron = cloud.getElectrons()[1];
+    BOOST_CHECK(electron.cru == 126);
+    BOOST_CHECK(electron.row == 0);
+    BOOST_CHECK(electron.pad == 3);
+    BOOST_CHECK(electron.getPadFraction() == 0.25f);
+    BOOST_CHECK(electron.getRowFraction() < 1.f);
+    BOOST_CHECK(electron.time == 80.25f);
+    BOOST_CHECK(electron.nElectrons == 2000.f);
+
+    BOOST_CHECK(cloud.read(stream));
+    BOOST_CHECK(cloud.getEventID() == 4);
+    BOOST_CHECK(cloud.getSector() == 35);
+    BOOST_CHECK(cloud.getHits().empty());
+    BOOST_CHECK(cloud.getElectrons().empty());
+
+    BOOST_CHECK(!cloud.read(stream));
+
+    /// data in another format is rejected
+    std::stringstream invalid("this is not an electron cloud");
+    BOOST_CHECK(!cloud.read(invalid));
+  }
+
+  /// \brief Test of the replay of a cached electron cloud
+  /// The digits obtained from a cloud, also after writing it out, are the same as the ones of the full digitization.
+  /// A cloud replayed at a later interaction time gives the same signal at later time bins.
+  BOOST_AUTO_TEST_CASE(ElectronCloud_replay_test)
+  {
+    Digitizer digitizer;
+    digitizer.init();
+
+    std::vector<HitGroup> hits;
+    for(int track = 0; track < 5; ++track) {
+      hits.emplace_back(track);
+      const float phi = 0.05f + 0.05f * track;
+      for(float r = 90.f; r < 240.f; r += 1.f) {
+        hits.back().addHit(r * std::cos(phi), r * std::sin(phi), 50.f + 0.2f * r, 0.f, 40);
+      }
+    }
+
+    const float eventTime = 10.f;
+    DigitContainer processed;
+    digitizer.Process(processed, hits, Sector(0), eventTime, 2);
+
+    ElectronCloud cloud;
+    digitizer.transport(cloud, hits, Sector(0), 2);
+    BOOST_CHECK(cloud.getEventID() == 2);
+    BOOST_CHECK(!cloud.getElectrons().empty());
+
+    std::stringstream stream;
+    BOOST_CHECK(cloud.write(stream));
+    ElectronCloud cached;
+    BOOST_CHECK(cached.read(stream));
+
+    DigitContainer replayed;
+    digitizer.replay(replayed, cached, eventTime);
+
+    const auto processedDigits = getDigits(processed);
+    const auto replayedDigits = getDigits(replayed);
+    BOOST_REQUIRE(!processedDigits.empty());
+    BOOST_CHECK(processedDigits.size() == replayedDigits.size());
+    for(size_t i = 0; i < std::min(processedDigits.size(), replayedDigits.size()); ++i) {
+      BOOST_CHECK(processedDigits[i].getCRU() == replayedDigits[i].getCRU());
+      BOOST_CHECK(processedDigits[i].getTimeStamp() == replayedDigits[i].getTimeStamp());
+      BOOST_CHECK(processedDigits[i].getRow() == replayedDigits[i].getRow());
+      BOOST_CHECK(processedDigits[i].getPad() == replayedDigits[i].getPad());
+      BOOST_CHECK(processedDigits[i].getChargeFloat() == replayedDigits[i].getChargeFloat());
+    }
+
+    /// the pile-up of the same event at a later time arrives later
+    DigitContainer shifted;
+    digitizer.replay(shifted, cached, eventTime + 100.f);
+    const auto shiftedDigits = getDigits(shifted);
+    BOOST_REQUIRE(!shiftedDigits.empty());
+    int firstProcessed = processedDigits.front().getTimeStamp(), firstShifted = shiftedDigits.front().getTimeStamp();
+    for(const auto &digit : processedDigits) firstProcessed = std::min(firstProcessed, digit.getTimeStamp());
+    for(const auto &digit : shiftedDigits) firstShifted = std::min(firstShifted, digit.getTimeStamp());
+    BOOST_CHECK(firstShifted > firstProcessed);
+  }
+}
+}
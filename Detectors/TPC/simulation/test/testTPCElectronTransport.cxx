@@ -20,6 +20,8 @@
 #include "TPCBase/ParameterGas.h"
 #include "TPCBase/ParameterDetector.h"
 
+#include <vector>
+
 #include "TH1D.h"
 #include "TF1.h"
 
@@ -115,6 +117,50 @@ namespace TPC {
     BOOST_CHECK_CLOSE(gausZ.GetParameter(2), gasParam.getDiffL(), 0.5);
   }
   
+  /// \brief Test of the batched getElectronDrift function
+  /// The same as test 1, but all electrons are drifted in one go
+  ///
+  /// Precision: 0.5 %.
+  BOOST_AUTO_TEST_CASE(ElectronDiffusion_test_batched)
+  {
+    const static ParameterGas &gasParam = ParameterGas::defaultInstance();
+    const static ParameterDetector &detParam = ParameterDetector::defaultInstance();
+    const GlobalPosition3D posEle(10.f, 10.f, 10.f);
+    TH1D hTestDiffX("hTestDiffX", "", 500, posEle.X()-10., posEle.X()+10.);
+    TH1D hTestDiffY("hTestDiffY", "", 500, posEle.Y()-10., posEle.Y()+10.);
+    TH1D hTestDiffZ("hTestDiffZ", "", 500, posEle.Z()-10., posEle.Z()+10.);
+
+    TF1 gausX("gausX", "gaus");
+    TF1 gausY("gausY", "gaus");
+    TF1 gausZ("gausZ", "gaus");
+
+    static ElectronTransport electronTransport;
+
+    const int nElectrons = 500000;
+    std::vector<float, Vc::Allocator<float>> x(nElectrons+float_v::Size), y(nElectrons+float_v::Size), z(nElectrons+float_v::Size);
+    electronTransport.getElectronDrift(posEle, nElectrons, x.data(), y.data(), z.data());
+    for(int i=0; i<nElectrons; ++i) {
+      hTestDiffX.Fill(x[i]);
+      hTestDiffY.Fill(y[i]);
+      hTestDiffZ.Fill(z[i]);
+    }
+
+    hTestDiffX.Fit("gausX", "Q0");
+    hTestDiffY.Fit("gausY", "Q0");
+    hTestDiffZ.Fit("gausZ", "Q0");
+
+    BOOST_CHECK_CLOSE(gausX.GetParameter(1), posEle.X(), 0.5);
+    BOOST_CHECK_CLOSE(gausY.GetParameter(1), posEle.Y(), 0.5);
+    BOOST_CHECK_CLOSE(gausZ.GetParameter(1), posEle.Z(), 0.5);
+
+    const float sigT = std::sqrt(detParam.getTPClength()-posEle.Z()) * gasParam.getDiffT();
+    const float sigL = std::sqrt(detParam.getTPClength()-posEle.Z()) * gasParam.getDiffL();
+
+    BOOST_CHECK_CLOSE(gausX.GetParameter(2), sigT, 0.5);
+    BOOST_CHECK_CLOSE(gausY.GetParameter(2), sigT, 0.5);
+    BOOST_CHECK_CLOSE(gausZ.GetParameter(2), sigL, 0.5);
+  }
+
   /// \brief Test of the isElectronAttachment function
   /// We let the electrons drift for 100 us and compare the fraction
   /// of lost electrons to the expected value
@@ -136,5 +182,23 @@ namespace TPC {
 
     BOOST_CHECK_CLOSE(lostElectrons/nEvents, gasParam.getAttachmentCoefficient() * gasParam.getOxygenContent() * driftTime, 0.1);
   }
+
+  /// \brief Test of the vectorized isElectronAttachment function
+  ///
+  /// Precision: 0.1 %.
+  BOOST_AUTO_TEST_CASE(ElectronAttatchment_test_batched)
+  {
+    const static ParameterGas &gasParam = ParameterGas::defaultInstance();
+    static ElectronTransport electronTransport;
+
+    const float driftTime = 100.f;
+    float lostElectrons = 0;
+    const float nEvents = 500000;
+    for(int i=0; i<nEvents; i+=float_v::Size) {
+      lostElectrons += electronTransport.isElectronAttachment(float_v(driftTime)).count();
+    }
+
+    BOOST_CHECK_CLOSE(lostElectrons/nEvents, gasParam.getAttachmentCoefficient() * gasParam.getOxygenContent() * driftTime, 0.1);
+  }
 }
 }
@@ -20,6 +20,8 @@
 #include "TPCBase/ParameterGas.h"
 #include "TPCBase/ParameterGEM.h"
 
+#include <vector>
+
 #include "TH1D.h"
 #include "TF1.h"
 
@@ -134,5 +136,28 @@ namespace TPC {
     /// -# case the probability is explicitly handled for each electron
     BOOST_CHECK_CLOSE(hTest2.GetMean(), 2, 0.5);
   }
+
+  /// \brief Test of the batched getStackAmplification function
+  /// Single electrons are amplified in batches and the mean gain is compared
+  /// to the one of the single electron amplification and to the expected one
+  BOOST_AUTO_TEST_CASE(GEMamplification_batched_test)
+  {
+    const static ParameterGEM &gemParam = ParameterGEM::defaultInstance();
+    static GEMAmplification gemStack;
+
+    const int nElectrons = 100000;
+    std::vector<int> gain(nElectrons);
+    gemStack.getStackAmplification(nElectrons, gain.data());
+    double sumBatched = 0;
+    double sumSingle = 0;
+    for(int i=0; i < nElectrons; ++i) {
+      sumBatched += gain[i];
+      sumSingle += gemStack.getStackAmplification();
+    }
+
+    const float effectiveGain = gemParam.getEffectiveGain(1) * gemParam.getEffectiveGain(2) * gemParam.getEffectiveGain(3) * gemParam.getEffectiveGain(4);
+    BOOST_CHECK_CLOSE(sumBatched/sumSingle, 1., 5.f);
+    BOOST_CHECK_CLOSE(sumBatched/nElectrons, effectiveGain, 20.f);
+  }
 }
 } 
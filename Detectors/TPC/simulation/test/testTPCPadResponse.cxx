@@ -0,0 +1,111 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTPCPadResponse.cxx
+/// \brief This task tests the tabulated pad response of the TPC digitization
+
+#define BOOST_TEST_MODULE Test TPC PadResponse
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TPCSimulation/PadResponse.h"
+#include "TPCBase/Mapper.h"
+
+namespace o2 {
+namespace TPC {
+
+  /// \brief Test of the tabulated kernels
+  /// The kernels are normalized, symmetric and most of the charge stays on the pad of the electron if it arrives at the pad centre
+  BOOST_AUTO_TEST_CASE(PadResponse_kernel_test)
+  {
+    const static PadResponse padResponse;
+    const Mapper& mapper = Mapper::instance();
+    for(int region = 0; region < mapper.getNumberOfPadRegions(); ++region) {
+      for(float padFraction : {0.f, 0.3f, 0.5f, 0.99f}) {
+        for(float rowFraction : {0.f, 0.5f, 0.8f}) {
+          const float *kernel = padResponse.getKernel(region, padFraction, rowFraction);
+          float sum = 0.f;
+          for(int i = 0; i < PadResponse::KernelCells; ++i) {
+            BOOST_CHECK(kernel[i] >= 0.f);
+            sum += kernel[i];
+          }
+          BOOST_CHECK_CLOSE(sum, 1.f, 1E-3);
+        }
+      }
+
+      const float *centre = padResponse.getKernel(region, 0.5f, 0.5f);
+      BOOST_CHECK(centre[PadResponse::KernelCells / 2] > 0.5f);
+
+      /// mirrored positions give mirrored kernels
+      const float *left = padResponse.getKernel(region, 0.45f, 0.45f);
+      const float *right = padResponse.getKernel(region, 0.55f, 0.55f);
+      BOOST_CHECK_CLOSE(left[3], right[5], 1E-3);
+      BOOST_CHECK_CLOSE(left[1], right[7], 1E-3);
+
+      /// towards the edge of the pad more charge goes to the neighbouring pad
+      const float *edge = padResponse.getKernel(region, 0.99f, 0.5f);
+      BOOST_CHECK(edge[5] > centre[5]);
+      BOOST_CHECK(edge[5] > edge[3]);
+    }
+  }
+
+  /// \brief Test of the pads with signal
+  /// The charge is conserved inside a pad region and the signal is shared with the neighbouring pad region of the same ROC
+  BOOST_AUTO_TEST_CASE(PadResponse_signal_test)
+  {
+    const static PadResponse padResponse;
+    const Mapper& mapper = Mapper::instance();
+    PadResponse::PadSignal signals[PadResponse::KernelCells];
+
+    /// electron at the upper edge of a pad in the middle of region 1 of sector 2
+    const int cru = 2 * CRU::CRUperSector + 1;
+    const int row = 3;
+    const int pad = mapper.getNumberOfPadsInRowRegion(1, row) / 2;
+    int nSignals = padResponse.getPadSignals(cru, row, pad, 0.95f, 0.5f, signals);
+    float sum = 0.f;
+    bool hasNeighbour = false;
+    for(int i = 0; i < nSignals; ++i) {
+      BOOST_CHECK(signals[i].cru == cru);
+      BOOST_CHECK(signals[i].row >= row - 1 && signals[i].row <= row + 1);
+      hasNeighbour |= (signals[i].row == row && signals[i].pad == pad + 1);
+      sum += signals[i].weight;
+    }
+    BOOST_CHECK(hasNeighbour);
+    BOOST_CHECK_CLOSE(sum, 1.f, 1E-3);
+
+    /// electron at the outer edge of the last row of region 1, the neighbouring row is in region 2
+    const int lastRow = mapper.getNumberOfRowsRegion(1) - 1;
+    nSignals = padResponse.getPadSignals(cru, lastRow, mapper.getNumberOfPadsInRowRegion(1, lastRow) / 2, 0.5f, 0.99f, signals);
+    sum = 0.f;
+    bool hasNextRegion = false;
+    for(int i = 0; i < nSignals; ++i) {
+      if(signals[i].cru == cru + 1) {
+        hasNextRegion = true;
+        BOOST_CHECK(signals[i].row == 0);
+      }
+      sum += signals[i].weight;
+    }
+    BOOST_CHECK(hasNextRegion);
+    BOOST_CHECK_CLOSE(sum, 1.f, 1E-3);
+
+    /// at the outer edge of the IROC the signal on the OROC side is lost
+    const int cruIROC = 2 * CRU::CRUperSector + CRU::CRUperIROC - 1;
+    const int lastRowIROC = mapper.getNumberOfRowsRegion(CRU::CRUperIROC - 1) - 1;
+    nSignals = padResponse.getPadSignals(cruIROC, lastRowIROC, mapper.getNumberOfPadsInRowRegion(CRU::CRUperIROC - 1, lastRowIROC) / 2,
+                                         0.5f, 0.99f, signals);
+    sum = 0.f;
+    for(int i = 0; i < nSignals; ++i) {
+      BOOST_CHECK(signals[i].cru == cruIROC);
+      sum += signals[i].weight;
+    }
+    BOOST_CHECK(sum < 1.f);
+  }
+}
+}
@@ -18,11 +18,13 @@
 #include <boost/test/unit_test.hpp>
 #include "TPCSimulation/SAMPAProcessing.h"
 #include "TPCBase/ParameterElectronics.h"
+#include "TPCBase/RandomStream.h"
 
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 #include "FairLogger.h"
 
 namespace o2 {
@@ -69,6 +71,44 @@ namespace TPC {
     }
   }
 
+  /// \brief Test of the vectorized saturation curve against the scalar one
+  BOOST_AUTO_TEST_CASE(SAMPA_saturation_Vc_test)
+  {
+    const SAMPAProcessing& sampa = SAMPAProcessing::instance();
+    for(float signal = -50.f; signal < 1200.f; signal += Vc::float_v::Size * 0.37f) {
+      const Vc::float_v signals = signal + Vc::float_v::IndexesFromZero() * 0.37f;
+      const Vc::float_v saturated = sampa.getADCSaturation(signals);
+      for(size_t i = 0; i < Vc::float_v::Size; ++i) {
+        BOOST_CHECK_SMALL(saturated[i] - sampa.getADCSaturation(signals[i]), 1E-3f);
+      }
+    }
+  }
+
+  /// \brief Test of the conversion of the charges of all pads of a time bin
+  BOOST_AUTO_TEST_CASE(SAMPA_makeSignal_test)
+  {
+    const SAMPAProcessing& sampa = SAMPAProcessing::instance();
+    const size_t nPads = 4 * Vc::float_v::Size;
+    const float commonMode = 1.5f;
+    std::vector<float> charge(nPads), pedestal(nPads), noise(nPads), adc(nPads), noiseValue(nPads);
+    for(size_t pad = 0; pad < nPads; ++pad) {
+      charge[pad] = 100.f * pad;
+      pedestal[pad] = 50.f + pad;
+      noise[pad] = 0.5f * pad;
+    }
+
+    RandomStream random(RandomStream::RandomType::Gaus);
+    random.setKey(RandomStream::makeKey(1, 2, 3));
+    sampa.makeSignal(nPads, charge.data(), commonMode, pedestal.data(), noise.data(), random, adc.data(), noiseValue.data());
+
+    random.setKey(RandomStream::makeKey(1, 2, 3));
+    for(size_t pad = 0; pad < nPads; ++pad) {
+      BOOST_CHECK_CLOSE(noiseValue[pad], noise[pad] * random.getNextValue(), 1E-3);
+      const float expected = sampa.getADCSaturation(charge[pad] - commonMode + noiseValue[pad] + pedestal[pad]) - pedestal[pad];
+      BOOST_CHECK_SMALL(adc[pad] - expected, 1E-3f);
+    }
+  }
+
   /// \brief Test of the Gamma4 function
   BOOST_AUTO_TEST_CASE(SAMPA_Gamma4_test)
   {
@@ -94,5 +134,25 @@ namespace TPC {
       BOOST_CHECK_CLOSE(currentSignal, currentADC, 1E-3);
     }
   }
+
+  /// \brief Test of the tabulated pulse shape
+  /// The interpolated shaping table is compared to the Gamma4 function for a couple of arrival times within a time bin
+  BOOST_AUTO_TEST_CASE(SAMPA_shaping_table_test)
+  {
+    const static ParameterElectronics &eleParam = ParameterElectronics::defaultInstance();
+    const SAMPAProcessing& sampa = SAMPAProcessing::instance();
+    const float ADC = 100.f;
+    const float driftTimes[5] = {10.f*eleParam.getZBinWidth(), 10.003f, 25.1f, 25.19f, 87.654f};
+    std::vector<float> signalArray;
+    for(float driftTime : driftTimes) {
+      SAMPAProcessing::getShapedSignal(ADC, driftTime, signalArray);
+      BOOST_CHECK(static_cast<int>(signalArray.size()) == eleParam.getNShapedPoints());
+      const float timeBinTime = static_cast<int>(driftTime/eleParam.getZBinWidth()) * eleParam.getZBinWidth();
+      for(int i=0; i<eleParam.getNShapedPoints(); ++i) {
+        const Vc::float_v gamma4 = sampa.getGamma4(Vc::float_v(timeBinTime + i*eleParam.getZBinWidth()), Vc::float_v(driftTime), Vc::float_v(ADC));
+        BOOST_CHECK_SMALL(signalArray[i] - gamma4[0], 1E-3f*ADC);
+      }
+    }
+  }
 }
 }
@@ -22,6 +22,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <chrono>
+#include <vector>
 
 #include <FairMQDevice.h>
 
@@ -33,11 +34,16 @@ namespace Devices {
 struct TFBuffer
 {
   FairMQParts parts;
+  std::vector<int> flps; ///< Indices of the flpSenders which sent the parts
   std::chrono::steady_clock::time_point start;
   std::chrono::steady_clock::time_point end;
 };
 
 /// Receives sub-timeframes from the flpSenders and merges these into full timeframes.
+///
+/// If a credit channel is configured (one sub-channel per flpSender), every
+/// received sub-timeframe is acknowledged to the flpSender it came from once
+/// the timeframe is complete or discarded, releasing its credit (max-in-flight).
 
 class EPNReceiver : public FairMQDevice
 {
@@ -56,6 +62,9 @@ class EPNReceiver : public FairMQDevice
     /// Discared incomplete timeframes after \p fBufferTimeoutInMs.
     void DiscardIncompleteTimeframes();
 
+    /// Returns the credit of the sub-timeframe \p id to flpSender \p flpIndex
+    void SendCredit(uint16_t id, int flpIndex);
+
   protected:
     /// Overloads the Run() method of FairMQDevice
     void Run() override;
@@ -70,6 +79,7 @@ class EPNReceiver : public FairMQDevice
     std::string mInChannelName;
     std::string mOutChannelName;
     std::string mAckChannelName;
+    std::string mCreditChannelName;
 };
 
 } // namespace Devices
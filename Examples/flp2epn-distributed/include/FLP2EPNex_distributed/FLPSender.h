@@ -19,12 +19,13 @@
 #define ALICEO2_DEVICES_FLPSENDER_H_
 
 #include <string>
-#include <queue>
-#include <unordered_map>
+#include <memory>
 #include <chrono>
 
 #include <FairMQDevice.h>
 
+#include "DataFlow/SendScheduler.h"
+
 namespace o2 {
 namespace Devices {
 
@@ -33,6 +34,11 @@ namespace Devices {
 /// Sub-timeframes are received from the previous step (or generated in test-mode)
 /// and are sent to epnReceivers. Target epnReceiver is determined from the timeframe ID:
 /// targetEpnReceiver = timeframeId % numEPNs (numEPNs is same for every flpSender, although some may be inactive).
+///
+/// The output is shaped by a SendScheduler (staggering, per epnReceiver rate
+/// limit and bounded send queue). If an acknowledgement channel is given, the
+/// acknowledgements of the epnReceivers limit the number of sub-timeframes in
+/// flight towards each of them.
 
 class FLPSender : public FairMQDevice
 {
@@ -51,16 +57,22 @@ class FLPSender : public FairMQDevice
     void Run() override;
 
   private:
-    /// Sends the "oldest" element from the sub-timeframe container
-    void sendFrontData();
+    /// Sends all the sub-timeframes the scheduler releases
+    void sendReadyData();
+    /// Releases the credits of the timeframes acknowledged by the epnReceivers
+    void receiveAcknowledgements();
 
-    std::queue<FairMQParts> mSTFBuffer; ///< Buffer for sub-timeframes
-    std::queue<std::chrono::steady_clock::time_point> mArrivalTime; ///< Stores arrival times of sub-timeframes
+    using Scheduler = o2::dataflow::SendScheduler<FairMQParts>;
+    std::unique_ptr<Scheduler> mScheduler; ///< Buffer for sub-timeframes, decides when they are sent
 
     int mNumEPNs; ///< Number of epnReceivers
     unsigned int mIndex; ///< Index of the flpSender among other flpSenders
     unsigned int mSendOffset; ///< Offset for staggering output
     unsigned int mSendDelay; ///< Delay for staggering output
+    double mSendRate; ///< Maximum rate towards one epnReceiver in MB/s, 0 = unlimited
+    int mSendBurst; ///< Maximum burst towards one epnReceiver in bytes
+    int mMaxQueued; ///< Maximum number of buffered sub-timeframes
+    int mMaxInFlight; ///< Maximum number of unacknowledged sub-timeframes per epnReceiver, 0 = unlimited
 
     int mEventSize; ///< Size of the sub-timeframe body (only for test mode)
     int mTestMode; ///< Run the device in test mode (only syncSampler+flpSender+epnReceiver)
@@ -68,6 +80,7 @@ class FLPSender : public FairMQDevice
 
     std::string mInChannelName;
     std::string mOutChannelName;
+    std::string mCreditChannelName;
 };
 
 } // namespace Devices
@@ -30,7 +30,8 @@ void addCustomOptions(bpo::options_description& options)
     ("test-mode", bpo::value<int>()->default_value(0), "Run in test mode")
     ("in-chan-name", bpo::value<std::string>()->default_value("stf2"), "Name of the input channel (sub-time frames)")
     ("out-chan-name", bpo::value<std::string>()->default_value("tf"), "Name of the output channel (time frames)")
-    ("ack-chan-name", bpo::value<std::string>()->default_value("ack"), "Name of the acknowledgement channel");
+    ("ack-chan-name", bpo::value<std::string>()->default_value("ack"), "Name of the acknowledgement channel")
+    ("credit-chan-name", bpo::value<std::string>()->default_value(""), "Name of the channel returning the credits to the FLPs, one sub-channel per FLP (optional)");
 }
 
 FairMQDevice* getDevice(const FairMQProgOptions& config)
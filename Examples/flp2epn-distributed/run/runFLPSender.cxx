@@ -31,8 +31,13 @@ void addCustomOptions(bpo::options_description& options)
     ("test-mode", bpo::value<int>()->default_value(0), "Run in test mode")
     ("send-offset", bpo::value<int>()->default_value(0), "Offset for staggered sending")
     ("send-delay", bpo::value<int>()->default_value(8), "Delay for staggered sending")
+    ("send-rate", bpo::value<double>()->default_value(0.), "Maximum rate towards one EPN in MB/s (0 = unlimited)")
+    ("send-burst", bpo::value<int>()->default_value(1 << 20), "Maximum burst towards one EPN in bytes")
+    ("max-queued", bpo::value<int>()->default_value(1000), "Maximum number of buffered sub-timeframes")
+    ("max-in-flight", bpo::value<int>()->default_value(0), "Maximum number of unacknowledged sub-timeframes per EPN (0 = unlimited)")
     ("in-chan-name", bpo::value<std::string>()->default_value("stf1"), "Name of the input channel (sub-time frames)")
-    ("out-chan-name", bpo::value<std::string>()->default_value("stf2"), "Name of the output channel (sub-time frames)");
+    ("out-chan-name", bpo::value<std::string>()->default_value("stf2"), "Name of the output channel (sub-time frames)")
+    ("credit-chan-name", bpo::value<std::string>()->default_value(""), "Name of the channel receiving the credits returned by the EPNs (optional)");
 }
 
 FairMQDevice* getDevice(const FairMQProgOptions& config)
@@ -16,6 +16,8 @@
  */
 
 #include <cstddef> // size_t
+#include <cstring>
+#include <stdexcept>
 #include <fstream> // writing to file (DEBUG)
 
 #include <FairMQLogger.h>
@@ -43,6 +45,7 @@ EPNReceiver::EPNReceiver()
   , mInChannelName()
   , mOutChannelName()
   , mAckChannelName()
+  , mCreditChannelName()
 {
 }
 
@@ -57,6 +60,28 @@ void EPNReceiver::InitTask()
   mInChannelName = GetConfig()->GetValue<string>("in-chan-name");
   mOutChannelName = GetConfig()->GetValue<string>("out-chan-name");
   mAckChannelName = GetConfig()->GetValue<string>("ack-chan-name");
+  mCreditChannelName = GetConfig()->GetValue<string>("credit-chan-name");
+
+  if (!mCreditChannelName.empty() && fChannels.at(mCreditChannelName).size() != static_cast<size_t>(mNumFLPs)) {
+    throw runtime_error("The credit channel needs one sub-channel per FLP (num-flps)");
+  }
+}
+
+void EPNReceiver::SendCredit(uint16_t id, int flpIndex)
+{
+  if (mCreditChannelName.empty()) {
+    return;
+  }
+  if (flpIndex < 0 || flpIndex >= mNumFLPs) {
+    LOG(ERROR) << "No credit channel for FLP " << flpIndex;
+    return;
+  }
+  unique_ptr<FairMQMessage> credit(NewMessage(sizeof(uint16_t)));
+  memcpy(credit->GetData(), &id, sizeof(uint16_t));
+
+  if (fChannels.at(mCreditChannelName).at(flpIndex).Send(credit, 0) <= 0) {
+    LOG(ERROR) << "Could not send credit to FLP " << flpIndex << " without blocking";
+  }
 }
 
 void EPNReceiver::PrintBuffer(const unordered_map<uint16_t, TFBuffer>& buffer) const
@@ -88,6 +113,10 @@ void EPNReceiver::DiscardIncompleteTimeframes()
     if (duration_cast<milliseconds>(steady_clock::now() - (it->second).start).count() > mBufferTimeoutInMs) {
       LOG(WARN) << "Timeframe #" << it->first << " incomplete after " << mBufferTimeoutInMs << " milliseconds, discarding";
       mDiscardedSet.insert(it->first);
+      // the flpSenders which did send their part need the credits back anyway
+      for (auto flp : (it->second).flps) {
+        SendCredit(it->first, flp);
+      }
       mTimeframeBuffer.erase(it++);
       LOG(WARN) << "Number of discarded timeframes: " << mDiscardedSet.size();
     } else {
@@ -137,15 +166,18 @@ void EPNReceiver::Run()
         // if the received ID has not previously been discarded,
         // store the data part in the buffer
         mTimeframeBuffer[id].parts.AddPart(move(parts.At(1)));
+        mTimeframeBuffer[id].flps.push_back(header.flpIndex);
         // PrintBuffer(fTimeframeBuffer);
       }
       else
       {
         // if received ID has been previously discarded.
         LOG(WARN) << "Received part from an already discarded timeframe with id " << id;
+        SendCredit(id, header.flpIndex);
       }
 
-      if (mTimeframeBuffer[id].parts.Size() == mNumFLPs) {
+      auto buffered = mTimeframeBuffer.find(id);
+      if (buffered != mTimeframeBuffer.end() && (buffered->second).parts.Size() == mNumFLPs) {
         if (mTestMode > 0) {
           // Send an acknowledgement back to the sampler to measure the round trip time
           unique_ptr<FairMQMessage> ack(NewMessage(sizeof(uint16_t)));
@@ -164,6 +196,9 @@ void EPNReceiver::Run()
 
         // fTimeframeBuffer[id].end = steady_clock::now();
 
+        for (auto flp : mTimeframeBuffer[id].flps) {
+          SendCredit(id, flp);
+        }
         mTimeframeBuffer.erase(id);
       }
 
@@ -15,8 +15,12 @@
  * @author D. Klein, A. Rybalchenko, M. Al-Turany, C. Kouzinopoulos
  */
 
+#include <algorithm>
 #include <cstdint> // UINT64_MAX
 #include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
 
 #include <FairMQLogger.h>
 #include <FairMQMessage.h>
@@ -34,17 +38,21 @@ struct f2eHeader {
 };
 
 FLPSender::FLPSender()
-  : mSTFBuffer()
-  , mArrivalTime()
+  : mScheduler()
   , mNumEPNs(0)
   , mIndex(0)
   , mSendOffset(0)
   , mSendDelay(8)
+  , mSendRate(0.)
+  , mSendBurst(0)
+  , mMaxQueued(1000)
+  , mMaxInFlight(0)
   , mEventSize(10000)
   , mTestMode(0)
   , mTimeFrameId(0)
   , mInChannelName()
   , mOutChannelName()
+  , mCreditChannelName()
 {
 }
 
@@ -59,8 +67,33 @@ void FLPSender::InitTask()
   mTestMode = GetConfig()->GetValue<int>("test-mode");
   mSendOffset = GetConfig()->GetValue<int>("send-offset");
   mSendDelay = GetConfig()->GetValue<int>("send-delay");
+  mSendRate = GetConfig()->GetValue<double>("send-rate");
+  mSendBurst = GetConfig()->GetValue<int>("send-burst");
+  mMaxQueued = GetConfig()->GetValue<int>("max-queued");
+  mMaxInFlight = GetConfig()->GetValue<int>("max-in-flight");
   mInChannelName = GetConfig()->GetValue<string>("in-chan-name");
   mOutChannelName = GetConfig()->GetValue<string>("out-chan-name");
+  mCreditChannelName = GetConfig()->GetValue<string>("credit-chan-name");
+
+  if (mNumEPNs <= 0) {
+    throw runtime_error("num-epns must be positive");
+  }
+  if (mMaxInFlight > 0 && mCreditChannelName.empty()) {
+    throw runtime_error("max-in-flight requires a credit channel (credit-chan-name)");
+  }
+  if (mSendRate > 0. && mSendBurst <= 0) {
+    // the token bucket would never hold enough tokens for anything
+    throw runtime_error("send-rate requires a positive send-burst");
+  }
+
+  o2::dataflow::SendSchedulerConfig config;
+  config.nDestinations = mNumEPNs;
+  config.delay = milliseconds(mSendDelay * mSendOffset);
+  config.rate = mSendRate * 1e6;
+  config.burst = mSendBurst;
+  config.maxQueueSize = max(mMaxQueued, 1);
+  config.maxOutstanding = max(mMaxInFlight, 0);
+  mScheduler.reset(new Scheduler(config));
 }
 
 void FLPSender::Run()
@@ -72,12 +105,23 @@ void FLPSender::Run()
   FairMQChannel& dataInChannel = fChannels.at(mInChannelName).at(0);
 
   while (CheckCurrentState(RUNNING)) {
+    receiveAcknowledgements();
+    sendReadyData();
+
+    // stop reading the input while the send queue is full
+    if (mScheduler->full()) {
+      this_thread::sleep_for(microseconds(100));
+      continue;
+    }
+
     // initialize f2e header
     auto* header = new f2eHeader;
     if (mTestMode > 0) {
       // test-mode: receive and store id part in the buffer.
       FairMQMessagePtr id(NewMessage());
-      if (dataInChannel.Receive(id) > 0) {
+      // do not block while there is something to send
+      int received = mScheduler->size() > 0 ? dataInChannel.ReceiveAsync(id) : dataInChannel.Receive(id);
+      if (received > 0) {
         header->timeFrameId = *(static_cast<uint16_t*>(id->GetData()));
         header->flpIndex = mIndex;
       } else {
@@ -95,53 +139,59 @@ void FLPSender::Run()
       }
     }
 
+    uint16_t timeFrameId = header->timeFrameId;
     FairMQParts parts;
 
     parts.AddPart(NewMessage(header, sizeof(f2eHeader), [](void* data, void* hint){ delete static_cast<f2eHeader*>(hint); }, header));
     parts.AddPart(NewMessage());
 
-    // save the arrival time of the message.
-    mArrivalTime.push(steady_clock::now());
-
     if (mTestMode > 0) {
-      // test-mode: initialize and store data part in the buffer.
+      // test-mode: initialize data part.
       parts.At(1)->Copy(*baseMsg);
-      mSTFBuffer.push(move(parts));
     } else {
       // regular mode: receive data part from input
-      if (dataInChannel.Receive(parts.At(1)) >= 0) {
-        mSTFBuffer.push(move(parts));
-      } else {
+      if (dataInChannel.Receive(parts.At(1)) < 0) {
         // if nothing was received, try again
         continue;
       }
     }
 
-    // if offset is 0 - send data out without staggering.
-    if (mSendOffset == 0 && mSTFBuffer.size() > 0) {
-      sendFrontData();
-    } else if (mSTFBuffer.size() > 0) {
-      if (duration_cast<milliseconds>(steady_clock::now() - mArrivalTime.front()).count() >= (mSendDelay * mSendOffset)) {
-        sendFrontData();
-      } else {
-        // LOG(INFO) << "buffering...";
-      }
-    }
+    // the scheduler saves the arrival time of the message.
+    size_t bytes = sizeof(f2eHeader) + parts.At(1)->GetSize();
+    mScheduler->push(move(parts), timeFrameId, bytes);
   }
 }
 
-inline void FLPSender::sendFrontData()
+void FLPSender::receiveAcknowledgements()
 {
-  f2eHeader header = *(static_cast<f2eHeader*>(mSTFBuffer.front().At(0)->GetData()));
-  uint16_t currentTimeframeId = header.timeFrameId;
-
-  // for which EPN is the message?
-  int direction = currentTimeframeId % mNumEPNs;
-  // LOG(INFO) << "Sending event " << currentTimeframeId << " to EPN#" << direction << "...";
+  if (mCreditChannelName.empty()) {
+    return;
+  }
+  FairMQChannel& creditChannel = fChannels.at(mCreditChannelName).at(0);
+  while (true) {
+    FairMQMessagePtr ack(NewMessage());
+    if (creditChannel.ReceiveAsync(ack) <= 0) {
+      break;
+    }
+    if (ack->GetSize() != sizeof(uint16_t)) {
+      LOG(WARN) << "Ignoring acknowledgement of unexpected size " << ack->GetSize();
+      continue;
+    }
+    uint16_t id;
+    memcpy(&id, ack->GetData(), sizeof(uint16_t));
+    mScheduler->acknowledge(id);
+  }
+}
 
-  if (Send(mSTFBuffer.front(), mOutChannelName, direction, 0) < 0) {
-    LOG(ERROR) << "Failed to queue sub-timeframe #" << currentTimeframeId << " to EPN[" << direction << "]";
+void FLPSender::sendReadyData()
+{
+  FairMQParts parts;
+  uint32_t currentTimeframeId;
+  size_t direction;
+  while (mScheduler->pop(parts, currentTimeframeId, direction)) {
+    // LOG(INFO) << "Sending event " << currentTimeframeId << " to EPN#" << direction << "...";
+    if (Send(parts, mOutChannelName, direction, 0) < 0) {
+      LOG(ERROR) << "Failed to queue sub-timeframe #" << currentTimeframeId << " to EPN[" << direction << "]";
+    }
   }
-  mSTFBuffer.pop();
-  mArrivalTime.pop();
 }
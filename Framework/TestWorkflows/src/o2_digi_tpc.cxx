@@ -0,0 +1,289 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "o2_digi_tpc.h"
+
+#include "Framework/AlgorithmSpec.h"
+#include "Framework/ConfigParamRegistry.h"
+#include "Framework/ControlService.h"
+#include "Framework/DataAllocator.h"
+
+#include "FairMQLogger.h"
+
+#include "Steer/InteractionSampler.h"
+#include "SimulationDataFormat/MCCompLabel.h"
+#include "SimulationDataFormat/MCTruthContainer.h"
+#include "TPCBase/CRU.h"
+#include "TPCBase/Digit.h"
+#include "TPCBase/Sector.h"
+#include "TPCSimulation/DigitContainer.h"
+#include "TPCSimulation/Digitizer.h"
+#include "TPCSimulation/Point.h"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace o2::framework;
+using SubSpecificationType = o2::header::DataHeader::SubSpecificationType;
+
+namespace o2 {
+namespace workflows {
+
+std::vector<int> getTPCLaneSectors(int nLanes, int lane)
+{
+  std::vector<int> sectors;
+  const int maxSector = o2::TPC::Sector::MAXSECTOR;
+  for (int s = lane * maxSector / nLanes; s < (lane + 1) * maxSector / nLanes; ++s) {
+    sectors.push_back(s);
+  }
+  return sectors;
+}
+
+std::vector<int> getTPCLaneInputSectors(int nLanes, int lane)
+{
+  // signals only diffuse into the adjacent sectors of the same side
+  const int sectorsPerSide = o2::TPC::Sector::MAXSECTOR / 2;
+  std::vector<int> sectors;
+  for (auto s : getTPCLaneSectors(nLanes, lane)) {
+    const int side = s / sectorsPerSide;
+    sectors.push_back(s);
+    sectors.push_back(side * sectorsPerSide + (s + 1) % sectorsPerSide);
+    sectors.push_back(side * sectorsPerSide + (s + sectorsPerSide - 1) % sectorsPerSide);
+  }
+  std::sort(sectors.begin(), sectors.end());
+  sectors.erase(std::unique(sectors.begin(), sectors.end()), sectors.end());
+  return sectors;
+}
+
+SubSpecificationType getTPCHitsSubSpec(int lane, int sector)
+{
+  return static_cast<SubSpecificationType>(lane * o2::TPC::Sector::MAXSECTOR + sector);
+}
+
+DataProcessorSpec tpc_hit_reader(int nLanes)
+{
+  Outputs outputs;
+  for (int lane = 0; lane < nLanes; ++lane) {
+    outputs.emplace_back(OutputSpec{"TPC", "COLLISION", static_cast<SubSpecificationType>(lane), OutputSpec::Timeframe});
+    for (auto s : getTPCLaneInputSectors(nLanes, lane)) {
+      outputs.emplace_back(OutputSpec{"TPC", "HITS", getTPCHitsSubSpec(lane, s), OutputSpec::Timeframe});
+    }
+  }
+
+  return {
+    "tpc-hit-reader",
+    Inputs{},
+    outputs,
+    AlgorithmSpec{
+      [nLanes](InitContext &setup) {
+        auto hitFile = setup.options().get<std::string>("hitFile");
+        auto interactionRate = setup.options().get<double>("interactionRate");
+
+        struct ReaderState {
+          std::unique_ptr<TFile> file;
+          TTree *tree = nullptr;
+          std::array<std::vector<o2::TPC::HitGroup>*, o2::TPC::Sector::MAXSECTOR> hits{};
+          std::vector<o2::TPC::HitGroup> noHits;
+          o2::steer::InteractionSampler sampler;
+          int nEvents = 0;
+          int event = 0;
+        };
+        auto state = std::make_shared<ReaderState>();
+
+        state->file.reset(TFile::Open(hitFile.c_str()));
+        if (!state->file || state->file->IsZombie()) {
+          throw std::runtime_error("Cannot open TPC hit file " + hitFile);
+        }
+        state->tree = dynamic_cast<TTree*>(state->file->Get("o2sim"));
+        if (state->tree == nullptr) {
+          throw std::runtime_error("No o2sim tree in TPC hit file " + hitFile);
+        }
+        for (int s = 0; s < o2::TPC::Sector::MAXSECTOR; ++s) {
+          const std::string branchName = "TPCHitsSector" + std::to_string(s);
+          if (state->tree->GetBranch(branchName.c_str()) == nullptr) {
+            continue;
+          }
+          state->tree->SetBranchAddress(branchName.c_str(), &state->hits[s]);
+        }
+        state->nEvents = state->tree->GetEntries();
+
+        state->sampler.setInteractionRate(interactionRate);
+        state->sampler.init();
+        LOG(INFO) << "Digitizing " << state->nEvents << " events from " << hitFile << " at an interaction rate of "
+                  << interactionRate << " Hz";
+
+        return [state, nLanes](ProcessingContext &ctx) {
+          if (state->event >= state->nEvents) {
+            return;
+          }
+          state->tree->GetEntry(state->event);
+          const auto record = state->sampler.generateCollisionTime();
+          const TPCCollisionInfo info{ state->event, state->event + 1 == state->nEvents, record.timeNS };
+
+          // each lane gets its own copy, such that the lanes are independent of each other
+          for (int lane = 0; lane < nLanes; ++lane) {
+            ctx.allocator().snapshot(OutputSpec{"TPC", "COLLISION", static_cast<SubSpecificationType>(lane), OutputSpec::Timeframe}, info);
+            for (auto s : getTPCLaneInputSectors(nLanes, lane)) {
+              auto &hits = state->hits[s] ? *state->hits[s] : state->noHits;
+              ctx.allocator().snapshot(OutputSpec{"TPC", "HITS", getTPCHitsSubSpec(lane, s), OutputSpec::Timeframe}, hits);
+            }
+          }
+
+          if (++state->event == state->nEvents) {
+            ctx.services().get<ControlService>().readyToQuit(false);
+          }
+        };
+      }
+    },
+    Options{
+      {"hitFile", VariantType::String, "o2sim.root", {"File with the TPC hits"}},
+      {"interactionRate", VariantType::Double, 50000., {"Interaction rate in Hz"}}
+    }
+  };
+}
+
+DataProcessorSpec digi_tpc(int nLanes, int lane)
+{
+  Inputs inputs{
+    InputSpec{"collision", "TPC", "COLLISION", static_cast<SubSpecificationType>(lane), InputSpec::Timeframe}
+  };
+  for (auto s : getTPCLaneInputSectors(nLanes, lane)) {
+    inputs.emplace_back(InputSpec{"hits" + std::to_string(s), "TPC", "HITS", getTPCHitsSubSpec(lane, s), InputSpec::Timeframe});
+  }
+
+  Outputs outputs;
+  for (auto s : getTPCLaneSectors(nLanes, lane)) {
+    const auto subSpec = static_cast<SubSpecificationType>(s);
+    outputs.emplace_back(OutputSpec{"TPC", "DIGITS", subSpec, OutputSpec::Timeframe});
+    outputs.emplace_back(OutputSpec{"TPC", "DIGITSMCTR", subSpec, OutputSpec::Timeframe});
+    outputs.emplace_back(OutputSpec{"TPC", "DIGITSTF", subSpec, OutputSpec::Timeframe});
+  }
+
+  return {
+    "tpc-digitizer-" + std::to_string(lane),
+    inputs,
+    outputs,
+    AlgorithmSpec{
+      [nLanes, lane](InitContext &setup) {
+        const int tfOrbits = setup.options().get<int>("tfOrbits");
+
+        struct DigitizerState {
+          std::unique_ptr<o2::TPC::Digitizer> digitizer;
+          std::vector<int> sectors;                  ///< Sectors of which the digits are sent
+          std::vector<int> inputSectors;             ///< Sectors of which the hits are digitized
+          std::vector<std::string> bindings;         ///< Input bindings of the hits of the input sectors
+          std::array<bool, o2::TPC::Sector::MAXSECTOR> isOwnSector{};
+          std::array<std::unique_ptr<o2::TPC::DigitContainer>, o2::TPC::Sector::MAXSECTOR> containers;
+          std::unique_ptr<o2::TPC::DigitContainer> neighbourContainer; ///< Signals of the neighbouring sectors, discarded after each event
+          std::array<std::vector<o2::TPC::Digitizer::ForeignSignal>, o2::TPC::Sector::MAXSECTOR> foreignSignals;
+          std::vector<o2::TPC::Digit> digits;
+          o2::dataformats::MCTruthContainer<o2::MCCompLabel> labels;
+          double timeFrameLength = 0.;               ///< Length of a timeframe in us
+          int timeFrame = -1;                        ///< Timeframe which is currently being filled
+        };
+        auto state = std::make_shared<DigitizerState>();
+
+        state->digitizer = std::make_unique<o2::TPC::Digitizer>();
+        state->digitizer->init();
+        o2::TPC::Digitizer::setContinuousReadout(true);
+
+        state->sectors = getTPCLaneSectors(nLanes, lane);
+        state->inputSectors = getTPCLaneInputSectors(nLanes, lane);
+        for (auto s : state->sectors) {
+          state->isOwnSector[s] = true;
+          state->containers[s] = std::make_unique<o2::TPC::DigitContainer>();
+        }
+        for (auto s : state->inputSectors) {
+          state->bindings.emplace_back("hits" + std::to_string(s));
+        }
+        state->timeFrameLength = tfOrbits * o2::steer::InteractionSampler::OrbitDuration * 0.001;
+
+        // send the digits of the own sectors in a timeframe, up to (excluding) the given time bin
+        auto sendDigits = [state](ProcessingContext &ctx, int timeFrame, int lastTimeBin) {
+          const int firstTimeBin = o2::TPC::Digitizer::getTimeBinFromTime(timeFrame * state->timeFrameLength);
+          for (auto s : state->sectors) {
+            const auto subSpec = static_cast<SubSpecificationType>(s);
+            state->digits.clear();
+            state->labels.clear();
+            state->containers[s]->fillOutputContainer(&state->digits, state->labels, nullptr, lastTimeBin, true);
+            // the digits are sent as a plain array, a std::vector would be ROOT serialized
+            auto digits = ctx.allocator().make<o2::TPC::Digit>(OutputSpec{"TPC", "DIGITS", subSpec, OutputSpec::Timeframe}, state->digits.size());
+            std::copy(state->digits.begin(), state->digits.end(), digits.begin());
+            ctx.allocator().snapshot(OutputSpec{"TPC", "DIGITSMCTR", subSpec, OutputSpec::Timeframe}, state->labels);
+            ctx.allocator().snapshot(OutputSpec{"TPC", "DIGITSTF", subSpec, OutputSpec::Timeframe},
+                                     TPCDigitTimeFrameInfo{ timeFrame, firstTimeBin, lastTimeBin - 1 });
+          }
+        };
+
+        // send the open timeframe and all following ones before the given timeframe, one message per timeframe
+        auto sendTimeFrames = [state, sendDigits](ProcessingContext &ctx, int endTimeFrame) {
+          for (; state->timeFrame < endTimeFrame; ++state->timeFrame) {
+            sendDigits(ctx, state->timeFrame, o2::TPC::Digitizer::getTimeBinFromTime((state->timeFrame + 1) * state->timeFrameLength));
+          }
+        };
+
+        return [state, sendDigits, sendTimeFrames](ProcessingContext &ctx) {
+          const auto &info = ctx.inputs().get<TPCCollisionInfo>("collision");
+          const float eventTime = static_cast<float>(info.timeNS * 0.001); // in us
+          const int timeFrame = static_cast<int>(eventTime / state->timeFrameLength);
+          if (state->timeFrame < 0) {
+            state->timeFrame = timeFrame;
+          }
+
+          // Signals which diffused into another sector are added after all sectors are processed and in sector
+          // order, as in the DigitizerTask. Signals ending up in sectors of other lanes are digitized there.
+          state->neighbourContainer = std::make_unique<o2::TPC::DigitContainer>();
+          for (size_t i = 0; i < state->inputSectors.size(); ++i) {
+            const int s = state->inputSectors[i];
+            auto hits = ctx.inputs().get<std::vector<o2::TPC::HitGroup>>(state->bindings[i].c_str());
+            auto &container = state->isOwnSector[s] ? *state->containers[s] : *state->neighbourContainer;
+            state->foreignSignals[s].clear();
+            state->digitizer->Process(container, *hits, o2::TPC::Sector(s), eventTime, info.eventID, &state->foreignSignals[s]);
+          }
+          for (auto s : state->inputSectors) {
+            for (auto &signal : state->foreignSignals[s]) {
+              const int sector = o2::TPC::CRU(signal.cru).sector().getSector();
+              if (!state->isOwnSector[sector]) {
+                continue;
+              }
+              state->containers[sector]->addDigit(info.eventID, signal.trackID, signal.cru, signal.timeBin, signal.row, signal.pad, signal.charge);
+            }
+          }
+
+          // Signals of this and all later collisions are at or after the time bin of this collision, hence all
+          // time frames before the one of this collision are complete
+          if (info.isLastEvent) {
+            // the signals of the last collision end at most one full drift time after it, the last timeframe
+            // takes all remaining digits
+            const int lastTimeFrame = static_cast<int>((eventTime + o2::TPC::Digitizer::getTime(0.f)) / state->timeFrameLength);
+            sendTimeFrames(ctx, lastTimeFrame);
+            sendDigits(ctx, state->timeFrame, std::numeric_limits<int>::max());
+            ctx.services().get<ControlService>().readyToQuit(false);
+          }
+          else {
+            sendTimeFrames(ctx, timeFrame);
+          }
+        };
+      }
+    },
+    Options{
+      {"tfOrbits", VariantType::Int, 256, {"Length of a timeframe in LHC orbits"}}
+    }
+  };
+}
+
+} // namespace workflows
+} // namespace o2
@@ -0,0 +1,58 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef WORKFLOWS_O2_DIGI_TPC
+#define WORKFLOWS_O2_DIGI_TPC
+
+#include "Framework/DataProcessorSpec.h"
+#include "Headers/DataHeader.h"
+
+#include <vector>
+
+namespace o2 {
+namespace workflows{
+
+  /// Collision record sent along with the hits of one MC event
+  struct TPCCollisionInfo {
+    int eventID;      ///< MC event ID
+    int isLastEvent;  ///< 1 for the last event to be digitized
+    double timeNS;    ///< Collision time in ns since the start of the run
+  };
+
+  /// Range of time bins covered by a chunk of digits
+  /// Each chunk holds exactly one timeframe, timeframes without collisions are sent
+  /// as empty chunks. The chunk of the last timeframe extends to the last digit.
+  struct TPCDigitTimeFrameInfo {
+    int timeFrame;     ///< Index of the timeframe of the chunk
+    int firstTimeBin;  ///< First time bin of the chunk
+    int lastTimeBin;   ///< Last time bin of the chunk
+  };
+
+  /// Sectors whose digits are produced by one digitizer lane
+  /// The sectors are split into contiguous blocks, to minimise the number of neighbouring sectors of other lanes
+  std::vector<int> getTPCLaneSectors(int nLanes, int lane);
+
+  /// Sectors whose hits are needed by one digitizer lane
+  /// Besides its own sectors, a lane also digitizes the hits of the neighbouring sectors, keeping only the
+  /// signals which diffuse into its own sectors. The result is thus independent of the number of lanes.
+  std::vector<int> getTPCLaneInputSectors(int nLanes, int lane);
+
+  /// Sub specification of the hits of a sector sent to a lane
+  o2::header::DataHeader::SubSpecificationType getTPCHitsSubSpec(int lane, int sector);
+
+  /// Reads the TPC hits event by event and attaches the collision times from the InteractionSampler
+  o2::framework::DataProcessorSpec tpc_hit_reader(int nLanes);
+
+  /// Continuous readout digitization of the sectors of one lane, sending the digits per sector and timeframe
+  o2::framework::DataProcessorSpec digi_tpc(int nLanes, int lane);
+}
+}
+
+#endif // WORKFLOWS_O2_DIGI_TPC
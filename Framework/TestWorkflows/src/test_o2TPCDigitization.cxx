@@ -0,0 +1,32 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#include "Framework/runDataProcessing.h"
+#include "o2_digi_tpc.h"
+
+using namespace o2::framework;
+using namespace o2::workflows;
+
+// Number of digitizer devices, the sectors are distributed over them
+constexpr int nDigitizerLanes = 4;
+
+// The hits are read event by event and digitized in continuous readout mode.
+// The digits are sent per sector and timeframe as arrays of o2::TPC::Digit
+// ("TPC", "DIGITS", sector) with the MC labels ("TPC", "DIGITSMCTR", sector)
+// and the covered time bins ("TPC", "DIGITSTF", sector).
+void defineDataProcessing(WorkflowSpec &specs) {
+  WorkflowSpec workflow{
+    tpc_hit_reader(nDigitizerLanes),
+  };
+  for (int lane = 0; lane < nDigitizerLanes; ++lane) {
+    workflow.push_back(digi_tpc(nDigitizerLanes, lane));
+  }
+
+  specs.swap(workflow);
+}
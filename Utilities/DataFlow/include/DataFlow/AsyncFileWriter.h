@@ -0,0 +1,114 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef DATAFLOW_ASYNCFILEWRITER_H_
+#define DATAFLOW_ASYNCFILEWRITER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace o2 { namespace DataFlow {
+
+/// A sequential file writer which moves the actual disk I/O to a
+/// dedicated thread.
+///
+/// Data passed to write() is copied into one of a fixed set of aligned
+/// buffers. Full buffers are handed over to the I/O thread and the caller
+/// continues filling the next free one, so that a slow disk only blocks the
+/// caller once all the buffers are in flight. When @a directIO is requested
+/// the files are opened with O_DIRECT, bypassing the page cache. Files are
+/// closed asynchronously as well, so that open() can be called for the next
+/// file right after close().
+///
+/// Errors happening in the I/O thread are reported by throwing
+/// std::runtime_error from the next call on the writer.
+class AsyncFileWriter
+{
+public:
+  static constexpr size_t sAlignment = 4096;
+
+  AsyncFileWriter(size_t bufferSize, size_t nBuffers, bool directIO);
+  ~AsyncFileWriter();
+
+  AsyncFileWriter(const AsyncFileWriter&) = delete;
+  AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+  /// Open @a filename for writing, truncating it. A file must not be open.
+  void open(const std::string& filename);
+  /// Append @a size bytes from @a data to the current file.
+  void write(const void* data, size_t size);
+  /// Queue the remaining data and the closing of the current file.
+  void close();
+  /// Block until all the queued data has reached the disk.
+  void flush();
+
+  bool isOpen() const { return mFd >= 0; }
+  /// Number of bytes appended to the current file so far
+  size_t tell() const { return mFileSize; }
+  /// Total number of bytes written to disk by the I/O thread
+  size_t bytesWritten() const { return mBytesWritten.load(std::memory_order_relaxed); }
+  /// Number of buffers waiting to be written
+  size_t queueDepth() const { return mQueueDepth.load(std::memory_order_relaxed); }
+  /// True if the current file is actually written with O_DIRECT
+  bool directIO() const { return mFileDirect; }
+
+private:
+  struct Buffer {
+    char* data;
+    size_t size;
+  };
+
+  /// A unit of work for the I/O thread
+  struct Chunk {
+    Buffer* buffer;   // may be null if only closing
+    int fd;
+    bool directIO;    // the file was opened with O_DIRECT
+    bool closeFile;   // close the file after writing
+    size_t fileSize;  // logical size of the file, used when closing
+  };
+
+  void submit(Chunk chunk);
+  Buffer* acquireBuffer();
+  void ioLoop();
+  void checkError();
+
+  size_t mBufferSize;
+  bool mDirectIO;
+  std::vector<std::unique_ptr<char, void (*)(void*)>> mStorage;
+  std::vector<Buffer> mBuffers;
+
+  int mFd;
+  bool mFileDirect;
+  size_t mFileSize;
+  Buffer* mCurrent;
+
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  std::deque<Chunk> mPending;
+  std::vector<Buffer*> mFree;
+  bool mBusy;
+  bool mStop;
+  std::string mError;
+
+  std::atomic<size_t> mBytesWritten;
+  std::atomic<size_t> mQueueDepth;
+  std::thread mThread;
+};
+
+} } // namespace o2::DataFlow
+
+#endif // DATAFLOW_ASYNCFILEWRITER_H_
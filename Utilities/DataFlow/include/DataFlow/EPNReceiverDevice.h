@@ -12,25 +12,29 @@
 #define ALICEO2_DEVICES_EPNRECEIVER_H_
 
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
-#include <chrono>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include <FairMQDevice.h>
+#include "DataFlow/TimeframeAggregationRing.h"
 
 namespace o2 {
 namespace Devices {
 
-/// Container for (sub-)timeframes
-
-struct TFBuffer
-{
-  FairMQParts parts;
-  std::chrono::steady_clock::time_point start;
-  std::chrono::steady_clock::time_point end;
-};
-
 /// Receives sub-timeframes from the flpSenders and merges these into full timeframes.
+///
+/// Every sub-channel of the input channel is served by its own receiver
+/// thread. The sub-timeframes are collected in a TimeframeAggregationRing,
+/// indexed by timeframe id, and the complete timeframes are published by the
+/// device thread.
+///
+/// If a credit channel is configured, every received sub-timeframe is
+/// acknowledged to the flpSender it came from once the EPN is done with it
+/// (published, discarded or rejected), on the sub-channel given by the FLP
+/// index. This releases the credits of the flpSenders limiting the
+/// sub-timeframes in flight (max-in-flight).
 
 class EPNReceiverDevice : public FairMQDevice
 {
@@ -39,26 +43,40 @@ class EPNReceiverDevice : public FairMQDevice
     ~EPNReceiverDevice() final = default;
     void InitTask() final;
 
-    /// Prints the contents of the timeframe container
-    void PrintBuffer(const std::unordered_map<uint16_t, TFBuffer> &buffer) const;
-
-    /// Discared incomplete timeframes after \p fBufferTimeoutInMs.
+    /// Discared incomplete timeframes after \p mBufferTimeoutInMs.
     void DiscardIncompleteTimeframes();
 
   protected:
+    using AggregationRing = o2::dataflow::TimeframeAggregationRing<FairMQParts, uint16_t>;
+
     /// Overloads the Run() method of FairMQDevice
     void Run() override;
 
-    std::unordered_map<uint16_t, TFBuffer> mTimeframeBuffer; ///< Stores (sub-)timeframes
-    std::unordered_set<uint16_t> mDiscardedSet; ///< Set containing IDs of dropped timeframes
+    /// Receives the sub-timeframes of sub-channel \p index of the input channel
+    void ReceiveSubtimeframes(int index);
+
+    /// Notifies the ack channel that timeframe \p id is done with
+    void SendAcknowledgement(uint16_t id);
+
+    /// Returns the credit of the sub-timeframe \p id to flpSender \p flpIndex
+    void SendCredit(uint16_t id, int flpIndex);
+
+    /// Adds the index and sends a complete timeframe
+    void PublishTimeframe(uint16_t id, std::vector<FairMQParts>& subtimeframes);
+
+    std::unique_ptr<AggregationRing> mTimeframeBuffer; ///< Stores (sub-)timeframes
+    std::atomic<size_t> mNumDiscarded{ 0 }; ///< Number of dropped timeframes
 
     int mNumFLPs = 0; ///< Number of flpSenders
     int mBufferTimeoutInMs = 5000; ///< Time after which incomplete timeframes are dropped
+    int mBufferCapacity = 256; ///< Number of timeframes which can be buffered at the same time
     int mTestMode = 0; ///< Run the device in test mode (only syncSampler+flpSender+epnReceiver)
 
     std::string mInChannelName = "";
     std::string mOutChannelName = "";
     std::string mAckChannelName = "";
+    std::string mCreditChannelName = ""; ///< One sub-channel per flpSender, empty to disable
+    std::mutex mCreditMutex; ///< Serializes the sends on the credit channel
 };
 
 } // namespace Devices
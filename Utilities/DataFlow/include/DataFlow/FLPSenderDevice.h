@@ -12,12 +12,13 @@
 #define ALICEO2_DEVICES_FLPSENDER_H_
 
 #include <string>
-#include <queue>
-#include <unordered_map>
+#include <memory>
 #include <chrono>
 
 #include <FairMQDevice.h>
 
+#include "DataFlow/SendScheduler.h"
+
 namespace o2 {
 namespace Devices {
 
@@ -26,6 +27,13 @@ namespace Devices {
 /// Sub-timeframes are received from the previous step (or generated in test-mode)
 /// and are sent to epnReceivers. Target epnReceiver is determined from the timeframe ID:
 /// targetEpnReceiver = timeframeId % numEPNs (numEPNs is same for every flpSender, although some may be inactive).
+///
+/// To avoid all the flpSenders hitting the same epnReceiver at once, the
+/// output is shaped by a SendScheduler: each flpSender delays its output by
+/// send-offset * send-delay ms, the rate towards each epnReceiver can be
+/// limited with a token bucket and the number of sub-timeframes not yet
+/// acknowledged by an epnReceiver can be bounded. When the send queue is
+/// full no more input is read, pushing back on the previous step.
 
 class FLPSenderDevice : public FairMQDevice
 {
@@ -44,16 +52,22 @@ class FLPSenderDevice : public FairMQDevice
     void Run() final;
 
   private:
-    /// Sends the "oldest" element from the sub-timeframe container
-    void sendFrontData();
+    /// Sends all the sub-timeframes the scheduler releases
+    void sendReadyData();
+    /// Releases the credits of the timeframes acknowledged by the epnReceivers
+    void receiveAcknowledgements();
 
-    std::queue<FairMQParts> mSTFBuffer; ///< Buffer for sub-timeframes
-    std::queue<std::chrono::steady_clock::time_point> mArrivalTime; ///< Stores arrival times of sub-timeframes
+    using Scheduler = o2::dataflow::SendScheduler<FairMQParts>;
+    std::unique_ptr<Scheduler> mScheduler; ///< Buffer for sub-timeframes, decides when they are sent
 
     int mNumEPNs = 0; ///< Number of epnReceivers
     unsigned int mIndex = 0; ///< Index of the flpSender among other flpSenders
     unsigned int mSendOffset = 0; ///< Offset for staggering output
     unsigned int mSendDelay = 8; ///< Delay for staggering output
+    double mSendRate = 0.; ///< Maximum rate towards one epnReceiver in MB/s, 0 = unlimited
+    int mSendBurst = 0; ///< Maximum burst towards one epnReceiver in bytes
+    int mMaxQueued = 1000; ///< Maximum number of buffered sub-timeframes
+    int mMaxInFlight = 0; ///< Maximum number of unacknowledged sub-timeframes per epnReceiver, 0 = unlimited
 
     int mEventSize = 10000; ///< Size of the sub-timeframe body (only for test mode)
     int mTestMode = false; ///< Run the device in test mode (only syncSampler+flpSender+epnReceiver)
@@ -61,6 +75,7 @@ class FLPSenderDevice : public FairMQDevice
 
     std::string mInChannelName = "";
     std::string mOutChannelName = "";
+    std::string mCreditChannelName = "";
     int mLastTimeframeId = -1;
 };
 
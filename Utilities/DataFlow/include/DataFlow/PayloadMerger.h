@@ -10,25 +10,68 @@
 #ifndef PAYLOAD_MERGER_H
 #define PAYLOAD_MERGER_H
 
-#include <map>
+#include <algorithm>
 #include <cstdint>
 #include <vector>
 #include <functional>
 #include <cstring>
+#include <memory>
+#include <utility>
 
 #include <fairmq/FairMQMessage.h>
+#include <fairmq/FairMQParts.h>
+#include <fairmq/FairMQTransportFactory.h>
 
 namespace o2 { namespace dataflow {
 /// Helper class that given a set of FairMQMessage, merges (part of) their
-/// payload into a separate memory area.
+/// payload into a separate memory area, or into a multipart message
+/// referencing the original buffers.
 ///
 /// - Append multiple messages via the aggregate method 
-/// - Finalise buffer creation with the finalise call.
+/// - Finalise buffer creation with one of the finalise calls.
 template <typename ID>
 class PayloadMerger {
 public:
   using MergeableId = ID;
-  using MessageMap = std::multimap<MergeableId, std::unique_ptr<FairMQMessage>>;
+
+  /// Flat container of the aggregated messages, sorted by id. Messages with
+  /// the same id are kept in arrival order. Ids are expected to arrive
+  /// mostly in increasing order, so that insertion is an append.
+  class MessageMap {
+  public:
+    using value_type = std::pair<MergeableId, std::unique_ptr<FairMQMessage>>;
+    using iterator = typename std::vector<value_type>::iterator;
+
+    void emplace(const MergeableId &id, std::unique_ptr<FairMQMessage> &&payload) {
+      auto pos = std::upper_bound(mParts.begin(), mParts.end(), id, Compare{});
+      mParts.emplace(pos, id, std::move(payload));
+    }
+
+    std::pair<iterator, iterator> equal_range(const MergeableId &id) {
+      return std::equal_range(mParts.begin(), mParts.end(), id, Compare{});
+    }
+
+    size_t count(const MergeableId &id) {
+      auto range = equal_range(id);
+      return range.second - range.first;
+    }
+
+    void erase(const MergeableId &id) {
+      auto range = equal_range(id);
+      mParts.erase(range.first, range.second);
+    }
+
+    size_t size() const { return mParts.size(); }
+    bool empty() const { return mParts.empty(); }
+
+  private:
+    struct Compare {
+      bool operator()(const value_type &lhs, const MergeableId &rhs) const { return lhs.first < rhs; }
+      bool operator()(const MergeableId &lhs, const value_type &rhs) const { return lhs < rhs.first; }
+    };
+    std::vector<value_type> mParts;
+  };
+
   using PayloadExtractor = std::function<size_t(char **, char *, size_t)>;
   using IdExtractor = std::function<MergeableId(std::unique_ptr<FairMQMessage>&)>;
   using MergeCompletionCheker = std::function<bool(MergeableId, MessageMap &)>;
@@ -43,7 +86,9 @@ public:
     :
       mMakeId{makeId},
       mCheckIfComplete{checkIfComplete},
-      mExtractPayload{extractPayload}
+      mExtractPayload{extractPayload},
+      mPartsMap{},
+      mExtracted{}
   {
   }
 
@@ -52,7 +97,7 @@ public:
   ///         specified id policy (mMakeId callback).
   MergeableId aggregate(std::unique_ptr<FairMQMessage> &payload) {
     auto id = mMakeId(payload);
-    mPartsMap.emplace(std::make_pair(id, std::move(payload)));
+    mPartsMap.emplace(id, std::move(payload));
     return id;
   }
 
@@ -61,42 +106,28 @@ public:
   /// The decision on whether the merge must happen is done by the constructor
   /// specified policy mCheckIfComplete which can, for example, decide
   /// to merge when a certain number of subparts are reached.
-  /// Merging at the moment requires an extra copy, but in principle this could
-  /// be easily extended to support scatter - gather.
+  /// The buffer is allocated once with the total size of the extracted
+  /// payloads and filled in a single pass. It must be freed with delete[].
+  /// If the extracted payloads are empty, no buffer is allocated and
+  /// @out is set to nullptr.
   size_t finalise(char **out, MergeableId &id) {
     *out = nullptr;
     if (mCheckIfComplete(id, mPartsMap) == false) {
       return 0;
     }
-    // If we are here, it means we can send the messages that belong
-    // to some predefined class of equivalence, identified by the MERGEABLE_ID,
-    // to the receiver. This is done by the following process:
-    // 
-    // - Extract what we actually want to send (this might be data embedded inside the message itself)
-    // - Calculate the aggregate size of all the payloads.
-    // - Copy all the parts into a final payload
-    // - Create the header part
-    // - Create the payload part
-    // - Send
-    std::vector<std::pair<char *, size_t>> parts;
-
-    size_t sum = 0;
-    auto range = mPartsMap.equal_range(id);
-    for (auto hi = range.first, he = range.second; hi != he; ++hi) {
-      std::unique_ptr<FairMQMessage> &payload = hi->second;
-      std::pair<char *, size_t> part;
-      part.second = mExtractPayload(&part.first, reinterpret_cast<char *>(payload->GetData()), payload->GetSize());
-      parts.push_back(part);
-      sum += part.second;
+    size_t sum = extract(id);
+    if (sum == 0) {
+      // nothing to hand out, a 0 return must not leave a buffer behind
+      mPartsMap.erase(id);
+      return 0;
     }
 
-    auto *payload = new char[sum]();
-    size_t offset = 0;
-    for (auto &part : parts) {
-      // Right now this does a copy. In principle this could be done with some sort of
-      // vectorized I/O
-      memcpy(payload + offset, part.first, part.second);
-      offset += part.second;
+    // no need to initialise the buffer, it is fully overwritten
+    auto *payload = new char[sum];
+    char *cursor = payload;
+    for (auto &part : mExtracted) {
+      memcpy(cursor, part.first, part.second);
+      cursor += part.second;
     }
 
     mPartsMap.erase(id);
@@ -104,6 +135,37 @@ public:
     return sum;
   }
 
+  /// Scatter - gather version of the merging: the extracted payloads of the
+  /// messages with id @id are appended to @out as separate parts, without
+  /// copying them. Messages whose full payload is used are moved as they
+  /// are, the others are wrapped in a message created by @transport which
+  /// references the extracted region and keeps the original message alive.
+  /// @return the total size of the payloads appended to @out, 0 if the
+  ///         merge is not complete yet.
+  size_t finalise(FairMQParts &out, MergeableId &id, FairMQTransportFactory &transport) {
+    if (mCheckIfComplete(id, mPartsMap) == false) {
+      return 0;
+    }
+    size_t sum = extract(id);
+
+    auto range = mPartsMap.equal_range(id);
+    auto part = mExtracted.begin();
+    for (auto hi = range.first; hi != range.second; ++hi, ++part) {
+      std::unique_ptr<FairMQMessage> &payload = hi->second;
+      if (part->first == payload->GetData() && part->second == payload->GetSize()) {
+        out.AddPart(std::move(payload));
+        continue;
+      }
+      FairMQMessage *original = payload.release();
+      out.AddPart(transport.CreateMessage(part->first, part->second,
+                                          [](void *, void *hint) { delete static_cast<FairMQMessage *>(hint); },
+                                          original));
+    }
+
+    mPartsMap.erase(id);
+    return sum;
+  }
+
   // Helper method which leaves the payload untouched
   static int64_t fullPayloadExtractor(char **payload,
                                       char *buffer,
@@ -112,11 +174,29 @@ public:
     return bufferSize;
   }
 private:
+  /// Fills mExtracted with the regions to merge for @id
+  /// @return their total size
+  size_t extract(const MergeableId &id) {
+    mExtracted.clear();
+    size_t sum = 0;
+    auto range = mPartsMap.equal_range(id);
+    for (auto hi = range.first, he = range.second; hi != he; ++hi) {
+      std::unique_ptr<FairMQMessage> &payload = hi->second;
+      std::pair<char *, size_t> part;
+      part.second = mExtractPayload(&part.first, reinterpret_cast<char *>(payload->GetData()), payload->GetSize());
+      mExtracted.push_back(part);
+      sum += part.second;
+    }
+    return sum;
+  }
+
   IdExtractor mMakeId;
   MergeCompletionCheker mCheckIfComplete;
   PayloadExtractor mExtractPayload;
 
   MessageMap mPartsMap;
+  /// Extracted regions of the parts being merged, kept to avoid allocations
+  std::vector<std::pair<char *, size_t>> mExtracted;
 };
 } /* dataflow */
 } /* o2 */
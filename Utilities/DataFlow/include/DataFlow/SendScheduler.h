@@ -0,0 +1,162 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef DATAFLOW_SENDSCHEDULER_H_
+#define DATAFLOW_SENDSCHEDULER_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace o2 { namespace dataflow {
+
+/// Configuration of the SendScheduler
+struct SendSchedulerConfig {
+  /// Number of destinations, the destination of timeframe id is
+  /// id % nDestinations
+  size_t nDestinations = 1;
+  /// Time an item is held back after being pushed. Using a different delay
+  /// on each sender staggers the senders and avoids incast at the receiver.
+  std::chrono::microseconds delay{ 0 };
+  /// Sustained rate per destination in bytes/s, 0 means unlimited
+  double rate = 0.;
+  /// Size of the token bucket of each destination in bytes
+  size_t burst = 0;
+  /// Maximum number of items waiting to be sent
+  size_t maxQueueSize = 1000;
+  /// Maximum number of items sent to a destination and not yet acknowledged
+  /// by it, 0 disables the feedback
+  size_t maxOutstanding = 0;
+};
+
+/// Decides when and in which order the sub-timeframes of a sender go out.
+///
+/// Items are kept in one FIFO per destination and are released when
+/// - the configured delay since they were pushed has elapsed,
+/// - the token bucket of the destination holds enough tokens for them,
+/// - the destination has not too many unacknowledged items in flight.
+/// Destinations are served round-robin. The destination itself is never
+/// changed, since all the senders need to agree on it.
+template <typename T>
+class SendScheduler
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit SendScheduler(const SendSchedulerConfig& config, Clock::time_point now = Clock::now())
+    : mConfig(config),
+      mQueues(config.nDestinations),
+      mTokens(config.nDestinations, static_cast<double>(config.burst)),
+      mOutstanding(config.nDestinations, 0),
+      mLastRefill(now),
+      mSize(0),
+      mNext(0)
+  {
+  }
+
+  size_t size() const { return mSize; }
+  bool full() const { return mSize >= mConfig.maxQueueSize; }
+  size_t outstanding(size_t destination) const { return mOutstanding[destination]; }
+  size_t destination(uint32_t id) const { return id % mConfig.nDestinations; }
+
+  /// Queue @a data of @a bytes bytes belonging to timeframe @a id.
+  /// @return false if the queue is full, @a data is then left untouched
+  bool push(T&& data, uint32_t id, size_t bytes, Clock::time_point now = Clock::now())
+  {
+    if (full()) {
+      return false;
+    }
+    mQueues[destination(id)].push_back(Entry{ std::move(data), id, bytes, now + mConfig.delay });
+    ++mSize;
+    return true;
+  }
+
+  /// Retrieve the next item which can be sent at @a now.
+  /// @return false if no item can be sent yet
+  bool pop(T& data, uint32_t& id, size_t& dest, Clock::time_point now = Clock::now())
+  {
+    refill(now);
+    for (size_t i = 0; i < mQueues.size(); ++i) {
+      auto d = (mNext + i) % mQueues.size();
+      auto& queue = mQueues[d];
+      if (queue.empty()) {
+        continue;
+      }
+      auto& entry = queue.front();
+      if (entry.readyAt > now) {
+        continue;
+      }
+      if (mConfig.maxOutstanding > 0 && mOutstanding[d] >= mConfig.maxOutstanding) {
+        continue;
+      }
+      if (mConfig.rate > 0.) {
+        // Items bigger than the bucket only need a full bucket.
+        auto needed = std::min<double>(entry.bytes, std::max<size_t>(mConfig.burst, 1));
+        if (mTokens[d] < needed) {
+          continue;
+        }
+        mTokens[d] -= entry.bytes;
+      }
+      data = std::move(entry.data);
+      id = entry.id;
+      dest = d;
+      queue.pop_front();
+      --mSize;
+      if (mConfig.maxOutstanding > 0) {
+        ++mOutstanding[d];
+      }
+      mNext = (d + 1) % mQueues.size();
+      return true;
+    }
+    return false;
+  }
+
+  /// Feedback from the receiver that timeframe @a id has been received
+  void acknowledge(uint32_t id)
+  {
+    auto& outstanding = mOutstanding[destination(id)];
+    if (outstanding > 0) {
+      --outstanding;
+    }
+  }
+
+private:
+  struct Entry {
+    T data;
+    uint32_t id;
+    size_t bytes;
+    Clock::time_point readyAt;
+  };
+
+  void refill(Clock::time_point now)
+  {
+    if (mConfig.rate <= 0. || now <= mLastRefill) {
+      return;
+    }
+    auto elapsed = std::chrono::duration<double>(now - mLastRefill).count();
+    for (auto& tokens : mTokens) {
+      tokens = std::min<double>(tokens + elapsed * mConfig.rate, mConfig.burst);
+    }
+    mLastRefill = now;
+  }
+
+  SendSchedulerConfig mConfig;
+  std::vector<std::deque<Entry>> mQueues;
+  std::vector<double> mTokens;
+  std::vector<size_t> mOutstanding;
+  Clock::time_point mLastRefill;
+  size_t mSize;
+  size_t mNext;
+};
+
+} } // namespace o2::dataflow
+
+#endif // DATAFLOW_SENDSCHEDULER_H_
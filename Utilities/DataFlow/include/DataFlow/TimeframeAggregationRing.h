@@ -0,0 +1,290 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#ifndef DATAFLOW_TIMEFRAMEAGGREGATIONRING_H_
+#define DATAFLOW_TIMEFRAMEAGGREGATIONRING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <boost/lockfree/queue.hpp>
+
+namespace o2 { namespace dataflow {
+
+/// Fixed capacity set of aggregation slots, used to build timeframes out of
+/// the sub-timeframes of @a nSources sources.
+///
+/// The slot of a timeframe is selected by its id modulo the capacity, so no
+/// lookup structure is needed. Any number of threads can add sub-timeframes
+/// concurrently: each source has its own entry in the slot and completion is
+/// detected with an atomic counter, so adding never takes a lock. Complete
+/// timeframes are handed over to a single consumer through a lock-free
+/// queue. Timeframes which are not complete after @a timeout are discarded
+/// by expire(), which only looks at the timeframes registered in the elapsed
+/// buckets of a timer wheel.
+///
+/// Every slot remembers the last timeframe it published or discarded, late
+/// parts of it or of even older timeframes are rejected. The ids are compared
+/// as serial numbers of type @a Id, so they may wrap around.
+template <typename T, typename Id = uint32_t>
+class TimeframeAggregationRing
+{
+  static_assert(std::is_unsigned<Id>::value && sizeof(Id) <= sizeof(uint32_t),
+                "timeframe ids must be unsigned integers of at most 32 bit");
+
+public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class AddResult {
+    Added,     ///< stored, timeframe still incomplete
+    Completed, ///< stored, the timeframe is now complete
+    Duplicate, ///< the source already provided this timeframe
+    Discarded, ///< the timeframe (or a newer one in the same slot) has been discarded or completed
+    Busy       ///< the slot is taken by another timeframe
+  };
+
+  TimeframeAggregationRing(size_t capacity, size_t nSources, std::chrono::milliseconds timeout,
+                           size_t wheelBuckets = 64)
+    : mNSources{ nSources },
+      mSlots(capacity),
+      mComplete(capacity),
+      mTimeout{ timeout },
+      mTick{ std::max(std::chrono::milliseconds(1), timeout / std::max<long>(wheelBuckets / 2, 1)) },
+      mBuckets(wheelBuckets),
+      mEpoch{ Clock::now() },
+      mLastTick{ 0 }
+  {
+    for (auto& slot : mSlots) {
+      slot.data.resize(nSources);
+      slot.present.reset(new std::atomic<bool>[nSources]);
+      for (size_t i = 0; i < nSources; ++i) {
+        slot.present[i] = false;
+      }
+    }
+  }
+
+  size_t capacity() const { return mSlots.size(); }
+  size_t sources() const { return mNSources; }
+
+  /// Store @a data as the contribution of @a source to timeframe @a id.
+  /// Can be called concurrently from any number of threads.
+  AddResult add(Id id, size_t source, T&& data)
+  {
+    if (source >= mNSources) {
+      return AddResult::Discarded;
+    }
+    auto& slot = mSlots[id % mSlots.size()];
+    auto filling = makeTag(id, Filling);
+    auto tag = slot.tag.load(std::memory_order_acquire);
+    while (tag != filling) {
+      if (stateOf(tag) != Free) {
+        return idOf(tag) == id ? AddResult::Discarded : AddResult::Busy;
+      }
+      if (isFinished(slot, id)) {
+        return AddResult::Discarded;
+      }
+      if (slot.tag.compare_exchange_weak(tag, filling, std::memory_order_acq_rel)) {
+        // First sub-timeframe of this timeframe: arm the timeout.
+        registerTimeout(id);
+        break;
+      }
+    }
+
+    slot.refs.fetch_add(1, std::memory_order_acq_rel);
+    if (slot.tag.load(std::memory_order_acquire) != filling) {
+      slot.refs.fetch_sub(1, std::memory_order_release);
+      return AddResult::Discarded;
+    }
+    if (slot.present[source].exchange(true, std::memory_order_acq_rel)) {
+      slot.refs.fetch_sub(1, std::memory_order_release);
+      return AddResult::Duplicate;
+    }
+    slot.data[source] = std::move(data);
+    auto count = slot.count.fetch_add(1, std::memory_order_acq_rel) + 1;
+    slot.refs.fetch_sub(1, std::memory_order_release);
+
+    if (count == mNSources) {
+      auto expected = filling;
+      if (!slot.tag.compare_exchange_strong(expected, makeTag(id, Complete), std::memory_order_acq_rel)) {
+        // expired meanwhile, the contribution is reported by expire()
+        return AddResult::Added;
+      }
+      // Published by the time the slot is free again
+      slot.lastFinished.store(uint64_t(id) + 1, std::memory_order_relaxed);
+      mComplete.push(id % mSlots.size());
+      return AddResult::Completed;
+    }
+    return AddResult::Added;
+  }
+
+  /// Retrieve a complete timeframe, if any, and release its slot. The
+  /// contributions are returned ordered by source. Single consumer only.
+  bool popComplete(Id& id, std::vector<T>& contributions)
+  {
+    size_t index;
+    if (!mComplete.pop(index)) {
+      return false;
+    }
+    auto& slot = mSlots[index];
+    id = idOf(slot.tag.load(std::memory_order_acquire));
+    waitForWriters(slot);
+    contributions.clear();
+    contributions.swap(slot.data);
+    reset(slot);
+    return true;
+  }
+
+  /// Discard the timeframes which have been incomplete for longer than the
+  /// timeout, calling @a onDiscard with their ids and the sources which had
+  /// contributed to them. Single caller only.
+  /// @return the number of discarded timeframes
+  size_t expire(std::function<void(Id, const std::vector<size_t>&)> onDiscard = nullptr)
+  {
+    auto now = currentTick();
+    size_t discarded = 0;
+    std::vector<size_t> sources;
+    // Do not go around the wheel more than once if we were not called
+    // for a long time.
+    auto first = std::max(mLastTick + 1, now >= mBuckets.size() ? now - mBuckets.size() + 1 : 0);
+    for (auto tick = first; tick <= now; ++tick) {
+      auto& bucket = mBuckets[tick % mBuckets.size()];
+      std::vector<WheelEntry> due;
+      {
+        std::lock_guard<std::mutex> lock(bucket.mutex);
+        auto keep = bucket.entries.begin();
+        for (auto& entry : bucket.entries) {
+          if (entry.deadline <= now) {
+            due.push_back(entry);
+          } else {
+            *keep++ = entry;
+          }
+        }
+        bucket.entries.erase(keep, bucket.entries.end());
+      }
+      for (auto& entry : due) {
+        if (discard(entry.id, sources)) {
+          ++discarded;
+          if (onDiscard) {
+            onDiscard(entry.id, sources);
+          }
+        }
+      }
+    }
+    mLastTick = std::max(mLastTick, now);
+    return discarded;
+  }
+
+private:
+  enum State : uint64_t { Free = 0, Filling = 1, Complete = 2, Discarding = 3 };
+
+  static uint64_t makeTag(Id id, State state) { return (uint64_t(id) << 32) | state; }
+  static Id idOf(uint64_t tag) { return static_cast<Id>(tag >> 32); }
+  static State stateOf(uint64_t tag) { return static_cast<State>(tag & 0xffffffff); }
+
+  struct Slot {
+    std::atomic<uint64_t> tag{ makeTag(0, Free) };
+    std::atomic<size_t> count{ 0 };
+    std::atomic<int> refs{ 0 };
+    std::atomic<uint64_t> lastFinished{ 0 }; ///< id + 1 of the last published or discarded timeframe
+    std::unique_ptr<std::atomic<bool>[]> present;
+    std::vector<T> data;
+  };
+
+  struct WheelEntry {
+    Id id;
+    uint64_t deadline;
+  };
+
+  struct Bucket {
+    std::mutex mutex;
+    std::vector<WheelEntry> entries;
+  };
+
+  uint64_t currentTick() const { return (Clock::now() - mEpoch) / mTick; }
+
+  void registerTimeout(Id id)
+  {
+    auto deadline = currentTick() + (mTimeout + mTick - std::chrono::milliseconds(1)) / mTick;
+    auto& bucket = mBuckets[deadline % mBuckets.size()];
+    std::lock_guard<std::mutex> lock(bucket.mutex);
+    bucket.entries.push_back(WheelEntry{ id, deadline });
+  }
+
+  bool discard(Id id, std::vector<size_t>& sources)
+  {
+    auto& slot = mSlots[id % mSlots.size()];
+    auto expected = makeTag(id, Filling);
+    if (!slot.tag.compare_exchange_strong(expected, makeTag(id, Discarding), std::memory_order_acq_rel)) {
+      // completed in the meantime
+      return false;
+    }
+    waitForWriters(slot);
+    sources.clear();
+    for (size_t i = 0; i < mNSources; ++i) {
+      if (slot.present[i].load(std::memory_order_relaxed)) {
+        sources.push_back(i);
+      }
+      slot.data[i] = T{};
+    }
+    slot.lastFinished.store(uint64_t(id) + 1, std::memory_order_relaxed);
+    reset(slot);
+    return true;
+  }
+
+  /// True if timeframe @a id is not newer than the last one which left @a slot
+  static bool isFinished(const Slot& slot, Id id)
+  {
+    auto last = slot.lastFinished.load(std::memory_order_relaxed);
+    if (last == 0) {
+      return false;
+    }
+    // serial number arithmetic: the difference is negative for older ids,
+    // also across a wraparound
+    using SignedId = typename std::make_signed<Id>::type;
+    return static_cast<SignedId>(static_cast<Id>(id - static_cast<Id>(last - 1))) <= 0;
+  }
+
+  void waitForWriters(Slot& slot)
+  {
+    while (slot.refs.load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  void reset(Slot& slot)
+  {
+    slot.data.resize(mNSources);
+    for (size_t i = 0; i < mNSources; ++i) {
+      slot.present[i].store(false, std::memory_order_relaxed);
+    }
+    slot.count.store(0, std::memory_order_relaxed);
+    slot.tag.store(makeTag(0, Free), std::memory_order_release);
+  }
+
+  size_t mNSources;
+  std::vector<Slot> mSlots;
+  boost::lockfree::queue<size_t, boost::lockfree::fixed_sized<true>> mComplete;
+  std::chrono::milliseconds mTimeout;
+  std::chrono::milliseconds mTick;
+  std::vector<Bucket> mBuckets;
+  Clock::time_point mEpoch;
+  uint64_t mLastTick;
+};
+
+} } // namespace o2::dataflow
+
+#endif // DATAFLOW_TIMEFRAMEAGGREGATIONRING_H_
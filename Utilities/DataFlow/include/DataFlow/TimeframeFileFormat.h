@@ -0,0 +1,110 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef DATAFLOW_TIMEFRAMEFILEFORMAT_H_
+#define DATAFLOW_TIMEFRAMEFILEFORMAT_H_
+
+#include "Headers/DataHeader.h"
+#include <cstdint>
+#include <cstring>
+
+namespace o2 { namespace DataFlow {
+
+/// The index footer appended by the TimeframeWriterDevice at the end of
+/// each file. Version 1 of the footer only locates the timeframes:
+///
+///   TimeframeFileFooterHeader
+///   TimeframeFileIndexEntry [TimeframeFileIndexEntry [...]]
+///   TimeframeFileTrailer
+///
+/// Version 2 is a full table of contents, locating every header / payload
+/// pair of every timeframe:
+///
+///   TimeframeFileFooterHeader
+///   TimeframeFileTOCHeader
+///   TimeframeFileTimeframeEntry [TimeframeFileTimeframeEntry [...]]
+///   TimeframeFilePartEntry [TimeframeFilePartEntry [...]]
+///   TimeframeFileTrailer
+///
+/// The header carries a magic which cannot be confused with the O2 magic of
+/// a DataHeader, so that sequential readers know where the timeframes end.
+/// The trailer has a fixed size and sits at the very end of the file, so that
+/// random access readers can locate the footer with a single seek.
+constexpr char gTimeframeFooterMagic[8] = {'O', '2', 'T', 'F', 'F', 'O', 'O', 'T'};
+constexpr char gTimeframeTrailerMagic[8] = {'O', '2', 'T', 'F', 'I', 'D', 'X', '\0'};
+constexpr uint32_t gTimeframeFooterVersion = 2;
+
+struct TimeframeFileFooterHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t nEntries;
+};
+
+/// Position of one timeframe inside the file (version 1)
+struct TimeframeFileIndexEntry {
+  uint64_t offset;
+  uint64_t size;
+};
+
+/// Flags of the table of contents
+enum TimeframeFileTOCFlags : uint32_t {
+  TOCHasChecksums = 0x1, ///< TimeframeFilePartEntry::checksum is filled
+};
+
+struct TimeframeFileTOCHeader {
+  uint32_t nParts;
+  uint32_t flags;
+};
+
+/// Position of one timeframe inside the file and range of its parts in the
+/// list of TimeframeFilePartEntry (version 2)
+struct TimeframeFileTimeframeEntry {
+  uint64_t offset;
+  uint64_t size;
+  uint32_t firstPart;
+  uint32_t nParts;
+};
+
+/// Position and identification of one header / payload pair. The payload
+/// immediately follows the header in the file.
+struct TimeframeFilePartEntry {
+  o2::header::DataOrigin origin;
+  uint32_t headerSize;
+  o2::header::DataDescription description;
+  uint64_t subSpecification;
+  uint64_t headerOffset;
+  uint64_t payloadSize;
+  uint32_t checksum; ///< CRC-32 of the payload, if TOCHasChecksums is set
+  uint32_t reserved;
+
+  uint64_t payloadOffset() const { return headerOffset + headerSize; }
+};
+
+struct TimeframeFileTrailer {
+  uint64_t footerOffset;
+  char magic[8];
+};
+
+static_assert(sizeof(TimeframeFileFooterHeader) == 16, "TimeframeFileFooterHeader must be of size 16");
+static_assert(sizeof(TimeframeFileIndexEntry) == 16, "TimeframeFileIndexEntry must be of size 16");
+static_assert(sizeof(TimeframeFileTrailer) == 16, "TimeframeFileTrailer must be of size 16");
+static_assert(sizeof(TimeframeFileTOCHeader) == 8, "TimeframeFileTOCHeader must be of size 8");
+static_assert(sizeof(TimeframeFileTimeframeEntry) == 24, "TimeframeFileTimeframeEntry must be of size 24");
+static_assert(sizeof(TimeframeFilePartEntry) == 56, "TimeframeFilePartEntry must be of size 56");
+
+/// @return true if @a buffer starts with the footer magic
+inline bool isTimeframeFooter(const void* buffer)
+{
+  return memcmp(buffer, gTimeframeFooterMagic, sizeof(gTimeframeFooterMagic)) == 0;
+}
+
+} } // namespace o2::DataFlow
+
+#endif // DATAFLOW_TIMEFRAMEFILEFORMAT_H_
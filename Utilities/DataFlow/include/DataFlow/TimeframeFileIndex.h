@@ -0,0 +1,94 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef DATAFLOW_TIMEFRAMEFILEINDEX_H_
+#define DATAFLOW_TIMEFRAMEFILEINDEX_H_
+
+#include "DataFlow/TimeframeFileFormat.h"
+#include "Headers/DataHeader.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace o2 { namespace DataFlow {
+
+struct TimeframePartSelector;
+
+/// In memory representation of the table of contents of a timeframe file.
+///
+/// Filled part by part while writing a file and serialized as the file
+/// footer, or read back from the footer of an existing file.
+class TimeframeFileIndex
+{
+public:
+  explicit TimeframeFileIndex(bool withChecksums = false);
+
+  /// Start a new timeframe at @a offset in the file
+  void beginTimeframe(uint64_t offset);
+  /// Add a header / payload pair at @a headerOffset in the file. The
+  /// checksum of the payload is computed only if the index was created
+  /// with checksums.
+  void addPart(const o2::header::DataHeader& header, uint64_t headerOffset, uint32_t headerSize,
+               const char* payload, uint64_t payloadSize);
+  /// Close the current timeframe, @a size being its total size in the file
+  void endTimeframe(uint64_t size);
+
+  void clear();
+
+  /// Serialize the index as a footer starting at @a footerOffset
+  std::vector<char> serialize(uint64_t footerOffset) const;
+  /// Read back the footer in @a buffer. Version 1 footers are supported as
+  /// well, in which case only the timeframe positions are known.
+  /// Throws std::runtime_error if the buffer is not a valid footer.
+  void deserialize(const char* buffer, size_t size);
+
+  bool hasChecksums() const { return mFlags & TOCHasChecksums; }
+  /// False if only the timeframe positions are known
+  bool hasParts() const { return mHasParts; }
+  uint32_t version() const { return mVersion; }
+
+  size_t getNumberOfTimeframes() const { return mTimeframes.size(); }
+  const std::vector<TimeframeFileTimeframeEntry>& timeframes() const { return mTimeframes; }
+  const std::vector<TimeframeFilePartEntry>& parts() const { return mParts; }
+
+  /// The parts of timeframe @a tf matching @a selector, in file order
+  std::vector<const TimeframeFilePartEntry*> findParts(size_t tf, const TimeframePartSelector& selector) const;
+
+  /// CRC-32 used for the per part checksums
+  static uint32_t checksum(const char* buffer, size_t size);
+
+private:
+  uint32_t mVersion;
+  uint32_t mFlags;
+  bool mHasParts;
+  std::vector<TimeframeFileTimeframeEntry> mTimeframes;
+  std::vector<TimeframeFilePartEntry> mParts;
+};
+
+/// Selection of parts by (origin, description, subSpecification), any of
+/// which can be a wildcard. The selection string has the form
+/// ORIGIN[/DESCRIPTION[/SUBSPEC]], where each field can be "*". An empty
+/// string selects everything.
+struct TimeframePartSelector {
+  explicit TimeframePartSelector(const std::string& selection = "");
+  bool matches(const TimeframeFilePartEntry& entry) const;
+
+  o2::header::DataOrigin origin;
+  o2::header::DataDescription description;
+  uint64_t subSpecification;
+  bool anyOrigin;
+  bool anyDescription;
+  bool anySubSpecification;
+};
+
+} } // namespace o2::DataFlow
+
+#endif // DATAFLOW_TIMEFRAMEFILEINDEX_H_
@@ -0,0 +1,68 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef DATAFLOW_TIMEFRAMEFILEREADER_H_
+#define DATAFLOW_TIMEFRAMEFILEREADER_H_
+
+#include "DataFlow/TimeframeFileIndex.h"
+#include <fstream>
+#include <functional>
+#include <string>
+
+namespace o2 { namespace DataFlow {
+
+/// Random access to the parts of a timeframe file.
+///
+/// The table of contents is taken from the file footer. For files
+/// without one (or with a version 1 footer, which only locates the
+/// timeframes) it is rebuilt by scanning the headers, skipping over the
+/// payloads.
+class TimeframeFileReader
+{
+public:
+  explicit TimeframeFileReader(const std::string& filename);
+
+  const TimeframeFileIndex& index() const { return mIndex; }
+  size_t getNumberOfTimeframes() const { return mIndex.getNumberOfTimeframes(); }
+  /// True if the table of contents was read from the file footer
+  bool hasTableOfContents() const { return mHasTableOfContents; }
+
+  /// Read the header of @a part into @a header, which must be able to hold
+  /// part.headerSize bytes
+  void readHeader(const TimeframeFilePartEntry& part, char* header);
+  /// Read the payload of @a part into @a payload, which must be able to hold
+  /// part.payloadSize bytes. The checksum is verified if the file has them.
+  /// Throws std::runtime_error on I/O errors or checksum mismatch.
+  void readPayload(const TimeframeFilePartEntry& part, char* payload);
+
+  /// Read the parts of timeframe @a tf matching @a selector, followed by a
+  /// TIMEFRAMEINDEX which only references them. @a onAddPart is called for
+  /// every header and payload in turn, with a buffer allocated by new char[]
+  /// which it takes ownership of. Returns false for an empty timeframe or
+  /// if @a tf is out of range.
+  /// Throws std::runtime_error if the timeframe has no TIMEFRAMEINDEX.
+  bool readSelected(size_t tf, const TimeframePartSelector& selector,
+                    std::function<void(char* buffer, size_t size)> onAddPart);
+
+private:
+  bool readFooter();
+  void scan();
+  void read(uint64_t offset, char* buffer, uint64_t size);
+
+  std::string mFileName;
+  std::ifstream mFile;
+  uint64_t mFileSize;
+  bool mHasTableOfContents;
+  TimeframeFileIndex mIndex;
+};
+
+} } // namespace o2::DataFlow
+
+#endif // DATAFLOW_TIMEFRAMEFILEREADER_H_
@@ -25,6 +25,11 @@ void streamTimeframe(std::istream &stream,
                      std::function<void(FairMQParts &parts, char *buffer, size_t size)> onAddPart,
                      std::function<void(FairMQParts &parts)> onSend);
 
+/// Check that @a parts is a complete timeframe, i.e. it terminates with a
+/// TIMEFRAMEINDEX header / payload pair matching the number of parts.
+/// Throws std::runtime_error if not.
+void validateTimeframe(FairMQParts &parts);
+
 void streamTimeframe(std::ostream &stream, FairMQParts &parts);
 
 } } // end
@@ -17,12 +17,17 @@
 namespace o2 {
 namespace DataFlow {
 
-/// A device which writes to file the timeframes.
+/// A device which reads timeframes from file and sends them.
+///
+/// If a selection is given, only the matching parts of every timeframe are
+/// read, seeking directly to them through the table of contents of the
+/// file, and sent together with a matching TIMEFRAMEINDEX.
 class TimeframeReaderDevice : public Base::O2Device
 {
 public:
     static constexpr const char* OptionKeyOutputChannelName = "output-channel-name";
     static constexpr const char* OptionKeyInputFileName = "input-file";
+    static constexpr const char* OptionKeySelection = "select";
 
     /// Default constructor
     TimeframeReaderDevice();
@@ -36,8 +41,13 @@ public:
     /// Overloads the ConditionalRun() method of FairMQDevice
     bool ConditionalRun() final;
 
+  private:
+    /// Send only the parts of each timeframe matching mSelection
+    void replaySelected(const std::string& filename);
+
     std::string      mOutChannelName;
     std::string      mInFileName;
+    std::string      mSelection;
     std::fstream     mFile;
     std::vector<std::string> mSeen;
 };
@@ -12,12 +12,21 @@
 #define ALICEO2_TIMEFRAME_WRITER_DEVICE_H_
 
 #include "O2Device/O2Device.h"
-#include <fstream>
+#include "DataFlow/AsyncFileWriter.h"
+#include "DataFlow/TimeframeFileIndex.h"
+#include <chrono>
+#include <memory>
 
 namespace o2 {
 namespace DataFlow {
 
 /// A device which writes to file the timeframes.
+///
+/// The disk I/O happens on a separate thread (see AsyncFileWriter), so that
+/// the device keeps receiving while the data are written. Each file is
+/// terminated by a table of contents locating every part (see
+/// TimeframeFileFormat.h) and files are rotated by number of timeframes,
+/// size or age.
 class TimeframeWriterDevice : public Base::O2Device
 {
 public:
@@ -26,6 +35,11 @@ public:
     static constexpr const char* OptionKeyMaxTimeframesPerFile = "max-timeframes-per-file";
     static constexpr const char* OptionKeyMaxFileSize = "max-file-size";
     static constexpr const char* OptionKeyMaxFiles = "max-files";
+    static constexpr const char* OptionKeyMaxFileDuration = "max-file-duration";
+    static constexpr const char* OptionKeyDirectIO = "direct-io";
+    static constexpr const char* OptionKeyWriteBufferSize = "write-buffer-size";
+    static constexpr const char* OptionKeyWriteBuffers = "write-buffers";
+    static constexpr const char* OptionKeyChecksums = "checksums";
 
     /// Default constructor
     TimeframeWriterDevice();
@@ -42,13 +56,30 @@ public:
     /// Overloads the Run() method of FairMQDevice
     void Run() final;
 
+  private:
+    /// Append the table of contents and queue the file for closing
+    void closeFile();
+    /// Publish throughput and queue depth of the writer
+    void publishMetrics();
+
+    using Clock = std::chrono::steady_clock;
+
     std::string      mInChannelName;
     std::string      mOutFileName;
-    std::fstream     mFile;
+    std::unique_ptr<AsyncFileWriter> mWriter;
+    TimeframeFileIndex mIndex;
     size_t           mMaxTimeframes;
     size_t           mMaxFileSize;
     size_t           mMaxFiles;
+    size_t           mMaxFileDuration;
+    bool             mDirectIO;
+    bool             mChecksums;
+    size_t           mWriteBufferSize;
+    size_t           mWriteBuffers;
     size_t           mFileCount;
+    Clock::time_point mFileOpenTime;
+    Clock::time_point mLastMetricsTime;
+    size_t           mLastBytesWritten;
 };
 
 } // namespace DataFlow
@@ -4,9 +4,9 @@
 #  - O2 bin and lib set n the shell environment
 
 
-xterm -geometry 80x25+0+0 -hold -e epnReceiver --id epnReceiver --mq-config confBasicSetup.json --in-chan-name input --out-chan-name output --num-flps 1 &
+xterm -geometry 80x25+0+0 -hold -e epnReceiver --id epnReceiver --mq-config confBasicSetup.json --in-chan-name input --out-chan-name output --credit-chan-name credit --num-flps 1 &
 
-xterm -geometry 80x25+500+0 -hold -e flpSender --id flpSender --mq-config confBasicSetup.json --in-chan-name input --out-chan-name output --num-epns 1 &
+xterm -geometry 80x25+500+0 -hold -e flpSender --id flpSender --mq-config confBasicSetup.json --in-chan-name input --out-chan-name output --credit-chan-name credit --max-in-flight 16 --num-epns 1 &
 
 xterm -geometry 80x25+1000+0 -hold -e SubframeBuilderDevice --id subframeBuilder --mq-config confBasicSetup.json --self-triggered &
 
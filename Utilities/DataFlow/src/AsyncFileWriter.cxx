@@ -0,0 +1,251 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   AsyncFileWriter.cxx
+/// @brief  Buffered file writer doing the disk I/O on a separate thread
+
+#include "DataFlow/AsyncFileWriter.h"
+#include <FairMQLogger.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace o2 { namespace DataFlow {
+
+namespace {
+size_t alignUp(size_t size, size_t alignment)
+{
+  return (size + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+AsyncFileWriter::AsyncFileWriter(size_t bufferSize, size_t nBuffers, bool directIO)
+  : mBufferSize{ alignUp(std::max<size_t>(bufferSize, 1), sAlignment) }
+  , mDirectIO{ directIO }
+  , mStorage{}
+  , mBuffers(std::max<size_t>(nBuffers, 2))
+  , mFd{ -1 }
+  , mFileDirect{ false }
+  , mFileSize{ 0 }
+  , mCurrent{ nullptr }
+  , mBusy{ false }
+  , mStop{ false }
+  , mBytesWritten{ 0 }
+  , mQueueDepth{ 0 }
+{
+  for (auto& buffer : mBuffers) {
+    void* memory = nullptr;
+    if (posix_memalign(&memory, sAlignment, mBufferSize) != 0) {
+      throw std::bad_alloc();
+    }
+    mStorage.emplace_back(reinterpret_cast<char*>(memory), &free);
+    buffer.data = reinterpret_cast<char*>(memory);
+    buffer.size = 0;
+    mFree.push_back(&buffer);
+  }
+  mThread = std::thread(&AsyncFileWriter::ioLoop, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+  try {
+    if (isOpen()) {
+      close();
+    }
+  } catch (std::runtime_error& e) {
+    LOG(ERROR) << e.what() << "\n";
+  }
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mCondition.notify_all();
+  mThread.join();
+}
+
+void AsyncFileWriter::open(const std::string& filename)
+{
+  checkError();
+  if (isOpen()) {
+    throw std::runtime_error("AsyncFileWriter: a file is already open");
+  }
+  int flags = O_WRONLY | O_CREAT | O_TRUNC;
+  int fd = -1;
+  mFileDirect = false;
+  if (mDirectIO) {
+    fd = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+    mFileDirect = fd >= 0;
+    if (fd < 0 && errno == EINVAL) {
+      // Some filesystems (e.g. tmpfs) do not support O_DIRECT.
+      LOG(WARN) << "O_DIRECT not supported for " << filename << ", falling back to buffered I/O\n";
+    }
+  }
+  if (fd < 0) {
+    fd = ::open(filename.c_str(), flags, 0644);
+  }
+  if (fd < 0) {
+    throw std::runtime_error("AsyncFileWriter: unable to open " + filename + ": " + strerror(errno));
+  }
+  mFd = fd;
+  mFileSize = 0;
+  mCurrent = acquireBuffer();
+}
+
+void AsyncFileWriter::write(const void* data, size_t size)
+{
+  if (!isOpen()) {
+    throw std::runtime_error("AsyncFileWriter: no file open");
+  }
+  auto source = reinterpret_cast<const char*>(data);
+  while (size > 0) {
+    auto n = std::min(size, mBufferSize - mCurrent->size);
+    memcpy(mCurrent->data + mCurrent->size, source, n);
+    mCurrent->size += n;
+    mFileSize += n;
+    source += n;
+    size -= n;
+    if (mCurrent->size == mBufferSize) {
+      submit(Chunk{ mCurrent, mFd, mFileDirect, false, 0 });
+      mCurrent = acquireBuffer();
+    }
+  }
+}
+
+void AsyncFileWriter::close()
+{
+  if (!isOpen()) {
+    return;
+  }
+  Buffer* last = nullptr;
+  if (mCurrent->size > 0) {
+    last = mCurrent;
+  } else {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFree.push_back(mCurrent);
+  }
+  mCurrent = nullptr;
+  submit(Chunk{ last, mFd, mFileDirect, true, mFileSize });
+  mFd = -1;
+  mFileSize = 0;
+  checkError();
+}
+
+void AsyncFileWriter::flush()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  mCondition.wait(lock, [this]() { return (mPending.empty() && !mBusy) || !mError.empty(); });
+  lock.unlock();
+  checkError();
+}
+
+void AsyncFileWriter::submit(Chunk chunk)
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPending.push_back(chunk);
+    mQueueDepth.store(mPending.size(), std::memory_order_relaxed);
+  }
+  mCondition.notify_all();
+}
+
+AsyncFileWriter::Buffer* AsyncFileWriter::acquireBuffer()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  // This is the only place where the caller waits for the disk.
+  mCondition.wait(lock, [this]() { return !mFree.empty() || !mError.empty(); });
+  if (!mError.empty()) {
+    lock.unlock();
+    checkError();
+  }
+  auto buffer = mFree.back();
+  mFree.pop_back();
+  buffer->size = 0;
+  return buffer;
+}
+
+void AsyncFileWriter::checkError()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!mError.empty()) {
+    throw std::runtime_error(mError);
+  }
+}
+
+void AsyncFileWriter::ioLoop()
+{
+  while (true) {
+    Chunk chunk;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [this]() { return !mPending.empty() || mStop; });
+      if (mPending.empty()) {
+        return;
+      }
+      chunk = mPending.front();
+      mPending.pop_front();
+      mQueueDepth.store(mPending.size(), std::memory_order_relaxed);
+      mBusy = true;
+    }
+
+    std::string error;
+    if (chunk.buffer) {
+      // With O_DIRECT both the buffer and the size of the write need to be
+      // aligned. Only the last buffer of a file can be partially filled: pad
+      // it and truncate the file to its real size afterwards.
+      size_t toWrite = chunk.buffer->size;
+      if (chunk.directIO) {
+        auto padded = alignUp(toWrite, sAlignment);
+        memset(chunk.buffer->data + toWrite, 0, padded - toWrite);
+        toWrite = padded;
+      }
+      size_t written = 0;
+      while (written < toWrite) {
+        auto ret = ::write(chunk.fd, chunk.buffer->data + written, toWrite - written);
+        if (ret < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          error = std::string("AsyncFileWriter: write failed: ") + strerror(errno);
+          break;
+        }
+        written += ret;
+      }
+      mBytesWritten.fetch_add(std::min(written, chunk.buffer->size), std::memory_order_relaxed);
+    }
+    if (chunk.closeFile) {
+      if (chunk.directIO && error.empty() && ftruncate(chunk.fd, chunk.fileSize) != 0) {
+        error = std::string("AsyncFileWriter: truncate failed: ") + strerror(errno);
+      }
+      if (::close(chunk.fd) != 0 && error.empty()) {
+        error = std::string("AsyncFileWriter: close failed: ") + strerror(errno);
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (chunk.buffer) {
+        mFree.push_back(chunk.buffer);
+      }
+      if (!error.empty() && mError.empty()) {
+        mError = error;
+      }
+      mBusy = false;
+    }
+    mCondition.notify_all();
+  }
+}
+
+} } // namespace o2::DataFlow
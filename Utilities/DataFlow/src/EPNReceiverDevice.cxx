@@ -20,7 +20,9 @@
 #include "Headers/SubframeMetadata.h"
 #include "TimeFrame/TimeFrame.h"
 
-#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 
 using namespace std;
 using namespace std::chrono;
@@ -34,65 +36,63 @@ void EPNReceiverDevice::InitTask()
 {
   mNumFLPs = GetConfig()->GetValue<int>("num-flps");
   mBufferTimeoutInMs = GetConfig()->GetValue<int>("buffer-timeout");
+  mBufferCapacity = GetConfig()->GetValue<int>("buffer-capacity");
   mTestMode = GetConfig()->GetValue<int>("test-mode");
   mInChannelName = GetConfig()->GetValue<string>("in-chan-name");
   mOutChannelName = GetConfig()->GetValue<string>("out-chan-name");
   mAckChannelName = GetConfig()->GetValue<string>("ack-chan-name");
-}
-
-void EPNReceiverDevice::PrintBuffer(const unordered_map<uint16_t, TFBuffer>& buffer) const
-{
-  string header = "===== ";
+  mCreditChannelName = GetConfig()->GetValue<string>("credit-chan-name");
 
-  for (int i = 1; i <= mNumFLPs; ++i) {
-    stringstream out;
-    out << i % 10;
-    header += out.str();
-    //i > 9 ? header += " " : header += "  ";
+  if (!mCreditChannelName.empty() && fChannels.at(mCreditChannelName).size() != static_cast<size_t>(mNumFLPs)) {
+    throw runtime_error("The credit channel needs one sub-channel per FLP (num-flps)");
   }
-  LOG(INFO) << header;
 
-  for (auto& it : buffer) {
-    string stars = "";
-    for (unsigned int j = 1; j <= (it.second).parts.Size(); ++j) {
-      stars += "*";
-    }
-    LOG(INFO) << setw(4) << it.first << ": " << stars;
-  }
+  mTimeframeBuffer = std::make_unique<AggregationRing>(mBufferCapacity, mNumFLPs, milliseconds(mBufferTimeoutInMs));
+  mNumDiscarded = 0;
 }
 
 void EPNReceiverDevice::DiscardIncompleteTimeframes()
 {
-  auto it = mTimeframeBuffer.begin();
-
-  while (it != mTimeframeBuffer.end()) {
-    if (duration_cast<milliseconds>(steady_clock::now() - (it->second).start).count() > mBufferTimeoutInMs) {
-      LOG(WARN) << "Timeframe #" << it->first << " incomplete after " << mBufferTimeoutInMs << " milliseconds, discarding";
-      mDiscardedSet.insert(it->first);
-      mTimeframeBuffer.erase(it++);
-      LOG(WARN) << "Number of discarded timeframes: " << mDiscardedSet.size();
-    } else {
-      // LOG(INFO) << "Timeframe #" << it->first << " within timeout, buffering...";
-      ++it;
+  mTimeframeBuffer->expire([this](uint16_t id, const vector<size_t>& flps) {
+    LOG(WARN) << "Timeframe #" << id << " incomplete after " << mBufferTimeoutInMs << " milliseconds, discarding";
+    LOG(WARN) << "Number of discarded timeframes: " << ++mNumDiscarded;
+    // the flpSenders which did send their part need the credits back anyway
+    for (auto flp : flps) {
+      SendCredit(id, flp);
     }
-  }
+  });
 }
 
-void EPNReceiverDevice::Run()
+void EPNReceiverDevice::SendAcknowledgement(uint16_t id)
 {
-  uint16_t id = 0; // holds the timeframe id of the currently arrived sub-timeframe.
+  unique_ptr<FairMQMessage> ack(NewMessage(sizeof(uint16_t)));
+  memcpy(ack->GetData(), &id, sizeof(uint16_t));
 
-  FairMQChannel& ackOutChannel = fChannels.at(mAckChannelName).at(0);
+  if (fChannels.at(mAckChannelName).at(0).Send(ack, 0) <= 0) {
+    LOG(ERROR) << "Could not send acknowledgement without blocking";
+  }
+}
 
-  // Simple multi timeframe index
-  using TimeframeId = int;
-  using FlpId = int;
-  std::multimap<TimeframeId, IndexElement> index;
-  std::multimap<TimeframeId, FlpId> flpIds;
+void EPNReceiverDevice::SendCredit(uint16_t id, int flpIndex)
+{
+  if (mCreditChannelName.empty()) {
+    return;
+  }
+  unique_ptr<FairMQMessage> credit(NewMessage(sizeof(uint16_t)));
+  memcpy(credit->GetData(), &id, sizeof(uint16_t));
 
+  // The sub-channels are shared by the receiver threads and the device thread.
+  lock_guard<mutex> lock(mCreditMutex);
+  if (fChannels.at(mCreditChannelName).at(flpIndex).Send(credit, 0) <= 0) {
+    LOG(ERROR) << "Could not send credit to FLP " << flpIndex << " without blocking";
+  }
+}
+
+void EPNReceiverDevice::ReceiveSubtimeframes(int index)
+{
   while (CheckCurrentState(RUNNING)) {
     FairMQParts subtimeframeParts;
-    if (Receive(subtimeframeParts, mInChannelName, 0, 100) <= 0)
+    if (Receive(subtimeframeParts, mInChannelName, index, 100) <= 0)
       continue;
 
     assert(subtimeframeParts.Size() >= 2);
@@ -100,88 +100,106 @@ void EPNReceiverDevice::Run()
     const auto* dh = o2::header::get<header::DataHeader>(subtimeframeParts.At(0)->GetData());
     assert(strncmp(dh->dataDescription.str, "SUBTIMEFRAMEMD", 16) == 0);
     SubframeMetadata* sfm = reinterpret_cast<SubframeMetadata*>(subtimeframeParts.At(1)->GetData());
-    id = o2::DataFlow::timeframeIdFromTimestamp(sfm->startTime, sfm->duration);
+    uint16_t id = o2::DataFlow::timeframeIdFromTimestamp(sfm->startTime, sfm->duration);
     auto flpId = sfm->flpIndex;
+    LOG(INFO) << "Timeframe ID " << id << " for startTime " << sfm->startTime  << "\n";
 
-    if (mDiscardedSet.find(id) == mDiscardedSet.end())
-    {
-      if (mTimeframeBuffer.find(id) == mTimeframeBuffer.end())
-      {
-        // if this is the first part with this ID, save the receive time.
-        mTimeframeBuffer[id].start = steady_clock::now();
-      }
-      flpIds.insert(std::make_pair(id, flpId));
-      LOG(INFO) << "Timeframe ID " << id << " for startTime " << sfm->startTime  << "\n";
-      // If the received ID has not previously been discarded, store
-      // the data part in the buffer For the moment we just concatenate
-      // the subtimeframes and add an index for their description at
-      // the end. Given every second part is a data header we skip
-      // every two parts to populate the index. Moreover we know that
-      // the SubframeMetadata is always in the second part, so we can
-      // extract the flpId from there.
-      for (size_t i = 0; i < subtimeframeParts.Size(); ++i)
-      {
-        if (i % 2 == 0)
-        {
-          const auto * adh = o2::header::get<header::DataHeader>(subtimeframeParts.At(i)->GetData());
-          auto ie = std::make_pair(*adh, index.count(id)*2);
-          index.insert(std::make_pair(id, ie));
-        }
-        mTimeframeBuffer[id].parts.AddPart(move(subtimeframeParts.At(i)));
-      }
+    if (flpId < 0 || flpId >= mNumFLPs) {
+      LOG(ERROR) << "Received sub-timeframe from FLP " << flpId << ", only " << mNumFLPs << " expected";
+      continue;
     }
-    else
-    {
-      // if received ID has been previously discarded.
-      LOG(WARN) << "Received part from an already discarded timeframe with id " << id;
+
+    // The sub-timeframes are stored as they are. Concatenation and
+    // indexing only happen once the timeframe is complete.
+    auto result = mTimeframeBuffer->add(id, flpId, move(subtimeframeParts));
+    // The slot is still used by an older timeframe: wait until it is
+    // published or discarded.
+    while (result == AggregationRing::AddResult::Busy && CheckCurrentState(RUNNING)) {
+      this_thread::yield();
+      result = mTimeframeBuffer->add(id, flpId, move(subtimeframeParts));
     }
+    if (result == AggregationRing::AddResult::Duplicate) {
+      LOG(WARN) << "Received timeframe with id " << id << " twice from FLP " << flpId;
+      SendCredit(id, flpId);
+    } else if (result == AggregationRing::AddResult::Discarded) {
+      // the timeframe has already been published or discarded
+      LOG(WARN) << "Received part from an already published or discarded timeframe with id " << id;
+      SendCredit(id, flpId);
+    }
+  }
+}
 
-    if (flpIds.count(id) == mNumFLPs) {
-      LOG(INFO) << "Timeframe " << id << " complete. Publishing.\n";
-      o2::header::DataHeader tih;
-      std::vector<IndexElement> flattenedIndex;
-
-      tih.dataDescription = o2::header::DataDescription("TIMEFRAMEINDEX");
-      tih.dataOrigin = o2::header::DataOrigin("EPN");
-      tih.subSpecification = 0;
-      tih.payloadSize = index.count(id) * sizeof(flattenedIndex.front());
-      void *indexData = malloc(tih.payloadSize);
-      auto indexRange = index.equal_range(id);
-      for (auto ie = indexRange.first; ie != indexRange.second; ++ie)
-      {
-        flattenedIndex.push_back(ie->second);
+void EPNReceiverDevice::PublishTimeframe(uint16_t id, vector<FairMQParts>& subtimeframes)
+{
+  LOG(INFO) << "Timeframe " << id << " complete. Publishing.\n";
+  // For the moment we just concatenate the subtimeframes, ordered by FLP,
+  // and add an index for their description at the end. Given every second
+  // part is a data header we skip every two parts to populate the index.
+  FairMQParts timeframeParts;
+  std::vector<IndexElement> flattenedIndex;
+  for (auto& subtimeframeParts : subtimeframes) {
+    for (int i = 0; i < subtimeframeParts.Size(); ++i) {
+      if (i % 2 == 0) {
+        const auto* adh = o2::header::get<header::DataHeader>(subtimeframeParts.At(i)->GetData());
+        flattenedIndex.emplace_back(*adh, flattenedIndex.size() * 2);
       }
-      memcpy(indexData, flattenedIndex.data(), tih.payloadSize);
+      timeframeParts.AddPart(move(subtimeframeParts.At(i)));
+    }
+  }
+
+  o2::header::DataHeader tih;
+  tih.dataDescription = o2::header::DataDescription("TIMEFRAMEINDEX");
+  tih.dataOrigin = o2::header::DataOrigin("EPN");
+  tih.subSpecification = 0;
+  tih.payloadSize = flattenedIndex.size() * sizeof(IndexElement);
+  void* indexData = malloc(tih.payloadSize);
+  memcpy(indexData, flattenedIndex.data(), tih.payloadSize);
 
-      mTimeframeBuffer[id].parts.AddPart(NewSimpleMessage(tih));
-      mTimeframeBuffer[id].parts.AddPart(NewMessage(indexData, tih.payloadSize,
+  timeframeParts.AddPart(NewSimpleMessage(tih));
+  timeframeParts.AddPart(NewMessage(indexData, tih.payloadSize,
                          [](void* data, void* hint){ free(data); }, nullptr));
-      // LOG(INFO) << "Collected all parts for timeframe #" << id;
-      // when all parts are collected send then to the output channel
-      Send(mTimeframeBuffer[id].parts, mOutChannelName);
-      LOG(INFO) << "Index count for " << id << " " << index.count(id) << "\n";
-      index.erase(id);
-      LOG(INFO) << "Index count for " << id << " " << index.count(id) << "\n";
-      flpIds.erase(id);
+  // when all parts are collected send then to the output channel
+  Send(timeframeParts, mOutChannelName);
+  LOG(INFO) << "Index count for " << id << " " << flattenedIndex.size() << "\n";
+}
+
+void EPNReceiverDevice::Run()
+{
+  // One receiver thread per FLP-facing sub-channel, all feeding the same
+  // aggregation ring. This thread publishes the complete timeframes.
+  vector<thread> receivers;
+  for (size_t i = 0; i < fChannels.at(mInChannelName).size(); ++i) {
+    receivers.emplace_back(&EPNReceiverDevice::ReceiveSubtimeframes, this, i);
+  }
+
+  vector<FairMQParts> subtimeframes;
+  while (CheckCurrentState(RUNNING)) {
+    uint16_t id = 0;
+    bool idle = true;
+    while (mTimeframeBuffer->popComplete(id, subtimeframes)) {
+      idle = false;
+      PublishTimeframe(id, subtimeframes);
 
       if (mTestMode > 0) {
         // Send an acknowledgement back to the sampler to measure the round trip time
-        unique_ptr<FairMQMessage> ack(NewMessage(sizeof(uint16_t)));
-        memcpy(ack->GetData(), &id, sizeof(uint16_t));
-
-        if (ackOutChannel.Send(ack, 0) <= 0) {
-          LOG(ERROR) << "Could not send acknowledgement without blocking";
-        }
+        SendAcknowledgement(id);
+      }
+      for (int flp = 0; flp < mNumFLPs; ++flp) {
+        SendCredit(id, flp);
       }
-
-      mTimeframeBuffer.erase(id);
     }
 
-    // LOG(WARN) << "Buffer size: " << fTimeframeBuffer.size();
-
     // Check if any incomplete timeframes in the buffer are older than
     // timeout period, and discard them if they are
     // QUESTION: is this really what we want to do?
     DiscardIncompleteTimeframes();
+
+    if (idle) {
+      this_thread::sleep_for(microseconds(100));
+    }
+  }
+
+  for (auto& receiver : receivers) {
+    receiver.join();
   }
 }
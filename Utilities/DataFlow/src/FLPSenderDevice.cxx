@@ -8,8 +8,12 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 
+#include <algorithm>
 #include <cstdint>
 #include <cassert>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
 
 #include <FairMQLogger.h>
 #include <FairMQMessage.h>
@@ -32,69 +36,107 @@ void FLPSenderDevice::InitTask()
   mTestMode = GetConfig()->GetValue<int>("test-mode");
   mSendOffset = GetConfig()->GetValue<int>("send-offset");
   mSendDelay = GetConfig()->GetValue<int>("send-delay");
+  mSendRate = GetConfig()->GetValue<double>("send-rate");
+  mSendBurst = GetConfig()->GetValue<int>("send-burst");
+  mMaxQueued = GetConfig()->GetValue<int>("max-queued");
+  mMaxInFlight = GetConfig()->GetValue<int>("max-in-flight");
   mInChannelName = GetConfig()->GetValue<string>("in-chan-name");
   mOutChannelName = GetConfig()->GetValue<string>("out-chan-name");
-}
+  mCreditChannelName = GetConfig()->GetValue<string>("credit-chan-name");
+
+  if (mNumEPNs <= 0) {
+    throw runtime_error("num-epns must be positive");
+  }
+  if (mMaxInFlight > 0 && mCreditChannelName.empty()) {
+    throw runtime_error("max-in-flight requires a credit channel (credit-chan-name)");
+  }
+  if (mSendRate > 0. && mSendBurst <= 0) {
+    // the token bucket would never hold enough tokens for anything
+    throw runtime_error("send-rate requires a positive send-burst");
+  }
 
+  o2::dataflow::SendSchedulerConfig config;
+  config.nDestinations = mNumEPNs;
+  config.delay = milliseconds(mSendDelay * mSendOffset);
+  config.rate = mSendRate * 1e6;
+  config.burst = mSendBurst;
+  config.maxQueueSize = max(mMaxQueued, 1);
+  config.maxOutstanding = max(mMaxInFlight, 0);
+  mScheduler.reset(new Scheduler(config));
+}
 
 void FLPSenderDevice::Run()
 {
-  // base buffer, to be copied from for every timeframe body (zero-copy)
-  FairMQMessagePtr baseMsg(NewMessage(mEventSize));
-
-  // store the channel reference to avoid traversing the map on every loop iteration
-  //FairMQChannel& dataInChannel = fChannels.at(fInChannelName).at(0);
-
   while (CheckCurrentState(RUNNING)) {
     // - Get the SubtimeframeMetadata
     // - Add the current FLP id to the SubtimeframeMetadata
-    // - Forward to the EPN the whole subtimeframe
-    FairMQParts subtimeframeParts;
-    if (Receive(subtimeframeParts, mInChannelName, 0, 100) <= 0)
-      continue;
-
-    assert(subtimeframeParts.Size() != 0);
-    assert(subtimeframeParts.Size() >= 2);
-    const auto* dh = o2::header::get<header::DataHeader>(subtimeframeParts.At(0)->GetData());
-    assert(strncmp(dh->dataDescription.str, "SUBTIMEFRAMEMD", 16) == 0);
-
-    SubframeMetadata* sfm = reinterpret_cast<SubframeMetadata*>(subtimeframeParts.At(1)->GetData());
-    sfm->flpIndex = mIndex;
-
-    mArrivalTime.push(steady_clock::now());
-    mSTFBuffer.push(move(subtimeframeParts));
-
-    // if offset is 0 - send data out without staggering.
-    assert(mSTFBuffer.size() > 0);
-
-    if (mSendOffset == 0 && mSTFBuffer.size() > 0) {
-      sendFrontData();
-    } else if (mSTFBuffer.size() > 0) {
-      if (duration_cast<milliseconds>(steady_clock::now() - mArrivalTime.front()).count() >= (mSendDelay * mSendOffset)) {
-        sendFrontData();
-      } else {
-        // LOG(INFO) << "buffering...";
+    // - Hand the whole subtimeframe to the scheduler
+    // When the queue is full nothing is read, so that the upstream
+    // device is throttled as well.
+    if (!mScheduler->full()) {
+      FairMQParts subtimeframeParts;
+      // do not wait long if there is something to send
+      int timeout = mScheduler->size() > 0 ? 1 : 100;
+      if (Receive(subtimeframeParts, mInChannelName, 0, timeout) > 0) {
+        assert(subtimeframeParts.Size() >= 2);
+        const auto* dh = o2::header::get<header::DataHeader>(subtimeframeParts.At(0)->GetData());
+        assert(strncmp(dh->dataDescription.str, "SUBTIMEFRAMEMD", 16) == 0);
+
+        SubframeMetadata* sfm = reinterpret_cast<SubframeMetadata*>(subtimeframeParts.At(1)->GetData());
+        sfm->flpIndex = mIndex;
+        uint16_t id = o2::DataFlow::timeframeIdFromTimestamp(sfm->startTime, sfm->duration);
+
+        size_t bytes = 0;
+        for (int i = 0; i < subtimeframeParts.Size(); ++i) {
+          bytes += subtimeframeParts.At(i)->GetSize();
+        }
+        mScheduler->push(move(subtimeframeParts), id, bytes);
       }
+    } else {
+      this_thread::sleep_for(microseconds(100));
     }
+
+    receiveAcknowledgements();
+    sendReadyData();
   }
 }
 
-inline void FLPSenderDevice::sendFrontData()
+void FLPSenderDevice::receiveAcknowledgements()
 {
-  SubframeMetadata *sfm = static_cast<SubframeMetadata*>(mSTFBuffer.front().At(1)->GetData());
-  uint16_t currentTimeframeId = o2::DataFlow::timeframeIdFromTimestamp(sfm->startTime, sfm->duration);
-  if (mLastTimeframeId != -1) {
-    if (currentTimeframeId == mLastTimeframeId) {
-      LOG(ERROR) << "Sent same consecutive timeframe ids\n";
+  if (mCreditChannelName.empty()) {
+    return;
+  }
+  FairMQChannel& creditChannel = fChannels.at(mCreditChannelName).at(0);
+  while (true) {
+    FairMQMessagePtr ack(NewMessage());
+    if (creditChannel.ReceiveAsync(ack) <= 0) {
+      break;
+    }
+    if (ack->GetSize() != sizeof(uint16_t)) {
+      LOG(WARN) << "Ignoring acknowledgement of unexpected size " << ack->GetSize();
+      continue;
     }
+    uint16_t id;
+    memcpy(&id, ack->GetData(), sizeof(uint16_t));
+    mScheduler->acknowledge(id);
   }
-  mLastTimeframeId = currentTimeframeId;
+}
+
+void FLPSenderDevice::sendReadyData()
+{
+  FairMQParts parts;
+  uint32_t currentTimeframeId;
+  size_t direction;
+  while (mScheduler->pop(parts, currentTimeframeId, direction)) {
+    if (mLastTimeframeId != -1) {
+      if (static_cast<int>(currentTimeframeId) == mLastTimeframeId) {
+        LOG(ERROR) << "Sent same consecutive timeframe ids\n";
+      }
+    }
+    mLastTimeframeId = currentTimeframeId;
 
-  // for which EPN is the message?
-  int direction = currentTimeframeId % mNumEPNs;
-  if (Send(mSTFBuffer.front(), mOutChannelName, direction, 0) < 0) {
-    LOG(ERROR) << "Failed to queue sub-timeframe #" << currentTimeframeId << " to EPN[" << direction << "]";
+    if (Send(parts, mOutChannelName, direction, 0) < 0) {
+      LOG(ERROR) << "Failed to queue sub-timeframe #" << currentTimeframeId << " to EPN[" << direction << "]";
+    }
   }
-  mSTFBuffer.pop();
-  mArrivalTime.pop();
 }
@@ -45,6 +45,7 @@ void o2::DataFlow::SubframeBuilderDevice::InitTask()
   mOutputChannelName = GetConfig()->GetValue<std::string>(OptionKeyOutputChannelName);
   mFLPId= GetConfig()->GetValue<size_t>(OptionKeyFLPId);
   mStripHBF= GetConfig()->GetValue<bool>(OptionKeyStripHBF);
+  mScatterGather = GetConfig()->GetValue<bool>(OptionKeyScatterGather);
 
   LOG(INFO) << "Obtaining data from DataPublisher\n";
   // Now that we have all the information lets create the policies to do the 
@@ -72,7 +73,7 @@ void o2::DataFlow::SubframeBuilderDevice::InitTask()
   // timeframe we want.
   Merger::MergeCompletionCheker checkIfComplete =
     [this](Merger::MergeableId id, Merger::MessageMap &map) {
-      return map.count(id) < this->mOrbitsPerTimeframe;
+      return map.count(id) >= this->mOrbitsPerTimeframe;
   };
 
   mMerger.reset(new Merger(makeId, checkIfComplete, payloadExtractor));
@@ -83,8 +84,12 @@ bool o2::DataFlow::SubframeBuilderDevice::BuildAndSendFrame(FairMQParts &inParts
 {
   auto id = mMerger->aggregate(inParts.At(1));
 
-  char **outBuffer;
-  size_t outSize = mMerger->finalise(outBuffer, id);
+  // Either merge the HBFs into a single buffer, or reference them as they
+  // are in a multipart message (scatter - gather, no copy).
+  char *outBuffer = nullptr;
+  FairMQParts hbfParts;
+  size_t outSize = mScatterGather ? mMerger->finalise(hbfParts, id, *fTransportFactory)
+                                  : mMerger->finalise(&outBuffer, id);
   // In this case we do not have enough subtimeframes for id,
   // so we simply return.
   if (outSize == 0)
@@ -118,10 +123,19 @@ bool o2::DataFlow::SubframeBuilderDevice::BuildAndSendFrame(FairMQParts &inParts
   O2Message outgoing;
   AddMessage(outgoing, dh, NewSimpleMessage(md));
 
-  // Add the actual merged payload.
-  AddMessage(outgoing, payloadheader,
-             NewMessage(*outBuffer, outSize,
-                        [](void* data, void* hint) { delete[] reinterpret_cast<char *>(hint); }, *outBuffer));
+  if (mScatterGather) {
+    // One header / payload pair per HBF
+    for (int i = 0; i < hbfParts.Size(); ++i) {
+      payloadheader.payloadSize = hbfParts.At(i)->GetSize();
+      AddMessage(outgoing, payloadheader, std::move(hbfParts.At(i)));
+    }
+  } else {
+    // Add the actual merged payload.
+    payloadheader.payloadSize = outSize;
+    AddMessage(outgoing, payloadheader,
+               NewMessage(outBuffer, outSize,
+                          [](void* data, void* hint) { delete[] reinterpret_cast<char *>(hint); }, outBuffer));
+  }
   // send message
   Send(outgoing, mOutputChannelName.c_str());
   // FIXME: do we actually need this? outgoing should go out of scope
@@ -0,0 +1,222 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   TimeframeFileIndex.cxx
+/// @brief  Table of contents of a timeframe file
+
+#include "DataFlow/TimeframeFileIndex.h"
+#include <boost/crc.hpp>
+#include <cstring>
+#include <stdexcept>
+
+using DataHeader = o2::header::DataHeader;
+
+namespace o2 { namespace DataFlow {
+
+namespace {
+template <typename T>
+void append(std::vector<char>& buffer, const T* data, size_t n = 1)
+{
+  auto source = reinterpret_cast<const char*>(data);
+  buffer.insert(buffer.end(), source, source + n * sizeof(T));
+}
+
+template <typename T>
+const char* extract(const char* buffer, const char* end, T* data, size_t n = 1)
+{
+  if (buffer + n * sizeof(T) > end) {
+    throw std::runtime_error("Truncated timeframe file footer");
+  }
+  memcpy(data, buffer, n * sizeof(T));
+  return buffer + n * sizeof(T);
+}
+} // namespace
+
+TimeframeFileIndex::TimeframeFileIndex(bool withChecksums)
+  : mVersion{ gTimeframeFooterVersion }
+  , mFlags{ withChecksums ? TOCHasChecksums : 0u }
+  , mHasParts{ true }
+  , mTimeframes{}
+  , mParts{}
+{
+}
+
+void TimeframeFileIndex::beginTimeframe(uint64_t offset)
+{
+  TimeframeFileTimeframeEntry entry;
+  entry.offset = offset;
+  entry.size = 0;
+  entry.firstPart = mParts.size();
+  entry.nParts = 0;
+  mTimeframes.push_back(entry);
+}
+
+void TimeframeFileIndex::addPart(const DataHeader& header, uint64_t headerOffset, uint32_t headerSize,
+                                 const char* payload, uint64_t payloadSize)
+{
+  if (mTimeframes.empty()) {
+    throw std::runtime_error("TimeframeFileIndex: part added outside of a timeframe");
+  }
+  TimeframeFilePartEntry entry;
+  entry.origin = header.dataOrigin;
+  entry.headerSize = headerSize;
+  entry.description = header.dataDescription;
+  entry.subSpecification = header.subSpecification;
+  entry.headerOffset = headerOffset;
+  entry.payloadSize = payloadSize;
+  entry.checksum = hasChecksums() ? checksum(payload, payloadSize) : 0;
+  entry.reserved = 0;
+  mParts.push_back(entry);
+  mTimeframes.back().nParts++;
+}
+
+void TimeframeFileIndex::endTimeframe(uint64_t size)
+{
+  if (mTimeframes.empty()) {
+    throw std::runtime_error("TimeframeFileIndex: no timeframe to end");
+  }
+  mTimeframes.back().size = size;
+}
+
+void TimeframeFileIndex::clear()
+{
+  mTimeframes.clear();
+  mParts.clear();
+}
+
+std::vector<char> TimeframeFileIndex::serialize(uint64_t footerOffset) const
+{
+  TimeframeFileFooterHeader header;
+  memcpy(header.magic, gTimeframeFooterMagic, sizeof(header.magic));
+  header.version = gTimeframeFooterVersion;
+  header.nEntries = mTimeframes.size();
+  TimeframeFileTOCHeader tocHeader;
+  tocHeader.nParts = mParts.size();
+  tocHeader.flags = mFlags;
+  TimeframeFileTrailer trailer;
+  trailer.footerOffset = footerOffset;
+  memcpy(trailer.magic, gTimeframeTrailerMagic, sizeof(trailer.magic));
+
+  std::vector<char> buffer;
+  buffer.reserve(sizeof(header) + sizeof(tocHeader) + mTimeframes.size() * sizeof(TimeframeFileTimeframeEntry) +
+                 mParts.size() * sizeof(TimeframeFilePartEntry) + sizeof(trailer));
+  append(buffer, &header);
+  append(buffer, &tocHeader);
+  append(buffer, mTimeframes.data(), mTimeframes.size());
+  append(buffer, mParts.data(), mParts.size());
+  append(buffer, &trailer);
+  return buffer;
+}
+
+void TimeframeFileIndex::deserialize(const char* buffer, size_t size)
+{
+  const char* end = buffer + size;
+  TimeframeFileFooterHeader header;
+  buffer = extract(buffer, end, &header);
+  if (!isTimeframeFooter(header.magic)) {
+    throw std::runtime_error("Invalid timeframe file footer");
+  }
+  clear();
+  mVersion = header.version;
+  if (header.version == 1) {
+    std::vector<TimeframeFileIndexEntry> entries(header.nEntries);
+    extract(buffer, end, entries.data(), entries.size());
+    for (auto& entry : entries) {
+      mTimeframes.push_back(TimeframeFileTimeframeEntry{ entry.offset, entry.size, 0, 0 });
+    }
+    mFlags = 0;
+    mHasParts = false;
+  } else if (header.version == 2) {
+    TimeframeFileTOCHeader tocHeader;
+    buffer = extract(buffer, end, &tocHeader);
+    mTimeframes.resize(header.nEntries);
+    mParts.resize(tocHeader.nParts);
+    buffer = extract(buffer, end, mTimeframes.data(), mTimeframes.size());
+    extract(buffer, end, mParts.data(), mParts.size());
+    for (auto& tf : mTimeframes) {
+      if (uint64_t(tf.firstPart) + tf.nParts > mParts.size()) {
+        throw std::runtime_error("Inconsistent timeframe file table of contents");
+      }
+    }
+    mFlags = tocHeader.flags;
+    mHasParts = true;
+  } else {
+    throw std::runtime_error("Unsupported timeframe file footer version " + std::to_string(header.version));
+  }
+}
+
+std::vector<const TimeframeFilePartEntry*> TimeframeFileIndex::findParts(size_t tf,
+                                                                         const TimeframePartSelector& selector) const
+{
+  std::vector<const TimeframeFilePartEntry*> result;
+  auto& entry = mTimeframes.at(tf);
+  for (size_t i = entry.firstPart; i < entry.firstPart + entry.nParts; ++i) {
+    if (selector.matches(mParts[i])) {
+      result.push_back(&mParts[i]);
+    }
+  }
+  return result;
+}
+
+uint32_t TimeframeFileIndex::checksum(const char* buffer, size_t size)
+{
+  boost::crc_32_type crc;
+  crc.process_bytes(buffer, size);
+  return crc.checksum();
+}
+
+TimeframePartSelector::TimeframePartSelector(const std::string& selection)
+  : origin{}
+  , description{}
+  , subSpecification{ 0 }
+  , anyOrigin{ true }
+  , anyDescription{ true }
+  , anySubSpecification{ true }
+{
+  std::vector<std::string> fields;
+  size_t start = 0;
+  while (start <= selection.size() && !selection.empty()) {
+    auto stop = selection.find('/', start);
+    if (stop == std::string::npos) {
+      stop = selection.size();
+    }
+    fields.push_back(selection.substr(start, stop - start));
+    start = stop + 1;
+  }
+  if (fields.size() > 3) {
+    throw std::runtime_error("Invalid part selection " + selection);
+  }
+  if (fields.size() > 0 && fields[0] != "*") {
+    if (fields[0].size() > sizeof(origin)) {
+      throw std::runtime_error("Invalid data origin " + fields[0]);
+    }
+    origin.runtimeInit(fields[0].c_str());
+    anyOrigin = false;
+  }
+  if (fields.size() > 1 && fields[1] != "*") {
+    if (fields[1].size() > sizeof(description)) {
+      throw std::runtime_error("Invalid data description " + fields[1]);
+    }
+    description.runtimeInit(fields[1].c_str());
+    anyDescription = false;
+  }
+  if (fields.size() > 2 && fields[2] != "*") {
+    subSpecification = std::stoull(fields[2]);
+    anySubSpecification = false;
+  }
+}
+
+bool TimeframePartSelector::matches(const TimeframeFilePartEntry& entry) const
+{
+  return (anyOrigin || entry.origin == origin) && (anyDescription || entry.description == description) &&
+         (anySubSpecification || entry.subSpecification == subSpecification);
+}
+
+} } // namespace o2::DataFlow
@@ -0,0 +1,168 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// @file   TimeframeFileReader.cxx
+/// @brief  Random access reader for timeframe files
+
+#include "DataFlow/TimeframeFileReader.h"
+#include "Headers/DataHeader.h"
+#include "TimeFrame/TimeFrame.h"
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using DataHeader = o2::header::DataHeader;
+using DataDescription = o2::header::DataDescription;
+using IndexElement = o2::DataFormat::IndexElement;
+
+namespace o2 { namespace DataFlow {
+
+TimeframeFileReader::TimeframeFileReader(const std::string& filename)
+  : mFileName{ filename }
+  , mFile{ filename, std::ios::in | std::ios::binary }
+  , mFileSize{ 0 }
+  , mHasTableOfContents{ false }
+  , mIndex{}
+{
+  if (!mFile.is_open()) {
+    throw std::runtime_error("Unable to open " + filename);
+  }
+  mFile.seekg(0, std::ios::end);
+  mFileSize = mFile.tellg();
+  mHasTableOfContents = readFooter();
+  if (!mHasTableOfContents) {
+    scan();
+  }
+}
+
+void TimeframeFileReader::readHeader(const TimeframeFilePartEntry& part, char* header)
+{
+  read(part.headerOffset, header, part.headerSize);
+}
+
+void TimeframeFileReader::readPayload(const TimeframeFilePartEntry& part, char* payload)
+{
+  read(part.payloadOffset(), payload, part.payloadSize);
+  if (mIndex.hasChecksums() && TimeframeFileIndex::checksum(payload, part.payloadSize) != part.checksum) {
+    throw std::runtime_error("Checksum mismatch for part at offset " + std::to_string(part.headerOffset) + " in " +
+                             mFileName);
+  }
+}
+
+bool TimeframeFileReader::readSelected(size_t tf, const TimeframePartSelector& selector,
+                                       std::function<void(char* buffer, size_t size)> onAddPart)
+{
+  if (tf >= mIndex.timeframes().size()) {
+    return false;
+  }
+  auto& tfEntry = mIndex.timeframes()[tf];
+  if (tfEntry.nParts == 0) {
+    return false;
+  }
+  // The last pair of a timeframe is its TIMEFRAMEINDEX, which needs to be
+  // rebuilt to only reference the selected parts.
+  auto& indexEntry = mIndex.parts()[tfEntry.firstPart + tfEntry.nParts - 1];
+  if (indexEntry.description != DataDescription("TIMEFRAMEINDEX")) {
+    throw std::runtime_error("Timeframe " + std::to_string(tf) + " in " + mFileName + " has no TIMEFRAMEINDEX");
+  }
+
+  std::vector<IndexElement> elements;
+  for (auto part : mIndex.findParts(tf, selector)) {
+    if (part == &indexEntry) {
+      continue;
+    }
+    // The buffers are only handed over once both are read, such that
+    // nothing leaks if reading throws.
+    std::unique_ptr<char[]> header{ new char[part->headerSize] };
+    readHeader(*part, header.get());
+    std::unique_ptr<char[]> payload{ new char[part->payloadSize] };
+    readPayload(*part, payload.get());
+    // The index refers to the position of the header in the list of parts,
+    // the payload follows it.
+    elements.emplace_back(*o2::header::get<DataHeader>(header.get()), elements.size() * 2);
+    onAddPart(header.release(), part->headerSize);
+    onAddPart(payload.release(), part->payloadSize);
+  }
+
+  std::unique_ptr<char[]> indexHeader{ new char[indexEntry.headerSize] };
+  readHeader(indexEntry, indexHeader.get());
+  auto indexPayloadSize = elements.size() * sizeof(IndexElement);
+  reinterpret_cast<DataHeader*>(indexHeader.get())->payloadSize = indexPayloadSize;
+  std::unique_ptr<char[]> indexPayload{ new char[indexPayloadSize] };
+  memcpy(indexPayload.get(), elements.data(), indexPayloadSize);
+  onAddPart(indexHeader.release(), indexEntry.headerSize);
+  onAddPart(indexPayload.release(), indexPayloadSize);
+  return true;
+}
+
+bool TimeframeFileReader::readFooter()
+{
+  TimeframeFileTrailer trailer;
+  if (mFileSize < sizeof(TimeframeFileFooterHeader) + sizeof(trailer)) {
+    return false;
+  }
+  read(mFileSize - sizeof(trailer), reinterpret_cast<char*>(&trailer), sizeof(trailer));
+  if (memcmp(trailer.magic, gTimeframeTrailerMagic, sizeof(trailer.magic)) != 0 ||
+      trailer.footerOffset > mFileSize - sizeof(trailer)) {
+    return false;
+  }
+  std::vector<char> footer(mFileSize - trailer.footerOffset);
+  read(trailer.footerOffset, footer.data(), footer.size());
+  mIndex.deserialize(footer.data(), footer.size());
+  return mIndex.hasParts();
+}
+
+void TimeframeFileReader::scan()
+{
+  // Walk the header / payload pairs of the file, only reading the headers.
+  mIndex = TimeframeFileIndex{};
+  uint64_t offset = 0;
+  uint64_t timeframeStart = 0;
+  bool inTimeframe = false;
+  while (offset + sizeof(DataHeader) <= mFileSize) {
+    DataHeader dh;
+    read(offset, reinterpret_cast<char*>(&dh), sizeof(dh));
+    if (isTimeframeFooter(&dh)) {
+      break;
+    }
+    if (o2::header::BaseHeader::get(reinterpret_cast<const byte*>(&dh)) == nullptr ||
+        dh.headerSize < sizeof(DataHeader) || offset + dh.headerSize + dh.payloadSize > mFileSize) {
+      throw std::runtime_error("Corrupted timeframe file " + mFileName + " at offset " + std::to_string(offset));
+    }
+    if (!inTimeframe) {
+      mIndex.beginTimeframe(offset);
+      timeframeStart = offset;
+      inTimeframe = true;
+    }
+    mIndex.addPart(dh, offset, dh.headerSize, nullptr, dh.payloadSize);
+    offset += dh.headerSize + dh.payloadSize;
+    if (dh.dataDescription == DataDescription("TIMEFRAMEINDEX")) {
+      mIndex.endTimeframe(offset - timeframeStart);
+      inTimeframe = false;
+    }
+  }
+  if (inTimeframe) {
+    throw std::runtime_error("Truncated timeframe at the end of " + mFileName);
+  }
+}
+
+void TimeframeFileReader::read(uint64_t offset, char* buffer, uint64_t size)
+{
+  mFile.clear();
+  mFile.seekg(offset);
+  mFile.read(buffer, size);
+  if (!mFile || static_cast<uint64_t>(mFile.gcount()) != size) {
+    throw std::runtime_error("Unable to read " + std::to_string(size) + " bytes at offset " + std::to_string(offset) +
+                             " from " + mFileName);
+  }
+}
+
+} } // namespace o2::DataFlow
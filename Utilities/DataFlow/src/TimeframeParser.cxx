@@ -18,6 +18,7 @@
 #include <cstring>
 
 #include "DataFlow/TimeframeParser.h"
+#include "DataFlow/TimeframeFileFormat.h"
 #include "Headers/SubframeMetadata.h"
 #include "Headers/DataHeader.h"
 #include "TimeFrame/TimeFrame.h"
@@ -53,6 +54,7 @@ struct StreamingState {
   ParsingState state = PARSE_BEGIN_STREAM;
   bool hasDataHeader = false;
   bool hasConcreteHeader = false;
+  bool atTimeframeStart = false;  // no part of the current timeframe parsed yet
   void *payloadBuffer = nullptr;
   void *headerBuffer = nullptr;
   DataHeader dh;                  // The current DataHeader being parsed
@@ -73,6 +75,7 @@ void streamTimeframe(std::istream &stream,
       case PARSE_BEGIN_TIMEFRAME:
         LOG(INFO) << "In PARSE_BEGIN_TIMEFRAME\n";
         state.state = PARSE_BEGIN_PAIR;
+        state.atTimeframeStart = true;
         break;
       case PARSE_BEGIN_PAIR:
         LOG(INFO) << "In PARSE_BEGIN_PAIR\n";
@@ -90,6 +93,14 @@ void streamTimeframe(std::istream &stream,
         }
         LOG(INFO) << "Reading dataheader of " << sizeof(state.dh) << " bytes\n";
         stream.read(reinterpret_cast<char *>(&state.dh), sizeof(state.dh));
+        // The index footer written at the end of a file terminates the
+        // sequence of timeframes.
+        if (state.atTimeframeStart && stream.gcount() >= static_cast<std::streamsize>(sizeof(gTimeframeFooterMagic))
+            && isTimeframeFooter(&state.dh)) {
+          state.state = PARSE_END_STREAM;
+          break;
+        }
+        state.atTimeframeStart = false;
         // If we have a TIMEFRAMEINDEX part and we find the eof, we are done.
         if (stream.eof()) {
           throw std::runtime_error("Premature end of stream");
@@ -168,7 +179,7 @@ void streamTimeframe(std::istream &stream,
   }
 }
 
-void streamTimeframe(std::ostream &stream, FairMQParts &parts) {
+void validateTimeframe(FairMQParts &parts) {
   if (parts.Size() < 2)
   {
     throw std::runtime_error("Expecting at least 2 parts\n");
@@ -196,6 +207,10 @@ void streamTimeframe(std::ostream &stream, FairMQParts &parts) {
   }
 
   LOG(INFO) << "Everything is fine with received timeframe\n";
+}
+
+void streamTimeframe(std::ostream &stream, FairMQParts &parts) {
+  validateTimeframe(parts);
   for (size_t i = 0;  i < parts.Size(); ++i)
   {
     stream.write(reinterpret_cast<const char *>(parts.At(i)->GetData()),
@@ -12,6 +12,7 @@
 
 #include "DataFlow/TimeframeReaderDevice.h"
 #include "DataFlow/TimeframeParser.h"
+#include "DataFlow/TimeframeFileReader.h"
 #include "Headers/SubframeMetadata.h"
 #include "Headers/DataHeader.h"
 #include <options/FairMQProgOptions.h>
@@ -31,6 +32,7 @@ void TimeframeReaderDevice::InitTask()
 {
   mOutChannelName = GetConfig()->GetValue<std::string>(OptionKeyOutputChannelName);
   mInFileName = GetConfig()->GetValue<std::string>(OptionKeyInputFileName);
+  mSelection = GetConfig()->GetValue<std::string>(OptionKeySelection);
   mSeen.clear();
 }
 
@@ -49,11 +51,15 @@ bool TimeframeReaderDevice::ConditionalRun()
   std::vector<std::string> files;
   files.push_back(mInFileName);
   for (auto &&fn : files) {
-    mFile.open(fn, std::ofstream::in | std::ofstream::binary);
     try {
-      streamTimeframe(mFile,
-                      addPartFn,
-                      sendFn);
+      if (mSelection.empty()) {
+        mFile.open(fn, std::ofstream::in | std::ofstream::binary);
+        streamTimeframe(mFile,
+                        addPartFn,
+                        sendFn);
+      } else {
+        replaySelected(fn);
+      }
     } catch(std::runtime_error &e) {
       LOG(ERROR) << e.what() << "\n";
     }
@@ -63,4 +69,24 @@ bool TimeframeReaderDevice::ConditionalRun()
   return false;
 }
 
+void TimeframeReaderDevice::replaySelected(const std::string& filename)
+{
+  TimeframeFileReader reader(filename);
+  if (!reader.hasTableOfContents()) {
+    LOG(WARN) << filename << " has no table of contents, scanned the headers instead\n";
+  }
+  TimeframePartSelector selector(mSelection);
+  auto freeFn = [](void* data, void* hint) { delete[] (char*)data; };
+
+  for (size_t tf = 0; tf < reader.getNumberOfTimeframes() && CheckCurrentState(RUNNING); ++tf) {
+    FairMQParts parts;
+    auto addPartFn = [this, &parts, &freeFn](char* buffer, size_t size) {
+      parts.AddPart(NewMessage(buffer, size, freeFn, nullptr));
+    };
+    if (reader.readSelected(tf, selector, addPartFn)) {
+      Send(parts, mOutChannelName);
+    }
+  }
+}
+
 }} // namespace o2::DataFlow
@@ -9,6 +9,7 @@
 // or submit itself to any jurisdiction.
 
 #include "DataFlow/TimeframeParser.h"
+#include "DataFlow/TimeframeFileReader.h"
 #include "fairmq/FairMQParts.h"
 #include <vector>
 #include <string>
@@ -18,14 +19,50 @@
 #include <unistd.h>
 #include <fstream>
 
+using DataHeader = o2::header::DataHeader;
+
+namespace {
+// Check that the table of contents matches the headers in the file
+// and that the payloads match their checksums.
+void validateTableOfContents(const std::string &fn) {
+  o2::DataFlow::TimeframeFileReader reader(fn);
+  auto &index = reader.index();
+  LOG(INFO) << fn << ": " << index.getNumberOfTimeframes() << " timeframes, "
+            << index.parts().size() << " parts"
+            << (reader.hasTableOfContents() ? "" : " (no table of contents, headers scanned)")
+            << (index.hasChecksums() ? ", with checksums" : "") << "\n";
+  std::vector<char> header;
+  std::vector<char> payload;
+  for (auto &part : index.parts()) {
+    header.resize(part.headerSize);
+    reader.readHeader(part, header.data());
+    auto dh = o2::header::get<DataHeader>(header.data());
+    if (dh == nullptr
+        || dh->dataOrigin != part.origin
+        || dh->dataDescription != part.description
+        || dh->subSpecification != part.subSpecification
+        || dh->payloadSize != part.payloadSize) {
+      throw std::runtime_error("Header at offset " + std::to_string(part.headerOffset)
+                               + " does not match the table of contents");
+    }
+    payload.resize(part.payloadSize);
+    reader.readPayload(part, payload.data());
+  }
+}
+}
+
 // A simple tool which verifies timeframe files
 int main(int argc, char **argv) {
   int c;
   opterr = 0;
+  bool checkTableOfContents = false;
 
-  while ((c = getopt (argc, argv, "")) != -1) {
+  while ((c = getopt (argc, argv, "c")) != -1) {
     switch (c)
     {
+    case 'c':
+      checkTableOfContents = true;
+      break;
     case '?':
       if (isprint (optopt))
         fprintf (stderr, "Unknown option `-%c'.\n", optopt);
@@ -55,6 +92,9 @@ int main(int argc, char **argv) {
 
     try {
       o2::DataFlow::streamTimeframe(s, onAddParts, onSend);
+      if (checkTableOfContents) {
+        validateTableOfContents(fn);
+      }
     } catch(std::runtime_error &e) {
       LOG(ERROR) << e.what() << std::endl;
       exit(1);
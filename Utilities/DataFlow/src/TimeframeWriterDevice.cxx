@@ -22,7 +22,7 @@
 #include "Headers/SubframeMetadata.h"
 #include "Headers/DataHeader.h"
 #include <options/FairMQProgOptions.h>
-#include <boost/filesystem.hpp>
+#include <stdexcept>
 
 
 using DataHeader = o2::header::DataHeader;
@@ -33,11 +33,20 @@ namespace o2 { namespace DataFlow {
 TimeframeWriterDevice::TimeframeWriterDevice()
   : O2Device{}
   , mInChannelName{}
-  , mFile{}
+  , mWriter{}
+  , mIndex{}
   , mMaxTimeframes{}
   , mMaxFileSize{}
   , mMaxFiles{}
+  , mMaxFileDuration{}
+  , mDirectIO{false}
+  , mChecksums{false}
+  , mWriteBufferSize{}
+  , mWriteBuffers{}
   , mFileCount{0}
+  , mFileOpenTime{}
+  , mLastMetricsTime{}
+  , mLastBytesWritten{0}
 {
 }
 
@@ -48,13 +57,21 @@ void TimeframeWriterDevice::InitTask()
   mMaxTimeframes = GetConfig()->GetValue<size_t>(OptionKeyMaxTimeframesPerFile);
   mMaxFileSize = GetConfig()->GetValue<size_t>(OptionKeyMaxFileSize);
   mMaxFiles = GetConfig()->GetValue<size_t>(OptionKeyMaxFiles);
+  mMaxFileDuration = GetConfig()->GetValue<size_t>(OptionKeyMaxFileDuration);
+  mDirectIO = GetConfig()->GetValue<bool>(OptionKeyDirectIO);
+  mWriteBufferSize = GetConfig()->GetValue<size_t>(OptionKeyWriteBufferSize);
+  mWriteBuffers = GetConfig()->GetValue<size_t>(OptionKeyWriteBuffers);
+  mChecksums = GetConfig()->GetValue<bool>(OptionKeyChecksums);
+  mIndex = TimeframeFileIndex(mChecksums);
+  mWriter = std::make_unique<AsyncFileWriter>(mWriteBufferSize, mWriteBuffers, mDirectIO);
 }
 
 void TimeframeWriterDevice::Run()
 {
-  boost::filesystem::path p(mOutFileName);
   size_t streamedTimeframes = 0;
   bool needsNewFile = true;
+  mLastMetricsTime = Clock::now();
+  mLastBytesWritten = mWriter->bytesWritten();
   while (CheckCurrentState(RUNNING) && mFileCount < mMaxFiles) {
     // In case we need to process more than one file,
     // the filename is split in basename and extension
@@ -67,19 +84,45 @@ void TimeframeWriterDevice::Run()
         filename = base_path + std::to_string(mFileCount) + extension;
       }
       LOG(INFO) << "Opening " << filename << " for output\n";
-      mFile.open(filename.c_str(), std::ofstream::out | std::ofstream::binary);
+      mWriter->open(filename);
+      if (mDirectIO && !mWriter->directIO()) {
+        LOG(WARN) << "Writing " << filename << " without O_DIRECT\n";
+      }
+      mIndex.clear();
+      mFileOpenTime = Clock::now();
+      streamedTimeframes = 0;
       needsNewFile = false;
     }
 
+    publishMetrics();
+
     FairMQParts timeframeParts;
-    if (Receive(timeframeParts, mInChannelName, 0, 100) <= 0)
-      continue;
+    bool received = Receive(timeframeParts, mInChannelName, 0, 100) > 0;
+    if (received) {
+      validateTimeframe(timeframeParts);
+      auto timeframeOffset = mWriter->tell();
+      mIndex.beginTimeframe(timeframeOffset);
+      for (int i = 0; i + 1 < timeframeParts.Size(); i += 2) {
+        auto& header = timeframeParts.At(i);
+        auto& payload = timeframeParts.At(i + 1);
+        auto dh = o2::header::get<DataHeader>(header->GetData());
+        if (!dh) {
+          throw std::runtime_error("Timeframe part without DataHeader");
+        }
+        mIndex.addPart(*dh, mWriter->tell(), header->GetSize(),
+                       reinterpret_cast<const char*>(payload->GetData()), payload->GetSize());
+        mWriter->write(header->GetData(), header->GetSize());
+        mWriter->write(payload->GetData(), payload->GetSize());
+      }
+      mIndex.endTimeframe(mWriter->tell() - timeframeOffset);
+      ++streamedTimeframes;
+    }
 
-    streamTimeframe(mFile, timeframeParts);
-    if ((mFile.tellp() > mMaxFileSize) || (streamedTimeframes++ > mMaxTimeframes))
+    auto fileAge = std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - mFileOpenTime);
+    bool expired = mMaxFileDuration > 0 && mIndex.getNumberOfTimeframes() > 0 && static_cast<size_t>(fileAge.count()) >= mMaxFileDuration;
+    if ((mWriter->tell() > mMaxFileSize) || (streamedTimeframes >= mMaxTimeframes) || expired)
     {
-      mFile.flush();
-      mFile.close();
+      closeFile();
       mFileCount++;
       needsNewFile = true;
     }
@@ -88,10 +131,40 @@ void TimeframeWriterDevice::Run()
 
 void TimeframeWriterDevice::PostRun()
 {
-  if (mFile.is_open()) {
-    mFile.flush();
-    mFile.close();
+  if (mWriter && mWriter->isOpen()) {
+    closeFile();
   }
+  if (mWriter) {
+    mWriter->flush();
+    publishMetrics();
+  }
+}
+
+void TimeframeWriterDevice::closeFile()
+{
+  auto footer = mIndex.serialize(mWriter->tell());
+  mWriter->write(footer.data(), footer.size());
+  mWriter->close();
+  mIndex.clear();
+}
+
+void TimeframeWriterDevice::publishMetrics()
+{
+  auto now = Clock::now();
+  auto elapsed = std::chrono::duration_cast<std::chrono::duration<float>>(now - mLastMetricsTime).count();
+  if (elapsed < 1.f) {
+    return;
+  }
+  auto bytesWritten = mWriter->bytesWritten();
+  float rate = (bytesWritten - mLastBytesWritten) / elapsed;
+  mLastMetricsTime = now;
+  mLastBytesWritten = bytesWritten;
+
+  // Same format as the one used by the DPL metrics service, so that the
+  // values can be picked up from the log.
+  auto timestamp = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+  LOG(INFO) << "METRIC:float:writer_bytes_per_second:" << timestamp << ":" << rate;
+  LOG(INFO) << "METRIC:int:writer_queue_depth:" << timestamp << ":" << mWriter->queueDepth();
 }
 
 }} // namespace o2::DataFlow
@@ -26,11 +26,13 @@ void addCustomOptions(bpo::options_description& options)
 {
   options.add_options()
     ("buffer-timeout", bpo::value<int>()->default_value(1000), "Buffer timeout in milliseconds")
+    ("buffer-capacity", bpo::value<int>()->default_value(256), "Maximum number of timeframes being built at the same time")
     ("num-flps", bpo::value<int>()->required(), "Number of FLPs")
     ("test-mode", bpo::value<int>()->default_value(0), "Run in test mode")
     ("in-chan-name", bpo::value<std::string>()->default_value("stf2"), "Name of the input channel (sub-time frames)")
     ("out-chan-name", bpo::value<std::string>()->default_value("tf"), "Name of the output channel (time frames)")
-    ("ack-chan-name", bpo::value<std::string>()->default_value("ack"), "Name of the acknowledgement channel");
+    ("ack-chan-name", bpo::value<std::string>()->default_value("ack"), "Name of the acknowledgement channel")
+    ("credit-chan-name", bpo::value<std::string>()->default_value(""), "Name of the channel returning the credits to the FLPs, one sub-channel per FLP (optional)");
 }
 
 FairMQDevice* getDevice(const FairMQProgOptions& config)
@@ -39,7 +39,10 @@ void addCustomOptions(bpo::options_description& options)
      "ID of the FLP used as data source")
     (o2::DataFlow::SubframeBuilderDevice::OptionKeyStripHBF,
      bpo::bool_switch()->default_value(false),
-     "Strip HBH & HBT from each HBF");
+     "Strip HBH & HBT from each HBF")
+    (o2::DataFlow::SubframeBuilderDevice::OptionKeyScatterGather,
+     bpo::bool_switch()->default_value(false),
+     "Send the HBFs of a subframe as separate parts instead of copying them into one buffer");
 }
 
 FairMQDevicePtr getDevice(const FairMQProgOptions& /*config*/)
@@ -23,6 +23,10 @@ void addCustomOptions(bpo::options_description& options)
     (o2::DataFlow::TimeframeReaderDevice::OptionKeyInputFileName,
      bpo::value<std::string>()->default_value("data.o2tf"),
      "Name of the input file");
+  options.add_options()
+    (o2::DataFlow::TimeframeReaderDevice::OptionKeySelection,
+     bpo::value<std::string>()->default_value(""),
+     "Only replay the parts matching ORIGIN[/DESCRIPTION[/SUBSPEC]], e.g. TPC");
 }
 
 FairMQDevicePtr getDevice(const FairMQProgOptions& /*config*/)
@@ -35,6 +35,26 @@ void addCustomOptions(bpo::options_description& options)
     (o2::DataFlow::TimeframeWriterDevice::OptionKeyMaxFileSize,
      bpo::value<size_t>()->default_value(-1),
      "Maximum size per file");
+  options.add_options()
+    (o2::DataFlow::TimeframeWriterDevice::OptionKeyMaxFileDuration,
+     bpo::value<size_t>()->default_value(0),
+     "Maximum time in seconds a file is kept open, 0 means no limit");
+  options.add_options()
+    (o2::DataFlow::TimeframeWriterDevice::OptionKeyDirectIO,
+     bpo::value<bool>()->default_value(false),
+     "Bypass the page cache using O_DIRECT");
+  options.add_options()
+    (o2::DataFlow::TimeframeWriterDevice::OptionKeyWriteBufferSize,
+     bpo::value<size_t>()->default_value(16 * 1024 * 1024),
+     "Size of each write buffer");
+  options.add_options()
+    (o2::DataFlow::TimeframeWriterDevice::OptionKeyWriteBuffers,
+     bpo::value<size_t>()->default_value(4),
+     "Number of write buffers in flight");
+  options.add_options()
+    (o2::DataFlow::TimeframeWriterDevice::OptionKeyChecksums,
+     bpo::value<bool>()->default_value(false),
+     "Store a CRC-32 of every payload in the table of contents");
 }
 
 FairMQDevicePtr getDevice(const FairMQProgOptions& /*config*/)
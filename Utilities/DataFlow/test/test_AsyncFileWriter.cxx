@@ -0,0 +1,98 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Utilities DataFlowTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include "DataFlow/AsyncFileWriter.h"
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <unistd.h>
+
+using AsyncFileWriter = o2::DataFlow::AsyncFileWriter;
+
+namespace {
+std::vector<char> readFile(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void checkRoundTrip(bool directIO)
+{
+  std::string filename = "test_AsyncFileWriter_" + std::to_string(getpid()) + (directIO ? "_direct" : "") + ".bin";
+  // Small buffers so that the data spans many of them, with a size which
+  // is not a multiple of the buffer size.
+  std::vector<char> data(3 * 4096 * 5 + 123);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = i % 251;
+  }
+
+  {
+    AsyncFileWriter writer(4096, 2, directIO);
+    writer.open(filename);
+    size_t offset = 0;
+    size_t chunk = 1;
+    while (offset < data.size()) {
+      auto n = std::min(chunk, data.size() - offset);
+      writer.write(data.data() + offset, n);
+      offset += n;
+      chunk = chunk * 3 + 1;
+    }
+    BOOST_CHECK_EQUAL(writer.tell(), data.size());
+    writer.close();
+    writer.flush();
+    BOOST_CHECK_EQUAL(writer.bytesWritten(), data.size());
+    BOOST_CHECK_EQUAL(writer.queueDepth(), 0);
+  }
+
+  auto content = readFile(filename);
+  BOOST_REQUIRE_EQUAL(content.size(), data.size());
+  BOOST_CHECK(content == data);
+  remove(filename.c_str());
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(AsyncFileWriterBuffered)
+{
+  checkRoundTrip(false);
+}
+
+BOOST_AUTO_TEST_CASE(AsyncFileWriterDirectIO)
+{
+  checkRoundTrip(true);
+}
+
+BOOST_AUTO_TEST_CASE(AsyncFileWriterRotation)
+{
+  std::string base = "test_AsyncFileWriter_" + std::to_string(getpid()) + "_";
+  AsyncFileWriter writer(4096, 2, false);
+  // Open the next file right after closing the previous one, without
+  // waiting for the I/O thread.
+  for (int i = 0; i < 3; ++i) {
+    writer.open(base + std::to_string(i));
+    std::string payload(1000 * (i + 1), 'a' + i);
+    writer.write(payload.data(), payload.size());
+    writer.close();
+  }
+  writer.flush();
+  for (int i = 0; i < 3; ++i) {
+    auto content = readFile(base + std::to_string(i));
+    BOOST_CHECK_EQUAL(content.size(), 1000 * (i + 1));
+    BOOST_CHECK(content.empty() == false && content.front() == 'a' + i && content.back() == 'a' + i);
+    remove((base + std::to_string(i)).c_str());
+  }
+  BOOST_CHECK_THROW(writer.write("x", 1), std::runtime_error);
+}
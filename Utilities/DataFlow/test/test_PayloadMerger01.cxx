@@ -79,3 +79,72 @@ BOOST_AUTO_TEST_CASE(PayloadMergerTest) {
     BOOST_CHECK(finalBuf[i] == ((i % partSize) == 0 ? 127 : 1));
   }
 }
+
+BOOST_AUTO_TEST_CASE(PayloadMergerScatterGatherTest) {
+  auto zmq = FairMQTransportFactory::CreateTransportFactory("zeromq");
+
+  auto checkIfComplete = [](SubframeId id, o2::dataflow::PayloadMerger<SubframeId>::MessageMap &m) -> bool {
+    return m.count(id) >= 3;
+  };
+
+  auto makeId = [](std::unique_ptr<FairMQMessage> &msg) {
+    auto header = reinterpret_cast<o2::header::HeartbeatHeader const*>(msg->GetData());
+    return o2::dataflow::makeIdFromHeartbeatHeader(*header, 0, 2);
+  };
+
+  o2::dataflow::PayloadMerger<SubframeId> merger(makeId, checkIfComplete, o2::dataflow::extractDetectorPayloadStrip);
+  FairMQParts parts;
+  // Ids arriving out of order
+  auto id = fakeAddition(merger, zmq, 4);
+  fakeAddition(merger, zmq, 1);
+  BOOST_CHECK(merger.finalise(parts, id, *zmq) == 0);
+  fakeAddition(merger, zmq, 5);
+  fakeAddition(merger, zmq, 0);
+  BOOST_CHECK(merger.finalise(parts, id, *zmq) == 0);
+  BOOST_CHECK(parts.Size() == 0);
+  fakeAddition(merger, zmq, 4);
+  size_t partSize = (1000-sizeof(HeartbeatHeader) - sizeof(HeartbeatTrailer));
+  BOOST_CHECK(merger.finalise(parts, id, *zmq) == 3*partSize);
+  BOOST_REQUIRE(parts.Size() == 3);
+  // The parts keep their arrival order
+  int orbits[] = { 4, 5, 4 };
+  for (int i = 0; i < parts.Size(); ++i) {
+    BOOST_CHECK(parts.At(i)->GetSize() == partSize);
+    auto *data = reinterpret_cast<char*>(parts.At(i)->GetData());
+    BOOST_CHECK(data[0] == 127);
+    BOOST_CHECK(data[partSize - 1] == orbits[i]);
+  }
+
+  // The parts of the other timeframe are still there
+  FairMQParts others;
+  id = fakeAddition(merger, zmq, 1);
+  BOOST_CHECK(merger.finalise(others, id, *zmq) == 3*partSize);
+  BOOST_CHECK(others.Size() == 3);
+}
+
+BOOST_AUTO_TEST_CASE(PayloadMergerEmptyTest) {
+  auto zmq = FairMQTransportFactory::CreateTransportFactory("zeromq");
+
+  auto checkIfComplete = [](SubframeId id, o2::dataflow::PayloadMerger<SubframeId>::MessageMap &m) -> bool {
+    return m.count(id) >= 1;
+  };
+
+  auto makeId = [](std::unique_ptr<FairMQMessage> &msg) {
+    auto header = reinterpret_cast<o2::header::HeartbeatHeader const*>(msg->GetData());
+    return o2::dataflow::makeIdFromHeartbeatHeader(*header, 0, 2);
+  };
+
+  o2::dataflow::PayloadMerger<SubframeId> merger(makeId, checkIfComplete, o2::dataflow::extractDetectorPayloadStrip);
+  // Only heartbeat header and trailer, the detector payload is empty
+  auto msg = zmq->CreateMessage(sizeof(HeartbeatHeader) + sizeof(HeartbeatTrailer));
+  reinterpret_cast<HeartbeatHeader*>(msg->GetData())->orbit = 1;
+  auto id = merger.aggregate(msg);
+  char *finalBuf = nullptr;
+  BOOST_CHECK(merger.finalise(&finalBuf, id) == 0);
+  BOOST_CHECK(finalBuf == nullptr); // Nothing allocated for an empty merge
+  // The parts of the id are gone, a new part of the same id is merged on its own
+  fakeAddition(merger, zmq, 1);
+  size_t partSize = (1000-sizeof(HeartbeatHeader) - sizeof(HeartbeatTrailer));
+  BOOST_CHECK(merger.finalise(&finalBuf, id) == partSize);
+  delete[] finalBuf;
+}
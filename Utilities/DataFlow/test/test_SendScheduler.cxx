@@ -0,0 +1,127 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Utilities DataFlowTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include "DataFlow/SendScheduler.h"
+#include <string>
+
+using Scheduler = o2::dataflow::SendScheduler<std::string>;
+using o2::dataflow::SendSchedulerConfig;
+using std::chrono::milliseconds;
+
+BOOST_AUTO_TEST_CASE(SendSchedulerDelay)
+{
+  auto t0 = Scheduler::Clock::now();
+  SendSchedulerConfig config;
+  config.nDestinations = 3;
+  config.delay = milliseconds(10);
+  Scheduler scheduler(config, t0);
+
+  BOOST_CHECK(scheduler.push("a", 4, 100, t0));
+  BOOST_CHECK(scheduler.push("b", 5, 100, t0 + milliseconds(5)));
+  BOOST_CHECK_EQUAL(scheduler.size(), 2);
+
+  std::string data;
+  uint32_t id;
+  size_t destination;
+  BOOST_CHECK(!scheduler.pop(data, id, destination, t0 + milliseconds(9)));
+  BOOST_REQUIRE(scheduler.pop(data, id, destination, t0 + milliseconds(10)));
+  BOOST_CHECK_EQUAL(data, "a");
+  BOOST_CHECK_EQUAL(id, 4);
+  BOOST_CHECK_EQUAL(destination, 1);
+  BOOST_CHECK(!scheduler.pop(data, id, destination, t0 + milliseconds(10)));
+  BOOST_REQUIRE(scheduler.pop(data, id, destination, t0 + milliseconds(15)));
+  BOOST_CHECK_EQUAL(data, "b");
+  BOOST_CHECK_EQUAL(destination, 2);
+  BOOST_CHECK_EQUAL(scheduler.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SendSchedulerQueueLimit)
+{
+  SendSchedulerConfig config;
+  config.nDestinations = 2;
+  config.maxQueueSize = 2;
+  Scheduler scheduler(config);
+
+  BOOST_CHECK(scheduler.push("a", 0, 1));
+  BOOST_CHECK(scheduler.push("b", 1, 1));
+  BOOST_CHECK(scheduler.full());
+  std::string rejected = "c";
+  BOOST_CHECK(!scheduler.push(std::move(rejected), 2, 1));
+  BOOST_CHECK_EQUAL(rejected, "c");
+}
+
+BOOST_AUTO_TEST_CASE(SendSchedulerRate)
+{
+  auto t0 = Scheduler::Clock::now();
+  SendSchedulerConfig config;
+  config.nDestinations = 2;
+  config.rate = 1000.; // 1 byte per ms
+  config.burst = 100;
+  Scheduler scheduler(config, t0);
+
+  for (uint32_t i = 0; i < 4; ++i) {
+    BOOST_CHECK(scheduler.push(std::to_string(i), i, 100, t0));
+  }
+  std::string data;
+  uint32_t id;
+  size_t destination;
+  // one full bucket per destination
+  BOOST_REQUIRE(scheduler.pop(data, id, destination, t0));
+  BOOST_CHECK_EQUAL(id, 0);
+  BOOST_REQUIRE(scheduler.pop(data, id, destination, t0));
+  BOOST_CHECK_EQUAL(id, 1);
+  BOOST_CHECK(!scheduler.pop(data, id, destination, t0 + milliseconds(50)));
+  BOOST_REQUIRE(scheduler.pop(data, id, destination, t0 + milliseconds(100)));
+  BOOST_CHECK_EQUAL(id, 2);
+  BOOST_REQUIRE(scheduler.pop(data, id, destination, t0 + milliseconds(100)));
+  BOOST_CHECK_EQUAL(id, 3);
+
+  // items larger than the bucket go out once the bucket is full
+  BOOST_CHECK(scheduler.push("big", 0, 250, t0 + milliseconds(100)));
+  BOOST_CHECK(!scheduler.pop(data, id, destination, t0 + milliseconds(150)));
+  BOOST_REQUIRE(scheduler.pop(data, id, destination, t0 + milliseconds(200)));
+  BOOST_CHECK_EQUAL(data, "big");
+}
+
+BOOST_AUTO_TEST_CASE(SendSchedulerCredits)
+{
+  SendSchedulerConfig config;
+  config.nDestinations = 2;
+  config.maxOutstanding = 1;
+  Scheduler scheduler(config);
+
+  scheduler.push("a", 0, 1);
+  scheduler.push("b", 2, 1);
+  scheduler.push("c", 1, 1);
+
+  std::string data;
+  uint32_t id;
+  size_t destination;
+  BOOST_REQUIRE(scheduler.pop(data, id, destination));
+  BOOST_CHECK_EQUAL(data, "a");
+  // destination 0 has no credit left, destination 1 is served
+  BOOST_REQUIRE(scheduler.pop(data, id, destination));
+  BOOST_CHECK_EQUAL(data, "c");
+  BOOST_CHECK(!scheduler.pop(data, id, destination));
+  BOOST_CHECK_EQUAL(scheduler.outstanding(0), 1);
+
+  scheduler.acknowledge(0);
+  BOOST_REQUIRE(scheduler.pop(data, id, destination));
+  BOOST_CHECK_EQUAL(data, "b");
+  // spurious acknowledgements are ignored
+  scheduler.acknowledge(1);
+  scheduler.acknowledge(1);
+  BOOST_CHECK_EQUAL(scheduler.outstanding(1), 0);
+}
@@ -0,0 +1,142 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Utilities DataFlowTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include "DataFlow/TimeframeAggregationRing.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Ring = o2::dataflow::TimeframeAggregationRing<std::string>;
+using AddResult = Ring::AddResult;
+
+BOOST_AUTO_TEST_CASE(TimeframeAggregationRingSimple)
+{
+  Ring ring(4, 3, std::chrono::milliseconds(1000));
+  BOOST_CHECK(ring.add(7, 2, "c") == AddResult::Added);
+  BOOST_CHECK(ring.add(7, 0, "a") == AddResult::Added);
+  BOOST_CHECK(ring.add(7, 0, "a") == AddResult::Duplicate);
+  // same slot, different timeframe
+  BOOST_CHECK(ring.add(11, 0, "x") == AddResult::Busy);
+  BOOST_CHECK(ring.add(7, 1, "b") == AddResult::Completed);
+  BOOST_CHECK(ring.add(7, 1, "b") == AddResult::Discarded);
+
+  uint32_t id;
+  std::vector<std::string> parts;
+  BOOST_REQUIRE(ring.popComplete(id, parts));
+  BOOST_CHECK_EQUAL(id, 7);
+  BOOST_REQUIRE_EQUAL(parts.size(), 3);
+  BOOST_CHECK_EQUAL(parts[0] + parts[1] + parts[2], "abc");
+  BOOST_CHECK(ring.popComplete(id, parts) == false);
+  // the slot can now be reused
+  BOOST_CHECK(ring.add(11, 0, "x") == AddResult::Added);
+}
+
+BOOST_AUTO_TEST_CASE(TimeframeAggregationRingTimeout)
+{
+  Ring ring(4, 2, std::chrono::milliseconds(20), 8);
+  BOOST_CHECK(ring.add(1, 0, "a") == AddResult::Added);
+  BOOST_CHECK_EQUAL(ring.expire(), 0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  std::vector<uint32_t> discarded;
+  std::vector<size_t> contributors;
+  auto onDiscard = [&discarded, &contributors](uint32_t id, const std::vector<size_t>& sources) {
+    discarded.push_back(id);
+    contributors = sources;
+  };
+  BOOST_CHECK_EQUAL(ring.expire(onDiscard), 1);
+  BOOST_REQUIRE_EQUAL(discarded.size(), 1);
+  BOOST_CHECK_EQUAL(discarded[0], 1);
+  // only source 0 had sent its part
+  BOOST_REQUIRE_EQUAL(contributors.size(), 1);
+  BOOST_CHECK_EQUAL(contributors[0], 0);
+  // late parts of a discarded timeframe are rejected
+  BOOST_CHECK(ring.add(1, 1, "b") == AddResult::Discarded);
+  BOOST_CHECK(ring.add(5, 1, "b") == AddResult::Added);
+}
+
+BOOST_AUTO_TEST_CASE(TimeframeAggregationRingLatePart)
+{
+  Ring ring(4, 2, std::chrono::milliseconds(20), 8);
+  BOOST_CHECK(ring.add(3, 0, "a") == AddResult::Added);
+  BOOST_CHECK(ring.add(3, 1, "b") == AddResult::Completed);
+  uint32_t id;
+  std::vector<std::string> parts;
+  BOOST_REQUIRE(ring.popComplete(id, parts));
+  // the slot is free again, but a duplicate part of the published timeframe
+  // must not start a new aggregation
+  BOOST_CHECK(ring.add(3, 1, "b") == AddResult::Discarded);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_CHECK_EQUAL(ring.expire(), 0);
+  BOOST_CHECK(ring.add(7, 0, "c") == AddResult::Added);
+}
+
+BOOST_AUTO_TEST_CASE(TimeframeAggregationRingWraparound)
+{
+  // 16 bit ids as used by the EPN, wrapping from 65535 to 0
+  using ShortRing = o2::dataflow::TimeframeAggregationRing<std::string, uint16_t>;
+  ShortRing ring(4, 1, std::chrono::milliseconds(1000));
+  uint16_t id;
+  std::vector<std::string> parts;
+  BOOST_CHECK(ring.add(65532, 0, "a") == ShortRing::AddResult::Completed);
+  BOOST_REQUIRE(ring.popComplete(id, parts));
+  BOOST_CHECK_EQUAL(id, 65532);
+  // same slot, older id
+  BOOST_CHECK(ring.add(65528, 0, "x") == ShortRing::AddResult::Discarded);
+  // same slot, newer id after the wraparound
+  BOOST_CHECK(ring.add(0, 0, "b") == ShortRing::AddResult::Completed);
+  BOOST_REQUIRE(ring.popComplete(id, parts));
+  BOOST_CHECK_EQUAL(id, 0);
+  BOOST_CHECK(ring.add(65532, 0, "a") == ShortRing::AddResult::Discarded);
+  BOOST_CHECK(ring.add(4, 0, "c") == ShortRing::AddResult::Completed);
+}
+
+BOOST_AUTO_TEST_CASE(TimeframeAggregationRingThreads)
+{
+  const size_t nSources = 8;
+  const uint32_t nTimeframes = 2000;
+  Ring ring(64, nSources, std::chrono::milliseconds(10000));
+  std::atomic<bool> done{ false };
+  std::vector<std::thread> threads;
+  for (size_t source = 0; source < nSources; ++source) {
+    threads.emplace_back([&ring, source]() {
+      for (uint32_t id = 0; id < nTimeframes; ++id) {
+        // Retry while the slot is still taken by an older timeframe.
+        while (ring.add(id, source, std::to_string(id)) == AddResult::Busy) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  uint32_t received = 0;
+  bool consistent = true;
+  while (received < nTimeframes) {
+    uint32_t id;
+    std::vector<std::string> parts;
+    if (!ring.popComplete(id, parts)) {
+      std::this_thread::yield();
+      continue;
+    }
+    for (auto& part : parts) {
+      consistent = consistent && part == std::to_string(id);
+    }
+    ++received;
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  BOOST_CHECK(consistent);
+  BOOST_CHECK_EQUAL(received, nTimeframes);
+}
@@ -0,0 +1,164 @@
+// Copyright CERN and copyright holders of ALICE O2. This software is
+// distributed under the terms of the GNU General Public License v3 (GPL
+// Version 3), copied verbatim in the file "COPYING".
+//
+// See http://alice-o2.web.cern.ch/license for full licensing information.
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+#define BOOST_TEST_MODULE Test Utilities DataFlowTest
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+
+#include <boost/test/unit_test.hpp>
+
+#include "DataFlow/TimeframeFileIndex.h"
+#include "DataFlow/TimeframeFileReader.h"
+#include "DataFlow/FakeTimeframeBuilder.h"
+#include "Headers/DataHeader.h"
+#include "TimeFrame/TimeFrame.h"
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace o2::DataFlow;
+using DataHeader = o2::header::DataHeader;
+
+namespace {
+// Writes two fake timeframes to @a filename, with a table of contents if
+// @a withFooter is set.
+void writeTestFile(const std::string& filename, bool withFooter)
+{
+  auto filler = [](char* b, size_t s) {
+    for (size_t i = 0; i < s; ++i) {
+      b[i] = i % 13;
+    }
+  };
+  std::vector<FakeTimeframeSpec> specs = {
+    { "TPC", "CLUSTERS", filler, 1000 },
+    { "ITS", "CLUSTERS", filler, 500 },
+    { "TPC", "RAWDATA", filler, 200 }
+  };
+  std::ofstream file(filename, std::ios::binary);
+  TimeframeFileIndex index(true);
+  uint64_t offset = 0;
+  for (int tf = 0; tf < 2; ++tf) {
+    size_t size = 0;
+    auto buffer = fakeTimeframeGenerator(specs, size);
+    index.beginTimeframe(offset);
+    size_t position = 0;
+    while (position < size) {
+      auto dh = reinterpret_cast<const DataHeader*>(buffer.get() + position);
+      index.addPart(*dh, offset + position, dh->headerSize, buffer.get() + position + dh->headerSize,
+                    dh->payloadSize);
+      position += dh->headerSize + dh->payloadSize;
+    }
+    index.endTimeframe(size);
+    file.write(buffer.get(), size);
+    offset += size;
+  }
+  if (withFooter) {
+    auto footer = index.serialize(offset);
+    file.write(footer.data(), footer.size());
+  }
+}
+
+void checkReader(TimeframeFileReader& reader)
+{
+  BOOST_REQUIRE_EQUAL(reader.getNumberOfTimeframes(), 2);
+  auto& index = reader.index();
+  // three parts plus the TIMEFRAMEINDEX
+  BOOST_CHECK_EQUAL(index.parts().size(), 8);
+  BOOST_CHECK_EQUAL(index.findParts(1, TimeframePartSelector("")).size(), 4);
+  BOOST_CHECK_EQUAL(index.findParts(1, TimeframePartSelector("ITS")).size(), 1);
+  BOOST_CHECK_EQUAL(index.findParts(0, TimeframePartSelector("*/CLUSTERS")).size(), 2);
+
+  auto tpc = index.findParts(1, TimeframePartSelector("TPC/CLUSTERS/0"));
+  BOOST_REQUIRE_EQUAL(tpc.size(), 1);
+  std::vector<char> header(tpc[0]->headerSize);
+  std::vector<char> payload(tpc[0]->payloadSize);
+  reader.readHeader(*tpc[0], header.data());
+  reader.readPayload(*tpc[0], payload.data());
+  BOOST_CHECK(reinterpret_cast<DataHeader*>(header.data())->dataOrigin == o2::header::gDataOriginTPC);
+  BOOST_CHECK_EQUAL(payload.size(), 1000);
+  BOOST_CHECK_EQUAL(payload[27], 27 % 13);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(TimeframeFileIndexRoundTrip)
+{
+  std::string filename = "test_TimeframeFileIndex_" + std::to_string(getpid()) + ".o2tf";
+  writeTestFile(filename, true);
+  TimeframeFileReader reader(filename);
+  BOOST_CHECK(reader.hasTableOfContents());
+  BOOST_CHECK(reader.index().hasChecksums());
+  checkReader(reader);
+  remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TimeframeFileIndexScan)
+{
+  std::string filename = "test_TimeframeFileIndex_scan_" + std::to_string(getpid()) + ".o2tf";
+  writeTestFile(filename, false);
+  TimeframeFileReader reader(filename);
+  BOOST_CHECK(reader.hasTableOfContents() == false);
+  checkReader(reader);
+  remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TimeframeFileIndexChecksum)
+{
+  std::string filename = "test_TimeframeFileIndex_crc_" + std::to_string(getpid()) + ".o2tf";
+  writeTestFile(filename, true);
+  TimeframeFileReader reader(filename);
+  auto part = reader.index().findParts(0, TimeframePartSelector("ITS"))[0];
+  {
+    // corrupt one byte of the payload
+    std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(part->payloadOffset() + 10);
+    file.put(42);
+  }
+  TimeframeFileReader corrupted(filename);
+  std::vector<char> payload(part->payloadSize);
+  BOOST_CHECK_THROW(corrupted.readPayload(*part, payload.data()), std::runtime_error);
+  remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(TimeframeFileIndexReadSelected)
+{
+  std::string filename = "test_TimeframeFileIndex_select_" + std::to_string(getpid()) + ".o2tf";
+  writeTestFile(filename, true);
+  TimeframeFileReader reader(filename);
+  std::vector<std::unique_ptr<char[]>> parts;
+  std::vector<size_t> sizes;
+  auto addPart = [&parts, &sizes](char* buffer, size_t size) {
+    parts.emplace_back(buffer);
+    sizes.push_back(size);
+  };
+  BOOST_REQUIRE(reader.readSelected(1, TimeframePartSelector("*/CLUSTERS"), addPart));
+
+  // two header / payload pairs and the rebuilt TIMEFRAMEINDEX
+  BOOST_REQUIRE_EQUAL(parts.size(), 6);
+  auto indexHeader = reinterpret_cast<const DataHeader*>(parts[4].get());
+  BOOST_CHECK(indexHeader->dataDescription == o2::header::DataDescription("TIMEFRAMEINDEX"));
+  BOOST_REQUIRE_EQUAL(indexHeader->payloadSize, 2 * sizeof(o2::DataFormat::IndexElement));
+  auto index = reinterpret_cast<const o2::DataFormat::IndexElement*>(parts[5].get());
+  for (size_t k = 0; k < 2; ++k) {
+    // every index entry points at the header of its part, the payload follows
+    BOOST_REQUIRE_EQUAL(index[k].second, 2 * k);
+    auto dh = reinterpret_cast<const DataHeader*>(parts[index[k].second].get());
+    BOOST_CHECK(dh->dataOrigin == index[k].first.dataOrigin);
+    BOOST_CHECK(dh->dataDescription == o2::header::DataDescription("CLUSTERS"));
+    BOOST_CHECK_EQUAL(sizes[index[k].second + 1], dh->payloadSize);
+  }
+
+  // timeframes beyond the end of the file are not read
+  BOOST_CHECK(!reader.readSelected(reader.getNumberOfTimeframes(), TimeframePartSelector("*/CLUSTERS"), addPart));
+  BOOST_CHECK_EQUAL(parts.size(), 6);
+  remove(filename.c_str());
+}
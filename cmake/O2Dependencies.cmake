@@ -274,6 +274,7 @@ o2_define_bucket(
 
     INCLUDE_DIRECTORIES
     ${FAIRROOT_INCLUDE_DIR}
+    ${CMAKE_SOURCE_DIR}/Utilities/DataFlow/include
 )
 
 o2_define_bucket(
@@ -754,6 +755,7 @@ o2_define_bucket(
     SimulationDataFormat
     CommonDataFormat
     DataFormatsTPC
+    $<IF:$<BOOL:${benchmark_FOUND}>,benchmark::benchmark,$<0:"">>
 
     INCLUDE_DIRECTORIES
     ${CMAKE_SOURCE_DIR}/Common/MathUtils/include
@@ -785,6 +787,7 @@ o2_define_bucket(
     Base
     TreePlayer
     Steer
+    $<IF:$<BOOL:${benchmark_FOUND}>,benchmark::benchmark,$<0:"">>
     #   Core
     #    root_base_bucket
     #    fairroot_geom
@@ -799,6 +802,7 @@ o2_define_bucket(
     ${CMAKE_SOURCE_DIR}/Common/Field/include
     ${CMAKE_SOURCE_DIR}/Common/MathUtils/include
     ${CMAKE_SOURCE_DIR}/DataFormats/Detectors/TPC/include
+    ${CMAKE_SOURCE_DIR}/Steer/include
     ${MS_GSL_INCLUDE_DIR}
 )
 